@@ -0,0 +1,14 @@
+#include <adf.h>
+#include "kernels.h"
+#include "graph.h"
+
+using namespace adf;
+
+attentionGraph mygraph;
+
+int main(void) {
+  mygraph.init();
+  mygraph.run(ITERATIONS);
+  mygraph.end();
+  return 0;
+}
@@ -0,0 +1,79 @@
+#include <adf.h>
+#include "kernels.h"
+#include "kernels/attention.h"
+
+#ifdef PLACEMENT
+#include "placement.h"
+#endif
+
+using namespace adf;
+
+// PLIO data files are text by default, raw binary when built with -DPLIO_BINARY
+#ifdef PLIO_BINARY
+#define PLIO_EXT ".bin"
+#define PLIO_IS_BINARY true
+#else
+#define PLIO_EXT ".txt"
+#define PLIO_IS_BINARY false
+#endif
+
+class attentionGraph : public adf::graph {
+private:
+
+  kernel qk, sm, pv;
+
+public:
+
+  input_plio  Qin, KTin, Vin;
+  output_plio Oout;
+
+
+  attentionGraph(){
+
+	  // K arrives transposed, HEAD_DIM x SEQ, as the B operand of Q K^T
+	  Qin  = input_plio::create("q",  plio_128_bits, std::string("data/q") + PLIO_EXT,  0.0, PLIO_IS_BINARY);
+	  KTin = input_plio::create("kt", plio_128_bits, std::string("data/kt") + PLIO_EXT, 0.0, PLIO_IS_BINARY);
+	  Vin  = input_plio::create("v",  plio_128_bits, std::string("data/v") + PLIO_EXT,  0.0, PLIO_IS_BINARY);
+	  Oout = output_plio::create("o", plio_128_bits, std::string("data/o") + PLIO_EXT,  0.0, PLIO_IS_BINARY);
+
+	  qk = kernel::create(scores);
+	  sm = kernel::create(softmax);
+	  pv = kernel::create(context);
+
+	  connect< window<SEQ*HEAD_DIM*sizeof(int32)> >  (Qin.out[0], qk.in[0]);
+	  connect< window<HEAD_DIM*SEQ*sizeof(int32)> >  (KTin.out[0], qk.in[1]);
+	  not_equal(location<buffer>(qk.in[0]), location<buffer>(qk.in[1]));
+
+	  // the SEQ x SEQ scores and probabilities never leave the array
+	  connect< window<SEQ*SEQ*sizeof(int32)> >  (qk.out[0], sm.in[0]);
+	  connect< window<SEQ*SEQ*sizeof(int32)> >  (sm.out[0], pv.in[0]);
+
+	  connect< window<SEQ*HEAD_DIM*sizeof(int32)> >  (Vin.out[0], pv.in[1]);
+	  not_equal(location<buffer>(pv.in[0]), location<buffer>(pv.in[1]));
+
+	  connect< window<SEQ*HEAD_DIM*sizeof(int32)> >  (pv.out[0], Oout.in[0]);
+
+	  source(qk) = "aie/kernels/kernels.cc";
+	  source(sm) = "aie/kernels/kernels.cc";
+	  source(pv) = "aie/kernels/kernels.cc";
+
+	  runtime<ratio>(qk) = 1.0;
+	  runtime<ratio>(sm) = 1.0;
+	  runtime<ratio>(pv) = 1.0;
+
+#ifdef PLACEMENT
+	  // tiles and banks planned by tools/placement.py
+	  kernel *stages[] = {&qk, &sm, &pv};
+	  place_graph([&](int i) -> kernel & { return *stages[i]; });
+#else
+	  // the three kernels on neighbouring tiles (placement.pipeline()), each
+	  // window between them one ping-pong buffer in memory both reach: handed
+	  // over under locks, no DMA or copy
+	  location<kernel>(qk) = tile(24, 0);
+	  location<kernel>(sm) = tile(24, 1);
+	  location<kernel>(pv) = tile(24, 2);
+	  location<buffer>(qk.out[0]) = location<kernel>(sm);
+	  location<buffer>(sm.out[0]) = location<kernel>(pv);
+#endif
+  }
+};
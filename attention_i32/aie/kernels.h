@@ -0,0 +1,16 @@
+#ifndef FUNCTION_KERNELS_H
+#define FUNCTION_KERNELS_H
+
+	// S = Q K^T, blocked SEQ x SEQ
+	void scores(input_window_int32 * __restrict q, input_window_int32 * __restrict kt,
+				output_window_int32 * __restrict s);
+
+	// P = softmax(S / sqrt(HEAD_DIM)) along the rows, same layout
+	void softmax(input_window_int32 * __restrict s, output_window_int32 * __restrict p);
+
+	// O = P V, blocked SEQ x HEAD_DIM
+	void context(input_window_int32 * __restrict p, input_window_int32 * __restrict v,
+				 output_window_int32 * __restrict o);
+
+
+#endif
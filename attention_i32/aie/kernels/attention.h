@@ -0,0 +1,39 @@
+#ifndef ATTENTION_H
+#define ATTENTION_H
+
+// One attention head, O = softmax(Q K^T / sqrt(HEAD_DIM)) V, per graph
+// iteration. generate_golden.cpp reads the same definitions.
+
+// sequence length and head dimension; the scores and probabilities are
+// SEQ x SEQ windows between the kernels (2 x 4 KB ping-pong at SEQ 32)
+#define SEQ 16
+#define HEAD_DIM 16
+
+// aie::mmul shape of both GEMMs (gemm.h). The probabilities leave softmax in
+// the scores' MxN blocks and enter P V as MxK blocks, so K_API == N_API.
+#define M_API 2
+#define K_API 2
+#define N_API 2
+
+// Q, K and V are fixed point with FRAC fraction bits; Q K^T is shifted back
+// to FRAC bits, and so is P V, whose probabilities have PROB_BITS
+#define FRAC 6
+#define QK_SHIFT FRAC
+#define PROB_BITS 15
+#define PV_SHIFT PROB_BITS
+
+// softmax: exp(s / sqrt(HEAD_DIM)) = 2^(s * log2(e) / sqrt(HEAD_DIM)), the
+// exponent as Q16 from the FRAC-bit scores: log2(e) / sqrt(HEAD_DIM) in
+// Q(16 - FRAC). generate_golden checks it against HEAD_DIM and FRAC.
+#define EXP_SCALE 369
+
+// 2^-f = 1 - f (C1 - f (C2 - f C3)) on [0, 1), Q15, least squares fit
+// (max error 1.2e-4)
+#define EXP_C1 22670
+#define EXP_C2 7606
+#define EXP_C3 1324
+
+// graph iterations, one head each
+#define ITERATIONS 10
+
+#endif // ATTENTION_H
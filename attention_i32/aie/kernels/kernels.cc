@@ -0,0 +1,56 @@
+#include <adf.h>
+#include "aie_api/aie.hpp"
+#include "aie_api/aie_adf.hpp"
+#include "attention.h"
+#include "gemm.h"
+#include "softmax.h"
+
+
+/*
+ *  One attention head as three kernels in neighbouring tiles, the api_benchmark
+ *  GEMM on both sides of the softmax. All matrices are in the blocked format of
+ *  gemm_i32/aie/api_benchmark/aie/kernels/kernels.cc with the M_API x K_API x
+ *  N_API tiles of attention.h; K comes in transposed, as the B of Q K^T.
+ *
+ *  Each kernel prints its cycle count under aiesimulator.
+ */
+
+static_assert(K_API == N_API, "P leaves softmax in N_API-wide blocks and enters P V in K_API-wide ones");
+
+void scores(input_window_int32 * __restrict q, input_window_int32 * __restrict kt,
+			output_window_int32 * __restrict s) {
+
+	unsigned long long cycle_num[2];
+	aie::tile tile = aie::tile::current();
+	cycle_num[0] = tile.cycles();
+
+	gemm_blocked<SEQ, HEAD_DIM, SEQ, M_API, K_API, N_API>((int32*) q->ptr, (int32*) kt->ptr, (int32*) s->ptr, QK_SHIFT);
+
+	cycle_num[1] = tile.cycles();
+	printf("scores: start=%llu,end=%llu,total=%llu\n", cycle_num[0], cycle_num[1], cycle_num[1] - cycle_num[0]);
+}
+
+void softmax(input_window_int32 * __restrict s, output_window_int32 * __restrict p) {
+
+	unsigned long long cycle_num[2];
+	aie::tile tile = aie::tile::current();
+	cycle_num[0] = tile.cycles();
+
+	attention::softmax_blocked<SEQ, M_API, N_API>((int32*) s->ptr, (int32*) p->ptr);
+
+	cycle_num[1] = tile.cycles();
+	printf("softmax: start=%llu,end=%llu,total=%llu\n", cycle_num[0], cycle_num[1], cycle_num[1] - cycle_num[0]);
+}
+
+void context(input_window_int32 * __restrict p, input_window_int32 * __restrict v,
+			 output_window_int32 * __restrict o) {
+
+	unsigned long long cycle_num[2];
+	aie::tile tile = aie::tile::current();
+	cycle_num[0] = tile.cycles();
+
+	gemm_blocked<SEQ, SEQ, HEAD_DIM, M_API, K_API, N_API>((int32*) p->ptr, (int32*) v->ptr, (int32*) o->ptr, PV_SHIFT);
+
+	cycle_num[1] = tile.cycles();
+	printf("context: start=%llu,end=%llu,total=%llu\n", cycle_num[0], cycle_num[1], cycle_num[1] - cycle_num[0]);
+}
@@ -0,0 +1,108 @@
+#ifndef SOFTMAX_H
+#define SOFTMAX_H
+
+#include <adf.h>
+#include "aie_api/aie.hpp"
+#include "aie_api/aie_adf.hpp"
+#include "attention.h"
+
+/*
+ *  Row softmax of the S x S attention scores, in fixed point and 8 lanes at a
+ *  time, in the MA x NA blocked layout the GEMM writes them in (gemm.h): a
+ *  block row of MA score rows is S * MA consecutive values, and with MA * NA
+ *  dividing 8, lane l of every vector holds row (l % (MA * NA)) / NA.
+ *
+ *  Per block row, three passes over the vectors:
+ *   1. lane maxima, reduced to the row maxima m;
+ *   2. e = 2^-u with u = (m - s) * EXP_SCALE, the exponent in Q16: the
+ *      integer part shifts, the fraction goes through a cubic in Q15
+ *      (exp2_neg). e is Q15, 1.0 at the maximum, so no row overflows. e goes
+ *      to the output window and the lanes sum it up;
+ *   3. one reciprocal per row, 2^(15 + PROB_BITS) / sum, and p = e * r >> 15
+ *      in place, PROB_BITS fraction bits.
+ *
+ *  Only the per-row reductions and the MA divisions are scalar.
+ *  generate_golden.cpp computes the same integers element by element.
+ */
+
+namespace attention {
+
+constexpr unsigned V = 8;           // int32 lanes per vector
+constexpr unsigned EXP_BITS = 15;   // e = 2^-u in Q15
+
+template <unsigned MA, unsigned NA>
+constexpr unsigned lane_row(unsigned l) { return (l % (MA * NA)) / NA; }
+
+// reduce the lanes of each row with f from init, map the row's result with g
+// and spread it back to the row's lanes
+template <unsigned MA, unsigned NA, typename F, typename G>
+inline aie::vector<int32, V> per_row(const aie::vector<int32, V> &v, int32 init, F f, G g)
+{
+    int32 r[MA];
+    for (unsigned m = 0; m < MA; ++m)
+        r[m] = init;
+    for (unsigned l = 0; l < V; ++l)
+        r[lane_row<MA, NA>(l)] = f(r[lane_row<MA, NA>(l)], v.get(l));
+    for (unsigned m = 0; m < MA; ++m)
+        r[m] = g(r[m]);
+
+    aie::vector<int32, V> out;
+    for (unsigned l = 0; l < V; ++l)
+        out.set(r[lane_row<MA, NA>(l)], l);
+    return out;
+}
+
+// 2^(-u / 2^16) in Q15, u >= 0
+inline aie::vector<int32, V> exp2_neg(const aie::vector<int32, V> &u)
+{
+    const aie::vector<int32, V> n = aie::downshift(u, 16);
+    const aie::vector<int32, V> f = aie::downshift(aie::bit_and(u, 0xffff), 1);
+
+    aie::vector<int32, V> y = aie::sub(EXP_C2, aie::mul(f, EXP_C3).template to_vector<int32>(EXP_BITS));
+    y = aie::sub(EXP_C1, aie::mul(f, y).template to_vector<int32>(EXP_BITS));
+    y = aie::sub(1 << EXP_BITS, aie::mul(f, y).template to_vector<int32>(EXP_BITS));
+
+    // y >> n lane by lane: one select per bit of n, nothing left from 16 on
+    y = aie::select(y, aie::downshift(y, 1), aie::neq(aie::bit_and(n, 1), 0));
+    y = aie::select(y, aie::downshift(y, 2), aie::neq(aie::bit_and(n, 2), 0));
+    y = aie::select(y, aie::downshift(y, 4), aie::neq(aie::bit_and(n, 4), 0));
+    y = aie::select(y, aie::downshift(y, 8), aie::neq(aie::bit_and(n, 8), 0));
+    return aie::select(y, aie::zeros<int32, V>(), aie::ge(n, 16));
+}
+
+template <unsigned S, unsigned MA, unsigned NA>
+inline void softmax_blocked(const int32 *__restrict in, int32 *__restrict out)
+{
+    static_assert(V % (MA * NA) == 0, "an mmul block (M_API x N_API) must divide a vector of 8");
+    static_assert(S % MA == 0 && (S * MA) % V == 0, "block rows must be whole vectors");
+    constexpr unsigned n = S * MA / V;   // vectors per block row
+
+    for (unsigned i = 0; i < S / MA; ++i) {
+        const int32 *__restrict pi = in + i * S * MA;
+        int32 *__restrict po = out + i * S * MA;
+
+        aie::vector<int32, V> lanes = aie::load_v<V>(pi);
+        for (unsigned t = 1; t < n; ++t) chess_prepare_for_pipelining
+            lanes = aie::max(lanes, aie::load_v<V>(pi + V * t));
+        const aie::vector<int32, V> m = per_row<MA, NA>(
+            lanes, -2147483647 - 1, [](int32 a, int32 b) { return a > b ? a : b; }, [](int32 a) { return a; });
+
+        lanes = aie::zeros<int32, V>();
+        for (unsigned t = 0; t < n; ++t) chess_prepare_for_pipelining {
+            const aie::vector<int32, V> d = aie::sub(m, aie::load_v<V>(pi + V * t));
+            const aie::vector<int32, V> e = exp2_neg(aie::mul(d, EXP_SCALE).template to_vector<int32>(0));
+            lanes = aie::add(lanes, e);
+            aie::store_v(po + V * t, e);
+        }
+        const aie::vector<int32, V> r = per_row<MA, NA>(
+            lanes, 0, [](int32 a, int32 b) { return a + b; },
+            [](int32 sum) { return int32((1LL << (EXP_BITS + PROB_BITS)) / sum); });
+
+        for (unsigned t = 0; t < n; ++t) chess_prepare_for_pipelining
+            aie::store_v(po + V * t, aie::mul(aie::load_v<V>(po + V * t), r).template to_vector<int32>(EXP_BITS));
+    }
+}
+
+} // namespace attention
+
+#endif // SOFTMAX_H
@@ -0,0 +1,185 @@
+/*
+*	How to run:
+* 	g++ -std=c++17 -O2 -o generate_golden.exe generate_golden.cpp
+*	./generate_golden.exe [--binary]
+*
+*	Writes ITERATIONS heads of random Q, K^T and V to data/q, kt, v and the
+*	expected O to data/o, all blocked as the kernels read and write them.
+*	O is computed with the kernels' integer arithmetic (the same shifts, the
+*	same exp polynomial and reciprocal), so the outputs match exactly; the
+*	error of that arithmetic against floating-point attention is printed.
+*
+*	--binary writes raw int32 .bin files for graphs built with PLIO_BINARY
+*	instead of the four-values-per-line text files.
+*
+*/
+
+#include <cmath>
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+#include "aie/kernels/attention.h"
+
+
+static bool binary = false;
+
+// write the i-th value of a PLIO file, four values per text line
+static void write_value(std::fstream &f, int32_t v, int i){
+
+	if (binary){
+		f.write(reinterpret_cast<const char*>(&v), sizeof(v));
+		return;
+	}
+
+	f << int(v);
+	if (i % 4 == 3){
+		f << "\n";
+	}
+	else{
+		f << " ";
+	}
+}
+
+// a rows x cols row-major matrix in the blocked order of gemm.h, br x bc blocks
+static void write_blocked(std::fstream &f, const std::vector<int32_t> &m, int rows, int cols, int br, int bc){
+
+	int i = 0;
+	for (int r0 = 0; r0 < rows; r0 += br)
+		for (int c0 = 0; c0 < cols; c0 += bc)
+			for (int r = r0; r < r0 + br; r++)
+				for (int c = c0; c < c0 + bc; c++)
+					write_value(f, m[r * cols + c], i++);
+}
+
+// the accumulator's to_vector(shift): floor, as the kernels leave the rounding mode
+static int32_t srs(int64_t v, int shift){
+	return int32_t(v >> shift);
+}
+
+// attention::exp2_neg on one lane: 2^(-u / 2^16) in Q15
+static int32_t exp2_neg(int32_t u){
+
+	const int32_t n = u >> 16;
+	const int32_t f = (u & 0xffff) >> 1;
+
+	int32_t y = EXP_C2 - srs(int64_t(f) * EXP_C3, 15);
+	y = EXP_C1 - srs(int64_t(f) * y, 15);
+	y = (1 << 15) - srs(int64_t(f) * y, 15);
+
+	return n >= 16 ? 0 : y >> n;
+}
+
+
+int main(int argc, char **argv){
+
+	binary = argc > 1 && std::string(argv[1]) == "--binary";
+	const std::string ext = binary ? ".bin" : ".txt";
+	const auto mode = binary ? std::ios::out | std::ios::binary : std::ios::out;
+
+	// EXP_SCALE is log2(e) / sqrt(HEAD_DIM) in Q(16 - FRAC)
+	const long exp_scale = lround(std::log2(std::exp(1.0)) / std::sqrt(double(HEAD_DIM)) * double(1 << (16 - FRAC)));
+	if (exp_scale != EXP_SCALE){
+		std::cerr << "generate_golden: EXP_SCALE should be " << exp_scale << " for HEAD_DIM " << HEAD_DIM
+				  << " and FRAC " << FRAC << " (attention.h)\n";
+		return 1;
+	}
+
+	std::fstream q_file("./data/q" + ext, mode);
+	std::fstream kt_file("./data/kt" + ext, mode);
+	std::fstream v_file("./data/v" + ext, mode);
+	std::fstream o_file("./data/o" + ext, mode);
+
+	// seed
+	srand(time(NULL));
+
+	std::vector<int32_t> q(SEQ * HEAD_DIM), kt(HEAD_DIM * SEQ), v(SEQ * HEAD_DIM);
+	std::vector<int32_t> s(SEQ * SEQ), p(SEQ * SEQ), o(SEQ * HEAD_DIM);
+	const double one = double(1 << FRAC);
+	double max_err = 0.0;
+
+	for (int batch = 0; batch < ITERATIONS; batch++){
+
+		// values in [-2, 2)
+		for (auto *m : {&q, &kt, &v})
+			for (auto &x : *m)
+				x = rand() % (4 << FRAC) - (2 << FRAC);
+
+		// S = Q K^T >> QK_SHIFT
+		for (int i = 0; i < SEQ; i++)
+			for (int j = 0; j < SEQ; j++){
+				int64_t acc = 0;
+				for (int k = 0; k < HEAD_DIM; k++)
+					acc += int64_t(q[i * HEAD_DIM + k]) * kt[k * SEQ + j];
+				s[i * SEQ + j] = srs(acc, QK_SHIFT);
+			}
+
+		// P: row max, e = 2^-((max - s) EXP_SCALE), one reciprocal per row
+		for (int i = 0; i < SEQ; i++){
+			int32_t mx = s[i * SEQ];
+			for (int j = 1; j < SEQ; j++)
+				mx = std::max(mx, s[i * SEQ + j]);
+
+			int32_t sum = 0;
+			for (int j = 0; j < SEQ; j++){
+				const int64_t u = int64_t(mx - s[i * SEQ + j]) * EXP_SCALE;
+				if (u > INT32_MAX){
+					std::cerr << "generate_golden: score range overflows the softmax exponent\n";
+					return 1;
+				}
+				p[i * SEQ + j] = exp2_neg(int32_t(u));
+				sum += p[i * SEQ + j];
+			}
+
+			const int32_t r = int32_t((1LL << (15 + PROB_BITS)) / sum);
+			for (int j = 0; j < SEQ; j++)
+				p[i * SEQ + j] = srs(int64_t(p[i * SEQ + j]) * r, 15);
+		}
+
+		// O = P V >> PV_SHIFT
+		for (int i = 0; i < SEQ; i++)
+			for (int j = 0; j < HEAD_DIM; j++){
+				int64_t acc = 0;
+				for (int k = 0; k < SEQ; k++)
+					acc += int64_t(p[i * SEQ + k]) * v[k * HEAD_DIM + j];
+				o[i * HEAD_DIM + j] = srs(acc, PV_SHIFT);
+			}
+
+		// floating-point attention on the same inputs
+		for (int i = 0; i < SEQ; i++){
+			std::vector<double> e(SEQ);
+			double mx = -INFINITY, sum = 0.0;
+			for (int j = 0; j < SEQ; j++){
+				double d = 0.0;
+				for (int k = 0; k < HEAD_DIM; k++)
+					d += q[i * HEAD_DIM + k] / one * (kt[k * SEQ + j] / one);
+				e[j] = d / std::sqrt(double(HEAD_DIM));
+				mx = std::max(mx, e[j]);
+			}
+			for (auto &x : e){
+				x = std::exp(x - mx);
+				sum += x;
+			}
+			for (int j = 0; j < HEAD_DIM; j++){
+				double ref = 0.0;
+				for (int k = 0; k < SEQ; k++)
+					ref += e[k] / sum * (v[k * HEAD_DIM + j] / one);
+				max_err = std::max(max_err, std::fabs(o[i * HEAD_DIM + j] / one - ref));
+			}
+		}
+
+		write_blocked(q_file, q, SEQ, HEAD_DIM, M_API, K_API);
+		write_blocked(kt_file, kt, HEAD_DIM, SEQ, K_API, N_API);
+		write_blocked(v_file, v, SEQ, HEAD_DIM, K_API, N_API);
+		write_blocked(o_file, o, SEQ, HEAD_DIM, M_API, N_API);
+	}
+
+	printf("attention %dx%d, %d heads: max |O - O_float| = %.4f (%.2f LSB)\n",
+		   SEQ, HEAD_DIM, ITERATIONS, max_err, max_err * one);
+
+	return 0;
+}
@@ -0,0 +1,238 @@
+"""
+Benchmark suite for every kernel variant in the repo.
+
+Runs each variant over a sweep of sizes and records cycles per invocation,
+MACs/cycle, program and data memory, and pass/fail against the golden data,
+into bench/results/bench.json and bench.csv. Cycles are compared against
+bench/baseline.json (from the same backend and cycle source) and anything
+slower than --tolerance, or failing where it used to pass, is flagged as a
+regression (exit code 1). The baseline is seeded with the aiesimulator numbers
+recorded in the kernel sources that print their own cycles; the gemv_i32 and
+gemv_i16 kernels.cc figures (79/87/42) are not seeded, as bench can only time
+those sources by their output timestamps, which also count PLIO, locks and
+the call.
+
+  --backend aiesim  build with aiecompiler and run aiesimulator per variant.
+                    Cycles come from the kernels' tile.cycles() printouts
+                    ("total = N"), or, for kernels without one, from the
+                    spacing of the output window timestamps. Program memory
+                    is the code size of the tile ELF in Work/aie.
+  --backend model   the tools/perf_model.h kernel cycles (autotune.model), with `make host_sim`
+                    for pass/fail; program memory is unknown.
+
+Data memory is the tile footprint from tools/footprint.py: weights, ping-pong
+windows, heap and stack.
+
+The default is aiesim when aiesimulator is on PATH, model otherwise.
+
+How to run:
+python bench/bench.py                       # all variants
+python bench/bench.py --filter gemv_i32     # variants whose id contains the string
+python bench/bench.py --update-baseline     # accept the current numbers
+"""
+
+import argparse
+import csv
+import glob
+import json
+import os
+import re
+import shutil
+import statistics
+import struct
+import sys
+
+REPO = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+sys.path.insert(0, os.path.join(REPO, "tools"))
+import autotune  # noqa: E402
+import footprint  # noqa: E402
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+BASELINE = os.path.join(HERE, "baseline.json")
+
+GEMV_SIZES = [(16, 16), (32, 32), (64, 64)]
+GEMM_SIZES = [(16, 32, 16), (32, 32, 32)]
+
+
+def variants():
+    """(id, Config, shape, macs) for every benchmark, or a reason it is skipped."""
+    out = []
+    for k, n in GEMV_SIZES:
+        for kernel in ("GemV8", "GemV4"):
+            sources = ["unrolled_kernels.cc", "packed_kernels.cc"]
+            if (k, n) == (16, 16):
+                sources = ["kernels.cc", "optimized_kernels.cc"] + sources
+            for source in sources:
+                cfg = autotune.Config("gemv_i32", dict(kernel=kernel, source=source, Q=2),
+                                      autotune.gemv_configs(k, n, "int32")[0].memory)
+                out.append((f"gemv_i32/{kernel}/{source}/{k}x{n}", cfg, (k, n), k * n))
+
+    for cfg in autotune.gemv_configs(16, 16, "int16"):
+        out.append(("gemv_i16/GemV/kernels.cc/16x16", cfg, (16, 16), 16 * 16))
+
+    out.append(("gemv_i8/GemV8/kernels.cc/16x8", "graph declares GemV, kernels.cc defines GemV8/GemV16", None, 0))
+
+    for m, k, n in GEMM_SIZES:
+        for ma, ka, na in autotune.GEMM_API_SHAPES:
+            if m % (2 * ma) or n % (2 * na) or k % ka:
+                continue
+            cfg = autotune.Config("gemm_i32", dict(M_API=ma, K_API=ka, N_API=na,
+                                                   single_M=m, single_K=k, single_N=n),
+                                  footprint.gemm(m, k, n).total)
+            out.append((f"gemm_i32/{ma}x{ka}x{na}/kernels.cc/{m}x{k}x{n}", cfg, (m, k, n), m * k * n))
+    return out
+
+
+# ---------------------------------------------------------------- measurements
+
+def elf_program_bytes(directory):
+    """Size of the executable sections of the first AIE tile ELF under Work/aie."""
+    for path in sorted(glob.glob(os.path.join(directory, "Work", "aie", "*", "Release", "*"))):
+        if os.path.splitext(path)[1] or not os.path.isfile(path):
+            continue
+        with open(path, "rb") as f:
+            blob = f.read()
+        if blob[:4] != b"\x7fELF" or blob[4] != 1:
+            continue
+        endian = "<" if blob[5] == 1 else ">"
+        shoff, = struct.unpack_from(endian + "I", blob, 0x20)
+        shentsize, shnum = struct.unpack_from(endian + "HH", blob, 0x2E)
+        program = 0
+        for i in range(shnum):
+            _, _, flags, _, _, size = struct.unpack_from(endian + "IIIIII", blob, shoff + i * shentsize)
+            if flags & 0x2 and flags & 0x4:     # SHF_ALLOC | SHF_EXECINSTR
+                program += size
+        return program
+    return None
+
+
+def timestamp_interval(path, freq_ghz):
+    """Median cycles between output windows from the T lines of an aiesimulator output."""
+    if not os.path.exists(path):
+        return None
+    times = []
+    with open(path) as f:
+        for line in f:
+            m = re.match(r"T\s+(\d+(?:\.\d+)?)\s*(ps|ns|us)", line)
+            if m:
+                scale = {"ps": 1e-3, "ns": 1.0, "us": 1e3}[m.group(2)]
+                times.append(float(m.group(1)) * scale)
+    # one T line per output window transfer; consecutive windows give the interval
+    deltas = [b - a for a, b in zip(times, times[1:]) if b > a]
+    return round(statistics.median(deltas) * freq_ghz) if deltas else None
+
+
+def run(vid, cfg, shape, macs, args, index):
+    row = dict(id=vid, kind=vid.split("/")[0], cycles=None, cycles_source=None, macs=macs,
+               macs_per_cycle=None, program_bytes=None, data_bytes=None, status="ok", note="")
+    if isinstance(cfg, str):
+        row.update(status="skipped", note=cfg)
+        return row
+
+    row["data_bytes"] = cfg.memory
+    directory = autotune.prepare(cfg, shape, args.workdir, index)
+    source = cfg.params.get("source", "kernels.cc")
+
+    if args.backend == "model":
+        row.update(cycles=autotune.model_cycles(cfg, shape), cycles_source="model", note=autotune.model_note(cfg))
+        log = autotune.make(directory, "host_sim", [f"HOST_KERNELS=aie/kernels/{source}"])
+        if "Success: Outputs match" not in log:
+            row.update(status="fail", note="host_sim output mismatch")
+    else:
+        log = autotune.make(directory, "run_sim")
+        if "Success: Outputs match" not in log:
+            row.update(status="fail", note="aiesim output mismatch or build failure")
+        totals = [int(t) for t in re.findall(r"total\s*=\s*(\d+)", log)]
+        if totals:
+            row.update(cycles=statistics.median(totals), cycles_source="printf")
+        else:
+            out = "matC0.txt" if cfg.kind == "gemm_i32" else "y_sim.txt"
+            cycles = timestamp_interval(os.path.join(directory, "aiesimulator_output", "data", out), args.aie_freq)
+            if cycles is not None:
+                row.update(cycles=cycles, cycles_source="timestamps")
+        row["program_bytes"] = elf_program_bytes(directory)
+
+    if row["cycles"]:
+        row["macs_per_cycle"] = round(macs / row["cycles"], 2)
+    if not args.keep:
+        shutil.rmtree(directory, ignore_errors=True)
+    return row
+
+
+# ---------------------------------------------------------------- baseline
+
+def compare(rows, baseline, backend, tolerance):
+    regressions = 0
+    for row in rows:
+        entry = baseline.get(row["id"], {})
+        # cycles are only comparable between runs of the same backend, measured
+        # the same way: output timestamps include PLIO and lock time, printf not
+        same = entry.get("backend") == backend and entry.get("cycles_source") == row["cycles_source"]
+        ref = entry.get("cycles") if same else None
+        row["baseline"] = ref
+        row["regression"] = False
+        if ref and row["cycles"]:
+            row["delta_pct"] = round(100.0 * (row["cycles"] - ref) / ref, 1)
+            if row["cycles"] > ref * (1 + tolerance):
+                row["regression"] = True
+                regressions += 1
+        if row["status"] == "fail" and entry.get("status") == "ok":
+            row["regression"] = True
+            regressions += 1
+    return regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Benchmark all kernel variants and check for regressions.")
+    parser.add_argument("--backend", choices=["aiesim", "model"],
+                        default="aiesim" if shutil.which("aiesimulator") else "model")
+    parser.add_argument("--filter", default="", help="Only run variants whose id contains this string.")
+    parser.add_argument("--tolerance", type=float, default=0.02, help="Allowed cycle increase (fraction).")
+    parser.add_argument("--aie-freq", type=float, default=1.25, help="AIE clock in GHz for timestamp cycles.")
+    parser.add_argument("--out", default=os.path.join(HERE, "results"), help="Directory for bench.json/csv.")
+    parser.add_argument("--workdir", default=os.path.join(HERE, "work"))
+    parser.add_argument("--keep", action="store_true", help="Keep the per-variant build directories.")
+    parser.add_argument("--update-baseline", action="store_true", help="Write the results as the new baseline.")
+    args = parser.parse_args()
+
+    rows = [run(vid, cfg, shape, macs, args, i)
+            for i, (vid, cfg, shape, macs) in enumerate(variants()) if args.filter in vid]
+
+    baseline = {}
+    if os.path.exists(BASELINE):
+        with open(BASELINE) as f:
+            baseline = json.load(f)["results"]
+    regressions = compare(rows, baseline, args.backend, args.tolerance)
+
+    os.makedirs(args.out, exist_ok=True)
+    with open(os.path.join(args.out, "bench.json"), "w") as f:
+        json.dump(dict(backend=args.backend, results=rows), f, indent=2)
+    fields = ["id", "status", "cycles", "cycles_source", "baseline", "delta_pct", "regression",
+              "macs", "macs_per_cycle", "program_bytes", "data_bytes", "note"]
+    with open(os.path.join(args.out, "bench.csv"), "w", newline="") as f:
+        w = csv.DictWriter(f, fieldnames=fields, extrasaction="ignore")
+        w.writeheader()
+        w.writerows(rows)
+
+    print(f"{'variant':44} {'status':8} {'cycles':>7} {'base':>6} {'MAC/cyc':>7} {'prog':>6} {'data':>6}")
+    for r in rows:
+        flag = "  REGRESSION" if r["regression"] else ""
+        print(f"{r['id']:44} {r['status']:8} {r['cycles'] or '-':>7} {r['baseline'] or '-':>6} "
+              f"{r['macs_per_cycle'] or '-':>7} {r['program_bytes'] or '-':>6} {r['data_bytes'] or '-':>6}{flag}")
+    print(f"\n{len(rows)} variants, {regressions} regression(s), backend {args.backend}; results in {args.out}")
+
+    if args.update_baseline:
+        keep = {k: v for k, v in baseline.items() if k not in {r["id"] for r in rows}}
+        keep.update({r["id"]: dict(cycles=r["cycles"], cycles_source=r["cycles_source"],
+                                   status=r["status"], backend=args.backend)
+                     for r in rows if r["status"] != "skipped"})
+        with open(BASELINE, "w") as f:
+            json.dump(dict(results=dict(sorted(keep.items()))), f, indent=2)
+            f.write("\n")
+        print(f"baseline updated: {BASELINE}")
+        return 0
+    return 1 if regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -8,7 +8,7 @@ simpleGraph mygraph;
 
 int main(void) {
   mygraph.init();
-  mygraph.run(10);
+  mygraph.run(ITERATIONS);
   mygraph.end();
   return 0;
 }
\ No newline at end of file
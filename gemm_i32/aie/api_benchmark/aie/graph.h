@@ -4,8 +4,21 @@
 #include "kernels.h"
 #include "kernels/include.h"
 
+#ifdef PLACEMENT
+#include "placement.h"
+#endif
+
 using namespace adf;
 
+// PLIO data files are text by default, raw binary when built with -DPLIO_BINARY
+#ifdef PLIO_BINARY
+#define PLIO_EXT ".bin"
+#define PLIO_IS_BINARY true
+#else
+#define PLIO_EXT ".txt"
+#define PLIO_IS_BINARY false
+#endif
+
 class simpleGraph : public adf::graph {
 private:
 
@@ -23,15 +36,15 @@ public:
 
 	  // input and output PLIOs creation below
 	  for (int i = 0; i < mult_X * mult_Y; i++){
-		  A[i] = input_plio::create(plio_128_bits, "data/matA" + std::to_string(i) + ".txt");
+		  A[i] = input_plio::create("A" + std::to_string(i), plio_128_bits, "data/matA" + std::to_string(i) + PLIO_EXT, 0.0, PLIO_IS_BINARY);
 	  }
 
 	  for (int i = 0; i < mult_Y * mult_Z; i++){
-		  B[i] = input_plio::create(plio_128_bits, "data/matB" + std::to_string(i) + ".txt");
+		  B[i] = input_plio::create("B" + std::to_string(i), plio_128_bits, "data/matB" + std::to_string(i) + PLIO_EXT, 0.0, PLIO_IS_BINARY);
 	  }
 
 	  for (int i = 0; i < mult_X * mult_Z; i++){
-		  C[i] = output_plio::create(plio_128_bits, "data/matC" + std::to_string(i) + ".txt");
+		  C[i] = output_plio::create("C" + std::to_string(i), plio_128_bits, "data/matC" + std::to_string(i) + PLIO_EXT, 0.0, PLIO_IS_BINARY);
 	  }
 
 	  // kernels creation
@@ -39,20 +52,36 @@ public:
 		  mat_mul_k[i] = kernel::create(gemm);
 	  }
 
-	  // Single kernel connections
-	  connect< window<single_M*single_K*1> >  (A[0].out[0], mat_mul_k[0].in[0]);
-	  connect< window<single_K*single_N*1> >  (B[0].out[0], mat_mul_k[0].in[1]);
+	  // A[x] feeds the kernels of row x, B[z] those of column z, kernel (x, z)
+	  // writes C[x*mult_Z + z]. K is not split over kernels: a larger K runs as
+	  // several iterations whose partial C tiles the host adds up (tools/gemm_plan.h).
+	  static_assert(mult_Y == 1, "the graph has no adder for partial sums over mult_Y");
+	  for (int x = 0; x < mult_X; x++){
+		  for (int z = 0; z < mult_Z; z++){
+			  kernel &k = mat_mul_k[x * mult_Z + z];
 
-	  // Place buffers in different banks to prevent memory stalls (see UG1076 for more details)
-	  not_equal(location<buffer>(mat_mul_k[0].in[0]), location<buffer>(mat_mul_k[0].in[1]));
+			  connect< window<single_M*single_K*sizeof(int32)> >  (A[x].out[0], k.in[0]);
+			  connect< window<single_K*single_N*sizeof(int32)> >  (B[z].out[0], k.in[1]);
 
-	  connect< window<single_M*single_N*4> >  (mat_mul_k[0].out[0], C[0].in[0]);
+			  // Place buffers in different banks to prevent memory stalls (see UG1076 for more details)
+			  not_equal(location<buffer>(k.in[0]), location<buffer>(k.in[1]));
+
+			  connect< window<single_M*single_N*sizeof(int32)> >  (k.out[0], C[x * mult_Z + z].in[0]);
+		  }
+	  }
 
 	  // direct the source file of kernels
 	  for (int i = 0; i < mult_Y * mult_X * mult_Z; i++){
 		  source(mat_mul_k[i]) = "aie/kernels/kernels.cc";
 	  }
 
-	  runtime<ratio>(mat_mul_k[0]) = 1.0;
+	  for (int i = 0; i < mult_Y * mult_X * mult_Z; i++){
+		  runtime<ratio>(mat_mul_k[i]) = 1.0;
+	  }
+
+#ifdef PLACEMENT
+	  // tiles and banks planned by tools/placement.py
+	  place_graph([&](int i) -> kernel & { return mat_mul_k[i]; });
+#endif
   }
 };
\ No newline at end of file
@@ -0,0 +1,103 @@
+#ifndef GEMM_H
+#define GEMM_H
+
+#include <adf.h>
+#include "aie_api/aie.hpp"
+#include "aie_api/aie_adf.hpp"
+
+
+/*
+ *  The blocked GEMM of kernels.cc for any M x K x N: C = (A * B) >> shift,
+ *  with A, B and C in the blocked format described there and MA x KA x NA
+ *  the aie::mmul tile. attention_i32 instantiates it for Q K^T and P V.
+ *
+ *  gemm() in kernels.cc keeps its own copy of the loop: that copy is the one
+ *  measured at 1071 cycles (16x32x16 on 2x2x2), which bench, perf_model and
+ *  autotune are fitted to. This template, with its run-time shift, has not
+ *  been measured on aiesimulator.
+ *
+ *  C is computed two block rows by two block columns at a time, four mmul
+ *  accumulators fed by two A and two B loads per step.
+ */
+
+template <unsigned M, unsigned K, unsigned N, unsigned MA, unsigned KA, unsigned NA>
+inline void gemm_blocked(const int32 * __restrict pA, const int32 * __restrict pB, int32 * __restrict pC, int shift)
+{
+	static_assert(M % (2*MA) == 0 && N % (2*NA) == 0 && K % KA == 0,
+				  "M and N must be multiples of two mmul tiles, K of one");
+
+	using MMUL = aie::mmul<MA, KA, NA, int32, int32>;
+
+	// unroll the loops for more optimization
+	for (unsigned i = 0; i < (M/MA); i+=2)
+//		chess_prepare_for_pipelining
+		chess_flatten_loop
+
+	{
+
+		int32 * __restrict pC1 = pC + (i * (N/NA)) * MMUL::size_C;
+		int32 * __restrict pC2 = pC + ((i+1) * (N/NA)) * MMUL::size_C;
+
+		for (unsigned j = 0; j < (N/NA); j+=2)
+		chess_flatten_loop
+//		chess_prepare_for_pipelining
+//		Just write it this way, don't question it, or it won't scheudle at every clk.
+
+		{
+
+			const int32 * __restrict pA1 = pA + ( i * (K/KA) + 0) * MMUL::size_A;
+			const int32 * __restrict pA2 = pA + ( (i+1) * (K/KA) + 0) * MMUL::size_A;
+
+			const int32 * __restrict pB1 = pB + ( 0 * (N/NA) + j) * MMUL::size_B;
+			const int32 * __restrict pB2 = pB + ( 0 * (N/NA) + (j+1)) * MMUL::size_B;
+
+
+			aie::vector<int32, MMUL::size_A> A0 = aie::load_v<MMUL::size_A>(pA1); pA1 += MMUL::size_A;
+			aie::vector<int32, MMUL::size_A> A1 = aie::load_v<MMUL::size_A>(pA2); pA2 += MMUL::size_A;
+
+			aie::vector<int32, MMUL::size_B> B0 = aie::load_v<MMUL::size_B>(pB1); pB1 += MMUL::size_B * (N/NA);
+			aie::vector<int32, MMUL::size_B> B1 = aie::load_v<MMUL::size_B>(pB2); pB2 += MMUL::size_B * (N/NA);
+
+
+
+			MMUL C00;
+			MMUL C01;
+			MMUL C10;
+			MMUL C11;
+
+			// matrix multiply by initializing to 0
+			C00.mul(A0, B0);
+			C01.mul(A0, B1);
+			C10.mul(A1, B0);
+			C11.mul(A1, B1);
+
+			for (unsigned k = 0; k < (K/KA)-1; k++)
+//			chess_prepare_for_pipelining
+			chess_flatten_loop
+			{
+				A0 = aie::load_v<MMUL::size_A>(pA1); pA1 += MMUL::size_A;
+				A1 = aie::load_v<MMUL::size_A>(pA2); pA2 += MMUL::size_A;
+
+				B0 = aie::load_v<MMUL::size_B>(pB1); pB1 += MMUL::size_B * (N/NA);
+				B1 = aie::load_v<MMUL::size_B>(pB2); pB2 += MMUL::size_B * (N/NA);
+
+				// matrix multiply and adding partial blocks
+				C00.mac(A0, B0);
+				C01.mac(A0, B1);
+				C10.mac(A1, B0);
+				C11.mac(A1, B1);
+			}
+
+			aie::store_v(pC1, C00.template to_vector<int32>(shift)); pC1 +=MMUL::size_C;
+			aie::store_v(pC1, C01.template to_vector<int32>(shift)); pC1 +=MMUL::size_C;
+			aie::store_v(pC2, C10.template to_vector<int32>(shift)); pC2 +=MMUL::size_C;
+			aie::store_v(pC2, C11.template to_vector<int32>(shift)); pC2 +=MMUL::size_C;
+
+
+		}
+
+	}
+}
+
+
+#endif // GEMM_H
@@ -8,7 +8,7 @@
 
 // multiple AIE parameters (XxYxZ on manuscript)
 #define mult_X 1
-#define mult_Y 1 // Has to be 4 for pattern 1, 3 for pattern 2
+#define mult_Y 1 // K is split over iterations, not kernels (tools/gemm_plan.h)
 #define mult_Z 1
 
 
@@ -23,6 +23,9 @@
 #define K_API 2
 #define N_API 2
 
+// graph iterations, one batch of A, B and C tiles each
+#define ITERATIONS 10
+
 // INT32 sizes
 // 4x2x4
 // 2x2x2
@@ -1,11 +1,16 @@
 /*
 *	How to run:
 * 	g++ -o generate_golden_int32 generate_golden_int32.cpp
+*	./generate_golden_int32 [--binary]
+*
+*	--binary writes raw int32 data/mat*.bin files for graphs built with
+*	PLIO_BINARY instead of the four-values-per-line text files.
 *
 */
 
 #include <iostream>
 #include <fstream>
+#include <string>
 #include <stdio.h>
 #include <stdint.h>
 #include <stdlib.h>
@@ -13,8 +18,31 @@
 #include "aie/kernels/include.h"
 
 
+static bool binary = false;
+
+// write the i-th value of a PLIO file, four values per text line
+static void write_value(std::fstream &f, int32_t v, int i){
+
+	if (binary){
+		f.write(reinterpret_cast<const char*>(&v), sizeof(v));
+		return;
+	}
+
+	f << int(v);
+	if (i % 4 == 3){
+		f << "\n";
+	}
+	else{
+		f << " ";
+	}
+}
+
 
-int main(){
+int main(int argc, char **argv){
+
+	binary = argc > 1 && std::string(argv[1]) == "--binary";
+	const std::string ext = binary ? ".bin" : ".txt";
+	const auto mode = binary ? std::ios::out | std::ios::binary : std::ios::out;
 
 
 	auto matA = new int32_t [single_M * single_K][mult_X * mult_Y];
@@ -32,15 +60,15 @@ int main(){
 
 
 	for (int i = 0; i < mult_X * mult_Y; i++){
-		a_file_array[i].open("./data/matA" + std::to_string(i) + ".txt", std::ios::out);
+		a_file_array[i].open("./data/matA" + std::to_string(i) + ext, mode);
 	}
 
 	for (int i = 0; i < mult_Y * mult_Z; i++){
-		b_file_array[i].open("./data/matB" + std::to_string(i) + ".txt", std::ios::out);
+		b_file_array[i].open("./data/matB" + std::to_string(i) + ext, mode);
 	}
 
 	for (int i = 0; i < mult_X * mult_Z; i++){
-		c_file_array[i].open("./data/matC" + std::to_string(i) + ".txt", std::ios::out);
+		c_file_array[i].open("./data/matC" + std::to_string(i) + ext, mode);
 	}
 
 
@@ -48,7 +76,7 @@ int main(){
 	srand(time(NULL));
 
 
-	for (int batch = 0; batch < 10; batch++){
+	for (int batch = 0; batch < ITERATIONS; batch++){
 
 
 		// A matrix
@@ -70,13 +98,7 @@ int main(){
 			// write matA to matA.txt
 			for (int i = 0; i < single_M*single_K; i++){
 
-				a_file_array[xy] << int(matA[i][xy]);
-				if (i % 4 == 3) {
-					a_file_array[xy] << "\n";
-				}
-				else{
-					a_file_array[xy] << " ";
-				}
+				write_value(a_file_array[xy], matA[i][xy], i);
 			}
 		}
 
@@ -100,13 +122,7 @@ int main(){
 			// write matB to matB.txt
 			for (int i = 0; i < single_K*single_N; i++){
 
-				b_file_array[yz] << int(matB[i][yz]);
-				if (i % 4 == 3){
-					b_file_array[yz] << "\n";
-				}
-				else{
-					b_file_array[yz] << " ";
-				}
+				write_value(b_file_array[yz], matB[i][yz], i);
 			}
 		}
 
@@ -171,13 +187,7 @@ int main(){
 			// write to output after elementwise addition
 			for (int i = 0; i < single_M*single_N; i++){
 
-				c_file_array[xz] << int(matC[i][xz]);
-				if (i % 4 == 3){
-					c_file_array[xz] << "\n";
-				}
-				else{
-					c_file_array[xz] << " ";
-				}
+				write_value(c_file_array[xz], matC[i][xz], i);
 			}
 		}
 
@@ -2,6 +2,7 @@
 #include "aie_api/aie.hpp"
 #include "aie_api/aie_adf.hpp"
 #include "matrix.h"
+#include "quant.h"
 
 // #include <stdio.h>
 // #include <stdlib.h>
@@ -44,6 +45,6 @@ void GemV(
         );
     }
 
-    aie::vector<DTYPE, DY> vy = acc.to_vector<DTYPE>();
+    aie::vector<DTYPE, DY> vy = acc.to_vector<DTYPE>(SHIFT);
     window_writeincr(out, vy);
 }
\ No newline at end of file
@@ -1,12 +1,25 @@
 
 #include <adf.h>
+
+#define DX 16
+#define DY 16
+
 #include "kernels.h"
 #include <vector>
 
-using namespace adf;
+#ifdef WEIGHTS_RTP
+#include "weight_blob.h"
+#endif
 
-#define DX 16
-#define DY 16
+#ifdef SPLITK
+#include "quant.h"
+#endif
+
+#ifdef PLACEMENT
+#include "placement.h"
+#endif
+
+using namespace adf;
 
 class simpleGraph : public adf::graph {
 private:
@@ -16,26 +29,110 @@ public:
 
   input_plio  X;
   output_plio Y;
+#ifdef WEIGHTS_RTP
+  input_port  W;
+#elif defined(SPLITK)
+  input_plio  W;
+#endif
 
   simpleGraph(){
 
+#ifdef PLIO_BINARY
+		X = input_plio::create("X", plio_128_bits, "data/x.bin", 0.0, true);
+		Y = output_plio::create("Y", plio_128_bits, "data/y_sim.bin", 0.0, true);
+#ifdef SPLITK
+		W = input_plio::create("W", plio_128_bits, "data/w_chunks.bin", 0.0, true);
+#endif
+#else
 		X = input_plio::create(plio_128_bits, "data/x.txt");
 		Y = output_plio::create(plio_128_bits, "data/y_sim.txt");
+#ifdef SPLITK
+		W = input_plio::create(plio_128_bits, "data/w_chunks.txt");
+#endif
+#endif
+#ifdef WEIGHTS_RTP
+		// weights arrive through W; async keeps them until the next graph.update()
+		gemv_kernel = kernel::create(GemV8Rtp); // Modify to use GemV8Rtp or GemV4Rtp
+		connect< parameter >  (W, gemv_kernel.in[1]);
+		async(gemv_kernel.in[1]);
+#elif defined(SPLITK)
+		// SPLITK_K inputs through one tile, SPLITK_KC at a time with their weight
+		// rows on W; the partial sums stay in the kernel object until the last chunk
+		gemv_kernel = kernel::create_object<GemV8SplitK>(SPLITK_K / SPLITK_KC, SHIFT);
+#elif defined(MULTIHEAD)
+		// HEADS projections of the same x in one kernel, x read once
+		gemv_kernel = kernel::create(GemV8Heads);
+#elif defined(TRANSPOSE)
+		// y = W^T x from the same matrix_packed.h: DY inputs, DX outputs
+		gemv_kernel = kernel::create(GemVT4);
+#else
 		gemv_kernel = kernel::create(GemV8); // Modify to use GemV8 or GemV4
+#endif
 
+#ifdef SPLITK
+	  connect< window<SPLITK_KC*sizeof(int32_t)> >  (X.out[0], gemv_kernel.in[0]);
+	  connect< window<SPLITK_KC*SPLITK_N*sizeof(int32_t)> >  (W.out[0], gemv_kernel.in[1]);
+	  connect< stream >  (gemv_kernel.out[0], Y.in[0]);
+#elif defined(MULTIHEAD)
+	  connect< window<DX*sizeof(int32_t)> >  (X.out[0], gemv_kernel.in[0]);
+	  connect< window<HEADS*DY*sizeof(int32_t)> >  (gemv_kernel.out[0], Y.in[0]);
+#elif defined(TRANSPOSE)
+	  connect< window<DY*sizeof(int32_t)> >  (X.out[0], gemv_kernel.in[0]);
+	  connect< window<DX*sizeof(int32_t)> >  (gemv_kernel.out[0], Y.in[0]);
+#else
 	  connect< window<DX*sizeof(int32_t)> >  (X.out[0], gemv_kernel.in[0]);
 	  connect< window<DY*sizeof(int32_t)> >  (gemv_kernel.out[0], Y.in[0]);
+#endif
+#ifdef WEIGHTS_RTP
+	  source(gemv_kernel) = "kernels/rtp_kernels.cc";
+#elif defined(SPLITK)
+	  source(gemv_kernel) = "kernels/splitk_kernels.cc";
+#elif defined(MULTIHEAD)
+	  source(gemv_kernel) = "kernels/heads_kernels.cc";
+#elif defined(TRANSPOSE)
+	  source(gemv_kernel) = "kernels/packed_kernels.cc";
+#else
 	  source(gemv_kernel) = "kernels/kernels.cc";
+#endif
 
 	  runtime<ratio>(gemv_kernel) = 1.0;
+
+#ifdef PLACEMENT
+	  // tiles and banks planned by tools/placement.py
+	  place_graph([&](int) -> kernel & { return gemv_kernel; });
+#endif
   }
 };
 
 simpleGraph mygraph;
 
+#ifdef WEIGHTS_RTP
+// DX x DY weight blob written by run.py, in kernel order
+static std::vector<int32> load_weights(const char *path)
+{
+  return weight_blob::load<int32>(path, DX, DY, weight_blob::layout::gemv_packed);
+}
+#endif
+
 int main(void) {
   mygraph.init();
+#ifdef WEIGHTS_RTP
+  // Two models back to back on the same graph: the first 10 inputs run with
+  // data/w.bin, the last 10 with data/w_b.bin.
+  std::vector<int32> w = load_weights("data/w.bin");
+  mygraph.update(mygraph.W, w.data(), w.size());
+  mygraph.run(10);
+  mygraph.wait();
+
+  w = load_weights("data/w_b.bin");
+  mygraph.update(mygraph.W, w.data(), w.size());
+  mygraph.run(10);
+#elif defined(SPLITK)
+  // 20 inputs, SPLITK_K / SPLITK_KC invocations each
+  mygraph.run(20 * SPLITK_K / SPLITK_KC);
+#else
   mygraph.run(20);
+#endif
   mygraph.end();
   return 0;
 }
@@ -11,4 +11,40 @@ void GemV4(
 	input_window_int32 * __restrict in, 
     output_window_int32 * __restrict out);
 
+// Transposed, y = W^T x over the same packed weights: DY inputs, DX outputs
+void GemVT4(
+	input_window_int32 * __restrict in, 
+    output_window_int32 * __restrict out);
+
+#ifdef SPLITK
+#include "splitk.h"
+#include "gemv_splitk.h"
+
+// Split-K kernel class: SPLITK_KC inputs and their packed weight rows per
+// invocation, SPLITK_N outputs on a stream after every SPLITK_K inputs
+typedef gemv::split_k8<SPLITK_KC, SPLITK_N> GemV8SplitK;
+#endif
+
+#ifdef MULTIHEAD
+#include "heads.h"
+
+// HEADS DX x DY matrices over one read of x: HEADS*DY outputs, head after head
+void GemV8Heads(
+	input_window_int32 * __restrict in, 
+    output_window_int32 * __restrict out);
+#endif
+
+#ifdef WEIGHTS_RTP
+// Weights as a run-time parameter, DX x DY packed by tools/weight_pack.h
+void GemV8Rtp(
+	input_window_int32 * __restrict in, 
+    output_window_int32 * __restrict out,
+    const int32 (&w)[DX*DY]);
+
+void GemV4Rtp(
+	input_window_int32 * __restrict in, 
+    output_window_int32 * __restrict out,
+    const int32 (&w)[DX*DY]);
+#endif
+
 #endif
@@ -0,0 +1,125 @@
+#ifndef GEMV_FUSED_H
+#define GEMV_FUSED_H
+
+#include <adf.h>
+#include "aie_api/aie.hpp"
+#include "aie_api/aie_adf.hpp"
+#include "gemv_unrolled.h"
+
+/*
+ *  Several Dense layers in one kernel, for networks small enough that all
+ *  their weights fit in one tile. At 16x16 a layer is 71-87 cycles of MACs,
+ *  far less than a window handoff to the next tile, so chaining the layers
+ *  in place and sending only the last output saves most of the latency.
+ *
+ *  mlp8 runs the layers in order with the GemV8 schedule of dense8_packed
+ *  (packed weights, bias start, optional ReLU, shift per layer). The first
+ *  layer reads the input window, the last writes the output window, and the
+ *  layers in between hand their activations over in two static tile-local
+ *  buffers, written and read as whole vectors. Each layer must have as many
+ *  inputs as the previous one has outputs.
+ *
+ *      gemv::mlp8(in, out,
+ *                 gemv::dense_layer<16, 32, true>{fc1_w, fc1_b, FC1_SHIFT},
+ *                 gemv::dense_layer<32, 16>{fc2_w, fc2_b, FC2_SHIFT});
+ *
+ *  tools/hls4ml_aie.py --fuse generates this call for a model.
+ */
+
+namespace gemv {
+
+// one layer of mlp8: NX x NY packed weights (matrix_packed layout), NY bias
+template <unsigned NX, unsigned NY, bool Relu = false>
+struct dense_layer {
+    static constexpr unsigned inputs = NX;
+    static constexpr unsigned outputs = NY;
+    static constexpr bool relu = Relu;
+
+    const int32 (&w)[NX * NY];
+    const int32 (&bias)[NY];
+    int shift;
+};
+
+// where a layer reads x and writes y: the kernel's windows at the ends of the
+// chain, a tile-local buffer in between
+struct window_x {
+    input_window_int32 *w;
+    aie::vector<int32, VX> next() { return window_readincr_v8(w); }
+    void rewind(unsigned n) { window_decr(w, n); }
+};
+
+struct local_x {
+    const int32 *p;
+    aie::vector<int32, VX> next() { aie::vector<int32, VX> v = aie::load_v<VX>(p); p += VX; return v; }
+    void rewind(unsigned n) { p -= n; }
+};
+
+struct window_y {
+    output_window_int32 *w;
+    void put(const aie::vector<int32, 8> &v) { window_writeincr(w, v); }
+};
+
+struct local_y {
+    int32 *p;
+    void put(const aie::vector<int32, 8> &v) { aie::store_v(p, v); p += 8; }
+};
+
+template <typename L, typename X, typename Y>
+inline void dense8_layer(const L &l, X x, Y y)
+{
+    using P = packed_layout<L::inputs, L::outputs>;
+
+    for (unsigned cb = 0; cb < L::outputs / COLS; ++cb) {
+        aie::accum<acc80, 8> lo = init<8>(l.bias + COLS * cb);
+        aie::accum<acc80, 8> hi = init<8>(l.bias + COLS * cb + 8);
+        const int32 *__restrict wi = l.w + P::block * cb;
+
+        for (unsigned i = 0; i < L::inputs / VX; ++i) chess_prepare_for_pipelining {
+            aie::vector<int32, VX> vx = x.next();
+            lmac8_step<P, 0>::run(lo, hi, wi, vx, aie::load_v<COLS>(wi + P::template row<0>));
+            wi += P::iter;
+        }
+        if (cb + 1 < L::outputs / COLS)
+            x.rewind(L::inputs);
+
+        y.put(activate<L::relu>(lo.template to_vector<int32>(l.shift)));
+        y.put(activate<L::relu>(hi.template to_vector<int32>(l.shift)));
+    }
+}
+
+template <typename X, typename L>
+inline void mlp8_chain(X x, output_window_int32 *out, int32 *, int32 *, const L &l)
+{
+    dense8_layer(l, x, window_y{out});
+}
+
+template <typename X, typename L, typename Next, typename... More>
+inline void mlp8_chain(X x, output_window_int32 *out, int32 *buf, int32 *spare, const L &l, const Next &next,
+                       const More &...more)
+{
+    static_assert(L::outputs == Next::inputs, "a layer must have as many inputs as the previous one has outputs");
+    dense8_layer(l, x, local_y{buf});
+    mlp8_chain(local_x{buf}, out, spare, buf, next, more...);
+}
+
+template <typename... L>
+constexpr unsigned widest()
+{
+    unsigned n = 0;
+    ((n = L::outputs > n ? L::outputs : n), ...);
+    return n;
+}
+
+// NB inputs per window, each through every layer
+template <unsigned NB = 1, typename... L>
+inline void mlp8(input_window_int32 *__restrict in, output_window_int32 *__restrict out, const L &...layers)
+{
+    alignas(32) static int32 act[2][widest<L...>()];
+
+    for (unsigned b = 0; b < NB; ++b)
+        mlp8_chain(window_x{in}, out, act[0], act[1], layers...);
+}
+
+} // namespace gemv
+
+#endif // GEMV_FUSED_H
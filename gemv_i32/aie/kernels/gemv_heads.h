@@ -0,0 +1,95 @@
+#ifndef GEMV_HEADS_H
+#define GEMV_HEADS_H
+
+#include <adf.h>
+#include "aie_api/aie.hpp"
+#include "aie_api/aie_adf.hpp"
+#include "gemv_unrolled.h"
+
+/*
+ *  Multi-head GemV8: H weight matrices applied to the same input, as in the
+ *  Q/K/V projections of attention. Run as H separate GemVs, every one of
+ *  them is a kernel call that reads x from its window again, once per
+ *  16-column block. heads8 reads the NX inputs once into NX/8 vector
+ *  registers, the zbuff operands of the lmac8s, and walks the H resident
+ *  matrices over them: the input traffic and the call overhead are paid once
+ *  for all heads.
+ *
+ *  The H matrices, NX x NY each, are stored back to back in matrix_packed
+ *  order, which is the packed layout of the NX x H*NY matrix [W0 W1 ...]:
+ *  tools/pack_weights.exe packs them as one. The outputs go either to one
+ *  window of H*NY values, head after head, or to one window per head:
+ *
+ *      gemv::heads8<DX, DY, HEADS>(in, out, matrix_heads, SHIFT);
+ *
+ *      output_window_int32 *qkv[3] = {q, k, v};
+ *      gemv::heads8<DX, DY, 3>(in, qkv, matrix_heads, SHIFT);
+ *
+ *  x is held in registers, so NX is kept small. The AIE1 vector register file
+ *  is 16 x 128 bits, eight v8int32 in all, and the weight rows loaded for
+ *  each lmac8 need their share of it: 4 vectors (NX = 32) of x leave that
+ *  room, more would spill x to the stack every column block.
+ */
+
+namespace gemv {
+
+// one window for all heads, head after head
+struct heads_y {
+    output_window_int32 *w;
+    void put(unsigned, const aie::vector<int32, 8> &v) { window_writeincr(w, v); }
+};
+
+// one window per head
+struct head_windows_y {
+    output_window_int32 *const *w;
+    void put(unsigned h, const aie::vector<int32, 8> &v) { window_writeincr(w[h], v); }
+};
+
+template <unsigned NX, unsigned NY, unsigned H, unsigned NB, typename Y>
+inline void heads8_impl(input_window_int32 *__restrict in, Y y, const int32 *__restrict w, int shift)
+{
+    static_assert(NX <= 4 * VX, "heads8 keeps x in registers: at most 32 inputs");
+    using P = packed_layout<NX, NY>;
+
+    for (unsigned b = 0; b < NB; ++b) {
+        aie::vector<int32, VX> x[NX / VX];
+        for (unsigned i = 0; i < NX / VX; ++i) chess_flatten_loop
+            x[i] = window_readincr_v8(in);
+
+        // the heads' column blocks follow each other in w
+        const int32 *__restrict wi = w;
+        for (unsigned h = 0; h < H; ++h)
+            for (unsigned cb = 0; cb < NY / COLS; ++cb) chess_prepare_for_pipelining {
+                aie::accum<acc80, 8> lo = init<8>(nullptr);
+                aie::accum<acc80, 8> hi = init<8>(nullptr);
+
+                for (unsigned i = 0; i < NX / VX; ++i) chess_flatten_loop {
+                    lmac8_step<P, 0>::run(lo, hi, wi, x[i], aie::load_v<COLS>(wi + P::template row<0>));
+                    wi += P::iter;
+                }
+
+                y.put(h, lo.template to_vector<int32>(shift));
+                y.put(h, hi.template to_vector<int32>(shift));
+            }
+    }
+}
+
+// NX inputs, H * NY outputs in one window
+template <unsigned NX, unsigned NY, unsigned H, unsigned NB = 1>
+inline void heads8(input_window_int32 *__restrict in, output_window_int32 *__restrict out,
+                   const int32 (&w)[H * NX * NY], int shift = 0)
+{
+    heads8_impl<NX, NY, H, NB>(in, heads_y{out}, w, shift);
+}
+
+// NX inputs, NY outputs in each of H windows
+template <unsigned NX, unsigned NY, unsigned H, unsigned NB = 1>
+inline void heads8(input_window_int32 *__restrict in, output_window_int32 *(&out)[H],
+                   const int32 (&w)[H * NX * NY], int shift = 0)
+{
+    heads8_impl<NX, NY, H, NB>(in, head_windows_y{out}, w, shift);
+}
+
+} // namespace gemv
+
+#endif // GEMV_HEADS_H
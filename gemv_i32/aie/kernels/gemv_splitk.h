@@ -0,0 +1,104 @@
+#ifndef GEMV_SPLITK_H
+#define GEMV_SPLITK_H
+
+#include <adf.h>
+#include "aie_api/aie.hpp"
+#include "aie_api/aie_adf.hpp"
+#include "gemv_unrolled.h"
+
+/*
+ *  Split-K GemV8 for input vectors whose weights do not fit on the tile
+ *  (4096 x 16 int32 weights are 256 KB, the tile has 32 KB).
+ *
+ *  Every invocation takes one chunk of KC inputs on its x window and the
+ *  KC x NY weight rows that go with it on its w window, packed like
+ *  matrix_packed.h (tools/weight_pack.h applied to the chunk), so both are
+ *  read front to back. The products go into acc80 accumulators kept in the
+ *  kernel object, which ADF preserves between invocations. After the last of
+ *  `chunks` invocations, y goes out on the stream and the accumulators
+ *  restart from zero: a K = chunks * KC input goes through one tile in
+ *  small windows, with no partial sums leaving it and nothing to reduce
+ *  outside.
+ *
+ *  y is a stream and not a window, since an output window is sent after
+ *  every invocation. The chunk count and the to_vector() shift are
+ *  constructor arguments (kernel::create_object), so the same kernel serves
+ *  any K that is a multiple of KC.
+ */
+
+namespace gemv {
+
+// lmac8_step with the weight rows read from a window instead of memory
+template <unsigned J>
+struct lmac8_window_step {
+    static inline void run(aie::accum<acc80, 8> &lo, aie::accum<acc80, 8> &hi, input_window_int32 *__restrict w,
+                           const aie::vector<int32, VX> &vx, const aie::vector<int32, COLS> &m)
+    {
+        if constexpr (J + 1 < VX) {
+            aie::vector<int32, COLS> next = window_readincr_v16(w);
+            lo = lmac8(lo, m, 0, 0x76543210, vx, J, 0x0);
+            hi = lmac8(hi, m, 8, 0x76543210, vx, J, 0x0);
+            lmac8_window_step<J + 1>::run(lo, hi, w, vx, next);
+        } else {
+            lo = lmac8(lo, m, 0, 0x76543210, vx, J, 0x0);
+            hi = lmac8(hi, m, 8, 0x76543210, vx, J, 0x0);
+        }
+    }
+};
+
+// kernel class: KC inputs per invocation, NY outputs every `chunks` invocations
+template <unsigned KC, unsigned NY>
+class split_k8 {
+    static_assert(KC % VX == 0, "the chunk must be a multiple of 8 inputs");
+    static_assert(NY % COLS == 0, "DY must be a multiple of 16");
+
+    aie::accum<acc80, 8> acc_[NY / 8];
+    unsigned chunks_;
+    unsigned chunk_ = 0;
+    int shift_;
+
+    void clear()
+    {
+        for (unsigned a = 0; a < NY / 8; ++a)
+            acc_[a] = aie::zeros<acc80, 8>();
+    }
+
+public:
+    split_k8(unsigned chunks, int shift = 0) : chunks_(chunks), shift_(shift) { clear(); }
+
+    void run(input_window_int32 *__restrict x, input_window_int32 *__restrict w,
+             output_stream_int32 *__restrict y)
+    {
+        for (unsigned cb = 0; cb < NY / COLS; ++cb) {
+            aie::accum<acc80, 8> lo = acc_[2 * cb];
+            aie::accum<acc80, 8> hi = acc_[2 * cb + 1];
+
+            for (unsigned i = 0; i < KC / VX; ++i) chess_prepare_for_pipelining {
+                aie::vector<int32, VX> vx = window_readincr_v8(x);
+                lmac8_window_step<0>::run(lo, hi, w, vx, window_readincr_v16(w));
+            }
+            if (cb + 1 < NY / COLS)
+                window_decr(x, KC);
+
+            acc_[2 * cb] = lo;
+            acc_[2 * cb + 1] = hi;
+        }
+
+        if (++chunk_ < chunks_)
+            return;
+
+        for (unsigned a = 0; a < NY / 8; ++a) {
+            aie::vector<int32, 8> v = acc_[a].template to_vector<int32>(shift_);
+            writeincr_v4(y, v.template extract<4>(0));
+            writeincr_v4(y, v.template extract<4>(1));
+        }
+        chunk_ = 0;
+        clear();
+    }
+
+    static void registerKernelClass() { REGISTER_FUNCTION(split_k8::run); }
+};
+
+} // namespace gemv
+
+#endif // GEMV_SPLITK_H
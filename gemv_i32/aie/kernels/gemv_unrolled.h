@@ -0,0 +1,315 @@
+#ifndef GEMV_UNROLLED_H
+#define GEMV_UNROLLED_H
+
+#include <adf.h>
+#include "aie_api/aie.hpp"
+#include "aie_api/aie_adf.hpp"
+
+/*
+ *  GemV8 / GemV4 for any DX x DY int32 weight matrix, fully unrolled at compile time.
+ *
+ *  Weights either use the run.py layout, matrix[Q][DX/Q][DY] with row k of
+ *  mat_t in matrix[k%Q][k/Q] (gemv8/gemv4), or come pre-packed in consumption
+ *  order by tools/weight_pack.h (gemv8_packed/gemv4_packed), where the kernel
+ *  walks a single pointer and lmac4 gets its row pair as one contiguous
+ *  32-element vector: four consecutive 256-bit loads off that pointer instead
+ *  of two loads from separate rows and a concat.
+ *
+ *  Each iteration reads 8 inputs; the 8 steps over them are unrolled by
+ *  template recursion and every step loads the weight rows of the next one
+ *  before issuing its own MACs, the schedule optimized_kernels.cc writes out
+ *  by hand for 16x16. zstart stays a compile time constant.
+ *
+ *  Outputs are computed 16 columns at a time (two v8acc80 for lmac8, four
+ *  v4acc80 for lmac4). Matrices wider than 16 loop over column blocks and
+ *  re-read x from the window. NB is the number of x vectors per window.
+ *  shift is the to_vector() shift of the outputs (SHIFT in quant.h).
+ *
+ *  gemvt4_packed computes the transposed product, y = W^T x with DY inputs
+ *  and DX outputs, from the same packed storage, so one resident copy of the
+ *  weights serves both directions. See lmac4t_step.
+ *
+ *  dense8_packed/dense4_packed add the Dense layer epilogue: the accumulators
+ *  start from the bias (already at the accumulator scale) instead of zero, and
+ *  with Relu the requantized outputs are clamped at zero. tools/hls4ml_aie.py
+ *  instantiates them, one per layer.
+ */
+
+namespace gemv {
+
+constexpr unsigned VX = 8;       // inputs read per iteration
+constexpr unsigned COLS = 16;    // outputs per column block
+
+template <unsigned NX, unsigned NY, unsigned NQ>
+using weights_t = const int32 (&)[NQ][NX / NQ][NY];
+
+// run.py layout
+template <unsigned NX, unsigned NY, unsigned NQ>
+struct layout {
+    static_assert(NX % VX == 0, "DX must be a multiple of 8");
+    static_assert(NY % COLS == 0, "DY must be a multiple of 16");
+    static_assert(VX % NQ == 0, "Q must divide 8");
+
+    static constexpr bool packed = false;
+
+    // offset of weight row 8*i + J from the base of iteration i
+    template <unsigned J>
+    static constexpr unsigned row = (J % NQ) * (NX / NQ) * NY + (J / NQ) * NY;
+
+    // base advance per iteration and per column block
+    static constexpr unsigned iter = (VX / NQ) * NY;
+    static constexpr unsigned block = COLS;
+};
+
+// weight_pack.h layout: 16-wide row slices, column block by column block
+template <unsigned NX, unsigned NY>
+struct packed_layout {
+    static_assert(NX % VX == 0, "DX must be a multiple of 8");
+    static_assert(NY % COLS == 0, "DY must be a multiple of 16");
+
+    static constexpr bool packed = true;
+
+    template <unsigned J>
+    static constexpr unsigned row = J * COLS;
+
+    static constexpr unsigned iter = VX * COLS;
+    static constexpr unsigned block = NX * COLS;
+};
+
+// lmac8: 8 lanes x 1 column, one weight row per step, x lane J
+template <typename L, unsigned J>
+struct lmac8_step {
+    static inline void run(aie::accum<acc80, 8> &lo, aie::accum<acc80, 8> &hi, const int32 *__restrict w,
+                           const aie::vector<int32, VX> &vx, const aie::vector<int32, COLS> &m)
+    {
+        if constexpr (J + 1 < VX) {
+            aie::vector<int32, COLS> next = aie::load_v<COLS>(w + L::template row<J + 1>);
+            lo = lmac8(lo, m, 0, 0x76543210, vx, J, 0x0);
+            hi = lmac8(hi, m, 8, 0x76543210, vx, J, 0x0);
+            lmac8_step<L, J + 1>::run(lo, hi, w, vx, next);
+        } else {
+            lo = lmac8(lo, m, 0, 0x76543210, vx, J, 0x0);
+            hi = lmac8(hi, m, 8, 0x76543210, vx, J, 0x0);
+        }
+    }
+};
+
+// lmac4: 4 lanes x 2 columns, rows 2J and 2J+1 side by side in a v32, x lanes 2J, 2J+1
+template <typename L, unsigned J>
+struct lmac4_step {
+    static inline aie::vector<int32, 2 * COLS> rows(const int32 *__restrict w)
+    {
+        if constexpr (L::packed)
+            return aie::load_v<2 * COLS>(w + L::template row<2 * J>);
+        else
+            return aie::concat(aie::load_v<COLS>(w + L::template row<2 * J>),
+                               aie::load_v<COLS>(w + L::template row<2 * J + 1>));
+    }
+
+    static inline void run(aie::accum<acc80, 4> (&acc)[4], const int32 *__restrict w,
+                           const aie::vector<int32, VX> &vx, const aie::vector<int32, 2 * COLS> &m)
+    {
+        if constexpr (2 * J + 2 < VX) {
+            aie::vector<int32, 2 * COLS> next = lmac4_step<L, J + 1>::rows(w);
+            mac(acc, vx, m);
+            lmac4_step<L, J + 1>::run(acc, w, vx, next);
+        } else {
+            mac(acc, vx, m);
+        }
+    }
+
+    static inline void mac(aie::accum<acc80, 4> (&acc)[4], const aie::vector<int32, VX> &vx,
+                           const aie::vector<int32, 2 * COLS> &m)
+    {
+        acc[0] = lmac4(acc[0], m, 0, 0x00003210, COLS, vx, 2 * J, 0x0, 1);
+        acc[1] = lmac4(acc[1], m, 4, 0x00003210, COLS, vx, 2 * J, 0x0, 1);
+        acc[2] = lmac4(acc[2], m, 8, 0x00003210, COLS, vx, 2 * J, 0x0, 1);
+        acc[3] = lmac4(acc[3], m, 12, 0x00003210, COLS, vx, 2 * J, 0x0, 1);
+    }
+};
+
+// Transposed lmac4: 4 lanes are 4 weight rows (outputs of W^T x), the 2
+// columns walk along the row. A 32-bit lane offset only reaches 15 elements
+// and packed rows are 16 apart, so the 8 rows of a group are gathered with
+// eight 128-bit loads of the same 4-column slice C of a column block: row r
+// lands at element 4r, lanes take offsets 0x0000C840 (xstart 16 for rows
+// 4-7) and xstep 1 steps to the next column. That is two loads per lmac4,
+// what the two load ports issue, so the MACs still run every cycle.
+template <unsigned C>
+struct lmac4t_step {
+    static inline aie::vector<int32, 2 * COLS> rows(const int32 *__restrict w)
+    {
+        return aie::concat(aie::load_v<4>(w + 0 * COLS + 4 * C), aie::load_v<4>(w + 1 * COLS + 4 * C),
+                           aie::load_v<4>(w + 2 * COLS + 4 * C), aie::load_v<4>(w + 3 * COLS + 4 * C),
+                           aie::load_v<4>(w + 4 * COLS + 4 * C), aie::load_v<4>(w + 5 * COLS + 4 * C),
+                           aie::load_v<4>(w + 6 * COLS + 4 * C), aie::load_v<4>(w + 7 * COLS + 4 * C));
+    }
+
+    static inline void run(aie::accum<acc80, 4> (&acc)[2], const int32 *__restrict w,
+                           const aie::vector<int32, VX> &lo, const aie::vector<int32, VX> &hi,
+                           const aie::vector<int32, 2 * COLS> &m)
+    {
+        if constexpr (C + 1 < COLS / 4) {
+            aie::vector<int32, 2 * COLS> next = lmac4t_step<C + 1>::rows(w);
+            mac(acc, C < 2 ? lo : hi, m);
+            lmac4t_step<C + 1>::run(acc, w, lo, hi, next);
+        } else {
+            mac(acc, hi, m);
+        }
+    }
+
+    // x lanes 4C..4C+3 of the column block, in the low or high half
+    static inline void mac(aie::accum<acc80, 4> (&acc)[2], const aie::vector<int32, VX> &vx,
+                           const aie::vector<int32, 2 * COLS> &m)
+    {
+        acc[0] = lmac4(acc[0], m, 0, 0x0000C840, 1, vx, 4 * (C % 2), 0x0, 1);
+        acc[0] = lmac4(acc[0], m, 2, 0x0000C840, 1, vx, 4 * (C % 2) + 2, 0x0, 1);
+        acc[1] = lmac4(acc[1], m, 16, 0x0000C840, 1, vx, 4 * (C % 2), 0x0, 1);
+        acc[1] = lmac4(acc[1], m, 18, 0x0000C840, 1, vx, 4 * (C % 2) + 2, 0x0, 1);
+    }
+};
+
+// accumulator start: zero, or N bias values
+template <unsigned N>
+inline aie::accum<acc80, N> init(const int32 *__restrict bias)
+{
+    aie::accum<acc80, N> acc(aie::zeros<acc80, N>());
+    if (bias)
+        acc.from_vector(aie::load_v<N>(bias), 0);
+    return acc;
+}
+
+template <bool Relu, unsigned N>
+inline aie::vector<int32, N> activate(const aie::vector<int32, N> &v)
+{
+    if constexpr (Relu)
+        return aie::max(v, aie::zeros<int32, N>());
+    else
+        return v;
+}
+
+template <typename L, unsigned NX, unsigned NY, unsigned NB, bool Relu = false>
+inline void gemv8_impl(input_window_int32 *__restrict in, output_window_int32 *__restrict out,
+                       const int32 *__restrict w, int shift, const int32 *__restrict bias = nullptr)
+{
+    for (unsigned b = 0; b < NB; ++b)
+        for (unsigned cb = 0; cb < NY / COLS; ++cb) {
+            aie::accum<acc80, 8> lo = init<8>(bias ? bias + COLS * cb : nullptr);
+            aie::accum<acc80, 8> hi = init<8>(bias ? bias + COLS * cb + 8 : nullptr);
+            const int32 *__restrict wi = w + L::block * cb;
+
+            for (unsigned i = 0; i < NX / VX; ++i) chess_prepare_for_pipelining {
+                aie::vector<int32, VX> vx = window_readincr_v8(in);
+                lmac8_step<L, 0>::run(lo, hi, wi, vx, aie::load_v<COLS>(wi + L::template row<0>));
+                wi += L::iter;
+            }
+            if (cb + 1 < NY / COLS)
+                window_decr(in, NX);
+
+            window_writeincr(out, activate<Relu>(lo.template to_vector<int32>(shift)));
+            window_writeincr(out, activate<Relu>(hi.template to_vector<int32>(shift)));
+        }
+}
+
+template <typename L, unsigned NX, unsigned NY, unsigned NB, bool Relu = false>
+inline void gemv4_impl(input_window_int32 *__restrict in, output_window_int32 *__restrict out,
+                       const int32 *__restrict w, int shift, const int32 *__restrict bias = nullptr)
+{
+    for (unsigned b = 0; b < NB; ++b)
+        for (unsigned cb = 0; cb < NY / COLS; ++cb) {
+            const int32 *__restrict bc = bias ? bias + COLS * cb : nullptr;
+            aie::accum<acc80, 4> acc[4] = {init<4>(bc), init<4>(bc ? bc + 4 : nullptr),
+                                           init<4>(bc ? bc + 8 : nullptr), init<4>(bc ? bc + 12 : nullptr)};
+            const int32 *__restrict wi = w + L::block * cb;
+
+            for (unsigned i = 0; i < NX / VX; ++i) chess_prepare_for_pipelining {
+                aie::vector<int32, VX> vx = window_readincr_v8(in);
+                lmac4_step<L, 0>::run(acc, wi, vx, lmac4_step<L, 0>::rows(wi));
+                wi += L::iter;
+            }
+            if (cb + 1 < NY / COLS)
+                window_decr(in, NX);
+
+            for (unsigned a = 0; a < 4; ++a)
+                window_writeincr(out, activate<Relu>(acc[a].template to_vector<int32>(shift)));
+        }
+}
+
+// y = W^T x for packed NX x NY weights: NY inputs, NX outputs, 8 rows of W
+// per output vector, reading x again for every group of 8 rows
+template <unsigned NX, unsigned NY, unsigned NB>
+inline void gemvt4_impl(input_window_int32 *__restrict in, output_window_int32 *__restrict out,
+                        const int32 *__restrict w, int shift)
+{
+    for (unsigned b = 0; b < NB; ++b)
+        for (unsigned g = 0; g < NX / VX; ++g) {
+            aie::accum<acc80, 4> acc[2] = {init<4>(nullptr), init<4>(nullptr)};
+            const int32 *__restrict wi = w + g * VX * COLS;
+
+            for (unsigned cb = 0; cb < NY / COLS; ++cb) chess_prepare_for_pipelining {
+                aie::vector<int32, VX> lo = window_readincr_v8(in);
+                aie::vector<int32, VX> hi = window_readincr_v8(in);
+                lmac4t_step<0>::run(acc, wi, lo, hi, lmac4t_step<0>::rows(wi));
+                wi += packed_layout<NX, NY>::block;
+            }
+            if (g + 1 < NX / VX)
+                window_decr(in, NY);
+
+            window_writeincr(out, aie::concat(acc[0].template to_vector<int32>(shift),
+                                              acc[1].template to_vector<int32>(shift)));
+        }
+}
+
+template <unsigned NX, unsigned NY, unsigned NQ, unsigned NB = 1>
+inline void gemv8(input_window_int32 *__restrict in, output_window_int32 *__restrict out,
+                  weights_t<NX, NY, NQ> w, int shift = 0)
+{
+    gemv8_impl<layout<NX, NY, NQ>, NX, NY, NB>(in, out, &w[0][0][0], shift);
+}
+
+template <unsigned NX, unsigned NY, unsigned NQ, unsigned NB = 1>
+inline void gemv4(input_window_int32 *__restrict in, output_window_int32 *__restrict out,
+                  weights_t<NX, NY, NQ> w, int shift = 0)
+{
+    gemv4_impl<layout<NX, NY, NQ>, NX, NY, NB>(in, out, &w[0][0][0], shift);
+}
+
+template <unsigned NX, unsigned NY, unsigned NB = 1>
+inline void gemv8_packed(input_window_int32 *__restrict in, output_window_int32 *__restrict out,
+                         const int32 (&w)[NX * NY], int shift = 0)
+{
+    gemv8_impl<packed_layout<NX, NY>, NX, NY, NB>(in, out, w, shift);
+}
+
+template <unsigned NX, unsigned NY, unsigned NB = 1>
+inline void gemv4_packed(input_window_int32 *__restrict in, output_window_int32 *__restrict out,
+                         const int32 (&w)[NX * NY], int shift = 0)
+{
+    gemv4_impl<packed_layout<NX, NY>, NX, NY, NB>(in, out, w, shift);
+}
+
+// NX x NY weights, NY inputs, NX outputs
+template <unsigned NX, unsigned NY, unsigned NB = 1>
+inline void gemvt4_packed(input_window_int32 *__restrict in, output_window_int32 *__restrict out,
+                          const int32 (&w)[NX * NY], int shift = 0)
+{
+    gemvt4_impl<NX, NY, NB>(in, out, w, shift);
+}
+
+template <unsigned NX, unsigned NY, bool Relu = false, unsigned NB = 1>
+inline void dense8_packed(input_window_int32 *__restrict in, output_window_int32 *__restrict out,
+                          const int32 (&w)[NX * NY], const int32 (&bias)[NY], int shift)
+{
+    gemv8_impl<packed_layout<NX, NY>, NX, NY, NB, Relu>(in, out, w, shift, bias);
+}
+
+template <unsigned NX, unsigned NY, bool Relu = false, unsigned NB = 1>
+inline void dense4_packed(input_window_int32 *__restrict in, output_window_int32 *__restrict out,
+                          const int32 (&w)[NX * NY], const int32 (&bias)[NY], int shift)
+{
+    gemv4_impl<packed_layout<NX, NY>, NX, NY, NB, Relu>(in, out, w, shift, bias);
+}
+
+} // namespace gemv
+
+#endif // GEMV_UNROLLED_H
@@ -0,0 +1,8 @@
+#ifndef HEADS_H
+#define HEADS_H
+
+// Multi-head GemV8 (MULTIHEAD=1): HEADS DX x DY weight matrices over the same
+// input, e.g. 3 for Q/K/V. run.py reads the count from here.
+#define HEADS 3
+
+#endif // HEADS_H
@@ -0,0 +1,26 @@
+#include <adf.h>
+#include "aie_api/aie.hpp"
+#include "aie_api/aie_adf.hpp"
+#include "matrix.h"
+#include "quant.h"
+#include "heads.h"
+#include "matrix_heads.h"
+#include "gemv_heads.h"
+
+// GemV8Heads (MULTIHEAD=1): the HEADS DX x DY matrices of matrix_heads.h,
+// packed back to back by run.py, over one read of x. The outputs of all
+// heads go out in one window, head after head.
+
+void GemV8Heads(
+	input_window_int32 * __restrict in, 
+    output_window_int32 * __restrict out)
+{
+    unsigned long long cycle_num[2];
+    aie::tile tile = aie::tile::current();
+    cycle_num[0] = tile.cycles();
+
+    gemv::heads8<DX, DY, HEADS>(in, out, matrix_heads, SHIFT);
+
+    cycle_num[1] = tile.cycles();
+    printf("start = %lld, end = %lld, total = %lld\n", cycle_num[0], cycle_num[1], cycle_num[1]-cycle_num[0]);
+}
@@ -2,6 +2,7 @@
 #include "aie_api/aie.hpp"
 #include "aie_api/aie_adf.hpp"
 #include "matrix.h"
+#include "quant.h"
 
 #define V8 8
 #define V4 4
@@ -55,8 +56,8 @@ void GemV8(
         }
     }
 
-    aie::vector<DTYPE, V8> vy1 = acc1.to_vector<DTYPE>();
-    aie::vector<DTYPE, V8> vy2 = acc2.to_vector<DTYPE>();
+    aie::vector<DTYPE, V8> vy1 = acc1.to_vector<DTYPE>(SHIFT);
+    aie::vector<DTYPE, V8> vy2 = acc2.to_vector<DTYPE>(SHIFT);
     window_writeincr(out, vy1);
     window_writeincr(out, vy2);
 }
@@ -110,10 +111,10 @@ void GemV4(
         }
     }
 
-    aie::vector<DTYPE, V4> vy1 = acc1.to_vector<DTYPE>();
-    aie::vector<DTYPE, V4> vy2 = acc2.to_vector<DTYPE>();
-    aie::vector<DTYPE, V4> vy3 = acc3.to_vector<DTYPE>();
-    aie::vector<DTYPE, V4> vy4 = acc4.to_vector<DTYPE>();
+    aie::vector<DTYPE, V4> vy1 = acc1.to_vector<DTYPE>(SHIFT);
+    aie::vector<DTYPE, V4> vy2 = acc2.to_vector<DTYPE>(SHIFT);
+    aie::vector<DTYPE, V4> vy3 = acc3.to_vector<DTYPE>(SHIFT);
+    aie::vector<DTYPE, V4> vy4 = acc4.to_vector<DTYPE>(SHIFT);
     window_writeincr(out, vy1);
     window_writeincr(out, vy2);
     window_writeincr(out, vy3);
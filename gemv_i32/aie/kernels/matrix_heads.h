@@ -0,0 +1,56 @@
+#ifndef MATRIX_HEADS_H
+#define MATRIX_HEADS_H
+
+// 16x48 weights in GemV consumption order, 16-column blocks (tools/weight_pack.h)
+alignas(32) const int32 matrix_heads[768] = {
+    9, 0, 3, 8, 9, 7, 6, 8, 5, 5, 9, 2, 8, 6, 3, 3,
+    0, 9, 3, 8, 4, 7, 3, 5, 2, 3, 6, 9, 8, 2, 9, 3,
+    6, 8, 8, 8, 2, 2, 8, 6, 3, 3, 2, 4, 7, 5, 2, 1,
+    2, 9, 2, 6, 1, 7, 4, 2, 0, 4, 0, 6, 4, 0, 0, 0,
+    3, 9, 1, 4, 9, 5, 8, 1, 8, 7, 0, 6, 4, 2, 8, 4,
+    1, 6, 6, 0, 9, 5, 3, 7, 1, 2, 8, 1, 9, 2, 1, 0,
+    7, 7, 2, 0, 3, 5, 0, 7, 5, 7, 3, 8, 4, 0, 8, 6,
+    4, 9, 7, 1, 8, 4, 0, 3, 9, 0, 2, 9, 8, 8, 6, 5,
+    8, 5, 5, 7, 0, 0, 7, 9, 7, 2, 3, 7, 1, 5, 9, 1,
+    5, 1, 0, 5, 1, 9, 0, 6, 1, 7, 2, 4, 4, 0, 7, 5,
+    1, 1, 3, 7, 2, 4, 6, 1, 7, 5, 2, 5, 0, 8, 9, 3,
+    1, 7, 5, 7, 1, 5, 6, 7, 0, 1, 6, 1, 7, 5, 3, 7,
+    8, 9, 5, 9, 2, 2, 6, 5, 0, 9, 5, 0, 8, 8, 4, 3,
+    4, 0, 9, 4, 6, 6, 5, 5, 6, 3, 4, 7, 7, 1, 8, 5,
+    6, 9, 9, 4, 2, 9, 6, 9, 1, 8, 3, 4, 5, 5, 7, 7,
+    6, 3, 7, 5, 1, 2, 2, 9, 4, 3, 3, 6, 1, 2, 3, 3,
+    6, 1, 2, 4, 5, 8, 1, 0, 9, 0, 1, 7, 0, 3, 8, 9,
+    9, 3, 4, 3, 2, 2, 9, 4, 7, 0, 2, 8, 8, 3, 8, 7,
+    9, 8, 7, 3, 7, 3, 7, 5, 7, 1, 5, 5, 2, 3, 9, 8,
+    2, 7, 9, 6, 9, 0, 8, 7, 5, 2, 1, 7, 3, 1, 9, 1,
+    1, 5, 4, 1, 9, 5, 2, 0, 2, 3, 8, 5, 3, 7, 5, 1,
+    8, 7, 0, 9, 2, 2, 3, 6, 5, 0, 0, 5, 7, 6, 9, 5,
+    6, 2, 4, 5, 9, 6, 6, 1, 8, 5, 7, 9, 6, 2, 5, 0,
+    1, 2, 7, 7, 3, 1, 6, 4, 7, 5, 7, 3, 2, 5, 4, 5,
+    2, 0, 7, 0, 1, 9, 6, 3, 3, 8, 0, 8, 5, 9, 4, 4,
+    4, 3, 9, 6, 6, 7, 1, 0, 8, 5, 6, 9, 0, 9, 2, 5,
+    0, 6, 4, 3, 8, 4, 7, 0, 2, 8, 0, 8, 4, 6, 1, 6,
+    4, 6, 0, 3, 5, 1, 0, 9, 6, 3, 2, 4, 2, 8, 5, 7,
+    5, 5, 1, 8, 2, 8, 7, 8, 5, 5, 5, 5, 8, 1, 3, 4,
+    4, 6, 5, 0, 9, 2, 4, 2, 2, 5, 9, 0, 1, 7, 5, 5,
+    0, 5, 1, 4, 0, 9, 4, 7, 2, 8, 7, 0, 4, 6, 4, 4,
+    0, 2, 9, 2, 1, 1, 7, 2, 7, 7, 2, 4, 6, 2, 5, 1,
+    1, 9, 6, 0, 9, 9, 4, 7, 9, 5, 2, 1, 2, 0, 8, 8,
+    9, 3, 6, 9, 4, 5, 9, 4, 8, 1, 1, 9, 4, 7, 4, 1,
+    3, 1, 9, 4, 0, 5, 3, 5, 7, 5, 0, 9, 4, 1, 9, 0,
+    7, 7, 2, 4, 5, 8, 6, 4, 1, 1, 5, 0, 0, 1, 6, 2,
+    7, 4, 6, 6, 3, 1, 4, 4, 7, 8, 9, 8, 4, 2, 1, 4,
+    5, 5, 7, 1, 6, 4, 4, 5, 6, 3, 8, 3, 7, 3, 5, 1,
+    5, 4, 2, 7, 3, 8, 3, 7, 2, 7, 9, 7, 1, 7, 7, 6,
+    5, 1, 3, 4, 8, 4, 7, 1, 2, 0, 8, 4, 3, 4, 1, 1,
+    7, 8, 7, 9, 7, 7, 6, 4, 8, 1, 6, 7, 8, 8, 6, 1,
+    5, 6, 2, 5, 5, 9, 3, 2, 7, 6, 8, 7, 5, 3, 9, 6,
+    8, 4, 2, 7, 0, 2, 4, 1, 6, 5, 7, 4, 9, 9, 5, 6,
+    8, 6, 8, 6, 8, 3, 1, 1, 9, 6, 6, 9, 7, 3, 4, 7,
+    5, 6, 1, 7, 7, 4, 4, 8, 0, 6, 9, 2, 1, 4, 5, 5,
+    2, 8, 1, 1, 4, 6, 3, 7, 4, 4, 5, 0, 6, 4, 5, 6,
+    7, 4, 1, 0, 7, 8, 8, 5, 5, 5, 0, 3, 3, 7, 7, 3,
+    6, 5, 3, 3, 2, 3, 6, 7, 4, 3, 4, 7, 5, 9, 2, 3
+};
+
+#endif // MATRIX_HEADS_H
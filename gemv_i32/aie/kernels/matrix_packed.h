@@ -0,0 +1,24 @@
+#ifndef MATRIX_PACKED_H
+#define MATRIX_PACKED_H
+
+// 16x16 weights in GemV consumption order, 16-column blocks (tools/weight_pack.h)
+alignas(32) const int32 matrix_packed[256] = {
+    9, 9, 0, 7, 1, 6, 1, 2, 0, 3, 1, 1, 8, 9, 5, 1,
+    2, 5, 4, 9, 3, 2, 1, 3, 3, 2, 7, 5, 1, 0, 5, 6,
+    3, 6, 4, 0, 6, 4, 7, 5, 8, 4, 0, 1, 4, 2, 4, 6,
+    5, 2, 5, 2, 3, 7, 5, 5, 0, 6, 0, 5, 4, 2, 4, 0,
+    0, 1, 2, 2, 8, 5, 3, 4, 4, 7, 0, 3, 4, 0, 1, 1,
+    7, 0, 6, 0, 5, 3, 3, 6, 7, 0, 9, 8, 0, 6, 1, 0,
+    0, 1, 2, 3, 5, 4, 3, 7, 0, 7, 2, 9, 0, 0, 5, 6,
+    0, 5, 6, 9, 5, 6, 3, 0, 6, 3, 1, 3, 8, 4, 0, 1,
+    4, 5, 9, 9, 7, 4, 0, 2, 3, 1, 0, 3, 3, 6, 1, 3,
+    6, 7, 0, 6, 2, 6, 4, 8, 9, 1, 7, 8, 7, 1, 0, 9,
+    4, 7, 6, 6, 9, 6, 9, 3, 0, 3, 4, 5, 3, 6, 6, 2,
+    6, 3, 7, 5, 5, 1, 1, 1, 5, 1, 8, 9, 0, 2, 9, 1,
+    0, 4, 8, 4, 2, 3, 4, 7, 9, 1, 9, 4, 7, 4, 2, 4,
+    9, 5, 7, 6, 8, 0, 1, 8, 4, 6, 7, 1, 1, 7, 9, 2,
+    4, 3, 0, 8, 2, 4, 1, 9, 3, 9, 3, 0, 1, 9, 2, 2,
+    7, 8, 1, 4, 3, 1, 8, 3, 1, 6, 4, 3, 4, 3, 2, 8
+};
+
+#endif // MATRIX_PACKED_H
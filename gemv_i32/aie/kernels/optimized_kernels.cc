@@ -2,6 +2,7 @@
 #include "aie_api/aie.hpp"
 #include "aie_api/aie_adf.hpp"
 #include "matrix.h"
+#include "quant.h"
 
 #define V8 8
 #define V4 4
@@ -79,8 +80,8 @@ void GemV8(
     cycle_num[1] = tile.cycles();
     printf("start = %lld, end = %lld, total = %lld\n", cycle_num[0], cycle_num[1], cycle_num[1]-cycle_num[0]);
     
-    window_writeincr(out, acc1.to_vector<DTYPE>());
-    window_writeincr(out, acc2.to_vector<DTYPE>());
+    window_writeincr(out, acc1.to_vector<DTYPE>(SHIFT));
+    window_writeincr(out, acc2.to_vector<DTYPE>(SHIFT));
 }
 
 
@@ -152,10 +153,10 @@ void GemV4(
 	cycle_num[1] = tile.cycles();
 	printf("start = %lld, end = %lld, total = %lld\n", cycle_num[0], cycle_num[1], cycle_num[1] - cycle_num[0]);
 
-	window_writeincr(out, acc1.to_vector<DTYPE>());
-	window_writeincr(out, acc2.to_vector<DTYPE>());
-	window_writeincr(out, acc3.to_vector<DTYPE>());
-	window_writeincr(out, acc4.to_vector<DTYPE>());
+	window_writeincr(out, acc1.to_vector<DTYPE>(SHIFT));
+	window_writeincr(out, acc2.to_vector<DTYPE>(SHIFT));
+	window_writeincr(out, acc3.to_vector<DTYPE>(SHIFT));
+	window_writeincr(out, acc4.to_vector<DTYPE>(SHIFT));
 }
 
 
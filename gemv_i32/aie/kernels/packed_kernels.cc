@@ -0,0 +1,57 @@
+#include <adf.h>
+#include "aie_api/aie.hpp"
+#include "aie_api/aie_adf.hpp"
+#include "matrix.h"
+#include "quant.h"
+#include "matrix_packed.h"
+#include "gemv_unrolled.h"
+
+// GemV8 / GemV4 over matrix_packed.h, the matrix.h weights re-laid out in
+// consumption order by tools/pack_weights.exe (run.py does this). One pointer
+// walks the weights with full-width loads; no row arithmetic or concat.
+// GemVT4 reads the same matrix_packed for the transposed product.
+
+void GemV8(
+	input_window_int32 * __restrict in, 
+    output_window_int32 * __restrict out)
+{
+    unsigned long long cycle_num[2];
+    aie::tile tile = aie::tile::current();
+    cycle_num[0] = tile.cycles();
+
+    gemv::gemv8_packed<DX, DY>(in, out, matrix_packed, SHIFT);
+
+    cycle_num[1] = tile.cycles();
+    printf("start = %lld, end = %lld, total = %lld\n", cycle_num[0], cycle_num[1], cycle_num[1]-cycle_num[0]);
+}
+
+
+void GemV4(
+	input_window_int32 * __restrict in, 
+    output_window_int32 * __restrict out)
+{
+    unsigned long long cycle_num[2];
+    aie::tile tile = aie::tile::current();
+    cycle_num[0] = tile.cycles();
+
+    gemv::gemv4_packed<DX, DY>(in, out, matrix_packed, SHIFT);
+
+    cycle_num[1] = tile.cycles();
+    printf("start = %lld, end = %lld, total = %lld\n", cycle_num[0], cycle_num[1], cycle_num[1]-cycle_num[0]);
+}
+
+
+// y = W^T x: DY inputs, DX outputs (TRANSPOSE=1)
+void GemVT4(
+	input_window_int32 * __restrict in, 
+    output_window_int32 * __restrict out)
+{
+    unsigned long long cycle_num[2];
+    aie::tile tile = aie::tile::current();
+    cycle_num[0] = tile.cycles();
+
+    gemv::gemvt4_packed<DX, DY>(in, out, matrix_packed, SHIFT);
+
+    cycle_num[1] = tile.cycles();
+    printf("start = %lld, end = %lld, total = %lld\n", cycle_num[0], cycle_num[1], cycle_num[1]-cycle_num[0]);
+}
@@ -0,0 +1,8 @@
+#ifndef QUANT_H
+#define QUANT_H
+
+// to_vector() shift of the layer's outputs; tools/calibrate.py rewrites this
+// file with `make golden CALIBRATE=layer` (or channel)
+#define SHIFT 0
+
+#endif // QUANT_H
@@ -0,0 +1,42 @@
+#include <adf.h>
+#include "aie_api/aie.hpp"
+#include "aie_api/aie_adf.hpp"
+#include "matrix.h"
+#include "quant.h"
+#include "gemv_unrolled.h"
+
+// GemV8 / GemV4 with the weights as a run-time parameter instead of a
+// constant in the ELF (graph.cpp, WEIGHTS=rtp). The host packs them with
+// tools/weight_pack.h and writes them with graph.update(), so a new model
+// needs no recompile. matrix.h only supplies DX and DY here.
+
+void GemV8Rtp(
+	input_window_int32 * __restrict in, 
+    output_window_int32 * __restrict out,
+    const int32 (&w)[DX*DY])
+{
+    unsigned long long cycle_num[2];
+    aie::tile tile = aie::tile::current();
+    cycle_num[0] = tile.cycles();
+
+    gemv::gemv8_packed<DX, DY>(in, out, w, SHIFT);
+
+    cycle_num[1] = tile.cycles();
+    printf("start = %lld, end = %lld, total = %lld\n", cycle_num[0], cycle_num[1], cycle_num[1]-cycle_num[0]);
+}
+
+
+void GemV4Rtp(
+	input_window_int32 * __restrict in, 
+    output_window_int32 * __restrict out,
+    const int32 (&w)[DX*DY])
+{
+    unsigned long long cycle_num[2];
+    aie::tile tile = aie::tile::current();
+    cycle_num[0] = tile.cycles();
+
+    gemv::gemv4_packed<DX, DY>(in, out, w, SHIFT);
+
+    cycle_num[1] = tile.cycles();
+    printf("start = %lld, end = %lld, total = %lld\n", cycle_num[0], cycle_num[1], cycle_num[1]-cycle_num[0]);
+}
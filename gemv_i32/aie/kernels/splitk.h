@@ -0,0 +1,10 @@
+#ifndef SPLITK_H
+#define SPLITK_H
+
+// Split-K GemV8 (SPLITK=1): SPLITK_K inputs, SPLITK_KC per invocation,
+// SPLITK_N outputs. run.py reads the shape from here.
+#define SPLITK_K  4096
+#define SPLITK_KC 64
+#define SPLITK_N  16
+
+#endif // SPLITK_H
@@ -0,0 +1,11 @@
+#include <adf.h>
+#include "aie_api/aie.hpp"
+#include "aie_api/aie_adf.hpp"
+#include "splitk.h"
+#include "gemv_splitk.h"
+
+// GemV8SplitK (SPLITK=1): the kernel class is gemv::split_k8 in
+// gemv_splitk.h, instantiated here for the shape in splitk.h. graph.cpp
+// passes the chunk count and SHIFT to its constructor.
+
+template class gemv::split_k8<SPLITK_KC, SPLITK_N>;
@@ -0,0 +1,39 @@
+#include <adf.h>
+#include "aie_api/aie.hpp"
+#include "aie_api/aie_adf.hpp"
+#include "matrix.h"
+#include "quant.h"
+#include "gemv_unrolled.h"
+
+// GemV8 / GemV4 instantiated from gemv_unrolled.h for the DX x DY matrix in
+// matrix.h. At 16x16 this is the optimized_kernels.cc schedule; other sizes
+// only need run.py and python_wrapper/gemV_wrapper.py.
+
+void GemV8(
+	input_window_int32 * __restrict in, 
+    output_window_int32 * __restrict out)
+{
+    unsigned long long cycle_num[2];
+    aie::tile tile = aie::tile::current();
+    cycle_num[0] = tile.cycles();
+
+    gemv::gemv8<DX, DY, Q>(in, out, matrix, SHIFT);
+
+    cycle_num[1] = tile.cycles();
+    printf("start = %lld, end = %lld, total = %lld\n", cycle_num[0], cycle_num[1], cycle_num[1]-cycle_num[0]);
+}
+
+
+void GemV4(
+	input_window_int32 * __restrict in, 
+    output_window_int32 * __restrict out)
+{
+    unsigned long long cycle_num[2];
+    aie::tile tile = aie::tile::current();
+    cycle_num[0] = tile.cycles();
+
+    gemv::gemv4<DX, DY, Q>(in, out, matrix, SHIFT);
+
+    cycle_num[1] = tile.cycles();
+    printf("start = %lld, end = %lld, total = %lld\n", cycle_num[0], cycle_num[1], cycle_num[1]-cycle_num[0]);
+}
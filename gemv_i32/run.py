@@ -1,5 +1,40 @@
+import argparse
+import os
+import re
+import subprocess
+import sys
 import numpy as np
 
+parser = argparse.ArgumentParser()
+parser.add_argument('--binary', action='store_true',
+                    help='write data/*.bin raw PLIO files instead of text (graph built with PLIO_BINARY)')
+parser.add_argument('--packer', default='../tools/pack_weights.exe',
+                    help='tools/pack_weights.exe, writes the weight blob and the headers generated from it')
+parser.add_argument('--calibrate', choices=['layer', 'channel'],
+                    help='pick SHIFT (and channel multipliers) on this data with tools/calibrate.py, write quant.h')
+parser.add_argument('--rtp', action='store_true',
+                    help='also write data/w_b.bin, the weights graph.cpp swaps in halfway (WEIGHTS=rtp)')
+parser.add_argument('--transpose', action='store_true',
+                    help='golden data for GemVT4 (TRANSPOSE=1): DY inputs, y = W^T x')
+parser.add_argument('--splitk', action='store_true',
+                    help='golden data for GemV8SplitK (SPLITK=1), shape from aie/kernels/splitk.h, '
+                         'and data/w_chunks.* with the weight rows of every chunk')
+parser.add_argument('--heads', action='store_true',
+                    help='golden data for GemV8Heads (MULTIHEAD=1): HEADS matrices from aie/kernels/heads.h '
+                         'side by side in one DX x HEADS*DY matrix, aie/kernels/matrix_heads.h')
+args = parser.parse_args()
+
+if not os.path.exists(args.packer):
+    raise SystemExit(f'{args.packer} not found, run `make -C ../tools`')
+sys.path.insert(0, os.path.dirname(os.path.abspath(args.packer)))
+import calibrate  # noqa: E402
+import weight_blob  # noqa: E402
+
+
+def blob(*argv):
+    subprocess.run([args.packer, *argv], check=True)
+
+
 # Parameters
 num_time_steps = 20
 DX = 16  # Num inputs
@@ -7,42 +42,72 @@ DY = 16  # Num outputs
 Q = 2    # Number of splits along DX
 dtype = np.int32
 
-mat_concat = ','.join([f'm[{i}]' for i in range(Q)])
+if args.splitk:
+    with open('aie/kernels/splitk.h') as f:
+        shape = dict(re.findall(r'#define\s+SPLITK_(\w+)\s+(\d+)', f.read()))
+    DX, KC, DY = int(shape['K']), int(shape['KC']), int(shape['N'])
+
+# Multi-head: the HEADS matrices are the column blocks of one wide matrix,
+# packed back to back, and y is the heads' outputs one after the other
+if args.heads:
+    with open('aie/kernels/heads.h') as f:
+        DY *= int(re.search(r'#define\s+HEADS\s+(\d+)', f.read()).group(1))
 
 # Generate matrix and input signals
 mat_t = np.random.randint(0, 10, size=(DX, DY), dtype=dtype)
-x = np.random.randint(0, 10, size=(num_time_steps, DX), dtype=dtype)
-np.savetxt("data/x.txt", x.reshape(num_time_steps*4, DX//4), fmt='%d')
-
-# Prepare matrix for C header
-rows_per_mat = DX // Q
-
-with open('aie/kernels/matrix.h', 'w') as f:
-    f.write(f'''
-#ifndef MATRIX_H
-#define MATRIX_H
-#define DTYPE int32
-#define DX {DX}
-#define DY {DY}
-#define Q {Q}
-#define MQS {mat_concat}
-
-alignas(32) const DTYPE matrix[{Q}][{rows_per_mat}][{DY}] = {{''')
-
-    for q in range(Q):
-        sub_mat = mat_t[q::Q, :]
-        f.write(f'    {{ // matrix block {q}\n')
-        for i in range(rows_per_mat):
-            row_vals = ', '.join([f'{val}' for val in sub_mat[i]])
-            end_char = ',' if i < rows_per_mat - 1 else ''
-            f.write(f'        {{{row_vals}}}{end_char}\n')
-        f.write('    }')
-        f.write(',\n' if q < Q - 1 else '\n')
-
-    f.write('};\n\n#endif // MATRIX_H\n')
+NI, NO = (DY, DX) if args.transpose else (DX, DY)  # inputs and outputs per step
+x = np.random.randint(0, 10, size=(num_time_steps, NI), dtype=dtype)
+if args.binary:
+    x.tofile("data/x.bin")
+else:
+    np.savetxt("data/x.txt", x.reshape(-1, 4), fmt='%d')
+
+# Requantization: SHIFT from quant.h, or calibrated on this data
+ACC_BITS = 80
+if args.calibrate:
+    # transposed, the output channels are the rows of mat_t
+    w_cal = mat_t.T if args.transpose else mat_t
+    q = calibrate.calibrate(w_cal, x, np.int32, ACC_BITS, per_channel=args.calibrate == 'channel')
+    mat_t = q.weights.T if args.transpose else q.weights
+    calibrate.write_header('aie/kernels/quant.h', q)
+shift = calibrate.read_shift('aie/kernels/quant.h')
+
+# Weights go through one binary blob (tools/weight_blob.h): the kernel
+# headers are generated from it and the golden output is computed from it.
+np.savetxt('data/w.txt', mat_t, fmt='%d')
+blob('blob', 'int32', str(DX), str(DY), 'data/w.txt', 'data/w.bin', '--packed')
+if args.heads:
+    blob('header', 'data/w.bin', 'aie/kernels/matrix_heads.h', '--packed', 'matrix_heads')
+elif not args.splitk:
+    blob('header', 'data/w.bin', 'aie/kernels/matrix.h', '--split', str(Q))
+    blob('header', 'data/w.bin', 'aie/kernels/matrix_packed.h', '--packed')
+mat_t = weight_blob.load('data/w.bin')
+
+# Split-K: the weights do not stay on the tile, every chunk of KC inputs
+# arrives with its KC rows, packed like matrix_packed.h (16-column blocks of
+# the chunk one after the other), again for every input
+if args.splitk:
+    chunks = mat_t.reshape(DX // KC, KC, DY // 16, 16).transpose(0, 2, 1, 3).reshape(-1)
+    w_chunks = np.tile(chunks, num_time_steps)
+    if args.binary:
+        w_chunks.tofile('data/w_chunks.bin')
+    else:
+        np.savetxt('data/w_chunks.txt', w_chunks.reshape(-1, 4), fmt='%d')
 
 # Compute expected output
 # y_exp = np.zeros((num_time_steps, DY), dtype=dtype)
-y_exp = (x @ mat_t).astype(np.int32)
+y_exp = calibrate.requantize(calibrate.accumulate(x, mat_t.T if args.transpose else mat_t, ACC_BITS), shift, np.int32)
+
+# Run-time weights: the second half of the inputs runs with a new matrix
+if args.rtp:
+    mat_b = np.random.randint(-10, 10, size=(DX, DY), dtype=dtype)
+    np.savetxt('data/w_b.txt', mat_b, fmt='%d')
+    blob('blob', 'int32', str(DX), str(DY), 'data/w_b.txt', 'data/w_b.bin', '--packed')
+    mat_b = weight_blob.load('data/w_b.bin')
+    half = num_time_steps // 2
+    y_exp[half:] = calibrate.requantize(calibrate.accumulate(x[half:], mat_b, ACC_BITS), shift, np.int32)
 
-np.savetxt("data/y_exp.txt", y_exp.reshape(num_time_steps*4, DY//4), fmt='%d')
+if args.binary:
+    y_exp.tofile("data/y_exp.bin")
+else:
+    np.savetxt("data/y_exp.txt", y_exp.reshape(-1, 4), fmt='%d')
@@ -20,8 +20,13 @@ public:
 
   simpleGraph(){
 
+#ifdef PLIO_BINARY
+		X = input_plio::create("X", plio_128_bits, "data/x.bin", 0.0, true);
+		Y = output_plio::create("Y", plio_128_bits, "data/y_sim.bin", 0.0, true);
+#else
 		X = input_plio::create(plio_128_bits, "data/x.txt");
 		Y = output_plio::create(plio_128_bits, "data/y_sim.txt");
+#endif
 		gemv_kernel = kernel::create(GemV);
 
 	  connect< window<DX> >  (X.out[0], gemv_kernel.in[0]);
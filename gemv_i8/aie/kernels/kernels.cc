@@ -4,6 +4,7 @@
 #include "aie_api/aie.hpp"
 #include "aie_api/aie_adf.hpp"
 #include "matrix.h"
+#include "quant.h"
 
 
 void GemV8(
@@ -11,9 +12,7 @@ void GemV8(
   output_window_int16 * __restrict out)
 {
     aie::accum<acc48, 8> acc1 (aie::zeros<acc48,8>()); //v8acc48
-    aie::accum<acc48, 8> acc2 (aie::zeros<acc48,8>());
-    aie::accum<acc48, 8> acc3 (aie::zeros<acc48,8>()); //v8acc48
-    aie::accum<acc48, 8> acc4 (aie::zeros<acc48,8>());
+    aie::accum<acc48, 8> acc2 (aie::zeros<acc48,8>()); //v8acc48
     aie::vector<DTYPE,DX> first_m [8]; //v16int8
     aie::vector<DTYPE,DX> second_m[8]; //v16int8
     aie::vector<DTYPE,DX> vx = window_readincr_v16(in); //v32int8
@@ -45,8 +44,10 @@ void GemV8(
             0x3210                          //unsigned int 	zsquare 
        );
 
-    acc2 = mac8(
-            acc2,                            //v8acc48 	acc,
+    // the second half of the rows accumulates onto the first, so the sum is
+    // shifted once, as the golden model does
+    acc1 = mac8(
+            acc1,                            //v8acc48 	acc,
             concat(second_m[0],second_m[1],second_m[2],second_m[3],second_m[4],second_m[5],second_m[6],second_m[7]),  //v128int8 	xbuff,
             0,                              //int 	xstart,
             0x3130,                         //unsigned int 	xoffsets,
@@ -58,8 +59,8 @@ void GemV8(
             2,                              //int 	zstep,
             0x3210                          //unsigned int 	zsquare 
        );
-    acc3 = mac8(
-            acc3,                            //v8acc48 	acc,
+    acc2 = mac8(
+            acc2,                            //v8acc48 	acc,
             concat(first_m[0],first_m[1],first_m[2],first_m[3],first_m[4],first_m[5],first_m[6],first_m[7]),  //v128int8 	xbuff,
             8,                              //int 	xstart,
             0x3130,                         //unsigned int 	xoffsets,
@@ -72,8 +73,8 @@ void GemV8(
             0x3210                          //unsigned int 	zsquare 
        );
 
-    acc4 = mac8(
-            acc4,                            //v8acc48 	acc,
+    acc2 = mac8(
+            acc2,                            //v8acc48 	acc,
             concat(second_m[0],second_m[1],second_m[2],second_m[3],second_m[4],second_m[5],second_m[6],second_m[7]),  //v128int8 	xbuff,
             8,                              //int 	xstart,
             0x3130,                         //unsigned int 	xoffsets,
@@ -87,15 +88,11 @@ void GemV8(
        );
 
     // aie::vector<DTYPE, 16> vy = acc.to_vector<DTYPE>();
-    aie::vector<int16, 8> vy = acc1.to_vector<int16>();
-    aie::vector<int16, 8> vvy = acc2.to_vector<int16>();
-    vvy = add(vy,vvy);
-    aie::vector<int16, 8> vy2 = acc3.to_vector<int16>();
-    aie::vector<int16, 8> vvy2 = acc4.to_vector<int16>();
-    vvy2 = add(vy2,vvy2);
+    aie::vector<int16, 8> vy = acc1.to_vector<int16>(SHIFT);
+    aie::vector<int16, 8> vy2 = acc2.to_vector<int16>(SHIFT);
 
-    window_writeincr(out, vvy);
-    window_writeincr(out,vvy2);
+    window_writeincr(out, vy);
+    window_writeincr(out,vy2);
 
 }
 
@@ -129,6 +126,6 @@ void GemV16(
         );
     }
 
-    aie::vector<DTYPE, DY> vy = acc.to_vector<DTYPE>();
+    aie::vector<DTYPE, DY> vy = acc.to_vector<DTYPE>(SHIFT);
     window_writeincr(out, vy);
 }
@@ -1,5 +1,29 @@
+import argparse
+import os
+import subprocess
+import sys
 import numpy as np
 
+parser = argparse.ArgumentParser()
+parser.add_argument('--binary', action='store_true',
+                    help='write data/*.bin raw PLIO files instead of text (graph built with PLIO_BINARY)')
+parser.add_argument('--packer', default='../tools/pack_weights.exe',
+                    help='tools/pack_weights.exe, writes the weight blob and the headers generated from it')
+parser.add_argument('--calibrate', choices=['layer', 'channel'],
+                    help='pick SHIFT (and channel multipliers) on this data with tools/calibrate.py, write quant.h')
+args = parser.parse_args()
+
+if not os.path.exists(args.packer):
+    raise SystemExit(f'{args.packer} not found, run `make -C ../tools`')
+sys.path.insert(0, os.path.dirname(os.path.abspath(args.packer)))
+import calibrate  # noqa: E402
+import weight_blob  # noqa: E402
+
+
+def blob(*argv):
+    subprocess.run([args.packer, *argv], check=True)
+
+
 # Parameters
 num_time_steps = 1
 DX = 16  # Num inputs
@@ -7,42 +31,34 @@ DY = 16  # Num output
 Q = 2    # Number of splits along DX
 dtype = np.int8
 
-mat_concat = ','.join([f'm[{i}]' for i in range(Q)])
-
 # Generate matrix and input signals
 mat_t = np.random.randint(0, 10, size=(DX, DY), dtype=dtype)
 x = np.random.randint(0, 10, size=(num_time_steps, DX), dtype=dtype)
-np.savetxt("data/x.txt", x.reshape(num_time_steps*2, DX//2), fmt='%d')
-
-# Prepare matrix for C header
-rows_per_mat = DX // Q
-
-with open('aie/kernels/matrix.h', 'w') as f:
-    f.write(f'''
-#ifndef MATRIX_H
-#define MATRIX_H
-#define DTYPE int8
-#define DX {DX}
-#define DY {DY}
-#define Q {Q}
-#define MQS {mat_concat}
-
-alignas(32) const DTYPE matrix[{Q}][{rows_per_mat}][{DY}] = {{''')
-
-    for q in range(Q):
-        sub_mat = mat_t[q::Q, :]
-        f.write(f'    {{ // matrix block {q}\n')
-        for i in range(rows_per_mat):
-            row_vals = ', '.join([f'{val}' for val in sub_mat[i]])
-            end_char = ',' if i < rows_per_mat - 1 else ''
-            f.write(f'        {{{row_vals}}}{end_char}\n')
-        f.write('    }')
-        f.write(',\n' if q < Q - 1 else '\n')
-
-    f.write('};\n\n#endif // MATRIX_H\n')
+if args.binary:
+    x.tofile("data/x.bin")
+else:
+    np.savetxt("data/x.txt", x.reshape(num_time_steps*2, DX//2), fmt='%d')
+
+# Requantization: SHIFT from quant.h, or calibrated on this data
+ACC_BITS = 48
+if args.calibrate:
+    q = calibrate.calibrate(mat_t, x, np.int16, ACC_BITS, per_channel=args.calibrate == 'channel')
+    mat_t = q.weights
+    calibrate.write_header('aie/kernels/quant.h', q)
+shift = calibrate.read_shift('aie/kernels/quant.h')
+
+# Weights go through one binary blob (tools/weight_blob.h): the kernel
+# headers are generated from it and the golden output is computed from it.
+np.savetxt('data/w.txt', mat_t, fmt='%d')
+blob('blob', 'int8', str(DX), str(DY), 'data/w.txt', 'data/w.bin')
+blob('header', 'data/w.bin', 'aie/kernels/matrix.h', '--split', str(Q))
+mat_t = weight_blob.load('data/w.bin')
 
 # Compute expected output
 # y_exp = np.zeros((num_time_steps, DY), dtype=dtype)
-y_exp = (x @ mat_t).astype(np.int16)
+y_exp = calibrate.requantize(calibrate.accumulate(x, mat_t, ACC_BITS), shift, np.int16)
 
-np.savetxt("data/y_exp.txt", y_exp.reshape(num_time_steps*2, DY//2), fmt='%d')
+if args.binary:
+    y_exp.tofile("data/y_exp.bin")
+else:
+    np.savetxt("data/y_exp.txt", y_exp.reshape(num_time_steps*2, DY//2), fmt='%d')
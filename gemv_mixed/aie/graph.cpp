@@ -0,0 +1,47 @@
+#include <adf.h>
+
+#define DX 16
+#define DY 16
+
+#include "kernels.h"
+#include <vector>
+
+using namespace adf;
+
+class simpleGraph : public adf::graph {
+private:
+  kernel gemv_kernel;
+
+public:
+
+  input_plio  X;
+  output_plio Y;
+
+  simpleGraph(){
+
+#ifdef PLIO_BINARY
+		X = input_plio::create("X", plio_128_bits, "data/x.bin", 0.0, true);
+		Y = output_plio::create("Y", plio_128_bits, "data/y_sim.bin", 0.0, true);
+#else
+		X = input_plio::create(plio_128_bits, "data/x.txt");
+		Y = output_plio::create(plio_128_bits, "data/y_sim.txt");
+#endif
+		// x_t / w_t from MIX (kernels/mix.h)
+		gemv_kernel = kernel::create(GemV);
+
+	  connect< window<DX*sizeof(x_t)> >  (X.out[0], gemv_kernel.in[0]);
+	  connect< window<DY*sizeof(x_t)> >  (gemv_kernel.out[0], Y.in[0]);
+	  source(gemv_kernel) = "kernels/kernels.cc";
+
+	  runtime<ratio>(gemv_kernel) = 1.0;
+  }
+};
+
+simpleGraph mygraph;
+
+int main(void) {
+  mygraph.init();
+  mygraph.run(20);
+  mygraph.end();
+  return 0;
+}
@@ -0,0 +1,12 @@
+#include "adf/window/types.h"
+#include "mix.h"
+
+#ifndef FUNCTION_KERNELS_H
+#define FUNCTION_KERNELS_H
+
+// DX x_t inputs, DY x_t outputs, w_t weights from matrix.h
+void GemV(
+	input_window<x_t> * __restrict in,
+    output_window<x_t> * __restrict out);
+
+#endif
@@ -0,0 +1,162 @@
+#ifndef GEMV_MIXED_H
+#define GEMV_MIXED_H
+
+#include <adf.h>
+#include "aie_api/aie.hpp"
+#include "aie_api/aie_adf.hpp"
+
+/*
+ *  GemV with different activation and weight widths, matrix row-major
+ *  [NX][NY] (matrix.h with Q 1), x_t inputs and outputs.
+ *
+ *  8 x 16 (a8w16): the native 16b x 8b scheme, mac16 with the int16 weight
+ *  rows in xbuff and the int8 inputs in zbuff: 16 outputs x 4 weight rows
+ *  per mac16, 64 MACs, acc48. The 4 rows are 128 bytes, two cycles of the
+ *  load ports, so from tile memory the loop runs at the 32 MACs per cycle of
+ *  the 16b x 16b scheme, without widening x.
+ *
+ *  16 x 8 (a16w8): the int8 operand of the 16b x 8b scheme is the per-lane
+ *  one, in zbuff, and zbuff holds 32 bytes: not the 16 outputs x 4 rows of
+ *  weights a GemV lane step needs. So the weights are widened with
+ *  aie::unpack, one op per mac16 row pair issued alongside the MAC, and
+ *  multiplied in the 16b x 16b scheme of gemv_i16: 16 outputs x 2 weight rows
+ *  per mac16, acc48.
+ *
+ *  The int8 side keeps its half size in tile memory and on the PLIO.
+ *
+ *  16 x 32: the 32b x 16b general scheme, lmac8 with the int32 weight rows
+ *  in xbuff and the int16 inputs in zbuff, acc80. Same MAC rate as GemV8 in
+ *  gemv_i32, with half the activation memory and bandwidth.
+ *
+ *  Outputs are computed 16 columns at a time; wider matrices loop over
+ *  column blocks and re-read x from the window. shift is the to_vector()
+ *  shift of the outputs (SHIFT in quant.h).
+ */
+
+namespace gemv_mixed {
+
+constexpr unsigned VX = 16;      // inputs read per iteration
+constexpr unsigned COLS = 16;    // outputs per column block
+
+template <typename T>
+inline aie::vector<int16, 16> widen(const aie::vector<T, 16> &v)
+{
+    if constexpr (sizeof(T) == 1)
+        return aie::unpack(v);
+    else
+        return v;
+}
+
+// weight rows k and k+1 of column block cb, side by side, as int16
+template <unsigned NY, typename TW>
+inline aie::vector<int16, 2 * COLS> rows16(const TW *__restrict w, unsigned k, unsigned cb)
+{
+    return aie::concat(widen(aie::load_v<COLS>(w + k * NY + COLS * cb)),
+                       widen(aie::load_v<COLS>(w + (k + 1) * NY + COLS * cb)));
+}
+
+// weight rows k to k+3 of column block cb, one after the other
+template <unsigned NY>
+inline aie::vector<int16, 4 * COLS> rows4(const int16 *__restrict w, unsigned k, unsigned cb)
+{
+    return aie::concat(aie::load_v<COLS>(w + k * NY + COLS * cb),
+                       aie::load_v<COLS>(w + (k + 1) * NY + COLS * cb),
+                       aie::load_v<COLS>(w + (k + 2) * NY + COLS * cb),
+                       aie::load_v<COLS>(w + (k + 3) * NY + COLS * cb));
+}
+
+// int8 x int16 in the 16b x 8b scheme
+template <unsigned NX, unsigned NY>
+inline void gemv16x8(input_window<int8> *__restrict in, output_window<int8> *__restrict out,
+                     const int16 *__restrict w, int shift)
+{
+    static_assert(NX % VX == 0 && NY % COLS == 0, "DX and DY must be multiples of 16");
+
+    for (unsigned cb = 0; cb < NY / COLS; ++cb) {
+        aie::accum<acc48, COLS> acc(aie::zeros<acc48, COLS>());
+
+        for (unsigned i = 0; i < NX; i += VX) chess_prepare_for_pipelining {
+            // zbuff is 32 bytes: the 16 inputs in its low half
+            aie::vector<int8, 2 * VX> vx = aie::concat(window_readincr_v16(in), aie::zeros<int8, VX>());
+            for (unsigned j = 0; j < VX; j += 4) chess_flatten_loop {
+                // lane l, column c: row i+j+c of the block times x[i+j+c]
+                acc = mac16(acc, rows4<NY>(w, i + j, cb), 0, 0x73727170, 0x77767574, 2 * COLS, 0x3120,
+                            vx, j, 0x0, 0x0, 2, 0x3210);
+            }
+        }
+        if (cb + 1 < NY / COLS)
+            window_decr(in, NX);
+
+        window_writeincr(out, acc.template to_vector<int8>(shift));
+    }
+}
+
+// int8/int16 x int8/int16 in the 16b x 16b scheme
+template <unsigned NX, unsigned NY, typename TX, typename TW>
+inline void gemv16(input_window<TX> *__restrict in, output_window<TX> *__restrict out,
+                   const TW *__restrict w, int shift)
+{
+    static_assert(NX % VX == 0 && NY % COLS == 0, "DX and DY must be multiples of 16");
+
+    for (unsigned cb = 0; cb < NY / COLS; ++cb) {
+        aie::accum<acc48, COLS> acc(aie::zeros<acc48, COLS>());
+
+        for (unsigned i = 0; i < NX; i += VX) chess_prepare_for_pipelining {
+            aie::vector<int16, VX> vx = widen(window_readincr_v16(in));
+            for (unsigned j = 0; j < VX; j += 2) chess_flatten_loop {
+                acc = mac16(acc, rows16<NY>(w, i + j, cb), 0, 0x73727170, 0x77767574, 0x3120,
+                            vx, j, 0x0, 0x0, 1);
+            }
+        }
+        if (cb + 1 < NY / COLS)
+            window_decr(in, NX);
+
+        window_writeincr(out, acc.template to_vector<TX>(shift));
+    }
+}
+
+// int16 x int32 in the 32b x 16b scheme
+template <unsigned NX, unsigned NY>
+inline void gemv32x16(input_window<int16> *__restrict in, output_window<int16> *__restrict out,
+                      const int32 *__restrict w, int shift)
+{
+    static_assert(NX % VX == 0 && NY % COLS == 0, "DX and DY must be multiples of 16");
+
+    for (unsigned cb = 0; cb < NY / COLS; ++cb) {
+        aie::accum<acc80, 8> lo(aie::zeros<acc80, 8>());
+        aie::accum<acc80, 8> hi(aie::zeros<acc80, 8>());
+
+        for (unsigned i = 0; i < NX; i += VX) chess_prepare_for_pipelining {
+            aie::vector<int16, VX> vx = window_readincr_v16(in);
+            for (unsigned j = 0; j < VX; j += 2) chess_flatten_loop {
+                // rows i+j and i+j+1 in one v32int32
+                aie::vector<int32, 2 * COLS> m = aie::concat(aie::load_v<COLS>(w + (i + j) * NY + COLS * cb),
+                                                             aie::load_v<COLS>(w + (i + j + 1) * NY + COLS * cb));
+                lo = lmac8(lo, m, 0, 0x76543210, vx, j, 0x0);
+                hi = lmac8(hi, m, 8, 0x76543210, vx, j, 0x0);
+                lo = lmac8(lo, m, 16, 0x76543210, vx, j + 1, 0x0);
+                hi = lmac8(hi, m, 24, 0x76543210, vx, j + 1, 0x0);
+            }
+        }
+        if (cb + 1 < NY / COLS)
+            window_decr(in, NX);
+
+        window_writeincr(out, aie::concat(lo.template to_vector<int16>(shift), hi.template to_vector<int16>(shift)));
+    }
+}
+
+template <unsigned NX, unsigned NY, typename TX, typename TW>
+inline void gemv(input_window<TX> *__restrict in, output_window<TX> *__restrict out,
+                 const TW *__restrict w, int shift = 0)
+{
+    if constexpr (sizeof(TW) == 4)
+        gemv32x16<NX, NY>(in, out, w, shift);
+    else if constexpr (sizeof(TX) == 1 && sizeof(TW) == 2)
+        gemv16x8<NX, NY>(in, out, w, shift);
+    else
+        gemv16<NX, NY>(in, out, w, shift);
+}
+
+} // namespace gemv_mixed
+
+#endif // GEMV_MIXED_H
@@ -0,0 +1,27 @@
+#include <adf.h>
+#include <type_traits>
+#include "aie_api/aie.hpp"
+#include "aie_api/aie_adf.hpp"
+#include "mix.h"
+#include "matrix.h"
+#include "quant.h"
+#include "gemv_mixed.h"
+
+// GemV over x_t activations and the w_t weights of matrix.h (mix.h). run.py
+// writes matrix.h for the MIX it is given, so the two have to agree.
+static_assert(std::is_same<DTYPE, w_t>::value, "matrix.h was generated for another MIX, run make golden");
+static_assert(Q == 1, "gemv_mixed reads matrix.h row-major (--split 1)");
+
+void GemV(
+	input_window<x_t> * __restrict in,
+    output_window<x_t> * __restrict out)
+{
+    unsigned long long cycle_num[2];
+    aie::tile tile = aie::tile::current();
+    cycle_num[0] = tile.cycles();
+
+    gemv_mixed::gemv<DX, DY>(in, out, &matrix[0][0][0], SHIFT);
+
+    cycle_num[1] = tile.cycles();
+    printf("start = %lld, end = %lld, total = %lld\n", cycle_num[0], cycle_num[1], cycle_num[1]-cycle_num[0]);
+}
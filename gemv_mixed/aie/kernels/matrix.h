@@ -0,0 +1,31 @@
+#ifndef MATRIX_H
+#define MATRIX_H
+#define DTYPE int16
+#define DX 16
+#define DY 16
+#define Q 1
+#define MQS m[0]
+
+// generated by tools/pack_weights.exe from a weight blob
+alignas(32) const DTYPE matrix[1][16][16] = {
+    { // matrix block 0
+        {6, 2, 8, -3, -2, 5, -3, -2, -1, -8, -9, -5, -3, 9, 0, -9},
+        {-2, -2, -8, -1, -1, -2, -10, -4, -2, 7, 7, -1, -6, 8, -9, 1},
+        {-5, -7, 6, 5, -3, -10, 9, 1, -5, -4, 8, -4, -7, 0, 9, 5},
+        {2, -2, -3, -3, -9, -10, -1, -3, -9, 2, -6, 3, -6, 3, -8, -3},
+        {-7, -7, -8, -8, -9, 1, -4, 5, 6, 4, 0, 8, -8, -10, -2, 6},
+        {-3, -5, 7, -4, 5, 6, 5, -1, -3, 5, -1, 4, 8, 1, -4, -1},
+        {7, 5, 0, -5, 6, 1, -9, -9, 6, 0, 5, -8, 3, -6, 3, 4},
+        {3, -6, -10, -4, -2, -2, -6, -4, 9, -3, -2, 8, 2, -7, -4, 7},
+        {6, 4, 2, 1, -7, 9, -7, -3, 4, -5, 6, -7, 5, -6, 9, -10},
+        {-7, 8, 9, -3, -7, 5, 8, -8, 4, 3, -1, 1, -7, -5, 8, -10},
+        {5, 1, -6, 7, -6, 2, -9, -5, 6, -1, 1, 5, 1, 2, -3, -7},
+        {-8, -7, -9, 2, 9, 9, -1, 2, 7, -4, -1, -2, -2, -5, -3, -3},
+        {7, -10, 3, 4, 0, 7, -6, 7, 6, -7, 2, -2, -6, -2, -8, -2},
+        {-1, -7, -3, -8, 4, -7, 2, 2, 6, -2, 6, 8, 7, -9, -10, -9},
+        {5, -8, -2, 3, -4, 8, -4, 5, -9, -7, 7, -2, -4, -7, -10, -9},
+        {0, 8, 0, -8, 7, -1, -8, -10, 1, 0, 7, -4, 4, 8, 5, 4}
+    }
+};
+
+#endif // MATRIX_H
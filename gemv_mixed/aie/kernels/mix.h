@@ -0,0 +1,17 @@
+#ifndef MIX_H
+#define MIX_H
+
+// Activation (x and y) and weight types of the build, from MIX in the
+// Makefile: MIX_A8W16 (default), MIX_A16W8 or MIX_A16W32.
+#if defined(MIX_A16W8)
+typedef int16 x_t;
+typedef int8  w_t;
+#elif defined(MIX_A16W32)
+typedef int16 x_t;
+typedef int32 w_t;
+#else
+typedef int8  x_t;
+typedef int16 w_t;
+#endif
+
+#endif // MIX_H
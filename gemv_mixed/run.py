@@ -0,0 +1,70 @@
+import argparse
+import os
+import subprocess
+import sys
+import numpy as np
+
+parser = argparse.ArgumentParser()
+parser.add_argument('--binary', action='store_true',
+                    help='write data/*.bin raw PLIO files instead of text (graph built with PLIO_BINARY)')
+parser.add_argument('--packer', default='../tools/pack_weights.exe',
+                    help='tools/pack_weights.exe, writes the weight blob and the headers generated from it')
+parser.add_argument('--calibrate', choices=['layer', 'channel'],
+                    help='pick SHIFT (and channel multipliers) on this data with tools/calibrate.py, write quant.h')
+parser.add_argument('--mix', choices=['a8w16', 'a16w8', 'a16w32'], default='a8w16',
+                    help='activation x weight precision, MIX in the Makefile')
+args = parser.parse_args()
+
+if not os.path.exists(args.packer):
+    raise SystemExit(f'{args.packer} not found, run `make -C ../tools`')
+sys.path.insert(0, os.path.dirname(os.path.abspath(args.packer)))
+import calibrate  # noqa: E402
+import weight_blob  # noqa: E402
+
+
+def blob(*argv):
+    subprocess.run([args.packer, *argv], check=True)
+
+
+# Parameters
+num_time_steps = 20
+DX = 16  # Num inputs
+DY = 16  # Num outputs
+Q = 1    # gemv_mixed.h reads the weights row-major
+
+# x and y in the activation type, weights in their own (aie/kernels/mix.h)
+x_dtype, w_dtype = {'a8w16': (np.int8, np.int16), 'a16w8': (np.int16, np.int8),
+                    'a16w32': (np.int16, np.int32)}[args.mix]
+# mac16 (16b x 16b, int8 widened) accumulates in acc48, lmac8 (32b x 16b) in acc80
+ACC_BITS = 80 if w_dtype == np.int32 else 48
+per_line = 16 // np.dtype(x_dtype).itemsize  # values per 128-bit PLIO word
+
+# Generate matrix and input signals, signed so the int8 widening is exercised
+mat_t = np.random.randint(-10, 10, size=(DX, DY)).astype(w_dtype)
+x = np.random.randint(-10, 10, size=(num_time_steps, DX)).astype(x_dtype)
+if args.binary:
+    x.tofile("data/x.bin")
+else:
+    np.savetxt("data/x.txt", x.reshape(-1, per_line), fmt='%d')
+
+# Requantization: SHIFT from quant.h, or calibrated on this data
+if args.calibrate:
+    q = calibrate.calibrate(mat_t, x, x_dtype, ACC_BITS, per_channel=args.calibrate == 'channel')
+    mat_t = q.weights
+    calibrate.write_header('aie/kernels/quant.h', q)
+shift = calibrate.read_shift('aie/kernels/quant.h')
+
+# Weights go through one binary blob (tools/weight_blob.h): the kernel
+# headers are generated from it and the golden output is computed from it.
+np.savetxt('data/w.txt', mat_t, fmt='%d')
+blob('blob', np.dtype(w_dtype).name, str(DX), str(DY), 'data/w.txt', 'data/w.bin')
+blob('header', 'data/w.bin', 'aie/kernels/matrix.h', '--split', str(Q))
+mat_t = weight_blob.load('data/w.bin')
+
+# Compute expected output
+y_exp = calibrate.requantize(calibrate.accumulate(x, mat_t, ACC_BITS), shift, x_dtype)
+
+if args.binary:
+    y_exp.tofile("data/y_exp.bin")
+else:
+    np.savetxt("data/y_exp.txt", y_exp.reshape(-1, per_line), fmt='%d')
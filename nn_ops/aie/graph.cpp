@@ -0,0 +1,14 @@
+#include <adf.h>
+#include "kernels.h"
+#include "graph.h"
+
+using namespace adf;
+
+nnOpsGraph mygraph;
+
+int main(void) {
+  mygraph.init();
+  mygraph.run(ITERATIONS);
+  mygraph.end();
+  return 0;
+}
@@ -0,0 +1,72 @@
+#include <adf.h>
+#include "kernels.h"
+
+#ifdef PLACEMENT
+#include "placement.h"
+#endif
+
+using namespace adf;
+
+// PLIO data files are text by default, raw binary when built with -DPLIO_BINARY
+#ifdef PLIO_BINARY
+#define PLIO_EXT ".bin"
+#define PLIO_IS_BINARY true
+#else
+#define PLIO_EXT ".txt"
+#define PLIO_IS_BINARY false
+#endif
+
+class nnOpsGraph : public adf::graph {
+private:
+
+  kernel residual, norm, gate, bn, maxpool, avgpool;
+
+public:
+
+  input_plio  X, R, G;
+  output_plio OMax, OAvg;
+
+
+  nnOpsGraph(){
+
+	  X = input_plio::create("x", plio_128_bits, std::string("data/x") + PLIO_EXT, 0.0, PLIO_IS_BINARY);
+	  R = input_plio::create("r", plio_128_bits, std::string("data/r") + PLIO_EXT, 0.0, PLIO_IS_BINARY);
+	  G = input_plio::create("g", plio_128_bits, std::string("data/g") + PLIO_EXT, 0.0, PLIO_IS_BINARY);
+	  OMax = output_plio::create("omax", plio_128_bits, std::string("data/omax") + PLIO_EXT, 0.0, PLIO_IS_BINARY);
+	  OAvg = output_plio::create("oavg", plio_128_bits, std::string("data/oavg") + PLIO_EXT, 0.0, PLIO_IS_BINARY);
+
+	  residual = kernel::create(Residual);
+	  norm     = kernel::create(Norm);
+	  gate     = kernel::create(Gate);
+	  bn       = kernel::create(BatchNorm);
+	  maxpool  = kernel::create(MaxPool);
+	  avgpool  = kernel::create(AvgPool);
+
+	  // x + r -> LayerNorm -> * g -> BatchNorm -> max and average pooling,
+	  // every intermediate a window between tiles
+	  connect< window<CH*POS*sizeof(x_t)> >  (X.out[0], residual.in[0]);
+	  connect< window<CH*POS*sizeof(x_t)> >  (R.out[0], residual.in[1]);
+	  connect< window<CH*POS*sizeof(x_t)> >  (residual.out[0], norm.in[0]);
+	  connect< window<CH*POS*sizeof(x_t)> >  (norm.out[0], gate.in[0]);
+	  connect< stream >  (G.out[0], gate.in[1]);
+	  connect< window<CH*POS*sizeof(x_t)> >  (gate.out[0], bn.in[0]);
+	  connect< window<CH*POS*sizeof(x_t)> >  (bn.out[0], maxpool.in[0]);
+	  connect< window<CH*POS*sizeof(x_t)> >  (bn.out[0], avgpool.in[0]);
+	  connect< window<CH*POS/POOL*sizeof(x_t)> >  (maxpool.out[0], OMax.in[0]);
+	  connect< window<CH*POS/POOL*sizeof(x_t)> >  (avgpool.out[0], OAvg.in[0]);
+
+	  // Place buffers in different banks to prevent memory stalls (see UG1076 for more details)
+	  not_equal(location<buffer>(residual.in[0]), location<buffer>(residual.in[1]));
+
+	  kernel *ops[] = {&residual, &norm, &gate, &bn, &maxpool, &avgpool};
+	  for (kernel *k : ops){
+		  source(*k) = "aie/kernels/kernels.cc";
+		  runtime<ratio>(*k) = 1.0;
+	  }
+
+#ifdef PLACEMENT
+	  // tiles and banks planned by tools/placement.py
+	  place_graph([&](int i) -> kernel & { return *ops[i]; });
+#endif
+  }
+};
@@ -0,0 +1,40 @@
+#include "adf/window/types.h"
+#include "kernels/ops.h"
+
+#ifndef FUNCTION_KERNELS_H
+#define FUNCTION_KERNELS_H
+
+// POS positions of CH x_t channels per window (kernels/ops.h)
+
+// s = x + r
+void Residual(
+	input_window<x_t> * __restrict x,
+	input_window<x_t> * __restrict r,
+    output_window<x_t> * __restrict s);
+
+// LayerNorm over the channels of every position
+void Norm(
+	input_window<x_t> * __restrict in,
+    output_window<x_t> * __restrict out);
+
+// n * g, the gate streamed in
+void Gate(
+	input_window<x_t> * __restrict n,
+	input_stream<x_t> * __restrict g,
+    output_window<x_t> * __restrict out);
+
+// folded BatchNorm, per channel scale and bias
+void BatchNorm(
+	input_window<x_t> * __restrict in,
+    output_window<x_t> * __restrict out);
+
+// POOL positions to one
+void MaxPool(
+	input_window<x_t> * __restrict in,
+    output_window<x_t> * __restrict out);
+
+void AvgPool(
+	input_window<x_t> * __restrict in,
+    output_window<x_t> * __restrict out);
+
+#endif
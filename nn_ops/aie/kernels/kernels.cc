@@ -0,0 +1,62 @@
+#include <adf.h>
+#include <type_traits>
+#include "aie_api/aie.hpp"
+#include "aie_api/aie_adf.hpp"
+#include "ops.h"
+#include "params.h"
+#include "nn_ops.h"
+
+// The demo chain of graph.h on nn_ops.h, one op per kernel. generate_golden
+// writes params.h for the DTYPE it is built with, so the two have to agree.
+static_assert(std::is_same<PARAMS_DTYPE, x_t>::value, "params.h was generated for another DTYPE, run make golden");
+
+void Residual(
+	input_window<x_t> * __restrict x,
+	input_window<x_t> * __restrict r,
+    output_window<x_t> * __restrict s)
+{
+    nn::add<x_t, CH * POS>(x, r, s);
+}
+
+void Norm(
+	input_window<x_t> * __restrict in,
+    output_window<x_t> * __restrict out)
+{
+    unsigned long long cycle_num[2];
+    aie::tile tile = aie::tile::current();
+    cycle_num[0] = tile.cycles();
+
+    nn::layer_norm<x_t, CH, POS>(in, out, ln_gamma, ln_beta, FRAC, GAMMA_BITS);
+
+    cycle_num[1] = tile.cycles();
+    printf("start = %lld, end = %lld, total = %lld\n", cycle_num[0], cycle_num[1], cycle_num[1]-cycle_num[0]);
+}
+
+void Gate(
+	input_window<x_t> * __restrict n,
+	input_stream<x_t> * __restrict g,
+    output_window<x_t> * __restrict out)
+{
+    nn::mul<x_t, CH * POS>(n, g, out, FRAC);
+}
+
+void BatchNorm(
+	input_window<x_t> * __restrict in,
+    output_window<x_t> * __restrict out)
+{
+    nn::scale_shift<x_t, CH, POS>(in, out, bn_scale, bn_bias, SCALE_BITS, SCALE_BITS);
+}
+
+void MaxPool(
+	input_window<x_t> * __restrict in,
+    output_window<x_t> * __restrict out)
+{
+    nn::max_pool<x_t, CH, POS, POOL>(in, out);
+}
+
+void AvgPool(
+	input_window<x_t> * __restrict in,
+    output_window<x_t> * __restrict out)
+{
+    nn::avg_pool<x_t, CH, POS, POOL>(in, out);
+}
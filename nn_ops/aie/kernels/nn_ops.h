@@ -0,0 +1,284 @@
+#ifndef NN_OPS_H
+#define NN_OPS_H
+
+#include <adf.h>
+#include "aie_api/aie.hpp"
+#include "aie_api/aie_adf.hpp"
+
+/*
+ *  The layers of a network around its matmuls, for the int32, int16 and int8
+ *  data of the GemV kernels, so they run on the array between GemV tiles
+ *  instead of on the host behind a PL round trip:
+ *
+ *      add          residual add, y = (a + b) >> shift
+ *      mul          elementwise product, y = (a * b) >> shift
+ *      scale_shift  folded BatchNorm, y = (x * scale[c] + (bias[c] << bias_shift)) >> shift
+ *      layer_norm   y = gamma[c] * (x - mean) / std + beta[c] over the channels of a position
+ *      max_pool     max over K consecutive positions, stride K
+ *      avg_pool     mean over K consecutive positions, stride K
+ *
+ *  Data is channel last, as the GemV kernels write it: a position is C
+ *  consecutive values, one GemV output vector, and a call handles P
+ *  positions. The ports are template parameters: windows are read with
+ *  window_readincr_v, streams 128 bits at a time, so an op sits behind a
+ *  GemV window or a split-K stream alike.
+ *
+ *  Vectors are 8 lanes for int32 (acc80) and 16 for int16 and int8 (acc48).
+ *  int8 is widened to int16 for the arithmetic: the ops multiply lane by
+ *  lane, and the 16b x 8b mac16 only gains by summing 4 columns per lane, as
+ *  in a GemV. Coefficients and biases are of that widened type, wide_t<T>. Results are narrowed by to_vector() with the rounding
+ *  and saturation modes in force.
+ */
+
+namespace nn {
+
+template <typename T> struct dtype;
+template <> struct dtype<int32> { static constexpr unsigned lanes = 8;  using wide = int32; using acc = acc80; };
+template <> struct dtype<int16> { static constexpr unsigned lanes = 16; using wide = int16; using acc = acc48; };
+template <> struct dtype<int8>  { static constexpr unsigned lanes = 16; using wide = int16; using acc = acc48; };
+
+template <typename T> constexpr unsigned lanes = dtype<T>::lanes;
+template <typename T> using wide_t = typename dtype<T>::wide;
+template <typename T> using vec_t = aie::vector<T, lanes<T>>;
+template <typename T> using wvec_t = aie::vector<wide_t<T>, lanes<T>>;
+template <typename T> using acc_t = aie::accum<typename dtype<T>::acc, lanes<T>>;
+
+// L lanes from a window, or from a stream in 128-bit reads
+template <unsigned L, typename T>
+inline aie::vector<T, L> read_v(input_window<T> *w) { return window_readincr_v<L>(w); }
+
+template <unsigned L, typename T>
+inline aie::vector<T, L> read_v(input_stream<T> *s)
+{
+    constexpr unsigned S = 16 / sizeof(T);
+    static_assert(L == S || L == 2 * S, "one or two stream words per vector");
+    if constexpr (L == S) {
+        return readincr_v<S>(s);
+    } else {
+        const aie::vector<T, S> lo = readincr_v<S>(s);
+        const aie::vector<T, S> hi = readincr_v<S>(s);
+        return aie::concat(lo, hi);
+    }
+}
+
+template <typename T, unsigned L>
+inline void write_v(output_window<T> *w, const aie::vector<T, L> &v) { window_writeincr(w, v); }
+
+template <typename T, unsigned L>
+inline void write_v(output_stream<T> *s, const aie::vector<T, L> &v)
+{
+    constexpr unsigned S = 16 / sizeof(T);
+    for (unsigned i = 0; i < L / S; ++i) chess_flatten_loop
+        writeincr(s, v.template extract<S>(i));
+}
+
+template <typename T>
+inline wvec_t<T> widen(const vec_t<T> &v)
+{
+    if constexpr (sizeof(T) == 1)
+        return aie::unpack(v);
+    else
+        return v;
+}
+
+template <typename T>
+inline vec_t<T> narrow(const wvec_t<T> &v)
+{
+    if constexpr (sizeof(T) == 1)
+        return aie::pack(v);
+    else
+        return v;
+}
+
+template <typename T, typename In>
+inline wvec_t<T> read_w(In *in) { return widen<T>(read_v<lanes<T>>(in)); }
+
+// y = (a + b) >> shift, N values; a and b at the same scale
+template <typename T, unsigned N, typename A, typename B, typename Out>
+inline void add(A *__restrict a, B *__restrict b, Out *__restrict out, int shift = 0)
+{
+    static_assert(N % lanes<T> == 0, "N must be a multiple of the vector lanes");
+    for (unsigned i = 0; i < N / lanes<T>; ++i) chess_prepare_for_pipelining {
+        acc_t<T> acc;
+        acc.from_vector(read_w<T>(a));
+        acc = aie::mac(acc, read_w<T>(b), wide_t<T>(1));
+        write_v(out, acc.template to_vector<T>(shift));
+    }
+}
+
+// y = (a * b) >> shift, N values
+template <typename T, unsigned N, typename A, typename B, typename Out>
+inline void mul(A *__restrict a, B *__restrict b, Out *__restrict out, int shift = 0)
+{
+    static_assert(N % lanes<T> == 0, "N must be a multiple of the vector lanes");
+    for (unsigned i = 0; i < N / lanes<T>; ++i) chess_prepare_for_pipelining {
+        const wvec_t<T> va = read_w<T>(a);
+        write_v(out, aie::mul(va, read_w<T>(b)).template to_vector<T>(shift));
+    }
+}
+
+// Folded BatchNorm of P positions of C channels: scale = gamma / sqrt(var + eps)
+// and bias = beta - mean * scale per channel, folded offline. bias is upshifted
+// by bias_shift to the scale of x * scale, the sum downshifted by shift.
+template <typename T, unsigned C, unsigned P, typename In, typename Out>
+inline void scale_shift(In *__restrict in, Out *__restrict out,
+                        const wide_t<T> (&scale)[C], const wide_t<T> (&bias)[C], int bias_shift, int shift)
+{
+    constexpr unsigned L = lanes<T>;
+    static_assert(C % L == 0, "C must be a multiple of the vector lanes");
+
+    for (unsigned p = 0; p < P; ++p)
+        for (unsigned j = 0; j < C / L; ++j) chess_prepare_for_pipelining {
+            acc_t<T> acc;
+            acc.from_vector(aie::load_v<L>(bias + j * L), bias_shift);
+            acc = aie::mac(acc, read_w<T>(in), aie::load_v<L>(scale + j * L));
+            write_v(out, acc.template to_vector<T>(shift));
+        }
+}
+
+// floor(sqrt(v)), bit by bit
+inline int32 isqrt(int32 v)
+{
+    unsigned x = v, r = 0, b = 1u << 30;
+    while (b > x)
+        b >>= 2;
+    while (b) {
+        if (x >= r + b) {
+            x -= r + b;
+            r = (r >> 1) + b;
+        } else {
+            r >>= 1;
+        }
+        b >>= 2;
+    }
+    return r;
+}
+
+// Right shift of the squared deviations before their lane sums leave the
+// accumulator for int32: none for int8 and int16, 16 for int32 data. Even.
+template <typename T> constexpr unsigned var_shift = sizeof(T) == 4 ? 16 : 0;
+
+constexpr int log2_ceil(unsigned n) { return n <= 1 ? 0 : 1 + log2_ceil((n + 1) / 2); }
+
+// Fraction bits of the normalized values in layer_norm: as many as wide_t<T>
+// holds for |z| < sqrt(C), at most 14 + VS/2 so that the shift to them is >= 0
+template <typename T, unsigned C, unsigned VS>
+constexpr int norm_bits = 8 * int(sizeof(wide_t<T>)) - 2 - (log2_ceil(C) + 1) / 2 < 14 + int(VS / 2)
+                        ? 8 * int(sizeof(wide_t<T>)) - 2 - (log2_ceil(C) + 1) / 2 : 14 + int(VS / 2);
+
+/*
+ *  LayerNorm of P positions of C channels. Per position, the channels are read
+ *  once into registers and
+ *   1. mean = sum(x) / C, lanes summed in the accumulator, then reduced;
+ *   2. d = x - mean and var = sum((d * d) >> VS) / C, the same way;
+ *   3. s = isqrt(var << 2e), e making var << 2e at least 2^28 so that s keeps
+ *      15 bits however small var is: std = s * 2^(VS/2 - e). r = 2^28 / s is
+ *      at most 2^14 and fits any multiplier;
+ *   4. z = (d * r) >> (28 + VS/2 - e - ZB), the normalized value with
+ *      ZB = norm_bits fraction bits, and y = ((beta << sy) + z * gamma) >> sy
+ *      with sy = gamma_bits + ZB - frac: gamma has gamma_bits fraction bits,
+ *      beta and y frac (frac <= ZB).
+ *  Only the two reductions, the square root and the divide are scalar, once
+ *  per position. d must fit wide_t<T>: int16 data within +-2^14 of its mean.
+ *
+ *  The two sums leave the accumulator as int32 lane sums and are reduced in
+ *  int32, so for int32 data sum(x) and sum(d * d) >> VS must stay below 2^31:
+ *  |x| < 2^31 / C and, with VS = 16, sum(d * d) < 2^47, i.e. deviations below
+ *  about 2^23.5 / sqrt(C) (2^21 for C = 32). Beyond that the lane sums
+ *  saturate and the reduction wraps; scale the data down before the call.
+ */
+template <typename T, unsigned C, unsigned P, unsigned VS = var_shift<T>, typename In, typename Out>
+inline void layer_norm(In *__restrict in, Out *__restrict out,
+                       const wide_t<T> (&gamma)[C], const wide_t<T> (&beta)[C], int frac, int gamma_bits)
+{
+    using W = wide_t<T>;
+    constexpr unsigned L = lanes<T>;
+    static_assert(C % L == 0, "C must be a multiple of the vector lanes");
+    static_assert(VS % 2 == 0, "the variance shift must be even");
+    constexpr int ZB = norm_bits<T, C, VS>;
+    const int sy = gamma_bits + ZB - frac;
+
+    for (unsigned p = 0; p < P; ++p) {
+        wvec_t<T> d[C / L];
+        acc_t<T> acc;
+
+        d[0] = read_w<T>(in);
+        acc = aie::mul(d[0], W(1));
+        for (unsigned j = 1; j < C / L; ++j) chess_prepare_for_pipelining {
+            d[j] = read_w<T>(in);
+            acc = aie::mac(acc, d[j], W(1));
+        }
+        const int32 mean = aie::reduce_add(acc.template to_vector<int32>(0)) / int32(C);
+
+        for (unsigned j = 0; j < C / L; ++j) chess_prepare_for_pipelining {
+            d[j] = aie::sub(d[j], W(mean));
+            acc = j == 0 ? aie::mul(d[j], d[j]) : aie::mac(acc, d[j], d[j]);
+        }
+        int32 var = aie::reduce_add(acc.template to_vector<int32>(VS)) / int32(C);
+        if (var < 1)
+            var = 1;
+
+        int e = 0;
+        while (e < 14 && var < (1 << (28 - 2 * e)))
+            ++e;
+        const W r = W((1 << 28) / isqrt(var << (2 * e)));
+        const int sh = 28 + int(VS / 2) - e - ZB;
+
+        for (unsigned j = 0; j < C / L; ++j) chess_prepare_for_pipelining {
+            const wvec_t<T> z = aie::mul(d[j], r).template to_vector<W>(sh);
+            acc.from_vector(aie::load_v<L>(beta + j * L), sy);
+            acc = aie::mac(acc, z, aie::load_v<L>(gamma + j * L));
+            write_v(out, acc.template to_vector<T>(sy));
+        }
+    }
+}
+
+// P positions of C channels to P / K: the channel maxima of every K positions
+template <typename T, unsigned C, unsigned P, unsigned K, typename In, typename Out>
+inline void max_pool(In *__restrict in, Out *__restrict out)
+{
+    constexpr unsigned L = lanes<T>;
+    static_assert(C % L == 0 && P % K == 0, "C must be a multiple of the vector lanes, P of K");
+
+    for (unsigned p = 0; p < P / K; ++p) {
+        wvec_t<T> m[C / L];
+        for (unsigned j = 0; j < C / L; ++j) chess_prepare_for_pipelining
+            m[j] = read_w<T>(in);
+        for (unsigned k = 1; k < K; ++k)
+            for (unsigned j = 0; j < C / L; ++j) chess_prepare_for_pipelining
+                m[j] = aie::max(m[j], read_w<T>(in));
+        for (unsigned j = 0; j < C / L; ++j) chess_prepare_for_pipelining
+            write_v(out, narrow<T>(m[j]));
+    }
+}
+
+// 2^avg_bits / K rounded, the multiplier of avg_pool: at most 2^14, so it
+// fits int16, and exact for powers of two
+template <unsigned K> constexpr int avg_bits = 14 + (K >= 2) + (K >= 4) + (K >= 8) + (K >= 16) + (K >= 32) + (K >= 64);
+template <unsigned K> constexpr int avg_mul = ((1 << avg_bits<K>) + K / 2) / K;
+
+// P positions of C channels to P / K: the channel means of every K positions,
+// sum(x * avg_mul) >> avg_bits in the accumulator
+template <typename T, unsigned C, unsigned P, unsigned K, typename In, typename Out>
+inline void avg_pool(In *__restrict in, Out *__restrict out)
+{
+    using W = wide_t<T>;
+    constexpr unsigned L = lanes<T>;
+    static_assert(C % L == 0 && P % K == 0, "C must be a multiple of the vector lanes, P of K");
+    static_assert(K >= 1 && K < 128, "pool sizes up to 127");
+
+    for (unsigned p = 0; p < P / K; ++p) {
+        acc_t<T> acc[C / L];
+        for (unsigned j = 0; j < C / L; ++j) chess_prepare_for_pipelining
+            acc[j] = aie::mul(read_w<T>(in), W(avg_mul<K>));
+        for (unsigned k = 1; k < K; ++k)
+            for (unsigned j = 0; j < C / L; ++j) chess_prepare_for_pipelining
+                acc[j] = aie::mac(acc[j], read_w<T>(in), W(avg_mul<K>));
+        for (unsigned j = 0; j < C / L; ++j) chess_prepare_for_pipelining
+            write_v(out, acc[j].template to_vector<T>(avg_bits<K>));
+    }
+}
+
+} // namespace nn
+
+#endif // NN_OPS_H
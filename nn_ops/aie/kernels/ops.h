@@ -0,0 +1,34 @@
+#ifndef OPS_H
+#define OPS_H
+
+// The demo chain of graph.h: a residual add, LayerNorm, a gate multiply,
+// folded BatchNorm, then max and average pooling, all on nn_ops.h.
+// generate_golden.cpp reads the same definitions.
+
+// Data type of the build, from DTYPE in the Makefile: DTYPE_INT16 (default),
+// DTYPE_INT8 or DTYPE_INT32, and its fraction bits
+#if defined(DTYPE_INT32)
+typedef int32 x_t;
+#define FRAC 16
+#elif defined(DTYPE_INT8)
+typedef int8 x_t;
+#define FRAC 4
+#else
+typedef int16 x_t;
+#define FRAC 8
+#endif
+
+// channels per position (one GemV output vector), positions per window and
+// pooling size
+#define CH 32
+#define POS 8
+#define POOL 2
+
+// fraction bits of the LayerNorm gamma and the BatchNorm scale (params.h)
+#define GAMMA_BITS 12
+#define SCALE_BITS 12
+
+// graph iterations, one window of POS positions each
+#define ITERATIONS 10
+
+#endif // OPS_H
@@ -0,0 +1,28 @@
+#ifndef PARAMS_H
+#define PARAMS_H
+
+// generated by generate_golden.cpp: LayerNorm gamma (GAMMA_BITS) and beta
+// (FRAC), folded BatchNorm scale (SCALE_BITS) and bias (FRAC)
+#define PARAMS_DTYPE int16
+
+alignas(32) const int16 ln_gamma[32] = {
+    4090, 2842, 2956, 3971, 3820, 3263, 3652, 2962, 2293, 3245, 3141, 2335, 3875, 3354, 2778, 3660,
+    3628, 3500, 3177, 2520, 2860, 4030, 2801, 3588, 3925, 2651, 3970, 4059, 3610, 2490, 2200, 3955
+};
+
+alignas(32) const int16 ln_beta[32] = {
+    55, 22, -35, 36, 42, 22, -11, -36, 3, 8, 58, 37, -16, -48, 32, -56,
+    -25, -4, -55, 1, -50, -28, 40, -9, 36, -18, -16, 50, -6, 53, -52, 10
+};
+
+alignas(32) const int16 bn_scale[32] = {
+    1561, 2470, 2075, 2198, 2159, 2420, 1538, 1141, 1611, 2540, 2868, 1377, 1912, 1908, 3485, 1530,
+    3581, 1933, 1949, 2009, 2374, 1683, 1749, 1498, 2807, 2142, 1693, 1942, 1973, 2339, 1990, 2111
+};
+
+alignas(32) const int16 bn_bias[32] = {
+    154, 117, 112, 133, 1, -46, 16, 21, 65, 155, -37, 95, 56, 55, -125, 125,
+    -106, 20, 100, -118, -71, -112, 43, -3, -146, -63, 83, 95, -56, -133, 14, 55
+};
+
+#endif // PARAMS_H
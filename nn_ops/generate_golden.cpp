@@ -0,0 +1,248 @@
+/*
+*	How to run:
+* 	g++ -std=c++17 -O2 -DDTYPE_INT16 -o generate_golden.exe generate_golden.cpp
+*	./generate_golden.exe [--binary]
+*
+*	Writes aie/kernels/params.h, the LayerNorm gamma/beta and the folded
+*	BatchNorm scale/bias of the demo chain (fixed seed, so the header only
+*	changes with DTYPE), ITERATIONS windows of random x, r and g to data/, and
+*	the expected max and average pooled outputs to data/omax and data/oavg.
+*	The outputs are computed with the kernels' integer arithmetic (nn_ops.h),
+*	stage by stage, so they match exactly.
+*
+*	--binary writes raw .bin files for graphs built with PLIO_BINARY instead
+*	of the one-128-bit-word-per-line text files.
+*
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <fstream>
+#include <limits>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+
+typedef int8_t  int8;
+typedef int16_t int16;
+typedef int32_t int32;
+
+#include "aie/kernels/ops.h"
+
+typedef std::conditional_t<sizeof(x_t) == 4, int32, int16> w_t;   // nn::wide_t<x_t>
+constexpr unsigned LANES = sizeof(x_t) == 4 ? 8 : 16;             // nn::lanes<x_t>
+constexpr unsigned VS = sizeof(x_t) == 4 ? 16 : 0;                // nn::var_shift<x_t>
+
+// nn::norm_bits<x_t, CH, VS>
+constexpr int log2_ceil(unsigned n){ return n <= 1 ? 0 : 1 + log2_ceil((n + 1) / 2); }
+constexpr int ZB = std::min(8 * int(sizeof(w_t)) - 2 - (log2_ceil(CH) + 1) / 2, 14 + int(VS / 2));
+
+
+static bool binary = false;
+static int overflows = 0;
+
+// write the i-th value of a PLIO file, one 128-bit word per text line
+static void write_value(std::fstream &f, x_t v, int i){
+
+	if (binary){
+		f.write(reinterpret_cast<const char*>(&v), sizeof(v));
+		return;
+	}
+
+	f << int(v);
+	if (i % (16 / sizeof(x_t)) == 16 / sizeof(x_t) - 1){
+		f << "\n";
+	}
+	else{
+		f << " ";
+	}
+}
+
+static void write_all(std::fstream &f, const std::vector<x_t> &v){
+	for (size_t i = 0; i < v.size(); i++)
+		write_value(f, v[i], int(i));
+}
+
+// to_vector<T>(shift): floor, then T. The chain is sized not to overflow;
+// a value that does is counted and reported.
+template <typename T>
+static T srs(int64_t v, int shift){
+	v >>= shift;
+	if (v < std::numeric_limits<T>::min() || v > std::numeric_limits<T>::max())
+		overflows++;
+	return T(v);
+}
+
+// nn::isqrt
+static int32 isqrt(int32 v){
+	unsigned x = v, r = 0, b = 1u << 30;
+	while (b > x)
+		b >>= 2;
+	while (b){
+		if (x >= r + b){
+			x -= r + b;
+			r = (r >> 1) + b;
+		}
+		else{
+			r >>= 1;
+		}
+		b >>= 2;
+	}
+	return r;
+}
+
+// nn::layer_norm over the CH channels of every position
+static std::vector<x_t> layer_norm(const std::vector<x_t> &x, const w_t *gamma, const w_t *beta){
+
+	std::vector<x_t> y(x.size());
+	for (size_t p = 0; p < x.size() / CH; p++){
+		const x_t *xp = &x[p * CH];
+
+		int32 total = 0;
+		for (int c = 0; c < CH; c++)
+			total += xp[c];
+		const int32 mean = total / int32(CH);
+
+		// squared deviations summed per lane, each lane shifted by VS
+		std::vector<w_t> d(CH);
+		std::vector<int64_t> lane(LANES, 0);
+		for (int c = 0; c < CH; c++){
+			d[c] = w_t(xp[c] - mean);
+			lane[c % LANES] += int64_t(d[c]) * d[c];
+		}
+		int32 sq = 0;
+		for (auto l : lane)
+			sq += srs<int32>(l, VS);
+		const int32 var = std::max(sq / int32(CH), 1);
+
+		int e = 0;
+		while (e < 14 && var < (1 << (28 - 2 * e)))
+			e++;
+		const w_t r = w_t((1 << 28) / isqrt(var << (2 * e)));
+		const int sh = 28 + int(VS / 2) - e - ZB;
+		const int sy = GAMMA_BITS + ZB - FRAC;
+
+		for (int c = 0; c < CH; c++){
+			const w_t z = srs<w_t>(int64_t(d[c]) * r, sh);
+			y[p * CH + c] = srs<x_t>((int64_t(beta[c]) << sy) + int64_t(z) * gamma[c], sy);
+		}
+	}
+	return y;
+}
+
+template <typename F>
+static void write_array(std::ofstream &h, const char *name, int n, F value){
+	h << "alignas(32) const " << (sizeof(w_t) == 4 ? "int32" : "int16") << " " << name << "[" << n << "] = {";
+	for (int i = 0; i < n; i++)
+		h << (i % 16 ? " " : "\n    ") << value(i) << (i + 1 < n ? "," : "");
+	h << "\n};\n\n";
+}
+
+
+int main(int argc, char **argv){
+
+	binary = argc > 1 && std::string(argv[1]) == "--binary";
+	const std::string ext = binary ? ".bin" : ".txt";
+	const auto mode = binary ? std::ios::out | std::ios::binary : std::ios::out;
+	const double one = double(1 << FRAC);
+
+	// parameters: LayerNorm gamma in [0.5, 1], beta in [-0.25, 0.25]; BatchNorm
+	// from running statistics, folded to scale = gamma / sqrt(var + eps) and
+	// bias = beta - mean * scale
+	std::mt19937 prng(1);
+	auto uniform = [&](double lo, double hi){ return std::uniform_real_distribution<double>(lo, hi)(prng); };
+
+	std::vector<w_t> ln_gamma(CH), ln_beta(CH), bn_scale(CH), bn_bias(CH);
+	for (int c = 0; c < CH; c++){
+		ln_gamma[c] = w_t(std::lround(uniform(0.5, 1.0) * (1 << GAMMA_BITS)));
+		ln_beta[c] = w_t(std::lround(uniform(-0.25, 0.25) * one));
+
+		const double g = uniform(0.5, 1.0), b = uniform(-0.5, 0.5);
+		const double mean = uniform(-0.5, 0.5), var = uniform(1.0, 4.0), eps = 1e-3;
+		const double scale = g / std::sqrt(var + eps);
+		bn_scale[c] = w_t(std::lround(scale * (1 << SCALE_BITS)));
+		bn_bias[c] = w_t(std::lround((b - mean * scale) * one));
+	}
+
+	std::ofstream h("aie/kernels/params.h");
+	h << "#ifndef PARAMS_H\n#define PARAMS_H\n\n"
+	  << "// generated by generate_golden.cpp: LayerNorm gamma (GAMMA_BITS) and beta\n"
+	  << "// (FRAC), folded BatchNorm scale (SCALE_BITS) and bias (FRAC)\n"
+	  << "#define PARAMS_DTYPE " << (sizeof(x_t) == 4 ? "int32" : sizeof(x_t) == 2 ? "int16" : "int8") << "\n\n";
+	write_array(h, "ln_gamma", CH, [&](int i){ return ln_gamma[i]; });
+	write_array(h, "ln_beta", CH, [&](int i){ return ln_beta[i]; });
+	write_array(h, "bn_scale", CH, [&](int i){ return bn_scale[i]; });
+	write_array(h, "bn_bias", CH, [&](int i){ return bn_bias[i]; });
+	h << "#endif // PARAMS_H\n";
+
+	std::fstream x_file("./data/x" + ext, mode);
+	std::fstream r_file("./data/r" + ext, mode);
+	std::fstream g_file("./data/g" + ext, mode);
+	std::fstream omax_file("./data/omax" + ext, mode);
+	std::fstream oavg_file("./data/oavg" + ext, mode);
+
+	// seed
+	srand(time(NULL));
+
+	constexpr int N = CH * POS;
+	std::vector<x_t> x(N), r(N), g(N), s(N), m(N), b(N), omax(N / POOL), oavg(N / POOL);
+
+	for (int batch = 0; batch < ITERATIONS; batch++){
+
+		// x and the residual r in [-2, 2), the gate g in [-1, 1)
+		for (int i = 0; i < N; i++){
+			x[i] = x_t(rand() % (4 << FRAC) - (2 << FRAC));
+			r[i] = x_t(rand() % (4 << FRAC) - (2 << FRAC));
+			g[i] = x_t(rand() % (2 << FRAC) - (1 << FRAC));
+		}
+
+		for (int i = 0; i < N; i++)
+			s[i] = srs<x_t>(int64_t(x[i]) + r[i], 0);
+
+		const std::vector<x_t> n = layer_norm(s, ln_gamma.data(), ln_beta.data());
+
+		for (int i = 0; i < N; i++)
+			m[i] = srs<x_t>(int64_t(n[i]) * g[i], FRAC);
+
+		for (int i = 0; i < N; i++)
+			b[i] = srs<x_t>((int64_t(bn_bias[i % CH]) << SCALE_BITS) + int64_t(m[i]) * bn_scale[i % CH], SCALE_BITS);
+
+		// nn::avg_pool: sum(x * avg_mul) >> avg_bits
+		int bits = 14;
+		for (int k = 2; k <= POOL; k *= 2)
+			bits++;
+		const int64_t avg_mul = ((int64_t(1) << bits) + POOL / 2) / POOL;
+
+		for (int p = 0; p < POS / POOL; p++)
+			for (int c = 0; c < CH; c++){
+				x_t mx = b[p * POOL * CH + c];
+				int64_t acc = 0;
+				for (int k = 0; k < POOL; k++){
+					mx = std::max(mx, b[(p * POOL + k) * CH + c]);
+					acc += int64_t(b[(p * POOL + k) * CH + c]) * avg_mul;
+				}
+				omax[p * CH + c] = mx;
+				oavg[p * CH + c] = srs<x_t>(acc, bits);
+			}
+
+		write_all(x_file, x);
+		write_all(r_file, r);
+		write_all(g_file, g);
+		write_all(omax_file, omax);
+		write_all(oavg_file, oavg);
+	}
+
+	if (overflows){
+		std::cerr << "generate_golden: " << overflows << " intermediate values overflow their type, "
+				  << "the kernels wrap them too; shrink the input ranges\n";
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,379 @@
+"""
+Autotuner for the GemV / GEMM kernel parameters.
+
+Enumerates the legal configurations for a layer shape and dtype, i.e. the
+knobs that are otherwise edited by hand:
+
+  gemv int32  GemV8 vs GemV4, kernel source (incl. packed weights), Q splits
+  gemv int16  the 16x16 mac16 kernel (the only shape it supports)
+  gemm int32  M_API/K_API/N_API and single_M/K/N in include.h
+
+and scores each one on cycles and tile data memory (tools/footprint.py). Configurations that do
+not fit a tile's 32 KB, or need more tiles than the array has, are listed but
+never built. GEMM layers are split over up to --max-tiles kernels (default 1,
+what graph.h wires today). Cycles come from
+
+  --backend model   the kernel cycles of tools/perf_model.h (perf_model.exe
+                    cycles), an issue-slot model with a fixed cost per
+                    kernel fitted to the measured 16x16 numbers (GemV8
+                    79/71, GemV4 87/77, i16 42, GEMM 1071). It
+                    reproduces those figures by construction and has not
+                    been checked against any other run. Unmeasured kernel
+                    sources are scored as optimized_kernels.cc, Q and every
+                    GEMM mmul shape score the same: configurations the model
+                    cannot tell apart are listed as one unranked row, and the
+                    best one names only what they share
+  --backend aiesim  a copy of the kernel directory per configuration,
+                    `make run_sim`, and the tile.cycles() printouts
+                    ("total = N") of the simulated kernel
+
+--verify additionally runs `make host_sim` on every configuration and drops
+the ones whose output does not match the golden data. The model does not see
+bank conflicts, so it ties on Q; aiesim tells those apart. The best configuration
+and a cycles vs. memory Pareto table are printed; --csv saves every row.
+
+How to run:
+python tools/autotune.py gemv --k 32 --n 48
+python tools/autotune.py gemv --k 16 --n 16 --dtype int16
+python tools/autotune.py gemm --m 32 --k 32 --n 32 --backend aiesim --jobs 4
+
+With --max-tiles > 1 a GEMM layer may be split over mult_X x mult_Y x mult_Z
+tiles running concurrently; cycles are then per tile, and aiesim measures the
+first one.
+"""
+
+import argparse
+import csv
+import os
+import re
+import shutil
+import statistics
+import subprocess
+import sys
+from concurrent.futures import ThreadPoolExecutor
+from dataclasses import dataclass
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+import footprint  # noqa: E402
+
+REPO = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+EMU_INCLUDE = os.path.join(REPO, "tools", "emu", "include")
+PLIO_CONVERT = os.path.join(REPO, "tools", "plio_convert.exe")
+PACK_WEIGHTS = os.path.join(REPO, "tools", "pack_weights.exe")
+PLIO_COMPARE = os.path.join(REPO, "tools", "plio_compare.exe")
+CPU_INFER = os.path.join(REPO, "tools", "cpu_infer.exe")
+TRACE_REPORT = os.path.join(REPO, "tools", "trace_report.exe")
+PERF_MODEL = os.path.join(REPO, "tools", "perf_model.exe")
+
+TILE_MEMORY = footprint.TILE_MEMORY
+ARRAY_TILES = 400           # AIE tiles on the VCK190
+max_tiles = 1               # --max-tiles
+
+# AI Engine API int32 x int32 mmul shapes (include.h)
+GEMM_API_SHAPES = [(4, 2, 4), (2, 2, 2), (2, 4, 2), (2, 8, 2), (4, 2, 2), (4, 4, 2), (2, 4, 4), (4, 4, 1)]
+
+# kernel sources without a measurement of their own, scored as this one by perf_model.h
+ASSUMED = {"unrolled_kernels.cc": "optimized_kernels.cc", "packed_kernels.cc": "optimized_kernels.cc"}
+
+
+@dataclass
+class Config:
+    kind: str
+    params: dict
+    memory: int
+    kernels: int = 1
+    cycles: float = None
+    note: str = ""
+    ok: bool = True
+
+    def name(self):
+        return " ".join(f"{k}={v}" for k, v in self.params.items())
+
+
+# ---------------------------------------------------------------- enumeration
+
+def gemv_configs(k, n, dtype):
+    memory = footprint.gemv(k, n, dtype).total
+    out = []
+    if dtype == "int16":
+        if (k, n) == (16, 16):
+            out.append(Config("gemv_i16", dict(kernel="GemV", source="kernels.cc", Q=2), memory))
+        return out
+
+    if k % 8 or n % 16:
+        return out
+    for kernel in ("GemV8", "GemV4"):
+        for q in (1, 2, 4, 8):
+            out.append(Config("gemv_i32", dict(kernel=kernel, source="unrolled_kernels.cc", Q=q), memory))
+        out.append(Config("gemv_i32", dict(kernel=kernel, source="packed_kernels.cc", Q=2), memory))
+        if (k, n) == (16, 16):
+            for source in ("kernels.cc", "optimized_kernels.cc"):
+                out.append(Config("gemv_i32", dict(kernel=kernel, source=source, Q=2), memory))
+    return out
+
+
+def divisors(x):
+    return [d for d in range(1, x + 1) if x % d == 0]
+
+
+def gemm_configs(m, k, n):
+    out = []
+    for ma, ka, na in GEMM_API_SHAPES:
+        for sm in divisors(m):
+            for sk in divisors(k):
+                for sn in divisors(n):
+                    # the kernel walks 2x2 blocks of mmul tiles
+                    if sm % (2 * ma) or sn % (2 * na) or sk % ka:
+                        continue
+                    memory = footprint.gemm(sm, sk, sn).total
+                    out.append(Config("gemm_i32", dict(M_API=ma, K_API=ka, N_API=na,
+                                                       single_M=sm, single_K=sk, single_N=sn),
+                                      memory, kernels=(m // sm) * (k // sk) * (n // sn)))
+    return out
+
+
+# ---------------------------------------------------------------- cycle model
+
+def model_args(cfg, shape):
+    """cfg as a perf_model.exe gemv or gemm command line"""
+    p = cfg.params
+    if cfg.kind == "gemv_i32":
+        return f"gemv {shape[0]} {shape[1]} --kernel {p['kernel']} --source {p['source']}"
+    if cfg.kind == "gemv_i16":
+        return f"gemv {shape[0]} {shape[1]} --x int16 --w int16 --y int16"
+    return (f"gemm {p['single_M']} {p['single_K']} {p['single_N']} "
+            f"--api {p['M_API']}x{p['K_API']}x{p['N_API']}")
+
+
+def model(configs, shape):
+    """Kernel cycles of every configuration from one perf_model.exe run."""
+    if not os.path.exists(PERF_MODEL):
+        subprocess.run(["make", "-C", os.path.join(REPO, "tools"), "perf_model.exe"], check=True,
+                       stdout=subprocess.DEVNULL)
+    lines = "".join(model_args(c, shape) + "\n" for c in configs)
+    r = subprocess.run([PERF_MODEL, "cycles"], input=lines, stdout=subprocess.PIPE, text=True, check=True)
+    return [int(line.split()[0]) for line in r.stdout.splitlines()]
+
+
+def model_cycles(cfg, shape):
+    return model([cfg], shape)[0]
+
+
+def model_note(cfg):
+    """What the model cycles of cfg do not stand for, "" when measured."""
+    if cfg.kind == "gemm_i32":
+        return "model, mmul shape unranked"
+    source = cfg.params.get("source")
+    if source in ASSUMED:
+        return f"model, unmeasured, scored as {ASSUMED[source]}"
+    return ""
+
+
+# ---------------------------------------------------------------- simulation
+
+def sub(path, pattern, repl):
+    with open(path, newline="") as f:
+        text = f.read()
+    text, count = re.subn(pattern, repl, text, flags=re.M)
+    if count == 0:
+        raise RuntimeError(f"{path}: no match for {pattern}")
+    with open(path, "w", newline="") as f:
+        f.write(text)
+
+
+def prepare(cfg, shape, workdir, index):
+    src = {"gemv_i32": "gemv_i32", "gemv_i16": "gemv_i16",
+           "gemm_i32": os.path.join("gemm_i32", "aie", "api_benchmark")}[cfg.kind]
+    dst = os.path.join(workdir, f"{cfg.kind}_{index}")
+    shutil.rmtree(dst, ignore_errors=True)
+    shutil.copytree(os.path.join(REPO, src), dst,
+                    ignore=shutil.ignore_patterns("Work", "data", "*.exe", "*simulator_output", "hostsim_output", "_x"))
+    p = cfg.params
+
+    if cfg.kind == "gemv_i32":
+        k, n = shape
+        sub(f"{dst}/run.py", r"^DX = \d+", f"DX = {k}")
+        sub(f"{dst}/run.py", r"^DY = \d+", f"DY = {n}")
+        sub(f"{dst}/run.py", r"^Q = \d+", f"Q = {p['Q']}")
+        sub(f"{dst}/aie/graph.cpp", r"#define DX \d+", f"#define DX {k}")
+        sub(f"{dst}/aie/graph.cpp", r"#define DY \d+", f"#define DY {n}")
+        sub(f"{dst}/aie/graph.cpp", r"kernel::create\(\w+\)", f"kernel::create({p['kernel']})")
+        sub(f"{dst}/aie/graph.cpp", r'"kernels/\w+\.cc"', f'"kernels/{p["source"]}"')
+    elif cfg.kind == "gemm_i32":
+        for key in ("M_API", "K_API", "N_API", "single_M", "single_K", "single_N"):
+            sub(f"{dst}/aie/kernels/include.h", rf"(#define {key} )\d+", rf"\g<1>{p[key]}")
+    return dst
+
+
+def make(directory, target, extra=()):
+    args = ["make", target, f"EMU_INCLUDE={EMU_INCLUDE}", f"PLIO_CONVERT={PLIO_CONVERT}",
+            f"PACK_WEIGHTS={PACK_WEIGHTS}", f"PLIO_COMPARE={PLIO_COMPARE}", f"CPU_INFER={CPU_INFER}",
+            f"TRACE_REPORT={TRACE_REPORT}", *extra]
+    r = subprocess.run(args, cwd=directory, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, text=True)
+    return r.stdout
+
+
+def legal(cfg):
+    return cfg.ok and cfg.memory <= TILE_MEMORY and cfg.kernels <= max_tiles
+
+
+def evaluate(cfg, shape, args, index):
+    cfg.note = model_note(cfg)
+    if cfg.memory > TILE_MEMORY:
+        cfg.note = "exceeds tile memory"
+    elif cfg.kernels > max_tiles:
+        cfg.note = f"needs {cfg.kernels} tiles"
+    if not legal(cfg) or (args.backend == "model" and not args.verify):
+        return cfg
+
+    directory = prepare(cfg, shape, args.workdir, index)
+    if args.verify:
+        log = make(directory, "host_sim", [f"HOST_KERNELS=aie/kernels/{cfg.params.get('source', 'kernels.cc')}"])
+        if "Success: Outputs match" not in log:
+            cfg.ok, cfg.note = False, "host_sim mismatch"
+            return cfg
+
+    if args.backend == "aiesim":
+        log = make(directory, "run_sim")
+        totals = [int(t) for t in re.findall(r"total\s*=\s*(\d+)", log)]
+        if "Success: Outputs match" not in log:
+            cfg.ok, cfg.note = False, "aiesim failed"
+        elif totals:
+            cfg.cycles, cfg.note = statistics.median(totals), "aiesim"
+        else:
+            cfg.note = "no cycle printout, " + (model_note(cfg) or "model")
+    return cfg
+
+
+# ---------------------------------------------------------------- report
+
+def unranked(c):
+    """cycles from the model rather than from a measurement of c itself"""
+    return c.note.startswith(("model", "no cycle printout"))
+
+
+def tie_groups(configs):
+    """configs as lists: the legal ones the model scores alike (same cycles and
+    memory, not simulated) share a list, every other configuration is alone."""
+    groups, rows = {}, []
+    for c in configs:
+        if legal(c) and unranked(c):
+            key = (c.kind, c.cycles, c.memory, c.kernels)
+            if key not in groups:
+                groups[key] = []
+                rows.append(groups[key])
+            groups[key].append(c)
+        else:
+            rows.append([c])
+    return rows
+
+
+def group_name(group):
+    """The parameters a tie group agrees on, and the names of the ones it does not."""
+    first = group[0].params
+    same = {k: v for k, v in first.items() if all(c.params[k] == v for c in group)}
+    return " ".join(f"{k}={v}" for k, v in same.items()), [k for k in first if k not in same]
+
+
+def pareto(rows):
+    front = []
+    for r in rows:
+        c = r[0]
+        dominated = any(o.cycles <= c.cycles and o.memory <= c.memory and
+                        (o.cycles < c.cycles or o.memory < c.memory) for o, *_ in rows)
+        if not dominated:
+            front.append(r)
+    return front
+
+
+def report(configs, csv_path):
+    ok = [c for c in configs if legal(c)]
+    rows = tie_groups(configs)
+    front = pareto([r for r in rows if legal(r[0])])
+
+    print(f"{'':2}{'cycles':>8} {'memory':>7} {'tiles':>5}  configuration")
+    for r in sorted(rows, key=lambda r: (not legal(r[0]), r[0].cycles, r[0].memory)):
+        c = r[0]
+        mark = "*" if r in front else " "
+        if len(r) > 1:
+            name, varying = group_name(r)
+            note = f"  ({len(r)} configurations, {', '.join(varying)} not ranked by the model)"
+        else:
+            name, note = c.name(), f"  ({c.note})" if c.note else ""
+        print(f"{mark:2}{c.cycles:>8} {c.memory:>7} {c.kernels:>5}  {name}{note}")
+
+    if csv_path:
+        pareto_configs = [c for r in front for c in r]
+        with open(csv_path, "w", newline="") as f:
+            w = csv.writer(f)
+            w.writerow(["kind", "cycles", "memory", "tiles", "pareto", "ok", "note"] + list(configs[0].params))
+            for c in configs:
+                w.writerow([c.kind, c.cycles, c.memory, c.kernels, c in pareto_configs, c.ok, c.note]
+                           + list(c.params.values()))
+
+    if not ok:
+        print("\nno legal configuration")
+        return 1
+    # on a tie, a measured configuration beats the ones scored like it
+    best = min(ok, key=lambda c: (c.cycles, c.memory, c.kernels, unranked(c)))
+    ties = next(r for r in rows if best in r)
+    if len(ties) > 1:
+        # the model only gets as far as the parameters the tied configurations
+        # share; aiesim tells the rest apart
+        name, varying = group_name(ties)
+        print(f"\nbest: {name or 'any of the tied configurations'}  ({best.cycles} cycles, "
+              f"{best.memory} bytes, {best.kernels} tile(s))")
+        print(f"{', '.join(varying)}: not ranked by the model, "
+              + ", ".join(" ".join(f"{k}={c.params[k]}" for k in varying) for c in ties)
+              + " tie; run with --backend aiesim to choose one")
+    else:
+        print(f"\nbest: {best.name()}  ({best.cycles} cycles, {best.memory} bytes, {best.kernels} tile(s))")
+    print("* = Pareto optimal in cycles vs. tile memory")
+    return 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Search GemV/GEMM kernel parameters for a layer shape.")
+    parser.add_argument("layer", choices=["gemv", "gemm"])
+    parser.add_argument("--m", type=int, default=16, help="GEMM rows of A / C.")
+    parser.add_argument("--k", type=int, required=True, help="Inner dimension (GemV inputs).")
+    parser.add_argument("--n", type=int, required=True, help="Outputs (GEMM columns of B / C).")
+    parser.add_argument("--dtype", choices=["int32", "int16"], default="int32")
+    parser.add_argument("--backend", choices=["model", "aiesim"], default="model")
+    parser.add_argument("--verify", action="store_true", help="Check every configuration with make host_sim.")
+    parser.add_argument("--max-tiles", type=int, default=1,
+                        help=f"Most AIE tiles a GEMM layer may be split over (array has {ARRAY_TILES}).")
+    parser.add_argument("--jobs", type=int, default=os.cpu_count() or 1)
+    parser.add_argument("--workdir", default=os.path.join(REPO, "tools", "autotune_work"),
+                        help="Scratch directory for per-configuration builds.")
+    parser.add_argument("--csv", help="Write every configuration to this CSV file.")
+    args = parser.parse_args()
+
+    global max_tiles
+    max_tiles = min(args.max_tiles, ARRAY_TILES)
+
+    if args.layer == "gemv":
+        shape = (args.k, args.n)
+        configs = gemv_configs(args.k, args.n, args.dtype)
+    else:
+        if args.dtype != "int32":
+            parser.error("the GEMM kernel is int32 only")
+        shape = (args.m, args.k, args.n)
+        configs = gemm_configs(args.m, args.k, args.n)
+
+    if not configs:
+        print(f"no {args.dtype} {args.layer} kernel supports shape {shape}")
+        return 1
+
+    if (args.backend == "aiesim" or args.verify) and not all(map(os.path.exists, (PLIO_CONVERT, PACK_WEIGHTS))):
+        subprocess.run(["make", "-C", os.path.join(REPO, "tools")], check=True)
+
+    for cfg, cycles in zip(configs, model(configs, shape)):
+        cfg.cycles = cycles
+    with ThreadPoolExecutor(max_workers=args.jobs) as pool:
+        configs = list(pool.map(lambda ic: evaluate(ic[1], shape, args, ic[0]), enumerate(configs)))
+    return report(configs, args.csv)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,246 @@
+"""
+Quantization calibration for the GemV kernels.
+
+The kernels requantize their accumulators once, in to_vector<T>(SHIFT): an
+arithmetic right shift with the default floor rounding, then, with no
+saturation mode set, a wrap to T. An accumulator that does not fit after the
+shift wraps silently. This script replays exactly that on the host (multiply,
+accumulate wrapped to the accumulator width, shift, wrap), over representative
+inputs, and picks the configuration that keeps every output in range:
+
+  per layer    the smallest SHIFT that fits the largest accumulator of the
+               layer (plus --headroom bits).
+  per channel  one SHIFT for the layer, since to_vector shifts every lane the
+               same, plus an integer multiplier M_c per output channel that is
+               folded into that channel's weights: (x . w_c*M_c) >> SHIFT ==
+               (acc_c*M_c) >> SHIFT bit for bit. Quiet channels get the
+               resolution loud ones would otherwise take away. M_c is a power
+               of two unless --multiplier-bits allows any integer up to
+               2^bits, at most 2^SHIFT, and capped by what the weight dtype
+               can hold.
+
+Each output channel then holds acc_c * M_c / 2^SHIFT. SHIFT goes to quant.h,
+which the kernels include. The folded weights are written as a new weight blob
+for pack_weights.exe to turn into headers.
+
+How to run:
+python tools/calibrate.py --weights data/w.bin --inputs data/x.txt --out-dtype int16 \\
+                          --acc-bits 48 --header aie/kernels/quant.h
+python tools/calibrate.py ... --per-channel --weights-out data/w_q.bin
+
+The gemv run.py generators call calibrate() on their own data with
+`make golden CALIBRATE=layer` (or channel).
+"""
+
+import argparse
+import os
+import subprocess
+import sys
+from dataclasses import dataclass, field
+
+import numpy as np
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+import weight_blob  # noqa: E402
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+
+
+def wrap(v, bits):
+    """Two's complement wrap to `bits` bits. int64 arrays stay int64 (below 64
+    bits); object arrays of Python ints, as accumulate() returns for acc80, are
+    wrapped exactly at any width."""
+    v = np.asarray(v)
+    if v.dtype == object:
+        half = 1 << (bits - 1)
+        return (v + half) % (1 << bits) - half
+    v = v.astype(np.int64)
+    if bits >= 64:
+        return v
+    sh = np.int64(64 - bits)
+    return (v << sh) >> sh
+
+
+def accumulate(x, w, acc_bits):
+    """x @ w in the accumulator, x: (batch, K), w: (K, N), wrapped to acc_bits.
+
+    The int64 product is exact while K * max|x| * max|w| stays below 2^63.
+    That holds for 8 and 16 bit data, but one int32 x int32 product alone
+    reaches 2^62, so those sums are taken in Python ints (an object array)
+    and wrapped to the accumulator like cpu_engine.h's __int128 path."""
+    x = np.asarray(x, dtype=np.int64)
+    w = np.asarray(w, dtype=np.int64)
+    peak = lambda a: int(np.abs(a).max()) if a.size else 0
+    if x.shape[-1] * peak(x) * peak(w) < (1 << 63):
+        return wrap(x @ w, acc_bits)
+    return wrap(x.astype(object) @ w.astype(object), acc_bits)
+
+
+def requantize(acc, shift, out_dtype):
+    """to_vector<out_dtype>(shift): floor shift, then wrap."""
+    return wrap(np.asarray(acc) >> shift, 8 * np.dtype(out_dtype).itemsize).astype(out_dtype)
+
+
+def fits_each(acc, shift, out_dtype):
+    info = np.iinfo(out_dtype)
+    q = np.asarray(acc) >> shift
+    return ((q >= info.min) & (q <= info.max)).astype(bool)
+
+
+def layer_shift(acc, out_dtype, headroom=0):
+    """Smallest shift after which every accumulator fits out_dtype, less `headroom` bits."""
+    info = np.iinfo(out_dtype)
+    hi, lo = info.max >> headroom, info.min >> headroom
+    q = np.asarray(acc)
+    for s in range(80):
+        v = q >> s
+        if v.size == 0 or (v.min() >= lo and v.max() <= hi):
+            return s
+    raise ValueError("no shift fits")
+
+
+@dataclass
+class Quant:
+    shift: int
+    multipliers: np.ndarray          # per output channel, ones for per-layer
+    weights: np.ndarray              # weights with the multipliers folded in
+    out_dtype: type
+    peak: int = 0                    # largest |output| after requantization
+    wrapped_unshifted: int = 0       # outputs that wrap with SHIFT 0 and no multipliers
+    notes: list = field(default_factory=list)
+
+
+def calibrate(w, x, out_dtype, acc_bits, headroom=0, per_channel=False, multiplier_bits=0, w_dtype=None):
+    """Pick SHIFT (and per-channel multipliers) for weights w (K, N) over inputs x (batch, K)."""
+    w = np.asarray(w)
+    w_dtype = w_dtype or w.dtype
+    acc = accumulate(x, w, acc_bits)
+    wrapped = int(np.count_nonzero(~fits_each(acc, 0, out_dtype)))
+
+    shift = layer_shift(acc, out_dtype, headroom)
+    mult = np.ones(w.shape[1], dtype=np.int64)
+    notes = []
+
+    if per_channel:
+        shift += multiplier_bits
+        info = np.iinfo(out_dtype)
+        hi, lo = info.max >> headroom, info.min >> headroom
+        winfo = np.iinfo(w_dtype)
+        wpeak = np.abs(w.astype(np.int64)).max(axis=0)
+        for c in range(w.shape[1]):
+            a = acc[:, c]
+            peak = int(np.abs(a).max()) if a.size else 0
+            # largest multiplier the output range and the weight dtype allow,
+            # and never above 2^SHIFT: requantization does not amplify
+            limit = min((1 << shift) * (hi + 1) // max(peak, 1), 1 << shift)
+            if wpeak[c]:
+                limit = min(limit, winfo.max // int(wpeak[c]))
+            if multiplier_bits:
+                limit = min(limit, 1 << multiplier_bits)
+            else:
+                limit = 1 << (int(limit).bit_length() - 1) if limit >= 1 else 1
+            m = max(int(limit), 1)
+            while m > 1:
+                q = accumulate(x, w[:, c:c + 1].astype(np.int64) * m, acc_bits) >> shift
+                if q.min() >= lo and q.max() <= hi:
+                    break
+                m = m - 1 if multiplier_bits else m // 2
+            mult[c] = m
+        if not multiplier_bits and (mult == 1).all() and shift:
+            notes.append("no channel could take a multiplier; per-layer shift only")
+
+    folded = (w.astype(np.int64) * mult[None, :]).astype(w_dtype)
+    out = requantize(accumulate(x, folded, acc_bits) if per_channel else acc, shift, out_dtype)
+    return Quant(shift=shift, multipliers=mult, weights=folded, out_dtype=out_dtype,
+                 peak=int(np.abs(out.astype(np.int64)).max()) if out.size else 0,
+                 wrapped_unshifted=wrapped, notes=notes)
+
+
+def write_header(path, q, source=""):
+    """quant.h with SHIFT and, for per-channel calibration, the multipliers."""
+    lines = ["#ifndef QUANT_H", "#define QUANT_H", "",
+             f"// generated by tools/calibrate.py{' from ' + source if source else ''}",
+             "// to_vector() shift of the layer's outputs",
+             f"#define SHIFT {q.shift}"]
+    if (q.multipliers != 1).any():
+        lines += ["", "// output c = (acc_c * QUANT_M[c]) >> SHIFT; QUANT_M is already folded into the weights",
+                  "#define QUANT_M {" + ", ".join(str(int(m)) for m in q.multipliers) + "}"]
+    lines += ["", "#endif // QUANT_H", ""]
+    with open(path, "w") as f:
+        f.write("\n".join(lines))
+
+
+def read_shift(path):
+    """SHIFT from a quant.h, 0 when there is none."""
+    if not os.path.exists(path):
+        return 0
+    with open(path) as f:
+        for line in f:
+            parts = line.split()
+            if len(parts) >= 3 and parts[:2] == ["#define", "SHIFT"]:
+                return int(parts[2])
+    return 0
+
+
+def load_inputs(path, k, dtype):
+    """Inputs as (batch, k): .npy, raw binary PLIO (.bin) or text PLIO."""
+    if path.endswith(".npy"):
+        x = np.load(path)
+    elif path.endswith(".bin"):
+        x = np.fromfile(path, dtype=np.dtype(dtype).newbyteorder("<"))
+    else:
+        x = np.loadtxt(path, dtype=np.int64, comments="T", ndmin=1)
+    x = np.asarray(x).reshape(-1)
+    if x.size % k:
+        raise SystemExit(f"{path}: {x.size} values is not a whole number of {k}-element inputs")
+    return x.reshape(-1, k)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Pick to_vector shifts (and channel multipliers) for a GemV layer.")
+    parser.add_argument("--weights", required=True, help="Weight blob (pack_weights.exe blob).")
+    parser.add_argument("--inputs", required=True, help="Representative inputs: text/binary PLIO file or .npy.")
+    parser.add_argument("--out-dtype", default="int16", choices=["int8", "int16", "int32"])
+    parser.add_argument("--acc-bits", type=int, default=48, help="Accumulator width: 48 (acc48) or 80 (acc80).")
+    parser.add_argument("--headroom", type=int, default=0, help="Extra bits of output range to leave unused.")
+    parser.add_argument("--per-channel", action="store_true", help="Fold per-channel multipliers into the weights.")
+    parser.add_argument("--multiplier-bits", type=int, default=0,
+                        help="Allow any integer multiplier up to 2^bits (default: powers of two).")
+    parser.add_argument("--header", help="quant.h to write.")
+    parser.add_argument("--weights-out", help="Weight blob with the multipliers folded in.")
+    parser.add_argument("--packer", default=os.path.join(HERE, "pack_weights.exe"))
+    args = parser.parse_args()
+
+    layout = weight_blob.header(args.weights)["layout"]
+    w = weight_blob.load(args.weights)
+    x = load_inputs(args.inputs, w.shape[0], w.dtype)
+    q = calibrate(w, x, np.dtype(args.out_dtype).type, args.acc_bits, args.headroom,
+                  args.per_channel, args.multiplier_bits)
+
+    info = np.iinfo(args.out_dtype)
+    print(f"{x.shape[0]} inputs, {w.shape[0]}x{w.shape[1]} {w.dtype} weights, acc{args.acc_bits} -> {args.out_dtype}")
+    print(f"outputs that wrap with SHIFT 0: {q.wrapped_unshifted} of {x.shape[0] * w.shape[1]}")
+    print(f"SHIFT {q.shift}, peak |output| {q.peak} of {info.max} ({100.0 * q.peak / info.max:.1f}% of range)")
+    if args.per_channel:
+        print("multipliers: " + " ".join(str(int(m)) for m in q.multipliers))
+    for note in q.notes:
+        print(note)
+
+    if args.header:
+        write_header(args.header, q, os.path.basename(args.weights))
+        print(f"wrote {args.header}")
+    if args.weights_out:
+        if not args.per_channel:
+            raise SystemExit("--weights-out only makes sense with --per-channel")
+        txt = os.path.splitext(args.weights_out)[0] + ".txt"
+        np.savetxt(txt, q.weights, fmt="%d")
+        cmd = [args.packer, "blob", str(w.dtype), str(w.shape[0]), str(w.shape[1]), txt, args.weights_out]
+        if layout == weight_blob.GEMV_PACKED:
+            cmd.append("--packed")
+        subprocess.run(cmd, check=True)
+        print(f"wrote {args.weights_out}")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,629 @@
+/*
+ *  GemV / GEMM on the host CPU, bit exact with the AIE kernels.
+ *
+ *  A layer runs from the same weight blob (weight_blob.h) and SHIFT
+ *  (quant.h) as its AIE kernel, so it can move between the array and the
+ *  A72 or x86 host. Per-channel multipliers are already folded into the
+ *  weights by calibrate.py, so there is nothing else to carry over.
+ *
+ *  What the kernels compute, per output n:
+ *
+ *      acc = bias[n] + sum_k x[k] * w[k][n]     wrapped to acc48 or acc80
+ *      y   = (acc >> SHIFT)                     floor rounding, wrapped to y's type
+ *      y   = max(y, 0)                          with ReLU
+ *
+ *  acc80 when x or w is 32 bits, acc48 otherwise (aie_emu.h acc_for). The
+ *  wraps make this arithmetic mod 2^bits, and y only keeps bits SHIFT to
+ *  SHIFT + |y| - 1 of the accumulator. So a narrower modular accumulator
+ *  gives the same y whenever it holds those bits:
+ *
+ *      SHIFT + |y| <= 32    32-bit lanes (mullo, or madd/dpwssd on 16-bit pairs)
+ *      SHIFT + |y| <= 64    64-bit lanes (32 x 32 -> 64 bit multiplies), or acc48
+ *      otherwise            scalar __int128, wrapped to 80 bits
+ *
+ *  The SIMD paths are chosen at compile time for the machine the tool is
+ *  built for: AVX-512 (with VNNI dpwssd for 16-bit operands), AVX2 or NEON,
+ *  else scalar. Weights are kept in weight_pack.h order, 16 outputs per
+ *  column block, and run.py's batches are split over threads by column
+ *  block and by tiles of batch_tile input vectors that share each pass over
+ *  the block's weights.
+ */
+
+#ifndef CPU_ENGINE_H
+#define CPU_ENGINE_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#include "plio.h"
+#include "weight_blob.h"
+#include "weight_pack.h"
+
+namespace cpu_engine {
+
+constexpr size_t block = weight_pack::gemv_block;  // outputs per column block
+constexpr size_t batch_tile = 8;                   // input vectors per pass over a block's weights
+constexpr size_t min_thread_macs = 1 << 16;        // below this a thread costs more than it saves
+
+enum class isa { scalar, neon, avx2, avx512, avx512_vnni };
+enum class lanes { i32, i64, i128 };
+
+// the SIMD extension this build uses
+inline isa native()
+{
+#if defined(__AVX512F__) && defined(__AVX512BW__) && defined(__AVX512VNNI__)
+    return isa::avx512_vnni;
+#elif defined(__AVX512F__) && defined(__AVX512BW__)
+    return isa::avx512;
+#elif defined(__AVX2__)
+    return isa::avx2;
+#elif defined(__ARM_NEON)
+    return isa::neon;
+#else
+    return isa::scalar;
+#endif
+}
+
+// whether this build can run `i`: scalar, the native extension and the ones it implies
+inline bool compiled(isa i)
+{
+    const isa n = native();
+    if (i == isa::scalar || i == n)
+        return true;
+    if (i == isa::avx2)
+        return n == isa::avx512 || n == isa::avx512_vnni;
+    return i == isa::avx512 && n == isa::avx512_vnni;
+}
+
+inline const char *isa_name(isa i)
+{
+    static const char *names[] = {"scalar", "neon", "avx2", "avx512", "avx512_vnni"};
+    return names[static_cast<int>(i)];
+}
+
+inline const char *lanes_name(lanes l)
+{
+    static const char *names[] = {"32-bit", "64-bit", "128-bit"};
+    return names[static_cast<int>(l)];
+}
+
+struct layer {
+    size_t rows = 0, cols = 0;      // inputs and outputs
+    size_t prows = 0, pcols = 0;    // padded to multiples of 8 and 16
+    std::vector<int32_t> w;         // prows x pcols, weight_pack.h order
+    std::vector<int16_t> w16;       // the same with rows 2j and 2j+1 interleaved, when w fits 16 bits
+    std::vector<int32_t> bias;      // pcols, at the accumulator scale
+    int shift = 0;
+    unsigned acc_bits = 80;
+    plio::dtype x_type = plio::dtype::int32, y_type = plio::dtype::int32;
+    bool relu = false;
+
+    unsigned y_bits() const { return unsigned(8 * plio::dtype_size(y_type)); }
+
+    // narrowest accumulator that gives the kernel's outputs bit for bit
+    lanes exact_lanes() const
+    {
+        const unsigned top = unsigned(std::max(shift, 0)) + y_bits();
+        if (top <= 32)
+            return lanes::i32;
+        if (top <= 64 || acc_bits <= 64)
+            return lanes::i64;
+        return lanes::i128;
+    }
+};
+
+// mat row-major rows x cols (inputs x outputs), w_type its element type
+inline layer make_layer(const std::vector<int64_t> &mat, size_t rows, size_t cols, plio::dtype w_type,
+                        plio::dtype x_type, plio::dtype y_type, int shift, const std::vector<int64_t> &bias = {},
+                        bool relu = false)
+{
+    if (mat.size() != rows * cols)
+        throw std::invalid_argument("cpu_engine: " + std::to_string(mat.size()) + " weights for a " +
+                                    std::to_string(rows) + "x" + std::to_string(cols) + " layer");
+    if (!bias.empty() && bias.size() != cols)
+        throw std::invalid_argument("cpu_engine: " + std::to_string(bias.size()) + " bias values for " +
+                                    std::to_string(cols) + " outputs");
+    for (plio::dtype t : {w_type, x_type, y_type})
+        if (t == plio::dtype::uint32)
+            throw std::invalid_argument("cpu_engine: uint32 x, w or y is not supported, the kernels are signed");
+
+    layer l;
+    l.rows = rows, l.cols = cols;
+    l.prows = (rows + 7) / 8 * 8, l.pcols = (cols + block - 1) / block * block;
+    l.shift = shift, l.relu = relu, l.x_type = x_type, l.y_type = y_type;
+    l.acc_bits = plio::dtype_size(x_type) == 4 || plio::dtype_size(w_type) == 4 ? 80 : 48;
+
+    std::vector<int64_t> padded(l.prows * l.pcols, 0);
+    for (size_t k = 0; k < rows; ++k)
+        std::copy(mat.begin() + k * cols, mat.begin() + (k + 1) * cols, padded.begin() + k * l.pcols);
+    const std::vector<int64_t> packed = weight_pack::pack_gemv(padded, l.prows, l.pcols);
+    l.w.assign(packed.begin(), packed.end());
+
+    auto fits16 = [](plio::dtype t) { return plio::dtype_size(t) == 1 || t == plio::dtype::int16; };
+    if (fits16(w_type) && fits16(x_type)) {
+        l.w16.resize(l.w.size());
+        for (size_t cb = 0; cb < l.pcols / block; ++cb)
+            for (size_t j = 0; j < l.prows / 2; ++j)
+                for (size_t n = 0; n < block; ++n)
+                    for (size_t h = 0; h < 2; ++h)
+                        l.w16[(cb * l.prows / 2 + j) * 2 * block + 2 * n + h] =
+                            int16_t(l.w[cb * l.prows * block + (2 * j + h) * block + n]);
+    }
+
+    l.bias.assign(l.pcols, 0);
+    for (size_t n = 0; n < bias.size(); ++n)
+        l.bias[n] = int32_t(bias[n]);
+    return l;
+}
+
+// a weight blob, row-major or packed, as a layer
+inline layer make_layer(const weight_blob::blob &b, plio::dtype x_type, plio::dtype y_type, int shift,
+                        const std::vector<int64_t> &bias = {}, bool relu = false)
+{
+    return make_layer(b.values(weight_blob::layout::row_major), b.h.rows, b.h.cols, b.type(), x_type, y_type, shift,
+                      bias, relu);
+}
+
+// SHIFT from a quant.h, 0 when there is none
+inline int read_shift(const std::string &path)
+{
+    std::ifstream f(path);
+    if (!f)
+        throw std::runtime_error("cannot open " + path);
+    std::string line;
+    while (std::getline(f, line)) {
+        std::istringstream s(line);
+        std::string d, name;
+        int v;
+        if (s >> d >> name >> v && d == "#define" && name == "SHIFT")
+            return v;
+    }
+    return 0;
+}
+
+namespace detail {
+
+inline int64_t narrow(int64_t v, unsigned bits)
+{
+    const unsigned sh = 64 - bits;
+    return static_cast<int64_t>(static_cast<uint64_t>(v) << sh) >> sh;
+}
+
+// to_vector(shift) and the epilogue, from an accumulator wrapped mod 2^64
+inline int64_t requantize(const layer &l, int64_t acc)
+{
+    if (l.acc_bits < 64)
+        acc = narrow(acc, l.acc_bits);
+    // acc48 shifted by 64 or more is all sign bits, like >> 63
+    int64_t y = narrow(acc >> std::min(std::max(l.shift, 0), 63), l.y_bits());
+    return l.relu ? std::max<int64_t>(y, 0) : y;
+}
+
+inline int64_t requantize(const layer &l, __int128 acc)
+{
+    const unsigned sh = 128 - l.acc_bits;
+    acc = static_cast<__int128>(static_cast<unsigned __int128>(acc) << sh) >> sh;
+    int64_t y = narrow(static_cast<int64_t>(acc >> std::max(l.shift, 0)), l.y_bits());
+    return l.relu ? std::max<int64_t>(y, 0) : y;
+}
+
+// One column block for NB input vectors: acc[r][n] +=
+// sum_k x[r][k] * w[k][n], w the block's prows x 16 slice. The acc types
+// wrap (unsigned arithmetic); the SIMD adds and multiplies wrap the same way.
+// NB is a constant so the unrolled r loops keep the accumulators in
+// registers. x2[r][j] packs x[r][2j] and x[r][2j+1] as int16 pairs for w16.
+
+template <size_t NB>
+inline void block32_scalar(const layer &l, const int32_t *w, const int32_t *const *x,
+                           uint32_t (*acc)[block])
+{
+    uint32_t a[NB][block];  // a local copy, acc could alias w
+    std::copy(&acc[0][0], &acc[0][0] + NB * block, &a[0][0]);
+    for (size_t k = 0; k < l.prows; ++k, w += block)
+        for (size_t r = 0; r < NB; ++r) {
+            const uint32_t xv = uint32_t(x[r][k]);
+            for (size_t n = 0; n < block; ++n)
+                a[r][n] += xv * uint32_t(w[n]);
+        }
+    std::copy(&a[0][0], &a[0][0] + NB * block, &acc[0][0]);
+}
+
+template <size_t NB>
+inline void block64_scalar(const layer &l, const int32_t *w, const int32_t *const *x,
+                           uint64_t (*acc)[block])
+{
+    uint64_t a[NB][block];
+    std::copy(&acc[0][0], &acc[0][0] + NB * block, &a[0][0]);
+    for (size_t k = 0; k < l.prows; ++k, w += block)
+        for (size_t r = 0; r < NB; ++r) {
+            const int64_t xv = x[r][k];
+            for (size_t n = 0; n < block; ++n)
+                a[r][n] += uint64_t(xv * w[n]);
+        }
+    std::copy(&a[0][0], &a[0][0] + NB * block, &acc[0][0]);
+}
+
+template <size_t NB>
+inline void block128(const layer &l, const int32_t *w, const int32_t *const *x,
+                     unsigned __int128 (*acc)[block])
+{
+    for (size_t k = 0; k < l.prows; ++k, w += block)
+        for (size_t r = 0; r < NB; ++r)
+            for (size_t n = 0; n < block; ++n)
+                acc[r][n] += static_cast<unsigned __int128>(static_cast<__int128>(int64_t(x[r][k]) * w[n]));
+}
+
+#if defined(__AVX2__)
+template <size_t NB>
+inline void block32_avx2(const layer &l, const int32_t *w, const int32_t *const *x, const int32_t *const *x2,
+                         uint32_t (*acc)[block])
+{
+    __m256i a[NB][2];
+    for (size_t r = 0; r < NB; ++r)
+        for (size_t i = 0; i < 2; ++i)
+            a[r][i] = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(acc[r] + 8 * i));
+
+    if (!l.w16.empty()) {
+        // two rows per madd: w16 holds (w[2j][n], w[2j+1][n]) pairs
+        const int16_t *p = l.w16.data() + (w - l.w.data());
+        for (size_t k = 0; k < l.prows; k += 2, p += 2 * block) {
+            const __m256i w0 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+            const __m256i w1 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + block));
+#pragma GCC unroll 16
+            for (size_t r = 0; r < NB; ++r) {
+                const __m256i xb = _mm256_set1_epi32(x2[r][k / 2]);
+                a[r][0] = _mm256_add_epi32(a[r][0], _mm256_madd_epi16(xb, w0));
+                a[r][1] = _mm256_add_epi32(a[r][1], _mm256_madd_epi16(xb, w1));
+            }
+        }
+    } else {
+        for (size_t k = 0; k < l.prows; ++k, w += block) {
+            const __m256i w0 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(w));
+            const __m256i w1 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(w + 8));
+#pragma GCC unroll 16
+            for (size_t r = 0; r < NB; ++r) {
+                const __m256i xb = _mm256_set1_epi32(x[r][k]);
+                a[r][0] = _mm256_add_epi32(a[r][0], _mm256_mullo_epi32(xb, w0));
+                a[r][1] = _mm256_add_epi32(a[r][1], _mm256_mullo_epi32(xb, w1));
+            }
+        }
+    }
+
+    for (size_t r = 0; r < NB; ++r)
+        for (size_t i = 0; i < 2; ++i)
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(acc[r] + 8 * i), a[r][i]);
+}
+
+template <size_t NB>
+inline void block64_avx2(const layer &l, const int32_t *w, const int32_t *const *x,
+                         uint64_t (*acc)[block])
+{
+    __m256i a[NB][4];
+    for (size_t r = 0; r < NB; ++r)
+        for (size_t i = 0; i < 4; ++i)
+            a[r][i] = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(acc[r] + 4 * i));
+
+    for (size_t k = 0; k < l.prows; ++k, w += block) {
+        __m256i wv[4];
+        for (size_t i = 0; i < 4; ++i)
+            wv[i] = _mm256_cvtepi32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i *>(w + 4 * i)));
+#pragma GCC unroll 16
+        for (size_t r = 0; r < NB; ++r) {
+            // mul_epi32 multiplies the low, sign-extended 32 bits of each lane
+            const __m256i xb = _mm256_set1_epi64x(x[r][k]);
+            for (size_t i = 0; i < 4; ++i)
+                a[r][i] = _mm256_add_epi64(a[r][i], _mm256_mul_epi32(xb, wv[i]));
+        }
+    }
+
+    for (size_t r = 0; r < NB; ++r)
+        for (size_t i = 0; i < 4; ++i)
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(acc[r] + 4 * i), a[r][i]);
+}
+#endif
+
+#if defined(__AVX512F__) && defined(__AVX512BW__)
+template <size_t NB>
+inline void block32_avx512(const layer &l, const int32_t *w, const int32_t *const *x, const int32_t *const *x2,
+                           uint32_t (*acc)[block], bool vnni)
+{
+    __m512i a[NB];
+    for (size_t r = 0; r < NB; ++r)
+        a[r] = _mm512_loadu_si512(acc[r]);
+
+    const int16_t *p = l.w16.data() + (w - l.w.data());
+    if (!l.w16.empty() && vnni) {
+#if defined(__AVX512VNNI__)
+        for (size_t k = 0; k < l.prows; k += 2, p += 2 * block) {
+            const __m512i wv = _mm512_loadu_si512(p);
+#pragma GCC unroll 16
+            for (size_t r = 0; r < NB; ++r)
+                a[r] = _mm512_dpwssd_epi32(a[r], _mm512_set1_epi32(x2[r][k / 2]), wv);
+        }
+#endif
+    } else if (!l.w16.empty()) {
+        for (size_t k = 0; k < l.prows; k += 2, p += 2 * block) {
+            const __m512i wv = _mm512_loadu_si512(p);
+#pragma GCC unroll 16
+            for (size_t r = 0; r < NB; ++r)
+                a[r] = _mm512_add_epi32(a[r], _mm512_madd_epi16(_mm512_set1_epi32(x2[r][k / 2]), wv));
+        }
+    } else {
+        for (size_t k = 0; k < l.prows; ++k, w += block) {
+            const __m512i wv = _mm512_loadu_si512(w);
+#pragma GCC unroll 16
+            for (size_t r = 0; r < NB; ++r)
+                a[r] = _mm512_add_epi32(a[r], _mm512_mullo_epi32(_mm512_set1_epi32(x[r][k]), wv));
+        }
+    }
+
+    for (size_t r = 0; r < NB; ++r)
+        _mm512_storeu_si512(acc[r], a[r]);
+}
+
+// GCC 12 flags the _mm512_undefined_epi32() inside these intrinsics once they inline
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+template <size_t NB>
+inline void block64_avx512(const layer &l, const int32_t *w, const int32_t *const *x,
+                           uint64_t (*acc)[block])
+{
+    __m512i a[NB][2];
+    for (size_t r = 0; r < NB; ++r)
+        for (size_t i = 0; i < 2; ++i)
+            a[r][i] = _mm512_loadu_si512(acc[r] + 8 * i);
+
+    for (size_t k = 0; k < l.prows; ++k, w += block) {
+        const __m512i w0 = _mm512_cvtepi32_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(w)));
+        const __m512i w1 = _mm512_cvtepi32_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(w + 8)));
+#pragma GCC unroll 16
+        for (size_t r = 0; r < NB; ++r) {
+            const __m512i xb = _mm512_set1_epi64(x[r][k]);
+            a[r][0] = _mm512_add_epi64(a[r][0], _mm512_mul_epi32(xb, w0));
+            a[r][1] = _mm512_add_epi64(a[r][1], _mm512_mul_epi32(xb, w1));
+        }
+    }
+
+    for (size_t r = 0; r < NB; ++r)
+        for (size_t i = 0; i < 2; ++i)
+            _mm512_storeu_si512(acc[r] + 8 * i, a[r][i]);
+}
+#pragma GCC diagnostic pop
+#endif
+
+#if defined(__ARM_NEON)
+template <size_t NB>
+inline void block32_neon(const layer &l, const int32_t *w, const int32_t *const *x,
+                         uint32_t (*acc)[block])
+{
+    int32x4_t a[NB][4];
+    for (size_t r = 0; r < NB; ++r)
+        for (size_t i = 0; i < 4; ++i)
+            a[r][i] = vreinterpretq_s32_u32(vld1q_u32(acc[r] + 4 * i));
+
+    for (size_t k = 0; k < l.prows; ++k, w += block) {
+        int32x4_t wv[4];
+        for (size_t i = 0; i < 4; ++i)
+            wv[i] = vld1q_s32(w + 4 * i);
+#pragma GCC unroll 16
+        for (size_t r = 0; r < NB; ++r)
+            for (size_t i = 0; i < 4; ++i)
+                a[r][i] = vmlaq_n_s32(a[r][i], wv[i], x[r][k]);
+    }
+
+    for (size_t r = 0; r < NB; ++r)
+        for (size_t i = 0; i < 4; ++i)
+            vst1q_u32(acc[r] + 4 * i, vreinterpretq_u32_s32(a[r][i]));
+}
+
+template <size_t NB>
+inline void block64_neon(const layer &l, const int32_t *w, const int32_t *const *x,
+                         uint64_t (*acc)[block])
+{
+    int64x2_t a[NB][8];
+    for (size_t r = 0; r < NB; ++r)
+        for (size_t i = 0; i < 8; ++i)
+            a[r][i] = vreinterpretq_s64_u64(vld1q_u64(acc[r] + 2 * i));
+
+    for (size_t k = 0; k < l.prows; ++k, w += block) {
+        int32x4_t wv[4];
+        for (size_t i = 0; i < 4; ++i)
+            wv[i] = vld1q_s32(w + 4 * i);
+#pragma GCC unroll 16
+        for (size_t r = 0; r < NB; ++r) {
+            const int32x2_t xb = vdup_n_s32(x[r][k]);
+            for (size_t i = 0; i < 4; ++i) {
+                a[r][2 * i] = vmlal_s32(a[r][2 * i], vget_low_s32(wv[i]), xb);
+                a[r][2 * i + 1] = vmlal_s32(a[r][2 * i + 1], vget_high_s32(wv[i]), xb);
+            }
+        }
+    }
+
+    for (size_t r = 0; r < NB; ++r)
+        for (size_t i = 0; i < 8; ++i)
+            vst1q_u64(acc[r] + 2 * i, vreinterpretq_u64_s64(a[r][i]));
+}
+#endif
+
+template <size_t NB>
+inline void block32(isa use, const layer &l, const int32_t *w, const int32_t *const *x, const int32_t *const *x2,
+                    uint32_t (*acc)[block])
+{
+    switch (use) {
+#if defined(__AVX512F__) && defined(__AVX512BW__)
+    case isa::avx512_vnni:
+    case isa::avx512: return block32_avx512<NB>(l, w, x, x2, acc, use == isa::avx512_vnni);
+#endif
+#if defined(__AVX2__)
+    case isa::avx2: return block32_avx2<NB>(l, w, x, x2, acc);
+#endif
+#if defined(__ARM_NEON)
+    case isa::neon: return block32_neon<NB>(l, w, x, acc);
+#endif
+    default: return block32_scalar<NB>(l, w, x, acc);
+    }
+}
+
+template <size_t NB>
+inline void block64(isa use, const layer &l, const int32_t *w, const int32_t *const *x,
+                    uint64_t (*acc)[block])
+{
+    switch (use) {
+#if defined(__AVX512F__) && defined(__AVX512BW__)
+    case isa::avx512_vnni:
+    case isa::avx512: return block64_avx512<NB>(l, w, x, acc);
+#endif
+#if defined(__AVX2__)
+    case isa::avx2: return block64_avx2<NB>(l, w, x, acc);
+#endif
+#if defined(__ARM_NEON)
+    case isa::neon: return block64_neon<NB>(l, w, x, acc);
+#endif
+    default: return block64_scalar<NB>(l, w, x, acc);
+    }
+}
+
+// column block cb of nb <= batch_tile input vectors (x, and x2 when the
+// layer has w16), outputs to y[r] + 16*cb
+inline void run_block(isa use, lanes width, const layer &l, size_t cb, const int32_t *const *x,
+                      const int32_t *const *x2, size_t nb, int64_t *const *y)
+{
+    const int32_t *w = l.w.data() + cb * l.prows * block;
+    const size_t n_out = std::min(block, l.cols - cb * block);
+    const int32_t *bias = l.bias.data() + cb * block;
+
+    // run(NB, r) on a full tile in one pass over the weights, or the tail of
+    // the batch one vector at a time
+    auto tile = [&](auto run) {
+        if (nb == batch_tile)
+            return run(std::integral_constant<size_t, batch_tile>(), 0);
+        for (size_t r = 0; r < nb; ++r)
+            run(std::integral_constant<size_t, 1>(), r);
+    };
+
+    // requantize the real vectors, `sign` reads an accumulator as a signed value
+    auto finish = [&](auto &acc, auto sign) {
+        for (size_t r = 0; r < nb; ++r)
+            for (size_t n = 0; n < n_out; ++n)
+                y[r][cb * block + n] = requantize(l, sign(acc[r][n]));
+    };
+
+    if (width == lanes::i32) {
+        // a 32-bit accumulator holds every bit y takes, see exact_lanes()
+        uint32_t acc[batch_tile][block];
+        for (size_t r = 0; r < nb; ++r)
+            for (size_t n = 0; n < block; ++n)
+                acc[r][n] = uint32_t(bias[n]);
+        tile([&](auto NB, size_t r) { block32<NB()>(use, l, w, x + r, x2 + r, acc + r); });
+        finish(acc, [](uint32_t v) { return int64_t(int32_t(v)); });
+    } else if (width == lanes::i64) {
+        uint64_t acc[batch_tile][block];
+        for (size_t r = 0; r < nb; ++r)
+            for (size_t n = 0; n < block; ++n)
+                acc[r][n] = uint64_t(int64_t(bias[n]));
+        tile([&](auto NB, size_t r) { block64<NB()>(use, l, w, x + r, acc + r); });
+        finish(acc, [](uint64_t v) { return int64_t(v); });
+    } else {
+        unsigned __int128 acc[batch_tile][block];
+        for (size_t r = 0; r < nb; ++r)
+            for (size_t n = 0; n < block; ++n)
+                acc[r][n] = static_cast<unsigned __int128>(static_cast<__int128>(bias[n]));
+        tile([&](auto NB, size_t r) { block128<NB()>(l, w, x + r, acc + r); });
+        finish(acc, [](unsigned __int128 v) { return static_cast<__int128>(v); });
+    }
+}
+
+} // namespace detail
+
+/*
+ *  y = layer(x) for a batch of input vectors, x batch x rows, y batch x cols,
+ *  both row-major. threads 0 uses every core when the batch is large enough
+ *  to pay for them. The accumulator is the narrowest exact one, or at least
+ *  `widest` to cross-check the paths. Throws if `use` is not compiled in.
+ */
+inline std::vector<int64_t> gemv(const layer &l, const std::vector<int64_t> &x, unsigned threads = 0,
+                                 isa use = native(), lanes widest = lanes::i32)
+{
+    if (!compiled(use))
+        throw std::invalid_argument(std::string("cpu_engine: this build has no ") + isa_name(use) + " support");
+    if (l.rows == 0 || x.size() % l.rows != 0)
+        throw std::invalid_argument("cpu_engine: " + std::to_string(x.size()) + " inputs is not a whole number of " +
+                                    std::to_string(l.rows) + "-input vectors");
+    const lanes width = std::max(widest, l.exact_lanes());
+
+    const size_t batch = x.size() / l.rows;
+    std::vector<int32_t> xi(batch * l.prows, 0);
+    for (size_t b = 0; b < batch; ++b)
+        for (size_t k = 0; k < l.rows; ++k)
+            xi[b * l.prows + k] = int32_t(x[b * l.rows + k]);
+    // the madd/dpwssd paths broadcast (x[2j], x[2j+1]) pairs
+    std::vector<int32_t> x2;
+    if (!l.w16.empty()) {
+        x2.resize(xi.size() / 2);
+        for (size_t j = 0; j < x2.size(); ++j)
+            x2[j] = int32_t(uint32_t(uint16_t(xi[2 * j])) | uint32_t(xi[2 * j + 1]) << 16);
+    }
+    std::vector<int64_t> y(batch * l.cols);
+
+    const size_t blocks = l.pcols / block, tiles = (batch + batch_tile - 1) / batch_tile;
+    const size_t items = blocks * tiles;
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    const size_t useful = std::max<size_t>(1, batch * l.prows * l.pcols / min_thread_macs);
+    threads = unsigned(std::min<size_t>({threads, items, useful}));
+
+    std::atomic<size_t> next{0};
+    auto worker = [&]() {
+        for (size_t i; (i = next++) < items;) {
+            // the tiles of one block run back to back while its weights are in cache
+            const size_t cb = i / tiles, t = i % tiles;
+            const size_t b0 = t * batch_tile, nb = std::min(batch_tile, batch - b0);
+            const int32_t *xs[batch_tile], *x2s[batch_tile];
+            int64_t *ys[batch_tile];
+            for (size_t r = 0; r < nb; ++r) {
+                xs[r] = xi.data() + (b0 + r) * l.prows;
+                x2s[r] = x2.empty() ? nullptr : x2.data() + (b0 + r) * l.prows / 2;
+                ys[r] = y.data() + (b0 + r) * l.cols;
+            }
+            detail::run_block(use, width, l, cb, xs, x2s, nb, ys);
+        }
+    };
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < threads; ++t)
+        pool.emplace_back(worker);
+    worker();
+    for (auto &t : pool)
+        t.join();
+    return y;
+}
+
+// C = A B >> shift like the gemm_i32 kernel (int32, acc80), A M x K, B K x N, row-major
+inline std::vector<int64_t> gemm(const std::vector<int64_t> &A, const std::vector<int64_t> &B, size_t M, size_t K,
+                                 size_t N, int shift = 0, unsigned threads = 0, isa use = native())
+{
+    if (A.size() != M * K)
+        throw std::invalid_argument("cpu_engine: A has " + std::to_string(A.size()) + " values, expected " +
+                                    std::to_string(M) + "x" + std::to_string(K));
+    const layer l = make_layer(B, K, N, plio::dtype::int32, plio::dtype::int32, plio::dtype::int32, shift);
+    return gemv(l, A, threads, use);
+}
+
+} // namespace cpu_engine
+
+#endif // CPU_ENGINE_H
@@ -0,0 +1,189 @@
+/*
+*	Run a GemV layer or a GEMM on the host CPU with cpu_engine.h, bit exact
+*	with the AIE kernels, from the same weight blob and SHIFT.
+*
+*	How to run:
+*	cpu_infer.exe gemv w.bin x.txt y.txt [options]
+*	cpu_infer.exe gemm A.txt B.txt C.txt <M> <K> <N> [options]
+*	cpu_infer.exe isa
+*
+*	gemv reads a batch of input vectors (x.txt/.bin, a multiple of the
+*	blob's rows values) and writes the outputs in the same PLIO form.
+*	gemm multiplies row-major int32 A (M x K) and B (K x N) like the
+*	gemm_i32 kernel, e.g. the A.txt, B.txt and C.txt gemm_plan.exe scatter
+*	writes.
+*
+*	options:
+*	  --x <dtype> --y <dtype>   activation and output types (gemv, default int32)
+*	  --shift <n>               to_vector() shift, or
+*	  --quant quant.h           the SHIFT of a kernel build
+*	  --bias bias.txt --relu    Dense layer epilogue (gemv)
+*	  --threads <n>             0 (default) for every core
+*	  --isa <name>              scalar, or a SIMD extension of this build (default the widest)
+*	  --lanes 32|64|128         at least this accumulator width, to cross-check the paths
+*	  --repeat <n>              run n times and report the best time
+*	  --expect y_exp.txt        compare with golden outputs, exit 1 on a mismatch
+*/
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <string>
+
+#include "cpu_engine.h"
+#include "plio.h"
+#include "weight_blob.h"
+
+static int usage()
+{
+    std::fprintf(stderr,
+                 "usage: cpu_infer gemv w.bin x y [--x dtype] [--y dtype] [--shift n | --quant quant.h] "
+                 "[--bias b.txt] [--relu] [options]\n"
+                 "       cpu_infer gemm A B C <M> <K> <N> [--shift n | --quant quant.h] [options]\n"
+                 "       cpu_infer isa\n"
+                 "options: [--threads n] [--isa name] [--lanes 32|64|128] [--repeat n] [--expect file]\n");
+    return 2;
+}
+
+struct options {
+    plio::dtype x = plio::dtype::int32, y = plio::dtype::int32;
+    int shift = 0;
+    std::string bias, expect;
+    bool relu = false;
+    unsigned threads = 0, repeat = 1;
+    cpu_engine::isa use = cpu_engine::native();
+    cpu_engine::lanes lanes = cpu_engine::lanes::i32;
+};
+
+static cpu_engine::isa parse_isa(const std::string &name)
+{
+    for (int i = 0; i <= static_cast<int>(cpu_engine::isa::avx512_vnni); ++i)
+        if (name == cpu_engine::isa_name(static_cast<cpu_engine::isa>(i)))
+            return static_cast<cpu_engine::isa>(i);
+    throw std::invalid_argument("unknown --isa " + name);
+}
+
+// options from argv[first..], false on an unknown one
+static bool parse(int argc, char **argv, int first, options &o)
+{
+    for (int i = first; i < argc; ++i) {
+        const std::string opt = argv[i];
+        if (opt == "--relu") {
+            o.relu = true;
+            continue;
+        }
+        if (i + 1 >= argc)
+            return false;
+        const std::string v = argv[++i];
+        if (opt == "--x")
+            o.x = plio::parse_dtype(v);
+        else if (opt == "--y")
+            o.y = plio::parse_dtype(v);
+        else if (opt == "--shift")
+            o.shift = std::atoi(v.c_str());
+        else if (opt == "--quant")
+            o.shift = cpu_engine::read_shift(v);
+        else if (opt == "--bias")
+            o.bias = v;
+        else if (opt == "--threads")
+            o.threads = unsigned(std::strtoul(v.c_str(), nullptr, 10));
+        else if (opt == "--isa")
+            o.use = parse_isa(v);
+        else if (opt == "--lanes")
+            o.lanes = v == "128" ? cpu_engine::lanes::i128 : v == "64" ? cpu_engine::lanes::i64 : cpu_engine::lanes::i32;
+        else if (opt == "--repeat")
+            o.repeat = std::max(1u, unsigned(std::strtoul(v.c_str(), nullptr, 10)));
+        else if (opt == "--expect")
+            o.expect = v;
+        else
+            return false;
+    }
+    return true;
+}
+
+static std::vector<int64_t> timed(const cpu_engine::layer &l, const std::vector<int64_t> &x, const options &o)
+{
+    std::vector<int64_t> y;
+    double best = 0;
+    for (unsigned r = 0; r < o.repeat; ++r) {
+        const auto t0 = std::chrono::steady_clock::now();
+        y = cpu_engine::gemv(l, x, o.threads, o.use, o.lanes);
+        const double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        best = r == 0 ? s : std::min(best, s);
+    }
+    const size_t batch = x.size() / l.rows;
+    const double macs = double(batch) * double(l.rows) * double(l.cols);
+    std::printf("%zu x %zu x %zu: %.3f ms, %.2f GMAC/s (%s, %s accumulators)\n", batch, l.rows, l.cols, best * 1e3,
+                macs / best * 1e-9, cpu_engine::isa_name(o.use),
+                cpu_engine::lanes_name(std::max(o.lanes, l.exact_lanes())));
+    return y;
+}
+
+static void write(const std::string &path, const std::vector<int64_t> &v, plio::dtype t)
+{
+    if (plio::is_binary_path(path))
+        plio::write_binary(path, v, t);
+    else
+        plio::write_text(path, v, plio::values_per_word(t));
+}
+
+static bool check(const std::vector<int64_t> &y, const std::string &path, plio::dtype t)
+{
+    const std::vector<int64_t> want = plio::read_any(path, t);
+    if (want.size() != y.size()) {
+        std::fprintf(stderr, "%s has %zu values, computed %zu\n", path.c_str(), want.size(), y.size());
+        return false;
+    }
+    size_t bad = 0;
+    for (size_t i = 0; i < y.size(); ++i)
+        if (y[i] != want[i] && bad++ < 8)
+            std::fprintf(stderr, "y[%zu] = %lld, expected %lld\n", i, static_cast<long long>(y[i]),
+                         static_cast<long long>(want[i]));
+    if (bad)
+        std::fprintf(stderr, "%zu of %zu values differ\n", bad, y.size());
+    return bad == 0;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+        return usage();
+    const std::string cmd = argv[1];
+    options o;
+
+    try {
+        if (cmd == "isa" && argc == 2) {
+            std::printf("%s, %u threads\n", cpu_engine::isa_name(cpu_engine::native()),
+                        std::thread::hardware_concurrency());
+            return 0;
+        }
+        if (cmd == "gemv" && argc >= 5 && parse(argc, argv, 5, o)) {
+            const weight_blob::blob b = weight_blob::read(argv[2]);
+            const std::vector<int64_t> bias = o.bias.empty() ? std::vector<int64_t>()
+                                                             : plio::read_text(o.bias, plio::dtype::int32);
+            const cpu_engine::layer l = cpu_engine::make_layer(b, o.x, o.y, o.shift, bias, o.relu);
+            const std::vector<int64_t> y = timed(l, plio::read_any(argv[3], o.x), o);
+            write(argv[4], y, o.y);
+            return o.expect.empty() || check(y, o.expect, o.y) ? 0 : 1;
+        }
+        if (cmd == "gemm" && argc >= 8 && parse(argc, argv, 8, o)) {
+            const size_t M = std::strtoul(argv[5], nullptr, 10), K = std::strtoul(argv[6], nullptr, 10),
+                         N = std::strtoul(argv[7], nullptr, 10);
+            const std::vector<int64_t> A = plio::read_any(argv[2], plio::dtype::int32);
+            const std::vector<int64_t> B = plio::read_any(argv[3], plio::dtype::int32);
+            if (A.size() != M * K)
+                throw std::invalid_argument(std::string(argv[2]) + " is not " + std::to_string(M) + "x" +
+                                            std::to_string(K));
+            const cpu_engine::layer l = cpu_engine::make_layer(B, K, N, plio::dtype::int32, plio::dtype::int32,
+                                                               plio::dtype::int32, o.shift);
+            const std::vector<int64_t> C = timed(l, A, o);
+            write(argv[4], C, plio::dtype::int32);
+            return o.expect.empty() || check(C, o.expect, plio::dtype::int32) ? 0 : 1;
+        }
+        return usage();
+    } catch (const std::exception &e) {
+        std::fprintf(stderr, "cpu_infer: %s\n", e.what());
+        return 1;
+    }
+}
@@ -0,0 +1,1015 @@
+/*
+ *  Host stand-in for the parts of the ADF graph/kernel API used in this repo.
+ *
+ *  Kernels see window and stream ports with the usual window_readincr_v8 /
+ *  window_writeincr / readincr / writeincr calls. Graphs are built the usual
+ *  way (kernel::create, input_plio/output_plio, connect<window<N>> and
+ *  connect<stream>) and graph.run(n) invokes every kernel n times in
+ *  dataflow order, reading PLIO files from the working directory and writing
+ *  outputs under hostsim_output/ (HOSTSIM_OUTPUT_DIR overrides it), in the
+ *  same text or binary format the simulators use, minus the timestamps.
+ *
+ *  Kernel classes come from kernel::create_object<C>(ctor args): the object
+ *  lives as long as the graph, so its members keep state across invocations,
+ *  and C::registerKernelClass() names the member function with
+ *  REGISTER_FUNCTION as in ADF.
+ *
+ *  Run-time parameters (scalars by value, arrays by const reference) are
+ *  driven from an input_port with connect<parameter> and graph.update().
+ *  A synchronous port consumes one update per kernel invocation, an async()
+ *  one keeps the last value; run() stops when a kernel would block on one.
+ *
+ *  Placement constraints (location<>, not_equal) are recorded but do not
+ *  change the emulation. With ADF_EMU_GRAPH=<file> set, graph.init() writes
+ *  the kernels, ports, connections and those constraints as JSON, which is
+ *  what tools/placement.py plans from.
+ */
+
+#ifndef ADF_EMU_H
+#define ADF_EMU_H
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "aie_emu.h"
+
+namespace adf_emu {
+
+template <typename T> struct identity { using type = T; };
+template <typename T> using nodeduce = typename identity<T>::type;
+
+// byte FIFO behind a stream connection
+struct fifo {
+    std::deque<unsigned char> bytes;
+
+    template <typename T>
+    T pop()
+    {
+        if (bytes.size() < sizeof(T))
+            throw std::runtime_error("host sim: stream read with no data (producer starved)");
+        T v;
+        unsigned char *p = reinterpret_cast<unsigned char *>(&v);
+        for (size_t i = 0; i < sizeof(T); ++i, bytes.pop_front())
+            p[i] = bytes.front();
+        return v;
+    }
+
+    template <typename T>
+    void push(const T &v)
+    {
+        const unsigned char *p = reinterpret_cast<const unsigned char *>(&v);
+        bytes.insert(bytes.end(), p, p + sizeof(T));
+    }
+};
+
+} // namespace adf_emu
+
+template <typename T>
+struct input_window {
+    T *ptr;
+    T *head;
+    unsigned size;
+};
+
+template <typename T>
+struct output_window {
+    T *ptr;
+    T *head;
+    unsigned size;
+};
+
+template <typename T> struct input_stream  { adf_emu::fifo *f; };
+template <typename T> struct output_stream { adf_emu::fifo *f; };
+
+#define ADF_EMU_PORT_TYPES(T)                        \
+    typedef input_window<T>  input_window_##T;       \
+    typedef output_window<T> output_window_##T;      \
+    typedef input_stream<T>  input_stream_##T;       \
+    typedef output_stream<T> output_stream_##T;
+
+ADF_EMU_PORT_TYPES(int8)
+ADF_EMU_PORT_TYPES(int16)
+ADF_EMU_PORT_TYPES(int32)
+ADF_EMU_PORT_TYPES(uint8)
+ADF_EMU_PORT_TYPES(uint16)
+ADF_EMU_PORT_TYPES(uint32)
+typedef input_window<float>  input_window_float;
+typedef output_window<float> output_window_float;
+
+#undef ADF_EMU_PORT_TYPES
+
+namespace adf_emu {
+template <typename W, typename T>
+void advance(W *w, int n)
+{
+    w->ptr += n;
+    while (w->ptr >= w->head + w->size) w->ptr -= w->size;
+    while (w->ptr < w->head) w->ptr += w->size;
+}
+} // namespace adf_emu
+
+/*
+ *  Window access
+ */
+template <typename T> T window_read(input_window<T> *w) { return *w->ptr; }
+template <typename T> T window_readincr(input_window<T> *w) { T v = *w->ptr; adf_emu::advance<input_window<T>, T>(w, 1); return v; }
+template <typename T> void window_incr(input_window<T> *w, int n) { adf_emu::advance<input_window<T>, T>(w, n); }
+template <typename T> void window_decr(input_window<T> *w, int n) { adf_emu::advance<input_window<T>, T>(w, -n); }
+template <typename T> void window_incr(output_window<T> *w, int n) { adf_emu::advance<output_window<T>, T>(w, n); }
+template <typename T> void window_decr(output_window<T> *w, int n) { adf_emu::advance<output_window<T>, T>(w, -n); }
+
+template <unsigned N, typename T>
+aie::vector<T, N> window_read_v(input_window<T> *w) { return aie::load_v<N>(w->ptr); }
+
+template <unsigned N, typename T>
+aie::vector<T, N> window_readincr_v(input_window<T> *w)
+{
+    aie::vector<T, N> v = aie::load_v<N>(w->ptr);
+    adf_emu::advance<input_window<T>, T>(w, N);
+    return v;
+}
+
+#define ADF_EMU_WINDOW_READ_V(N)                                                                      \
+    template <typename T> aie::vector<T, N> window_read_v##N(input_window<T> *w) { return window_read_v<N>(w); } \
+    template <typename T> aie::vector<T, N> window_readincr_v##N(input_window<T> *w) { return window_readincr_v<N>(w); }
+
+ADF_EMU_WINDOW_READ_V(2)
+ADF_EMU_WINDOW_READ_V(4)
+ADF_EMU_WINDOW_READ_V(8)
+ADF_EMU_WINDOW_READ_V(16)
+ADF_EMU_WINDOW_READ_V(32)
+ADF_EMU_WINDOW_READ_V(64)
+ADF_EMU_WINDOW_READ_V(128)
+#undef ADF_EMU_WINDOW_READ_V
+
+template <typename T> void window_write(output_window<T> *w, adf_emu::nodeduce<T> v) { *w->ptr = v; }
+template <typename T> void window_writeincr(output_window<T> *w, adf_emu::nodeduce<T> v)
+{
+    *w->ptr = v;
+    adf_emu::advance<output_window<T>, T>(w, 1);
+}
+
+template <typename T, unsigned N>
+void window_write(output_window<T> *w, const aie::vector<T, N> &v) { aie::store_v(w->ptr, v); }
+
+template <typename T, unsigned N>
+void window_writeincr(output_window<T> *w, const aie::vector<T, N> &v)
+{
+    aie::store_v(w->ptr, v);
+    adf_emu::advance<output_window<T>, T>(w, N);
+}
+
+/*
+ *  Stream access
+ */
+template <typename T> T readincr(input_stream<T> *s) { return s->f->template pop<T>(); }
+
+template <unsigned N, typename T>
+aie::vector<T, N> readincr_v(input_stream<T> *s)
+{
+    aie::vector<T, N> v;
+    for (unsigned i = 0; i < N; ++i)
+        v[i] = s->f->template pop<T>();
+    return v;
+}
+
+template <typename T> aie::vector<T, 4>  readincr_v4(input_stream<T> *s)  { return readincr_v<4>(s); }
+template <typename T> aie::vector<T, 8>  readincr_v8(input_stream<T> *s)  { return readincr_v<8>(s); }
+template <typename T> aie::vector<T, 16> readincr_v16(input_stream<T> *s) { return readincr_v<16>(s); }
+
+template <typename T> void writeincr(output_stream<T> *s, adf_emu::nodeduce<T> v) { s->f->push(v); }
+
+template <typename T, unsigned N>
+void writeincr(output_stream<T> *s, const aie::vector<T, N> &v)
+{
+    for (unsigned i = 0; i < N; ++i)
+        s->f->push(v[i]);
+}
+
+template <typename T> void writeincr_v4(output_stream<T> *s, const aie::vector<T, 4> &v)   { ::writeincr(s, v); }
+template <typename T> void writeincr_v8(output_stream<T> *s, const aie::vector<T, 8> &v)   { ::writeincr(s, v); }
+template <typename T> void writeincr_v16(output_stream<T> *s, const aie::vector<T, 16> &v) { ::writeincr(s, v); }
+
+namespace aie {
+template <unsigned N, typename T> vector<T, N> readincr_v(input_stream<T> *s) { return ::readincr_v<N>(s); }
+template <typename T> T readincr(input_stream<T> *s) { return ::readincr(s); }
+template <typename T, unsigned N> void writeincr(output_stream<T> *s, const vector<T, N> &v) { ::writeincr(s, v); }
+template <typename T> void writeincr(output_stream<T> *s, adf_emu::nodeduce<T> v) { ::writeincr(s, v); }
+} // namespace aie
+
+namespace adf {
+
+enum plio_type { plio_32_bits = 32, plio_64_bits = 64, plio_128_bits = 128 };
+
+// connection / constraint tags
+struct ratio {};
+struct buffer {};
+struct stack {};
+struct stream {};
+struct cascade {};
+struct parameter {};
+template <unsigned Bytes, unsigned Margin = 0> struct window {};
+
+struct tile    { int col, row;         tile(int c, int r) : col(c), row(r) {} };
+struct bank    { int col, row, id;     bank(int c, int r, int b) : col(c), row(r), id(b) {} };
+struct address { int col, row, offset; address(int c, int r, int o) : col(c), row(r), offset(o) {} };
+
+namespace detail {
+
+enum class port_kind { window, stream, parameter };
+
+struct node;
+
+struct port_info {
+    port_kind kind = port_kind::window;
+    size_t elem_size = 0;
+    bool is_signed = true;
+    bool is_float = false;
+
+    unsigned bytes = 0;                       // window size
+    std::vector<unsigned char> buf;           // window storage
+    adf_emu::fifo *f = nullptr;               // stream FIFO
+    bool async = false;                       // run-time parameter: keep the last update
+    unsigned updates = 0;                     // run-time parameter: updates not yet consumed
+    std::shared_ptr<void> obj;                // the typed window/stream object handed to the kernel
+};
+
+struct node {
+    enum type_t { kernel, plio_in, plio_out, rtp } type;
+    std::string name, file, source;
+    double ratio = 0.0;
+    plio_type width = plio_128_bits;
+    bool binary = false;
+
+    std::vector<port_info> in, out;
+
+    // kernel parameter i -> (is_input, port index)
+    std::vector<std::pair<bool, int>> params;
+    std::function<void(node &)> invoke;
+
+    // PLIO input bytes, PLIO output file
+    std::vector<unsigned char> data;
+    bool loaded = false;
+    std::FILE *fp = nullptr;
+    size_t written = 0;
+
+    explicit node(type_t t) : type(t) {}
+};
+
+struct edge {
+    node *src;
+    int si;
+    node *dst;
+    int di;
+    port_kind kind;
+    unsigned bytes;
+    const char *conn;                         // window, stream, cascade or parameter
+    adf_emu::fifo q;
+    size_t pos = 0;                           // read position in a PLIO input, per kernel it feeds
+};
+
+// location<what>(target) = sites, target a kernel (idx -1) or one of its ports
+struct site {
+    const char *kind;                         // tile, bank, address or kernel
+    int col, row, x;                          // x: bank id or byte offset
+    node *n = nullptr;                        // kernel: wherever this kernel is placed
+};
+
+struct placement {
+    const char *what;                         // kernel, buffer, stack or parameter
+    node *n;
+    bool out;
+    int idx;
+    std::vector<site> sites;
+};
+
+template <typename T> void describe(port_info &p)
+{
+    p.elem_size = sizeof(T);
+    p.is_signed = std::is_signed_v<T>;
+    p.is_float = std::is_floating_point_v<T>;
+}
+
+inline std::string output_dir()
+{
+    const char *d = std::getenv("HOSTSIM_OUTPUT_DIR");
+    return d ? d : "hostsim_output";
+}
+
+class registry {
+public:
+    std::vector<std::shared_ptr<node>> nodes;
+    std::vector<std::unique_ptr<edge>> edges;
+    std::vector<placement> placements;
+    std::vector<std::pair<placement, placement>> not_equal;
+
+    static registry &get() { static registry r; return r; }
+
+    void add_edge(node *src, int si, node *dst, int di, port_kind kind, unsigned bytes, const char *conn)
+    {
+        edges.push_back(std::unique_ptr<edge>(new edge{src, si, dst, di, kind, bytes, conn, {}}));
+    }
+
+    void init()
+    {
+        if (initialized_)
+            return;
+        initialized_ = true;
+
+        for (auto &e : edges) {
+            port_info *kp = nullptr;
+            if (e->dst->type == node::kernel) {
+                kp = &e->dst->in.at(e->di);
+                bind(*kp, *e);
+            }
+            if (e->src->type == node::kernel) {
+                port_info &sp = e->src->out.at(e->si);
+                bind(sp, *e);
+                kp = kp ? kp : &sp;
+            }
+            if (e->src->type == node::plio_in)
+                open_input(*e->src, *kp, *e);
+            if (e->dst->type == node::plio_out)
+                open_output(*e->dst);
+        }
+        order_kernels();
+        if (const char *path = std::getenv("ADF_EMU_GRAPH"))
+            dump(path);
+    }
+
+    // The graph as JSON: nodes in creation order, connections, placement constraints.
+    void dump(const std::string &path) const
+    {
+        std::FILE *fp = std::fopen(path.c_str(), "w");
+        if (!fp)
+            throw std::runtime_error("host sim: cannot create " + path);
+        static const char *types[] = {"kernel", "plio_in", "plio_out", "rtp"};
+        static const char *kinds[] = {"window", "stream", "parameter"};
+        auto ports = [&](const std::vector<port_info> &ps) {
+            std::fprintf(fp, "[");
+            for (size_t i = 0; i < ps.size(); ++i)
+                std::fprintf(fp, "%s{\"kind\": \"%s\", \"bytes\": %zu, \"elem\": %zu}", i ? ", " : "",
+                             kinds[int(ps[i].kind)], ps[i].kind == port_kind::parameter ? ps[i].buf.size() : ps[i].bytes,
+                             ps[i].elem_size);
+            std::fprintf(fp, "]");
+        };
+        auto target = [&](const placement &c) {
+            std::fprintf(fp, "{\"what\": \"%s\", \"node\": %d, \"out\": %s, \"port\": %d, \"sites\": [", c.what,
+                         index_of(c.n), c.out ? "true" : "false", c.idx);
+            for (size_t i = 0; i < c.sites.size(); ++i)
+                std::fprintf(fp, "%s{\"kind\": \"%s\", \"col\": %d, \"row\": %d, \"x\": %d}", i ? ", " : "",
+                             c.sites[i].kind, c.sites[i].col, c.sites[i].row,
+                             c.sites[i].n ? index_of(c.sites[i].n) : c.sites[i].x);
+            std::fprintf(fp, "]}");
+        };
+
+        std::fprintf(fp, "{\n\"nodes\": [\n");
+        for (size_t i = 0; i < nodes.size(); ++i) {
+            const node &n = *nodes[i];
+            std::fprintf(fp, "  {\"id\": %zu, \"type\": \"%s\", \"name\": \"%s\", \"source\": \"%s\", \"file\": \"%s\", "
+                             "\"ratio\": %g, \"width\": %d, \"in\": ",
+                         i, types[n.type], n.name.c_str(), n.source.c_str(), n.file.c_str(), n.ratio, int(n.width));
+            ports(n.in);
+            std::fprintf(fp, ", \"out\": ");
+            ports(n.out);
+            std::fprintf(fp, "}%s\n", i + 1 < nodes.size() ? "," : "");
+        }
+        std::fprintf(fp, "],\n\"edges\": [\n");
+        for (size_t i = 0; i < edges.size(); ++i) {
+            const edge &e = *edges[i];
+            std::fprintf(fp, "  {\"src\": %d, \"src_port\": %d, \"dst\": %d, \"dst_port\": %d, \"conn\": \"%s\", \"bytes\": %u}%s\n",
+                         index_of(e.src), e.si, index_of(e.dst), e.di, e.conn, e.bytes, i + 1 < edges.size() ? "," : "");
+        }
+        std::fprintf(fp, "],\n\"constraints\": [\n");
+        for (size_t i = 0; i < placements.size(); ++i) {
+            std::fprintf(fp, "  ");
+            target(placements[i]);
+            std::fprintf(fp, "%s\n", i + 1 < placements.size() ? "," : "");
+        }
+        std::fprintf(fp, "],\n\"not_equal\": [\n");
+        for (size_t i = 0; i < not_equal.size(); ++i) {
+            std::fprintf(fp, "  [");
+            target(not_equal[i].first);
+            std::fprintf(fp, ", ");
+            target(not_equal[i].second);
+            std::fprintf(fp, "]%s\n", i + 1 < not_equal.size() ? "," : "");
+        }
+        std::fprintf(fp, "]\n}\n");
+        std::fclose(fp);
+    }
+
+    int index_of(const node *n) const
+    {
+        for (size_t i = 0; i < nodes.size(); ++i)
+            if (nodes[i].get() == n)
+                return int(i);
+        return -1;
+    }
+
+    // Run every kernel `iterations` times (-1: until an input PLIO runs dry).
+    void run(int iterations)
+    {
+        init();
+        for (int it = 0; iterations < 0 || it < iterations; ++it) {
+            if (!inputs_available()) {
+                if (iterations >= 0)
+                    std::fprintf(stderr, "host sim: inputs exhausted after %d of %d iterations\n", it, iterations);
+                return;
+            }
+            if (const node *k = waiting_kernel()) {
+                std::fprintf(stderr, "host sim: %s waits for graph.update() after %d of %d iterations\n",
+                             k->name.c_str(), it, iterations);
+                return;
+            }
+            for (node *k : order_)
+                step(*k);
+        }
+    }
+
+    // Write a run-time parameter to every kernel port driven by input_port `src`.
+    void update(node *src, const void *data, size_t bytes)
+    {
+        init();
+        bool any = false;
+        for (auto &e : edges) {
+            if (e->src != src || e->kind != port_kind::parameter)
+                continue;
+            port_info &p = e->dst->in.at(e->di);
+            if (bytes != p.buf.size())
+                throw std::runtime_error("host sim: graph.update() with " + std::to_string(bytes) + " bytes, " +
+                                         e->dst->name + " expects " + std::to_string(p.buf.size()));
+            std::memcpy(p.buf.data(), data, bytes);
+            ++p.updates;
+            any = true;
+        }
+        if (!any)
+            throw std::runtime_error("host sim: graph.update() on an unconnected input_port");
+    }
+
+    void end()
+    {
+        for (auto &n : nodes)
+            if (n->fp) {
+                std::fclose(n->fp);
+                n->fp = nullptr;
+            }
+    }
+
+private:
+    bool initialized_ = false;
+    std::vector<node *> order_;
+
+    void bind(port_info &p, edge &e)
+    {
+        if (e.kind == port_kind::parameter)
+            return;     // sized by the kernel signature
+        p.bytes = e.bytes;
+        if (e.kind == port_kind::window)
+            p.buf.assign(e.bytes, 0);
+        else
+            p.f = &e.q;
+    }
+
+    void open_input(node &n, const port_info &p, edge &e)
+    {
+        // a PLIO broadcast to several kernels is read once, each reads all of it
+        if (!n.loaded)
+            load_input(n, p);
+        // a stream is fed the whole file up front
+        if (e.kind == port_kind::stream)
+            e.q.bytes.insert(e.q.bytes.end(), n.data.begin(), n.data.end());
+    }
+
+    static void load_input(node &n, const port_info &p)
+    {
+        if (n.binary) {
+            std::ifstream f(n.file, std::ios::binary);
+            if (!f)
+                throw std::runtime_error("host sim: cannot open " + n.file);
+            n.data.assign(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+        } else {
+            std::ifstream f(n.file);
+            if (!f)
+                throw std::runtime_error("host sim: cannot open " + n.file);
+            std::string line;
+            while (std::getline(f, line)) {
+                if (!line.empty() && line[0] == 'T')
+                    continue;
+                std::istringstream ss(line);
+                double d;
+                while (ss >> d)
+                    append_value(n.data, p, d);
+            }
+        }
+        n.loaded = true;
+    }
+
+    static void append_value(std::vector<unsigned char> &out, const port_info &p, double d)
+    {
+        unsigned char b[8];
+        if (p.is_float) {
+            float f = static_cast<float>(d);
+            std::memcpy(b, &f, 4);
+        } else {
+            int64_t v = static_cast<int64_t>(d);
+            std::memcpy(b, &v, 8);
+        }
+        out.insert(out.end(), b, b + p.elem_size);
+    }
+
+    void open_output(node &n)
+    {
+        if (n.fp)
+            return;
+        std::filesystem::path path = std::filesystem::path(output_dir()) / n.file;
+        std::filesystem::create_directories(path.parent_path());
+        n.fp = std::fopen(path.string().c_str(), n.binary ? "wb" : "w");
+        if (!n.fp)
+            throw std::runtime_error("host sim: cannot create " + path.string());
+    }
+
+    void write_output(node &n, const port_info &p, const unsigned char *b, size_t bytes)
+    {
+        if (n.binary) {
+            std::fwrite(b, 1, bytes, n.fp);
+            return;
+        }
+        const size_t per_line = std::max<size_t>(1, n.width / (8 * p.elem_size));
+        for (size_t i = 0; i < bytes; i += p.elem_size) {
+            if (p.is_float) {
+                float f;
+                std::memcpy(&f, b + i, 4);
+                std::fprintf(n.fp, "%g", f);
+            } else {
+                int64_t v = 0;
+                std::memcpy(&v, b + i, p.elem_size);
+                if (p.is_signed) {
+                    const unsigned sh = 64 - 8 * p.elem_size;
+                    v = static_cast<int64_t>(static_cast<uint64_t>(v) << sh) >> sh;
+                }
+                std::fprintf(n.fp, "%lld", static_cast<long long>(v));
+            }
+            std::fputc(++n.written % per_line == 0 ? '\n' : ' ', n.fp);
+        }
+    }
+
+    bool inputs_available() const
+    {
+        for (auto &e : edges)
+            if (e->src->type == node::plio_in && e->kind == port_kind::window &&
+                e->pos + e->bytes > e->src->data.size())
+                return false;
+        return true;
+    }
+
+    // first kernel with a run-time parameter that has no value to run with
+    const node *waiting_kernel() const
+    {
+        for (const node *k : order_)
+            for (const port_info &p : k->in)
+                if (p.kind == port_kind::parameter && p.updates == 0)
+                    return k;
+        return nullptr;
+    }
+
+    void order_kernels()
+    {
+        std::vector<node *> pending;
+        for (auto &n : nodes)
+            if (n->type == node::kernel && connected(*n))
+                pending.push_back(n.get());
+            else if (n->type == node::kernel)
+                std::fprintf(stderr, "host sim: skipping kernel %s with unconnected ports\n", n->name.c_str());
+
+        // Kahn's algorithm over kernel-to-kernel edges, creation order breaks ties
+        while (!pending.empty()) {
+            auto ready = std::find_if(pending.begin(), pending.end(), [&](node *k) {
+                for (auto &e : edges)
+                    if (e->dst == k && e->src->type == node::kernel &&
+                        std::find(pending.begin(), pending.end(), e->src) != pending.end())
+                        return false;
+                return true;
+            });
+            if (ready == pending.end())
+                throw std::runtime_error("host sim: graph has a cycle");
+            order_.push_back(*ready);
+            pending.erase(ready);
+        }
+    }
+
+    bool connected(const node &k) const
+    {
+        auto has = [&](bool input, int i) {
+            for (auto &e : edges)
+                if ((input && e->dst == &k && e->di == i) || (!input && e->src == &k && e->si == i))
+                    return true;
+            return false;
+        };
+        for (size_t i = 0; i < k.in.size(); ++i)
+            if (!has(true, int(i)))
+                return false;
+        for (size_t i = 0; i < k.out.size(); ++i)
+            if (!has(false, int(i)))
+                return false;
+        return true;
+    }
+
+    void step(node &k)
+    {
+        // fill input windows from PLIO files or upstream kernels
+        for (auto &e : edges) {
+            if (e->dst != &k || e->kind != port_kind::window)
+                continue;
+            port_info &p = k.in[e->di];
+            if (e->src->type == node::plio_in) {
+                std::memcpy(p.buf.data(), e->src->data.data() + e->pos, e->bytes);
+                e->pos += e->bytes;
+            } else {
+                const port_info &sp = e->src->out[e->si];
+                std::memcpy(p.buf.data(), sp.buf.data(), std::min(sp.buf.size(), p.buf.size()));
+            }
+        }
+
+        for (auto &p : k.out)
+            std::fill(p.buf.begin(), p.buf.end(), 0);
+
+        k.invoke(k);
+
+        for (auto &p : k.in)
+            if (p.kind == port_kind::parameter && !p.async)
+                --p.updates;
+
+        // drain outputs that go straight to PLIO files
+        for (auto &e : edges) {
+            if (e->src != &k || e->dst->type != node::plio_out)
+                continue;
+            const port_info &p = k.out[e->si];
+            if (e->kind == port_kind::window) {
+                write_output(*e->dst, p, p.buf.data(), p.buf.size());
+            } else {
+                std::vector<unsigned char> b(e->q.bytes.begin(), e->q.bytes.end());
+                e->q.bytes.clear();
+                write_output(*e->dst, p, b.data(), b.size());
+            }
+        }
+    }
+};
+
+// per-parameter adaptors between kernel signatures and ports
+template <typename A, typename = void> struct param;
+
+template <typename T> struct param<input_window<T> *> {
+    static constexpr bool input = true;
+    static void describe(port_info &p) { detail::describe<T>(p); p.kind = port_kind::window; p.obj = std::make_shared<input_window<T>>(); }
+    static input_window<T> *get(port_info &p)
+    {
+        auto *w = static_cast<input_window<T> *>(p.obj.get());
+        w->head = w->ptr = reinterpret_cast<T *>(p.buf.data());
+        w->size = unsigned(p.buf.size() / sizeof(T));
+        return w;
+    }
+};
+
+template <typename T> struct param<output_window<T> *> {
+    static constexpr bool input = false;
+    static void describe(port_info &p) { detail::describe<T>(p); p.kind = port_kind::window; p.obj = std::make_shared<output_window<T>>(); }
+    static output_window<T> *get(port_info &p)
+    {
+        auto *w = static_cast<output_window<T> *>(p.obj.get());
+        w->head = w->ptr = reinterpret_cast<T *>(p.buf.data());
+        w->size = unsigned(p.buf.size() / sizeof(T));
+        return w;
+    }
+};
+
+template <typename T> struct param<input_stream<T> *> {
+    static constexpr bool input = true;
+    static void describe(port_info &p) { detail::describe<T>(p); p.kind = port_kind::stream; p.obj = std::make_shared<input_stream<T>>(); }
+    static input_stream<T> *get(port_info &p)
+    {
+        auto *s = static_cast<input_stream<T> *>(p.obj.get());
+        s->f = p.f;
+        return s;
+    }
+};
+
+template <typename T> struct param<output_stream<T> *> {
+    static constexpr bool input = false;
+    static void describe(port_info &p) { detail::describe<T>(p); p.kind = port_kind::stream; p.obj = std::make_shared<output_stream<T>>(); }
+    static output_stream<T> *get(port_info &p)
+    {
+        auto *s = static_cast<output_stream<T> *>(p.obj.get());
+        s->f = p.f;
+        return s;
+    }
+};
+
+// run-time parameters: scalars by value, arrays by const reference
+template <typename T> struct param<T, std::enable_if_t<std::is_arithmetic_v<T>>> {
+    static constexpr bool input = true;
+    static void describe(port_info &p) { detail::describe<T>(p); p.kind = port_kind::parameter; p.buf.assign(sizeof(T), 0); }
+    static T get(port_info &p)
+    {
+        T v;
+        std::memcpy(&v, p.buf.data(), sizeof(T));
+        return v;
+    }
+};
+
+template <typename T, size_t N> struct param<const T (&)[N]> {
+    static constexpr bool input = true;
+    static void describe(port_info &p) { detail::describe<T>(p); p.kind = port_kind::parameter; p.buf.assign(N * sizeof(T), 0); }
+    static const T (&get(port_info &p))[N] { return *reinterpret_cast<const T(*)[N]>(p.buf.data()); }
+};
+
+template <typename A>
+void add_param(node &n)
+{
+    using P = param<A>;
+    auto &ports = P::input ? n.in : n.out;
+    ports.emplace_back();
+    P::describe(ports.back());
+    n.params.emplace_back(P::input, int(ports.size() - 1));
+}
+
+template <typename A>
+decltype(auto) get_param(node &n, size_t i)
+{
+    auto [input, idx] = n.params[i];
+    return param<A>::get(input ? n.in[idx] : n.out[idx]);
+}
+
+template <typename... Args, size_t... I>
+void invoke(void (*fn)(Args...), node &n, std::index_sequence<I...>)
+{
+    fn(get_param<Args>(n, I)...);
+}
+
+// kernel classes: registerKernelClass() hands REGISTER_FUNCTION the member
+// function, kernel::create_object<C>() collects it here
+struct class_function {
+    std::function<void(node &)> describe;
+    std::function<void(void *, node &)> invoke;
+};
+
+inline class_function *&registering()
+{
+    static class_function *f = nullptr;
+    return f;
+}
+
+template <typename C, typename... Args, size_t... I>
+void invoke(C *obj, void (C::*fn)(Args...), node &n, std::index_sequence<I...>)
+{
+    (obj->*fn)(get_param<Args>(n, I)...);
+}
+
+template <typename C, typename... Args>
+void register_function(void (C::*fn)(Args...))
+{
+    if (class_function *f = registering()) {
+        f->describe = [](node &n) { (add_param<Args>(n), ...); };
+        f->invoke = [fn](void *obj, node &n) {
+            invoke(static_cast<C *>(obj), fn, n, std::index_sequence_for<Args...>{});
+        };
+    }
+}
+
+template <typename C> struct conn_traits { static constexpr port_kind kind = port_kind::stream; static constexpr unsigned bytes = 0; static constexpr const char *name = "stream"; };
+template <unsigned B, unsigned M> struct conn_traits<window<B, M>> { static constexpr port_kind kind = port_kind::window; static constexpr unsigned bytes = B; static constexpr const char *name = "window"; };
+template <> struct conn_traits<cascade> { static constexpr port_kind kind = port_kind::stream; static constexpr unsigned bytes = 0; static constexpr const char *name = "cascade"; };
+template <> struct conn_traits<parameter> { static constexpr port_kind kind = port_kind::parameter; static constexpr unsigned bytes = 0; static constexpr const char *name = "parameter"; };
+
+template <typename T> struct constraint_kind;
+template <> struct constraint_kind<buffer>    { static constexpr const char *name = "buffer"; };
+template <> struct constraint_kind<stack>     { static constexpr const char *name = "stack"; };
+template <> struct constraint_kind<parameter> { static constexpr const char *name = "parameter"; };
+
+// location<>() result: records what it is assigned in the registry
+struct constraint {
+    placement c;
+
+    constraint &operator=(const tile &t)    { return add({{"tile", t.col, t.row, 0}}); }
+    constraint &operator=(const bank &b)    { return add({{"bank", b.col, b.row, b.id}}); }
+    constraint &operator=(const address &a) { return add({{"address", a.col, a.row, a.offset}}); }
+    // location<buffer>(port) = location<kernel>(k): in the memory of k's tile
+    constraint &operator=(const constraint &k) { return add({{"kernel", -1, -1, 0, k.c.n}}); }
+    // ping/pong pair
+    constraint &operator=(std::initializer_list<address> as)
+    {
+        std::vector<site> s;
+        for (const address &a : as)
+            s.push_back({"address", a.col, a.row, a.offset});
+        return add(s);
+    }
+    constraint &operator=(std::initializer_list<bank> bs)
+    {
+        std::vector<site> s;
+        for (const bank &b : bs)
+            s.push_back({"bank", b.col, b.row, b.id});
+        return add(s);
+    }
+
+private:
+    constraint &add(std::vector<site> s)
+    {
+        c.sites = std::move(s);
+        registry::get().placements.push_back(c);
+        return *this;
+    }
+};
+
+} // namespace detail
+
+struct port {
+    std::shared_ptr<detail::node> n;
+    bool out;
+    int idx;
+};
+
+class port_array {
+public:
+    port_array(const std::shared_ptr<detail::node> *owner, bool out) : owner_(owner), out_(out) {}
+    port operator[](int i) const { return port{*owner_, out_, i}; }
+
+private:
+    const std::shared_ptr<detail::node> *owner_;
+    bool out_;
+};
+
+// Common base of kernels and PLIOs: in[]/out[] always refer to this object's node.
+class node_handle {
+public:
+    port_array in{&impl, false};
+    port_array out{&impl, true};
+
+    node_handle() = default;
+    node_handle(const node_handle &o) : impl(o.impl) {}
+    node_handle &operator=(const node_handle &o) { impl = o.impl; return *this; }
+
+    std::shared_ptr<detail::node> impl;
+
+protected:
+    static std::shared_ptr<detail::node> make(detail::node::type_t t)
+    {
+        auto n = std::make_shared<detail::node>(t);
+        detail::registry::get().nodes.push_back(n);
+        return n;
+    }
+};
+
+class kernel : public node_handle {
+public:
+    template <typename... Args>
+    static kernel create(void (*fn)(Args...))
+    {
+        kernel k;
+        k.impl = make(detail::node::kernel);
+        k.impl->name = "kernel" + std::to_string(detail::registry::get().nodes.size() - 1);
+        (detail::add_param<Args>(*k.impl), ...);
+        k.impl->invoke = [fn](detail::node &n) { detail::invoke(fn, n, std::index_sequence_for<Args...>{}); };
+        return k;
+    }
+
+    // kernel class C constructed from args; the graph keeps the object
+    template <typename C, typename... CtorArgs>
+    static kernel create_object(CtorArgs &&...args)
+    {
+        detail::class_function f;
+        detail::registering() = &f;
+        C::registerKernelClass();
+        detail::registering() = nullptr;
+        if (!f.invoke)
+            throw std::runtime_error("host sim: registerKernelClass() registers no REGISTER_FUNCTION");
+
+        kernel k;
+        k.impl = make(detail::node::kernel);
+        k.impl->name = "kernel" + std::to_string(detail::registry::get().nodes.size() - 1);
+        f.describe(*k.impl);
+        std::shared_ptr<C> obj = std::make_shared<C>(std::forward<CtorArgs>(args)...);
+        k.impl->invoke = [obj, fn = f.invoke](detail::node &n) { fn(obj.get(), n); };
+        return k;
+    }
+};
+
+class input_plio : public node_handle {
+public:
+    static input_plio create(plio_type width, const std::string &file) { return create("", width, file); }
+    static input_plio create(const std::string &name, plio_type width, const std::string &file,
+                             double = 0.0, bool binary = false, bool = false)
+    {
+        input_plio p;
+        p.impl = make(detail::node::plio_in);
+        p.impl->out.emplace_back();
+        p.impl->name = name;
+        p.impl->file = file;
+        p.impl->width = width;
+        p.impl->binary = binary;
+        return p;
+    }
+};
+
+class output_plio : public node_handle {
+public:
+    static output_plio create(plio_type width, const std::string &file) { return create("", width, file); }
+    static output_plio create(const std::string &name, plio_type width, const std::string &file,
+                              double = 0.0, bool binary = false, bool = false)
+    {
+        output_plio p;
+        p.impl = make(detail::node::plio_out);
+        p.impl->in.emplace_back();
+        p.impl->name = name;
+        p.impl->file = file;
+        p.impl->width = width;
+        p.impl->binary = binary;
+        return p;
+    }
+};
+
+// graph-level run-time parameter input, written with graph.update()
+class input_port : public node_handle {
+public:
+    input_port()
+    {
+        impl = make(detail::node::rtp);
+        impl->out.emplace_back();
+        impl->name = "input_port";
+    }
+    operator port() const { return out[0]; }
+};
+
+template <typename C = stream>
+struct connect {
+    connect(const port &a, const port &b)
+    {
+        detail::registry::get().add_edge(a.n.get(), a.idx, b.n.get(), b.idx, detail::conn_traits<C>::kind,
+                                         detail::conn_traits<C>::bytes, detail::conn_traits<C>::name);
+    }
+};
+
+inline std::string &source(kernel &k) { return k.impl->source; }
+
+inline void async(const port &p) { p.n->in.at(p.idx).async = true; }
+inline void sync(const port &p) { p.n->in.at(p.idx).async = false; }
+
+template <typename R> double &runtime(kernel &k) { return k.impl->ratio; }
+
+namespace detail {
+template <> struct constraint_kind<kernel> { static constexpr const char *name = "kernel"; };
+} // namespace detail
+
+template <typename T> detail::constraint location(const node_handle &k)
+{
+    return {{detail::constraint_kind<T>::name, k.impl.get(), false, -1, {}}};
+}
+template <typename T> detail::constraint location(const port &p)
+{
+    return {{detail::constraint_kind<T>::name, p.n.get(), p.out, p.idx, {}}};
+}
+inline void not_equal(const detail::constraint &a, const detail::constraint &b)
+{
+    detail::registry::get().not_equal.emplace_back(a.c, b.c);
+}
+
+class graph {
+public:
+    void init() { detail::registry::get().init(); }
+    void run(int iterations = -1) { detail::registry::get().run(iterations); }
+    void end() { detail::registry::get().end(); }
+
+    template <typename T>
+    void update(const input_port &p, const T *value, size_t size)
+    {
+        detail::registry::get().update(p.impl.get(), value, size * sizeof(T));
+    }
+    template <typename T, typename = std::enable_if_t<std::is_arithmetic_v<T>>>
+    void update(const input_port &p, T value)
+    {
+        detail::registry::get().update(p.impl.get(), &value, sizeof(T));
+    }
+
+    void wait() {}
+    void wait(int) {}
+};
+
+} // namespace adf
+
+// inside C::registerKernelClass(): REGISTER_FUNCTION(C::run)
+#define REGISTER_FUNCTION(fn) ::adf::detail::register_function(&fn)
+
+#endif // ADF_EMU_H
@@ -0,0 +1,717 @@
+/*
+ *  Bit-exact host emulation of the AIE1 vector types and MAC intrinsics used
+ *  by the kernels in this repo, so they can be compiled and run natively with
+ *  g++ (see tools/emu/include for the drop-in adf.h / aie_api headers).
+ *
+ *  Covered:
+ *   - aie::vector, aie::accum<acc48|acc80>, aie::mask and the aie:: helpers
+ *     the kernels use (zeros, load_v, store_v, concat, select, add, mul,
+ *     compares, bitwise ops, shifts, ...)
+ *   - aie::mmul for the api_benchmark GEMM
+ *   - lmul8/lmac8, lmul4/lmac4          32b general scheme (also 32x16)
+ *   - mul16/mac16 (16b x 16b and 16b x 8b schemes), mul16/mac16 and
+ *     mul8/mac8 (8b x 8b)
+ *   - accumulator wrap at 48/80 bits and to_vector()/srs shift, rounding and
+ *     saturation modes
+ *
+ *  The lane addressing reproduces the repo's scheme scripts, which leave the
+ *  square implicit: gemv_i32/general_scheme.py (no square),
+ *  gemv_i16/16bx16b_scheme.py (xsquare 0x3210) and gemv_i8/8x8_data_scheme.py
+ *  (mac8, 8 lanes x 16 columns, xsquare 0x3120). The same index functions
+ *  are printed by tools/lane_map.exe, which replaces running those scripts
+ *  by hand.
+ *
+ *  Lane loops are plain fixed-trip loops over std::array storage so the host
+ *  compiler can vectorize them; nothing here depends on a particular ISA.
+ */
+
+#ifndef AIE_EMU_H
+#define AIE_EMU_H
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+typedef int8_t   int8;
+typedef int16_t  int16;
+typedef int32_t  int32;
+typedef uint8_t  uint8;
+typedef uint16_t uint16;
+typedef uint32_t uint32;
+
+// accumulator tags, as in aie::accum<acc80, 8>
+struct acc48 {};
+struct acc80 {};
+
+// chess scheduling pragmas are meaningless on the host
+#define chess_prepare_for_pipelining
+#define chess_flatten_loop
+#define chess_unroll_loop(...)
+#define chess_loop_range(...)
+#define chess_storage(...)
+#define chess_protect_access
+#define chess_copy(x) (x)
+
+namespace aie_emu {
+
+template <typename Tag> struct acc_traits;
+template <> struct acc_traits<acc48> { using storage = int64_t;  static constexpr unsigned bits = 48; };
+template <> struct acc_traits<acc80> { using storage = __int128; static constexpr unsigned bits = 80; };
+
+template <typename T> struct is_acc_tag : std::false_type {};
+template <> struct is_acc_tag<acc48> : std::true_type {};
+template <> struct is_acc_tag<acc80> : std::true_type {};
+
+// Accumulator used by the hardware for a product of A and B: anything with a
+// 32-bit operand needs the 80-bit lanes, narrower products fit in 48 bits.
+template <typename A, typename B>
+using acc_for = std::conditional_t<(sizeof(A) == 4 || sizeof(B) == 4), acc80, acc48>;
+
+// make_unsigned that also covers __int128 under strict -std=c++17
+template <typename S> struct unsigned_of { using type = std::make_unsigned_t<S>; };
+template <> struct unsigned_of<__int128> { using type = unsigned __int128; };
+
+// Sign-extend the low `bits` of v, i.e. wrap to the accumulator width.
+template <typename S>
+inline S wrap_bits(S v, unsigned bits)
+{
+    using U = typename unsigned_of<S>::type;
+    const unsigned sh = sizeof(S) * 8 - bits;
+    return static_cast<S>(static_cast<U>(v) << sh) >> sh;
+}
+
+inline unsigned nibble(unsigned word, unsigned i) { return (word >> (4 * i)) & 0xf; }
+
+inline unsigned wrap_index(int idx, unsigned n) { return static_cast<unsigned>(((idx % int(n)) + int(n)) % int(n)); }
+
+/*
+ *  Lane/column index functions. `lane` is the accumulator lane and `col` the
+ *  column being summed into it; results are element indices before wrapping
+ *  to the buffer size.
+ */
+
+// 32b general scheme: start + offsets[lane] + step*col
+inline int index_general(int start, unsigned offsets, int step, unsigned lane, unsigned col)
+{
+    return start + int(nibble(offsets, lane)) + step * int(col);
+}
+
+// 16b x 16b scheme, xbuff side. Offsets are in 32-bit (two element) units;
+// each odd lane is relative to the lane before it + 1. Columns come in pairs
+// that form a 2x2 square with the neighbouring lane, permuted by xsquare.
+inline int index_16b_x(int start, unsigned offsets, unsigned offsets_hi, int step, unsigned square,
+                       unsigned lane, unsigned col)
+{
+    auto off = [&](unsigned r) { return int(r < 8 ? nibble(offsets, r) : nibble(offsets_hi, r - 8)); };
+    const unsigned even = lane & ~1u;
+    const int base_e = 2 * off(even);
+    const int base_o = 2 * off(even + 1) + 2 * (off(even) + 1);
+    const unsigned sel = nibble(square, 2 * (lane & 1) + (col & 1));
+    return start + (sel < 2 ? base_e : base_o) + int(sel & 1) + int(col / 2) * step;
+}
+
+// 16b x 16b scheme, zbuff side: start + offsets[lane] + step*col
+inline int index_16b_z(int start, unsigned offsets, unsigned offsets_hi, int step, unsigned lane, unsigned col)
+{
+    const int off = int(lane < 8 ? nibble(offsets, lane) : nibble(offsets_hi, lane - 8));
+    return start + off + step * int(col);
+}
+
+// 16b x 8b scheme, zbuff side: one offset per lane in byte pairs, the two
+// bytes of a column pair permuted by zsquare, column pairs step by zstep.
+// zoffsets 0, zsquare 0x3210 and zstep 2 broadcast z[start + col] to all lanes.
+inline int index_16x8_z(int start, unsigned offsets, unsigned offsets_hi, int step, unsigned square,
+                        unsigned lane, unsigned col)
+{
+    const int off = int(lane < 8 ? nibble(offsets, lane) : nibble(offsets_hi, lane - 8));
+    return start + 2 * off + int(nibble(square, col & 1) & 1) + int(col / 2) * step;
+}
+
+// 8b x 8b scheme, xbuff side. One offset per lane pair in 32-bit (four byte)
+// units, odd pairs relative to the pair before + 1. The pair reads a 2x2
+// square of bytes per column pair, permuted by xsquare; col pairs step by xstep.
+// xsquare 0x3120 gives 8x8_data_scheme.py: lane 0 reads 0 2 16 18 at xstep 16.
+inline int index_8b_x(int start, unsigned offsets, int step, unsigned square, unsigned lane, unsigned col)
+{
+    const unsigned p = lane / 2;
+    int base = 4 * int(nibble(offsets, p));
+    if (p & 1)
+        base += 4 * (int(nibble(offsets, p - 1)) + 1);
+    const unsigned sel = nibble(square, 2 * (lane & 1) + (col & 1));
+    return start + base + int(sel) + int(col / 2) * step;
+}
+
+// 8b x 8b scheme, zbuff side. One offset per lane pair in 16-bit units, both
+// lanes of a pair read the same byte pair, column pairs step by zstep.
+inline int index_8b_z(int start, unsigned offsets, int step, unsigned square, unsigned lane, unsigned col)
+{
+    const unsigned p = lane / 2;
+    const unsigned sel = nibble(square, 2 * (lane & 1) + (col & 1));
+    return start + 2 * int(nibble(offsets, p)) + int(sel & 1) + int(col / 2) * step;
+}
+
+} // namespace aie_emu
+
+namespace aie {
+
+enum class rounding_mode { floor, ceil, positive_inf, negative_inf, symmetric_inf, symmetric_zero, conv_even, conv_odd };
+enum class saturation_mode { none, truncate, saturate, symmetric };
+
+namespace detail {
+inline rounding_mode   &rounding()   { static rounding_mode m = rounding_mode::floor; return m; }
+inline saturation_mode &saturation() { static saturation_mode m = saturation_mode::none; return m; }
+} // namespace detail
+
+inline void set_rounding(rounding_mode m)     { detail::rounding() = m; }
+inline void set_saturation(saturation_mode m) { detail::saturation() = m; }
+inline rounding_mode   get_rounding()   { return detail::rounding(); }
+inline saturation_mode get_saturation() { return detail::saturation(); }
+
+template <typename T, unsigned N>
+class vector {
+public:
+    using value_type = T;
+    static constexpr unsigned size() { return N; }
+
+    vector() : v_{} {}
+
+    T get(unsigned i) const { return v_[i]; }
+    vector &set(T x, unsigned i) { v_[i] = x; return *this; }
+    T &operator[](unsigned i) { return v_[i]; }
+    const T &operator[](unsigned i) const { return v_[i]; }
+    T *data() { return v_.data(); }
+    const T *data() const { return v_.data(); }
+
+    template <unsigned M>
+    vector<T, M> extract(unsigned idx) const
+    {
+        vector<T, M> r;
+        for (unsigned i = 0; i < M; ++i)
+            r[i] = v_[idx * M + i];
+        return r;
+    }
+
+    template <unsigned M>
+    vector &insert(unsigned idx, const vector<T, M> &x)
+    {
+        for (unsigned i = 0; i < M; ++i)
+            v_[idx * M + i] = x[i];
+        return *this;
+    }
+
+    template <unsigned M>
+    vector<T, M> grow(unsigned idx = 0) const
+    {
+        vector<T, M> r;
+        for (unsigned i = 0; i < N; ++i)
+            r[idx * N + i] = v_[i];
+        return r;
+    }
+
+private:
+    std::array<T, N> v_;
+};
+
+template <typename Tag, unsigned N>
+class accum {
+public:
+    using storage = typename aie_emu::acc_traits<Tag>::storage;
+    static constexpr unsigned bits = aie_emu::acc_traits<Tag>::bits;
+    static constexpr unsigned size() { return N; }
+
+    accum() : a_{} {}
+
+    storage get(unsigned i) const { return a_[i]; }
+    accum &set(storage x, unsigned i) { a_[i] = aie_emu::wrap_bits(x, bits); return *this; }
+
+    // srs: shift right with the current rounding mode, then saturate or wrap
+    template <typename T>
+    vector<T, N> to_vector(int shift = 0) const
+    {
+        vector<T, N> r;
+        for (unsigned i = 0; i < N; ++i)
+            r[i] = narrow<T>(round_shift(a_[i], shift));
+        return r;
+    }
+
+    // ups: load a vector, shifted left by `shift`
+    template <typename T>
+    accum &from_vector(const vector<T, N> &v, int shift = 0)
+    {
+        for (unsigned i = 0; i < N; ++i)
+            a_[i] = aie_emu::wrap_bits(static_cast<storage>(v[i]) << shift, bits);
+        return *this;
+    }
+
+    template <typename T>
+    accum(const vector<T, N> &v, int shift = 0) { from_vector(v, shift); }
+
+    static storage round_shift(storage v, int s)
+    {
+        if (s <= 0)
+            return v;
+        const storage one = 1, half = one << (s - 1);
+        const storage q = v >> s, rem = v & ((one << s) - 1);
+        switch (get_rounding()) {
+        case rounding_mode::floor:          return q;
+        case rounding_mode::ceil:           return rem ? q + 1 : q;
+        case rounding_mode::positive_inf:   return rem >= half ? q + 1 : q;
+        case rounding_mode::negative_inf:   return rem > half ? q + 1 : q;
+        case rounding_mode::symmetric_inf:  return (rem > half || (rem == half && v >= 0)) ? q + 1 : q;
+        case rounding_mode::symmetric_zero: return (rem > half || (rem == half && v < 0)) ? q + 1 : q;
+        case rounding_mode::conv_even:      return (rem > half || (rem == half && (q & 1))) ? q + 1 : q;
+        case rounding_mode::conv_odd:       return (rem > half || (rem == half && !(q & 1))) ? q + 1 : q;
+        }
+        return q;
+    }
+
+    template <typename T>
+    static T narrow(storage v)
+    {
+        const storage lo = std::numeric_limits<T>::min(), hi = std::numeric_limits<T>::max();
+        switch (get_saturation()) {
+        case saturation_mode::saturate:  return static_cast<T>(v < lo ? lo : v > hi ? hi : v);
+        case saturation_mode::symmetric: return static_cast<T>(v < -hi ? -hi : v > hi ? hi : v);
+        default:                         return static_cast<T>(static_cast<std::make_unsigned_t<T>>(v));
+        }
+    }
+
+private:
+    std::array<storage, N> a_;
+};
+
+template <unsigned N>
+class mask {
+public:
+    constexpr mask() : bits_(0) {}
+    constexpr explicit mask(uint64_t bits) : bits_(bits) {}
+    static constexpr mask from_uint32(uint32_t b) { return mask(b); }
+    constexpr bool test(unsigned i) const { return (bits_ >> i) & 1; }
+    static constexpr unsigned size() { return N; }
+
+private:
+    uint64_t bits_;
+};
+
+template <typename T, unsigned N>
+auto zeros()
+{
+    if constexpr (aie_emu::is_acc_tag<T>::value)
+        return accum<T, N>();
+    else
+        return vector<T, N>();
+}
+
+template <typename T, unsigned N>
+vector<T, N> broadcast(T x)
+{
+    vector<T, N> r;
+    for (unsigned i = 0; i < N; ++i)
+        r[i] = x;
+    return r;
+}
+
+template <unsigned N, typename T>
+vector<std::remove_const_t<T>, N> load_v(T *p)
+{
+    vector<std::remove_const_t<T>, N> r;
+    std::memcpy(r.data(), p, sizeof(T) * N);
+    return r;
+}
+
+template <typename T, unsigned N>
+void store_v(T *p, const vector<T, N> &v)
+{
+    std::memcpy(p, v.data(), sizeof(T) * N);
+}
+
+template <typename T, unsigned N, typename... Rest>
+vector<T, N * (1 + sizeof...(Rest))> concat(const vector<T, N> &first, const Rest &...rest)
+{
+    vector<T, N * (1 + sizeof...(Rest))> r;
+    unsigned idx = 0;
+    r.insert(idx++, first);
+    (r.insert(idx++, rest), ...);
+    return r;
+}
+
+template <typename T, unsigned N>
+vector<T, N> select(const vector<T, N> &a, const vector<T, N> &b, const mask<N> &m)
+{
+    vector<T, N> r;
+    for (unsigned i = 0; i < N; ++i)
+        r[i] = m.test(i) ? b[i] : a[i];
+    return r;
+}
+
+// elementwise on two vectors, or a vector and a scalar on either side
+#define AIE_EMU_ELEMENTWISE(name, expr)                                                              \
+    template <typename T, unsigned N>                                                                \
+    vector<T, N> name(const vector<T, N> &a, const vector<T, N> &b)                                  \
+    {                                                                                                \
+        vector<T, N> r;                                                                              \
+        for (unsigned i = 0; i < N; ++i)                                                             \
+            r[i] = static_cast<T>(expr);                                                             \
+        return r;                                                                                    \
+    }                                                                                                \
+    template <typename T, unsigned N, typename S, typename = std::enable_if_t<std::is_arithmetic_v<S>>> \
+    vector<T, N> name(const vector<T, N> &a, S b) { return name(a, broadcast<T, N>(static_cast<T>(b))); } \
+    template <typename T, unsigned N, typename S, typename = std::enable_if_t<std::is_arithmetic_v<S>>> \
+    vector<T, N> name(S a, const vector<T, N> &b) { return name(broadcast<T, N>(static_cast<T>(a)), b); }
+
+AIE_EMU_ELEMENTWISE(add, a[i] + b[i])
+AIE_EMU_ELEMENTWISE(sub, a[i] - b[i])
+AIE_EMU_ELEMENTWISE(max, a[i] > b[i] ? a[i] : b[i])
+AIE_EMU_ELEMENTWISE(min, a[i] < b[i] ? a[i] : b[i])
+AIE_EMU_ELEMENTWISE(bit_and, a[i] & b[i])
+AIE_EMU_ELEMENTWISE(bit_or, a[i] | b[i])
+AIE_EMU_ELEMENTWISE(bit_xor, a[i] ^ b[i])
+
+#undef AIE_EMU_ELEMENTWISE
+
+// comparisons into a lane mask
+#define AIE_EMU_COMPARE(name, op)                                                                    \
+    template <typename T, unsigned N>                                                                \
+    mask<N> name(const vector<T, N> &a, const vector<T, N> &b)                                       \
+    {                                                                                                \
+        uint64_t bits = 0;                                                                           \
+        for (unsigned i = 0; i < N; ++i)                                                             \
+            bits |= uint64_t(a[i] op b[i]) << i;                                                     \
+        return mask<N>(bits);                                                                        \
+    }                                                                                                \
+    template <typename T, unsigned N, typename S, typename = std::enable_if_t<std::is_arithmetic_v<S>>> \
+    mask<N> name(const vector<T, N> &a, S b) { return name(a, broadcast<T, N>(static_cast<T>(b))); }
+
+AIE_EMU_COMPARE(lt, <)
+AIE_EMU_COMPARE(le, <=)
+AIE_EMU_COMPARE(gt, >)
+AIE_EMU_COMPARE(ge, >=)
+AIE_EMU_COMPARE(eq, ==)
+AIE_EMU_COMPARE(neq, !=)
+
+#undef AIE_EMU_COMPARE
+
+// arithmetic shifts of every lane by the same amount
+template <typename T, unsigned N>
+vector<T, N> downshift(const vector<T, N> &v, unsigned shift)
+{
+    vector<T, N> r;
+    for (unsigned i = 0; i < N; ++i)
+        r[i] = static_cast<T>(v[i] >> shift);
+    return r;
+}
+
+template <typename T, unsigned N>
+vector<T, N> upshift(const vector<T, N> &v, unsigned shift)
+{
+    vector<T, N> r;
+    for (unsigned i = 0; i < N; ++i)
+        r[i] = static_cast<T>(static_cast<std::make_unsigned_t<T>>(v[i]) << shift);
+    return r;
+}
+
+template <typename T, unsigned N>
+T reduce_add(const vector<T, N> &v)
+{
+    T s = 0;
+    for (unsigned i = 0; i < N; ++i)
+        s = static_cast<T>(s + v[i]);
+    return s;
+}
+
+template <typename T, unsigned N>
+T reduce_max(const vector<T, N> &v)
+{
+    T m = v[0];
+    for (unsigned i = 1; i < N; ++i)
+        m = v[i] > m ? v[i] : m;
+    return m;
+}
+
+// elementwise products into the accumulator width the hardware would use
+template <typename A, typename B, unsigned N>
+accum<aie_emu::acc_for<A, B>, N> mul(const vector<A, N> &a, const vector<B, N> &b)
+{
+    accum<aie_emu::acc_for<A, B>, N> r;
+    for (unsigned i = 0; i < N; ++i)
+        r.set(static_cast<int64_t>(a[i]) * b[i], i);
+    return r;
+}
+
+template <typename A, typename B, unsigned N, typename = std::enable_if_t<std::is_arithmetic_v<B>>>
+accum<aie_emu::acc_for<A, B>, N> mul(const vector<A, N> &a, B b)
+{
+    return mul(a, broadcast<B, N>(b));
+}
+
+template <typename Tag, typename A, typename B, unsigned N>
+accum<Tag, N> mac(const accum<Tag, N> &acc, const vector<A, N> &a, const vector<B, N> &b)
+{
+    accum<Tag, N> r;
+    for (unsigned i = 0; i < N; ++i)
+        r.set(acc.get(i) + static_cast<int64_t>(a[i]) * b[i], i);
+    return r;
+}
+
+template <typename Tag, typename A, typename B, unsigned N, typename = std::enable_if_t<std::is_arithmetic_v<B>>>
+accum<Tag, N> mac(const accum<Tag, N> &acc, const vector<A, N> &a, B b)
+{
+    return mac(acc, a, broadcast<B, N>(b));
+}
+
+// int8 -> int16 / int16 -> int32 widening
+template <typename T, unsigned N>
+auto unpack(const vector<T, N> &v)
+{
+    using W = std::conditional_t<sizeof(T) == 1, int16, int32>;
+    vector<W, N> r;
+    for (unsigned i = 0; i < N; ++i)
+        r[i] = v[i];
+    return r;
+}
+
+// int16 -> int8 / int32 -> int16 narrowing, saturating
+template <typename T, unsigned N>
+auto pack(const vector<T, N> &v)
+{
+    using H = std::conditional_t<sizeof(T) == 2, int8, int16>;
+    vector<H, N> r;
+    for (unsigned i = 0; i < N; ++i)
+        r[i] = static_cast<H>(v[i] < std::numeric_limits<H>::min() ? std::numeric_limits<H>::min()
+                              : v[i] > std::numeric_limits<H>::max() ? std::numeric_limits<H>::max() : v[i]);
+    return r;
+}
+
+/*
+ *  aie::mmul<M, K, N, TA, TB>: C(MxN) = A(MxK) * B(KxN), all row-major.
+ */
+template <unsigned M, unsigned K, unsigned N, typename TA, typename TB>
+class mmul {
+public:
+    static constexpr unsigned size_A = M * K;
+    static constexpr unsigned size_B = K * N;
+    static constexpr unsigned size_C = M * N;
+    using accum_type = accum<aie_emu::acc_for<TA, TB>, size_C>;
+
+    mmul() = default;
+
+    void mul(const vector<TA, size_A> &a, const vector<TB, size_B> &b) { c_ = accum_type(); mac(a, b); }
+
+    void mac(const vector<TA, size_A> &a, const vector<TB, size_B> &b)
+    {
+        for (unsigned m = 0; m < M; ++m)
+            for (unsigned n = 0; n < N; ++n) {
+                typename accum_type::storage s = c_.get(m * N + n);
+                for (unsigned k = 0; k < K; ++k)
+                    s += static_cast<int64_t>(a[m * K + k]) * b[k * N + n];
+                c_.set(s, m * N + n);
+            }
+    }
+
+    template <typename T>
+    vector<T, size_C> to_vector(int shift = 0) const { return c_.template to_vector<T>(shift); }
+
+    const accum_type &to_accum() const { return c_; }
+
+private:
+    accum_type c_;
+};
+
+/*
+ *  The tile cycle counter. On the host this is wall-clock nanoseconds, so the
+ *  kernels' "total = N" printouts are host time, not AIE cycles.
+ */
+class tile {
+public:
+    static tile current() { return tile(); }
+    uint64_t cycles() const
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+};
+
+} // namespace aie
+
+// native vector/accumulator type names
+typedef aie::vector<int32, 4>   v4int32;
+typedef aie::vector<int32, 8>   v8int32;
+typedef aie::vector<int32, 16>  v16int32;
+typedef aie::vector<int32, 32>  v32int32;
+typedef aie::vector<int16, 8>   v8int16;
+typedef aie::vector<int16, 16>  v16int16;
+typedef aie::vector<int16, 32>  v32int16;
+typedef aie::vector<int16, 64>  v64int16;
+typedef aie::vector<int8, 16>   v16int8;
+typedef aie::vector<int8, 32>   v32int8;
+typedef aie::vector<int8, 64>   v64int8;
+typedef aie::vector<int8, 128>  v128int8;
+typedef aie::accum<acc80, 4>    v4acc80;
+typedef aie::accum<acc80, 8>    v8acc80;
+typedef aie::accum<acc48, 8>    v8acc48;
+typedef aie::accum<acc48, 16>   v16acc48;
+
+namespace aie_emu {
+
+// acc[lane] (+|-)= sum over cols of x[xi(lane, col)] * z[zi(lane, col)]
+template <unsigned Lanes, unsigned Cols, int Sign, typename Tag, typename TX, unsigned NX, typename TZ,
+          unsigned NZ, typename XI, typename ZI>
+aie::accum<Tag, Lanes> mac_scheme(const aie::accum<Tag, Lanes> &acc, const aie::vector<TX, NX> &x,
+                                  const aie::vector<TZ, NZ> &z, XI xi, ZI zi)
+{
+    aie::accum<Tag, Lanes> r;
+    for (unsigned lane = 0; lane < Lanes; ++lane) {
+        typename aie::accum<Tag, Lanes>::storage s = 0;
+        for (unsigned col = 0; col < Cols; ++col)
+            s += static_cast<int64_t>(x[wrap_index(xi(lane, col), NX)]) * z[wrap_index(zi(lane, col), NZ)];
+        r.set(Sign == 0 ? s : Sign > 0 ? acc.get(lane) + s : acc.get(lane) - s, lane);
+    }
+    return r;
+}
+
+} // namespace aie_emu
+
+/*
+ *  32b general scheme: lmul8/lmac8/lmsc8 (8 lanes x 1 column) and
+ *  lmul4/lmac4/lmsc4 (4 lanes x 2 columns).
+ */
+#define AIE_EMU_LMAC8(name, sign)                                                                        \
+    template <typename TX, unsigned NX, typename TZ, unsigned NZ>                                        \
+    v8acc80 name(const v8acc80 &acc, const aie::vector<TX, NX> &xbuff, int xstart, unsigned xoffsets,    \
+                 const aie::vector<TZ, NZ> &zbuff, int zstart, unsigned zoffsets)                        \
+    {                                                                                                    \
+        return aie_emu::mac_scheme<8, 1, sign>(                                                          \
+            acc, xbuff, zbuff,                                                                           \
+            [&](unsigned l, unsigned c) { return aie_emu::index_general(xstart, xoffsets, 0, l, c); },  \
+            [&](unsigned l, unsigned c) { return aie_emu::index_general(zstart, zoffsets, 0, l, c); }); \
+    }
+
+AIE_EMU_LMAC8(lmac8, 1)
+AIE_EMU_LMAC8(lmsc8, -1)
+#undef AIE_EMU_LMAC8
+
+template <typename TX, unsigned NX, typename TZ, unsigned NZ>
+v8acc80 lmul8(const aie::vector<TX, NX> &xbuff, int xstart, unsigned xoffsets,
+              const aie::vector<TZ, NZ> &zbuff, int zstart, unsigned zoffsets)
+{
+    return lmac8(v8acc80(), xbuff, xstart, xoffsets, zbuff, zstart, zoffsets);
+}
+
+#define AIE_EMU_LMAC4(name, sign)                                                                              \
+    template <typename TX, unsigned NX, typename TZ, unsigned NZ>                                              \
+    v4acc80 name(const v4acc80 &acc, const aie::vector<TX, NX> &xbuff, int xstart, unsigned xoffsets,          \
+                 int xstep, const aie::vector<TZ, NZ> &zbuff, int zstart, unsigned zoffsets, int zstep)        \
+    {                                                                                                          \
+        return aie_emu::mac_scheme<4, 2, sign>(                                                                \
+            acc, xbuff, zbuff,                                                                                 \
+            [&](unsigned l, unsigned c) { return aie_emu::index_general(xstart, xoffsets, xstep, l, c); },   \
+            [&](unsigned l, unsigned c) { return aie_emu::index_general(zstart, zoffsets, zstep, l, c); });  \
+    }
+
+AIE_EMU_LMAC4(lmac4, 1)
+AIE_EMU_LMAC4(lmsc4, -1)
+#undef AIE_EMU_LMAC4
+
+template <typename TX, unsigned NX, typename TZ, unsigned NZ>
+v4acc80 lmul4(const aie::vector<TX, NX> &xbuff, int xstart, unsigned xoffsets, int xstep,
+              const aie::vector<TZ, NZ> &zbuff, int zstart, unsigned zoffsets, int zstep)
+{
+    return lmac4(v4acc80(), xbuff, xstart, xoffsets, xstep, zbuff, zstart, zoffsets, zstep);
+}
+
+/*
+ *  16b x 16b scheme: mul16/mac16 (16 lanes x 2 columns).
+ */
+template <unsigned NX, unsigned NZ>
+v16acc48 mac16(const v16acc48 &acc, const aie::vector<int16, NX> &xbuff, int xstart, unsigned xoffsets,
+               unsigned xoffsets_hi, unsigned xsquare, const aie::vector<int16, NZ> &zbuff, int zstart,
+               unsigned zoffsets, unsigned zoffsets_hi, int zstep)
+{
+    return aie_emu::mac_scheme<16, 2, 1>(
+        acc, xbuff, zbuff,
+        [&](unsigned l, unsigned c) { return aie_emu::index_16b_x(xstart, xoffsets, xoffsets_hi, 0, xsquare, l, c); },
+        [&](unsigned l, unsigned c) { return aie_emu::index_16b_z(zstart, zoffsets, zoffsets_hi, zstep, l, c); });
+}
+
+template <unsigned NX, unsigned NZ>
+v16acc48 mul16(const aie::vector<int16, NX> &xbuff, int xstart, unsigned xoffsets, unsigned xoffsets_hi,
+               unsigned xsquare, const aie::vector<int16, NZ> &zbuff, int zstart, unsigned zoffsets,
+               unsigned zoffsets_hi, int zstep)
+{
+    return mac16(v16acc48(), xbuff, xstart, xoffsets, xoffsets_hi, xsquare, zbuff, zstart, zoffsets, zoffsets_hi,
+                 zstep);
+}
+
+/*
+ *  16b x 8b scheme: mul16/mac16 with an int16 xbuff and an int8 zbuff (16
+ *  lanes x 4 columns). xbuff is addressed as in the 16b x 16b scheme, its
+ *  column pairs stepped by xstep.
+ */
+template <unsigned NX, unsigned NZ>
+v16acc48 mac16(const v16acc48 &acc, const aie::vector<int16, NX> &xbuff, int xstart, unsigned xoffsets,
+               unsigned xoffsets_hi, int xstep, unsigned xsquare, const aie::vector<int8, NZ> &zbuff, int zstart,
+               unsigned zoffsets, unsigned zoffsets_hi, int zstep, unsigned zsquare)
+{
+    return aie_emu::mac_scheme<16, 4, 1>(
+        acc, xbuff, zbuff,
+        [&](unsigned l, unsigned c) {
+            return aie_emu::index_16b_x(xstart, xoffsets, xoffsets_hi, xstep, xsquare, l, c);
+        },
+        [&](unsigned l, unsigned c) {
+            return aie_emu::index_16x8_z(zstart, zoffsets, zoffsets_hi, zstep, zsquare, l, c);
+        });
+}
+
+template <unsigned NX, unsigned NZ>
+v16acc48 mul16(const aie::vector<int16, NX> &xbuff, int xstart, unsigned xoffsets, unsigned xoffsets_hi, int xstep,
+               unsigned xsquare, const aie::vector<int8, NZ> &zbuff, int zstart, unsigned zoffsets,
+               unsigned zoffsets_hi, int zstep, unsigned zsquare)
+{
+    return mac16(v16acc48(), xbuff, xstart, xoffsets, xoffsets_hi, xstep, xsquare, zbuff, zstart, zoffsets,
+                 zoffsets_hi, zstep, zsquare);
+}
+
+/*
+ *  8b x 8b scheme: mul16/mac16 (16 lanes x 8 columns) and mul8/mac8
+ *  (8 lanes x 16 columns).
+ */
+template <unsigned NX, unsigned NZ>
+v16acc48 mac16(const v16acc48 &acc, const aie::vector<int8, NX> &xbuff, int xstart, unsigned xoffsets, int xstep,
+               unsigned xsquare, const aie::vector<int8, NZ> &zbuff, int zstart, unsigned zoffsets, int zstep)
+{
+    return aie_emu::mac_scheme<16, 8, 1>(
+        acc, xbuff, zbuff,
+        [&](unsigned l, unsigned c) { return aie_emu::index_8b_x(xstart, xoffsets, xstep, xsquare, l, c); },
+        [&](unsigned l, unsigned c) { return aie_emu::index_8b_z(zstart, zoffsets, zstep, 0x3210, l, c); });
+}
+
+template <unsigned NX, unsigned NZ>
+v16acc48 mul16(const aie::vector<int8, NX> &xbuff, int xstart, unsigned xoffsets, int xstep, unsigned xsquare,
+               const aie::vector<int8, NZ> &zbuff, int zstart, unsigned zoffsets, int zstep)
+{
+    return mac16(v16acc48(), xbuff, xstart, xoffsets, xstep, xsquare, zbuff, zstart, zoffsets, zstep);
+}
+
+template <unsigned NX, unsigned NZ>
+v8acc48 mac8(const v8acc48 &acc, const aie::vector<int8, NX> &xbuff, int xstart, unsigned xoffsets, int xstep,
+             unsigned xsquare, const aie::vector<int8, NZ> &zbuff, int zstart, unsigned zoffsets, int zstep,
+             unsigned zsquare)
+{
+    return aie_emu::mac_scheme<8, 16, 1>(
+        acc, xbuff, zbuff,
+        [&](unsigned l, unsigned c) { return aie_emu::index_8b_x(xstart, xoffsets, xstep, xsquare, l, c); },
+        [&](unsigned l, unsigned c) { return aie_emu::index_8b_z(zstart, zoffsets, zstep, zsquare, l, c); });
+}
+
+template <unsigned NX, unsigned NZ>
+v8acc48 mul8(const aie::vector<int8, NX> &xbuff, int xstart, unsigned xoffsets, int xstep, unsigned xsquare,
+             const aie::vector<int8, NZ> &zbuff, int zstart, unsigned zoffsets, int zstep, unsigned zsquare)
+{
+    return mac8(v8acc48(), xbuff, xstart, xoffsets, xstep, xsquare, zbuff, zstart, zoffsets, zstep, zsquare);
+}
+
+#endif // AIE_EMU_H
@@ -0,0 +1,2 @@
+// Host emulation: forwards to the ADF/AIE API stand-ins.
+#include "../../../adf_emu.h"
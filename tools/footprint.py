@@ -0,0 +1,361 @@
+"""
+Static tile data memory footprint of a kernel configuration.
+
+Whether a configuration fits a tile is otherwise found out when aiecompiler
+fails to map it. This adds up what the compiler places in the 32 KB data
+memory of the kernel's tile, before compiling:
+
+  weights   const: the matrix.h / matrix_packed.h array, K*N elements.
+            rtp:   the async run-time parameter (WEIGHTS=rtp), double
+                   buffered, so twice that.
+            stream: none resident; the weights come in over a 32-bit stream
+                   every invocation, which bounds the kernel at K*N*size/4
+                   cycles per batch of inputs. A what-if: no kernel
+                   implements it yet.
+            chunked: GemV8SplitK (--chunk KC), KC x N weight rows per
+                   invocation in a double buffered window, whatever K is.
+  bias      N int32 (hls4ml Dense layers).
+  windows   window<NB*K*size> in and window<NB*N*size> out, NB inputs per
+            invocation, each double buffered (ping-pong).
+  heap      --aie.heapsize (2048 in the gemv_i32 and gemm_i32 Makefiles).
+  stack     the aiecompiler default, 1024.
+
+Every buffer is rounded up to the 32-byte alignment the vector loads need.
+--weights auto keeps the weights on the tile when they fit and otherwise falls
+back to the split-K kernel (int32, NB 1) with the largest chunk that fits. --max n|k|batch finds the largest value of that dimension, at the
+granularity of the kernels, that still fits. autotune.py, bench.py and
+hls4ml_aie.py take their memory numbers from here. placement.py takes the
+static data of each kernel of a graph from static_data(): the const arrays its
+source and the headers it includes define, such as matrix.h.
+
+How to run:
+python tools/footprint.py gemv --k 64 --n 64                        # int32, const weights, NB 1
+python tools/footprint.py gemv --k 128 --n 128 --weights auto --batch 4
+python tools/footprint.py gemv --k 64 --max n --weights rtp
+python tools/footprint.py gemv --k 64 --n 64 --max batch --heap-from gemv_i32/Makefile
+python tools/footprint.py gemv --k 128 --n 64 --dtype int16 --x-dtype int8  # gemv_mixed MIX=a8w16
+python tools/footprint.py gemv --k 4096 --n 16 --chunk 64                   # gemv_i32 SPLITK=1
+python tools/footprint.py gemm --m 32 --k 32 --n 32
+"""
+
+import argparse
+import os
+import re
+import sys
+from dataclasses import dataclass, field
+
+TILE_MEMORY = 32 * 1024     # AIE1 data memory per tile
+HEAP = 2048                 # --aie.heapsize of the gemv_i32 / gemm_i32 Makefiles
+HEAP_DEFAULT = 1024         # aiecompiler default, when a Makefile sets none
+STACK = 1024                # aiecompiler default stack
+PING_PONG = 2               # windows are double buffered
+ALIGN = 32                  # 256-bit vector loads
+STREAM_BYTES = 4            # bytes per cycle of one 32-bit AXI stream port
+ACC80_V8 = 80               # one v8acc80 kept in memory
+
+SIZE = {"int8": 1, "int16": 2, "int32": 4}
+# K and N granularity of the GemV kernels per dtype
+STEP = {"int32": (8, 16), "int16": (16, 16), "int8": (16, 16)}
+WEIGHT_MODES = ("const", "rtp", "stream")
+
+
+def align(nbytes):
+    return -(-nbytes // ALIGN) * ALIGN
+
+
+@dataclass
+class Footprint:
+    items: list = field(default_factory=list)   # (name, bytes)
+    stream_cycles: int = 0                      # weight stream bound per invocation
+    weights: str = "const"
+    chunk: int = 0                              # split-K inputs per invocation
+
+    def add(self, name, nbytes):
+        if nbytes:
+            self.items.append((name, align(nbytes)))
+        return self
+
+    @property
+    def total(self):
+        return sum(b for _, b in self.items)
+
+    def fits(self, memory=TILE_MEMORY):
+        return self.total <= memory
+
+
+def gemv(k, n, dtype="int32", batch=1, weights="const", bias=False, heap=HEAP, stack=STACK, out_dtype=None,
+         x_dtype=None):
+    """Footprint of one GemV tile: K inputs, N outputs, NB=batch inputs per invocation.
+
+    dtype is the weight type. x_dtype (inputs) defaults to it and out_dtype
+    to x_dtype, as in gemv_mixed.
+    """
+    if weights not in WEIGHT_MODES:
+        raise ValueError(f"weight mode {weights}: expected one of {', '.join(WEIGHT_MODES)}")
+    x_dtype = x_dtype or dtype
+    size, x_size, out_size = SIZE[dtype], SIZE[x_dtype], SIZE[out_dtype or x_dtype]
+    w = k * n * size
+    fp = Footprint(weights=weights)
+    fp.add("weights", {"const": w, "rtp": 2 * w, "stream": 0}[weights])
+    if bias:
+        fp.add("bias", n * 4)
+    for _ in range(PING_PONG):
+        fp.add("input window", batch * k * x_size)
+    for _ in range(PING_PONG):
+        fp.add("output window", batch * n * out_size)
+    fp.add("heap", heap).add("stack", stack)
+    if weights == "stream":
+        fp.stream_cycles = -(-w // STREAM_BYTES)
+    return fp
+
+
+def split_k(k, n, chunk, heap=HEAP, stack=STACK):
+    """Footprint of GemV8SplitK: K int32 inputs CHUNK at a time, with their weight rows.
+
+    Only the chunk windows and the accumulators carried between invocations
+    live on the tile, so it does not depend on K. y leaves on a stream.
+    """
+    if k % chunk or chunk % STEP["int32"][0]:
+        raise ValueError(f"--chunk {chunk}: must be a multiple of 8 that divides K={k}")
+    fp = Footprint(weights="chunked", chunk=chunk)
+    for _ in range(PING_PONG):
+        fp.add("input window", chunk * 4)
+    for _ in range(PING_PONG):
+        fp.add("weight window", chunk * n * 4)
+    fp.add("accumulators", n // 8 * ACC80_V8)
+    fp.add("heap", heap).add("stack", stack)
+    fp.stream_cycles = -(-chunk * n * 4 // STREAM_BYTES)
+    return fp
+
+
+def fused(shapes, heap=HEAP, stack=STACK):
+    """Footprint of a gemv::mlp8 tile: int32 Dense layers [(k, n), ...] chained in one kernel.
+
+    Every layer's weights and bias stay resident; the layers in between pass
+    their activations through two buffers as wide as the widest layer.
+    """
+    fp = Footprint()
+    for k, n in shapes:
+        fp.add("weights", k * n * 4)
+        fp.add("bias", n * 4)
+    if len(shapes) > 1:
+        for _ in range(2):
+            fp.add("activations", max(n for _, n in shapes) * 4)
+    for _ in range(PING_PONG):
+        fp.add("input window", shapes[0][0] * 4)
+    for _ in range(PING_PONG):
+        fp.add("output window", shapes[-1][1] * 4)
+    return fp.add("heap", heap).add("stack", stack)
+
+
+def gemm(m, k, n, heap=HEAP, stack=STACK):
+    """Footprint of one GEMM tile: A (MxK), B (KxN) and C (MxN) int32 windows."""
+    fp = Footprint()
+    for name, elems in (("A window", m * k), ("B window", k * n), ("C window", m * n)):
+        for _ in range(PING_PONG):
+            fp.add(name, elems * 4)
+    return fp.add("heap", heap).add("stack", stack)
+
+
+def choose(k, n, dtype="int32", batch=1, memory=TILE_MEMORY, **kw):
+    """Weights on the tile when they fit, else split-K with the largest chunk that fits;
+    (Footprint, reason) or (None, reason)."""
+    fp = gemv(k, n, dtype, batch, "const", **kw)
+    if fp.fits(memory):
+        return fp, "weights fit on the tile"
+    why = f"const weights need {fp.total} bytes, more than {memory}"
+    # GemV8SplitK is the only kernel whose weights do not stay on the tile
+    if dtype != "int32" or kw.get("x_dtype") not in (None, "int32") or batch != 1 or kw.get("bias"):
+        return None, f"{why}; split-K, the only kernel that streams its weights, is int32 with NB 1 and no bias"
+    if k % STEP["int32"][0] or n % STEP["int32"][1]:
+        return None, f"{why}; split-K needs K a multiple of 8 and N of 16"
+    for chunk in range(k - k % 8, 0, -8):
+        if k % chunk:
+            continue
+        sk = split_k(k, n, chunk, heap=kw.get("heap", HEAP), stack=kw.get("stack", STACK))
+        if sk.fits(memory):
+            return sk, f"{why}; split-K, {chunk} inputs per invocation (gemv_i32 SPLITK=1, SPLITK_KC {chunk})"
+    return None, f"{why}, and split-K does not fit even with 8 inputs per invocation"
+
+
+def largest(dim, k, n, dtype="int32", batch=1, weights="const", memory=TILE_MEMORY, limit=1 << 16, **kw):
+    """Largest k, n or batch (the others fixed) whose footprint fits, 0 if none does."""
+    step = {"k": STEP[dtype][0], "n": STEP[dtype][1], "batch": 1}[dim]
+
+    def fits(v):
+        shape = {"k": k, "n": n, "batch": batch}
+        shape[dim] = v
+        if weights == "auto":
+            return choose(shape["k"], shape["n"], dtype, shape["batch"], memory, **kw)[0] is not None
+        return gemv(shape["k"], shape["n"], dtype, shape["batch"], weights, **kw).fits(memory)
+
+    # the footprint grows with every dimension, so bisect over multiples of step
+    lo, hi = 0, limit // step
+    while lo < hi:
+        mid = (lo + hi + 1) // 2
+        if fits(mid * step):
+            lo = mid
+        else:
+            hi = mid - 1
+    return lo * step
+
+
+C_SIZE = {"int8": 1, "uint8": 1, "int16": 2, "uint16": 2, "int32": 4, "uint32": 4, "int64": 8, "uint64": 8,
+          "char": 1, "short": 2, "int": 4, "float": 4, "double": 8, "cint16": 4, "cint32": 8,
+          "int8_t": 1, "int16_t": 2, "int32_t": 4, "int64_t": 8}
+C_ARRAY = re.compile(r"\bconst\s+(\w+)\s+(\w+)\s*((?:\[[^\]]+\])+)\s*=")
+C_DEFINE = re.compile(r"^[ \t]*#define[ \t]+(\w+)[ \t]+([^\n]+?)[ \t]*$", re.M)
+C_INCLUDE = re.compile(r'^[ \t]*#include[ \t]+"([^"]+)"', re.M)
+
+
+def static_data(source):
+    """Bytes of the const arrays (weights, tables) that a kernel source and the
+    local headers it includes define, each aligned; (bytes, [names]).
+
+    Every array the source can see is counted, so kernels that share a source
+    and use different arrays are over-reserved rather than under. Array types
+    and sizes may use #defines from those files. An array whose size does not
+    resolve is left out and named in the list with a '?'."""
+    defines, arrays, seen = {}, [], set()
+
+    def scan(path):
+        path = os.path.normpath(path)
+        if path in seen or not os.path.isfile(path):
+            return
+        seen.add(path)
+        with open(path) as f:
+            text = re.sub(r"/\*.*?\*/", "", re.sub(r"//[^\n]*", "", f.read()), flags=re.S)
+        for inc in C_INCLUDE.findall(text):
+            scan(os.path.join(os.path.dirname(path), inc))
+        defines.update(C_DEFINE.findall(text))
+        arrays.extend(C_ARRAY.findall(text))
+
+    def value(expr):
+        for _ in range(8):
+            expr = re.sub(r"[A-Za-z_]\w*", lambda m: f"({defines[m.group(0)]})" if m.group(0) in defines
+                          else m.group(0), expr)
+        if not re.fullmatch(r"[\d\s()+\-*/%<>]+", expr):
+            return None
+        return int(eval(expr.replace("/", "//")))
+
+    scan(source)
+    total, names = 0, []
+    for ctype, name, dims in arrays:
+        size = C_SIZE.get(defines.get(ctype, ctype).strip())
+        count = 1
+        for d in re.findall(r"\[([^\]]+)\]", dims):
+            v = value(d)
+            count = None if v is None or count is None else count * v
+        if size is None or count is None:
+            names.append(name + "?")
+            continue
+        total += align(size * count)
+        names.append(name)
+    return total, names
+
+
+def makefile_heap(path):
+    """--aie.heapsize from a kernel Makefile, the aiecompiler default when it sets none."""
+    with open(path) as f:
+        m = re.search(r"--aie\.heapsize=(\d+)", f.read())
+    return int(m.group(1)) if m else HEAP_DEFAULT
+
+
+def compute_cycles(k, n, dtype, batch):
+    """MAC issue bound: 8 int32, 32 int16 or 128 int8 MACs per cycle."""
+    return batch * k * n // {"int32": 8, "int16": 32, "int8": 128}[dtype]
+
+
+def report(fp, memory, title):
+    print(title)
+    merged = {}
+    for name, nbytes in fp.items:
+        merged[name] = merged.get(name, 0) + nbytes
+    for name, nbytes in merged.items():
+        print(f"  {name:<14} {nbytes:>7}")
+    free = memory - fp.total
+    print(f"  {'total':<14} {fp.total:>7} of {memory}, "
+          + (f"{free} free" if free >= 0 else f"{-free} over: does not fit"))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Tile data memory footprint of a GemV/GEMM configuration.")
+    parser.add_argument("layer", choices=["gemv", "gemm"])
+    parser.add_argument("--m", type=int, default=16, help="GEMM rows of A / C.")
+    parser.add_argument("--k", type=int, default=16, help="Inner dimension (GemV inputs).")
+    parser.add_argument("--n", type=int, default=16, help="Outputs (GEMM columns of B / C).")
+    parser.add_argument("--dtype", choices=list(SIZE), default="int32", help="Weight type.")
+    parser.add_argument("--x-dtype", choices=list(SIZE), help="Activation type, if not --dtype (gemv_mixed).")
+    parser.add_argument("--batch", type=int, default=1, help="GemV inputs per invocation (NB).")
+    parser.add_argument("--weights", choices=list(WEIGHT_MODES) + ["auto"], default="const")
+    parser.add_argument("--bias", action="store_true", help="An int32 bias per output (hls4ml Dense).")
+    parser.add_argument("--chunk", type=int, help="Split-K GemV8SplitK: inputs per invocation (SPLITK_KC).")
+    parser.add_argument("--max", choices=["k", "n", "batch"], help="Largest value of this dimension that fits.")
+    parser.add_argument("--heap", type=int, default=HEAP, help="--aie.heapsize in bytes.")
+    parser.add_argument("--heap-from", metavar="MAKEFILE", help="Read --aie.heapsize from a kernel Makefile.")
+    parser.add_argument("--stack", type=int, default=STACK)
+    parser.add_argument("--memory", type=int, default=TILE_MEMORY, help="Tile data memory in bytes.")
+    args = parser.parse_args()
+
+    kw = dict(heap=makefile_heap(args.heap_from) if args.heap_from else args.heap, stack=args.stack)
+    if args.layer == "gemm":
+        if args.max or args.weights != "const" or args.dtype != "int32" or args.x_dtype:
+            parser.error("gemm takes --m/--k/--n only; its weights are the B window")
+        fp = gemm(args.m, args.k, args.n, **kw)
+        report(fp, args.memory, f"gemm int32 {args.m}x{args.k}x{args.n}")
+        return 0 if fp.fits(args.memory) else 1
+
+    if args.chunk:
+        if args.max or args.weights != "const" or args.dtype != "int32" or args.x_dtype or args.batch != 1 \
+                or args.bias:
+            parser.error("--chunk is the int32 split-K kernel: it takes --k/--n only")
+        try:
+            fp = split_k(args.k, args.n, args.chunk, **kw)
+        except ValueError as e:
+            parser.error(str(e))
+        report(fp, args.memory, f"gemv int32 {args.k}x{args.n}, split-K, {args.chunk} inputs per invocation")
+        mac = compute_cycles(args.chunk, args.n, "int32", 1)
+        print(f"  weight window {fp.stream_cycles} stream cycles vs {mac} MAC cycles per invocation, "
+              f"{args.k // args.chunk} invocations per output")
+        return 0 if fp.fits(args.memory) else 1
+
+    kw["x_dtype"] = args.x_dtype
+    if args.max:
+        best = largest(args.max, args.k, args.n, args.dtype, args.batch, args.weights, args.memory,
+                       bias=args.bias, **kw)
+        if not best:
+            print(f"no {args.max} fits")
+            return 1
+        if args.weights == "auto":
+            on_tile = largest(args.max, args.k, args.n, args.dtype, args.batch, "const", args.memory,
+                              bias=args.bias, **kw)
+            print(f"largest {args.max} with the weights on the tile: {on_tile or 'none'}")
+        print(f"largest {args.max} that fits: {best}")
+        setattr(args, args.max, best)
+
+    types = f"{args.x_dtype} x {args.dtype}" if args.x_dtype else args.dtype
+    shape = f"gemv {types} {args.k}x{args.n}, NB {args.batch}"
+    if args.weights == "auto":
+        fp, reason = choose(args.k, args.n, args.dtype, args.batch, args.memory, bias=args.bias, **kw)
+        print(reason)
+        if fp is None:
+            return 1
+    else:
+        fp = gemv(args.k, args.n, args.dtype, args.batch, args.weights, bias=args.bias, **kw)
+    report(fp, args.memory, f"{shape}, {fp.weights} weights")
+
+    if fp.weights == "chunked":
+        mac = compute_cycles(fp.chunk, args.n, "int32", 1)
+        print(f"  weight window {fp.stream_cycles} stream cycles vs {mac} MAC cycles per invocation, "
+              f"{args.k // fp.chunk} invocations per output")
+    if fp.weights == "stream":
+        wider = max(args.dtype, args.x_dtype or args.dtype, key=SIZE.get)
+        mac = compute_cycles(args.k, args.n, wider, args.batch)
+        bound = "stream" if fp.stream_cycles > mac else "MAC"
+        print(f"  weight stream {fp.stream_cycles} cycles vs {mac} MAC cycles per invocation: {bound} bound"
+              + (", raise --batch to amortize the weights" if bound == "stream" else ""))
+    return 0 if fp.fits(args.memory) else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
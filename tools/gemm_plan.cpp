@@ -0,0 +1,194 @@
+/*
+*	Plan an arbitrary M x K x N GEMM on the gemm_i32 api_benchmark graph
+*	(gemm_plan.h), and cut its matrices into the graph's PLIO streams and
+*	back.
+*
+*	How to run:
+*	gemm_plan.exe plan    <M> <K> <N> [--dtype int32] [--api 2x2x2] [--plio-in 32] [--plio-out 32] [--header include.h]
+*	gemm_plan.exe scatter include.h <dir> [--seed <s>] [--binary]
+*	gemm_plan.exe gather  include.h <dir> <C.txt>
+*
+*	plan prints the chosen tile, grid and predicted cycles, and with
+*	--header writes them as the include.h the kernel and graph build with.
+*
+*	scatter draws a random row-major A and B (values 0..127, like
+*	generate_golden_int32), writes the padded, blocked tiles to
+*	<dir>/matA<x> and <dir>/matB<z> in graph iteration order, the partial C
+*	tiles the kernels should write to <dir>/matC<xz>, and A, B and the
+*	row-major product to <dir>/A.txt, B.txt and C.txt. --binary writes
+*	raw int32 .bin stream files for PLIO_BINARY graphs.
+*
+*	gather reads the graph outputs <dir>/matC<xz>.txt or .bin, adds the
+*	partial tiles over K, crops the padding and compares the M x N result
+*	with C.txt. It exits with 1 on a mismatch.
+*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <random>
+#include <string>
+
+#include "gemm_plan.h"
+#include "plio.h"
+
+static int usage()
+{
+    std::fprintf(stderr,
+                 "usage: gemm_plan plan    <M> <K> <N> [--dtype int32] [--api MxKxN] [--plio-in n] [--plio-out n] "
+                 "[--header include.h]\n"
+                 "       gemm_plan scatter include.h <dir> [--seed s] [--binary]\n"
+                 "       gemm_plan gather  include.h <dir> <C.txt>\n");
+    return 2;
+}
+
+static gemm_plan::api parse_api(const std::string &s)
+{
+    gemm_plan::api a;
+    if (std::sscanf(s.c_str(), "%zux%zux%zu", &a.m, &a.k, &a.n) != 3)
+        throw std::invalid_argument("--api takes MxKxN, e.g. 2x2x2, not " + s);
+    return a;
+}
+
+static void print(const gemm_plan::plan &p)
+{
+    std::printf("GEMM %zu x %zu x %zu: %zu x %zu x %zu tiles (%zux%zux%zu API) on a %zu x %zu grid\n", p.M, p.K,
+                p.N, p.tm, p.tk, p.tn, p.a.m, p.a.k, p.a.n, p.X, p.Z);
+    std::printf("  %zu kernels, %zu A/B and %zu C PLIOs, %zu of 32768 bytes per tile\n", p.X * p.Z, p.X + p.Z,
+                p.X * p.Z, p.window_bytes());
+    std::printf("  %zu iterations (%zu x %zu output blocks, %zu K slices), %.1f%% of the MACs on padding\n",
+                p.iterations(), p.m_rounds(), p.n_rounds(), p.kt(), 100.0 * p.padding());
+    std::printf("  %zu cycles per iteration, %zu predicted\n", p.iteration_cycles(), p.cycles());
+}
+
+static std::string stream_path(const std::string &dir, const char *name, size_t i, bool binary)
+{
+    return dir + "/" + name + std::to_string(i) + (binary ? ".bin" : ".txt");
+}
+
+static void write_stream(const std::string &path, const std::vector<int64_t> &v, bool binary)
+{
+    if (binary)
+        plio::write_binary(path, v, plio::dtype::int32);
+    else
+        plio::write_text(path, v, plio::values_per_word(plio::dtype::int32));
+}
+
+static void scatter(const gemm_plan::plan &p, const std::string &dir, unsigned seed, bool binary)
+{
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> value(0, 127);
+    std::vector<int64_t> A(p.M * p.K), B(p.K * p.N), C(p.M * p.N);
+    for (int64_t &v : A)
+        v = value(rng);
+    for (int64_t &v : B)
+        v = value(rng);
+    for (size_t r = 0; r < p.M; ++r)
+        for (size_t c = 0; c < p.N; ++c) {
+            uint32_t v = 0;
+            for (size_t k = 0; k < p.K; ++k)
+                v += static_cast<uint32_t>(A[r * p.K + k]) * static_cast<uint32_t>(B[k * p.N + c]);
+            C[r * p.N + c] = static_cast<int32_t>(v);
+        }
+
+    const auto a = gemm_plan::scatter_a(p, A);
+    const auto b = gemm_plan::scatter_b(p, B);
+    const auto c = gemm_plan::expected_c(p, A, B);
+    for (size_t x = 0; x < a.size(); ++x)
+        write_stream(stream_path(dir, "matA", x, binary), a[x], binary);
+    for (size_t z = 0; z < b.size(); ++z)
+        write_stream(stream_path(dir, "matB", z, binary), b[z], binary);
+    for (size_t s = 0; s < c.size(); ++s)
+        write_stream(stream_path(dir, "matC", s, binary), c[s], binary);
+    plio::write_text(dir + "/A.txt", A, p.K);
+    plio::write_text(dir + "/B.txt", B, p.N);
+    plio::write_text(dir + "/C.txt", C, p.N);
+}
+
+static bool gather(const gemm_plan::plan &p, const std::string &dir, const std::string &expected)
+{
+    std::vector<std::vector<int64_t>> streams(p.X * p.Z);
+    for (size_t s = 0; s < streams.size(); ++s) {
+        std::string path = stream_path(dir, "matC", s, false);
+        if (!std::ifstream(path))
+            path = stream_path(dir, "matC", s, true);
+        streams[s] = plio::read_any(path, plio::dtype::int32);
+    }
+    const std::vector<int64_t> C = gemm_plan::gather_c(p, streams);
+    const std::vector<int64_t> want = plio::read_text(expected, plio::dtype::int32);
+    if (want.size() != C.size())
+        throw std::invalid_argument(expected + " has " + std::to_string(want.size()) + " values, expected " +
+                                    std::to_string(p.M) + "x" + std::to_string(p.N));
+
+    size_t bad = 0;
+    for (size_t i = 0; i < C.size(); ++i)
+        if (C[i] != want[i] && bad++ < 8)
+            std::fprintf(stderr, "C[%zu][%zu] = %lld, expected %lld\n", i / p.N, i % p.N,
+                         static_cast<long long>(C[i]), static_cast<long long>(want[i]));
+    if (bad)
+        std::fprintf(stderr, "%zu of %zu values differ\n", bad, C.size());
+    return bad == 0;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 3)
+        return usage();
+    const std::string cmd = argv[1];
+
+    try {
+        if (cmd == "plan" && argc >= 5) {
+            gemm_plan::api a;
+            gemm_plan::limits lim;
+            std::string header;
+            for (int i = 5; i < argc; i += 2) {
+                const std::string opt = argv[i];
+                if (i + 1 >= argc)
+                    return usage();
+                if (opt == "--dtype") {
+                    if (plio::parse_dtype(argv[i + 1]) != plio::dtype::int32)
+                        throw std::invalid_argument(std::string("the gemm_i32 kernel is int32 only, not ") +
+                                                    argv[i + 1]);
+                } else if (opt == "--api") {
+                    a = parse_api(argv[i + 1]);
+                } else if (opt == "--plio-in") {
+                    lim.plio_in = std::strtoul(argv[i + 1], nullptr, 10);
+                } else if (opt == "--plio-out") {
+                    lim.plio_out = std::strtoul(argv[i + 1], nullptr, 10);
+                } else if (opt == "--header") {
+                    header = argv[i + 1];
+                } else {
+                    return usage();
+                }
+            }
+            const gemm_plan::plan p = gemm_plan::choose(std::strtoul(argv[2], nullptr, 10),
+                                                        std::strtoul(argv[3], nullptr, 10),
+                                                        std::strtoul(argv[4], nullptr, 10), a, lim);
+            print(p);
+            if (!header.empty())
+                gemm_plan::write_header(p, header);
+        } else if (cmd == "scatter" && argc >= 4) {
+            unsigned seed = 1;
+            bool binary = false;
+            for (int i = 4; i < argc; ++i) {
+                const std::string opt = argv[i];
+                if (opt == "--seed" && i + 1 < argc)
+                    seed = std::strtoul(argv[++i], nullptr, 10);
+                else if (opt == "--binary")
+                    binary = true;
+                else
+                    return usage();
+            }
+            scatter(gemm_plan::read_header(argv[2]), argv[3], seed, binary);
+        } else if (cmd == "gather" && argc == 5) {
+            if (!gather(gemm_plan::read_header(argv[2]), argv[3], argv[4]))
+                return 1;
+        } else {
+            return usage();
+        }
+    } catch (const std::exception &e) {
+        std::fprintf(stderr, "gemm_plan: %s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,331 @@
+/*
+ *  Tiling of an arbitrary M x K x N GEMM onto the gemm_i32 kernel grid.
+ *
+ *  The api_benchmark graph runs mult_X x mult_Z copies of one gemm kernel,
+ *  each multiplying a single_M x single_K block of A by a single_K x
+ *  single_N block of B. A[x] is broadcast to the kernels of row x, B[z] to
+ *  those of column z, and kernel (x, z) writes C[x*mult_Z + z]. One graph
+ *  iteration therefore computes a (mult_X*single_M) x (mult_Z*single_N)
+ *  block of C over one single_K slice of K. A plan walks the output blocks
+ *  and, inside each, the K slices:
+ *
+ *      for mi < ceil(Mt / X), for ni < ceil(Nt / Z), for ki < Kt:  one iteration
+ *
+ *  with Mt, Nt, Kt the tile counts along M, N, K. The host adds the partial
+ *  C tiles over ki (gather) and drops the padding: A and B are zero padded
+ *  to whole tiles, so edge tiles run the same kernel and contribute zeros.
+ *  Partial sums wrap mod 2^32 like the kernel's int32 outputs, so adding
+ *  them on the host gives the same result as one long K, as long as SHIFT
+ *  is 0.
+ *
+ *  The planner enumerates the tile sizes the kernel accepts (single_M a
+ *  multiple of 2*M_API, single_N of 2*N_API, single_K of K_API) whose
+ *  ping-pong A, B and C windows fit the tile memory with heap and stack
+ *  (the tools/footprint.py gemm model), and the grids that fit the array and
+ *  the PLIO budget, and keeps the fewest predicted cycles. An iteration
+ *  takes the perf_model.h interval of one kernel:
+ *
+ *      iteration = max(kernel + call and locks, A, B or C tile bytes / 4)
+ *
+ *  The kernel is MAC or load bound, with a fixed cost fitted to the measured
+ *  16x32x16 kernel (1071 cycles). Each PLIO is one 32-bit stream. Ties go to
+ *  fewer kernels, then to less padding.
+ *
+ *  Tiles are laid out in the blocked order the kernel and
+ *  generate_golden_int32.cpp use: A in M_API x K_API blocks, row of blocks
+ *  by row of blocks; B in K_API x N_API blocks; C in M_API x N_API blocks.
+ */
+
+#ifndef GEMM_PLAN_H
+#define GEMM_PLAN_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "perf_model.h"
+
+namespace gemm_plan {
+
+constexpr size_t tile_memory = perf_model::tile_memory;
+constexpr size_t elem = 4;             // int32
+constexpr size_t max_tile = 128;       // largest single_M/N/K tried
+
+using api = perf_model::mmul_shape;
+
+// the int32 x int32 mmul shapes of the AI Engine API (include.h)
+constexpr api api_shapes[] = {{4, 2, 4}, {2, 2, 2}, {2, 4, 2}, {2, 8, 2}, {4, 2, 2}, {4, 4, 2}, {2, 4, 4}, {4, 4, 1}};
+
+struct limits {
+    size_t kernels = 400;              // AIE1 array of the VCK190, 50 x 8
+    size_t plio_in = 32;               // A and B PLIOs
+    size_t plio_out = 32;              // C PLIOs
+    size_t memory = tile_memory;
+};
+
+struct plan {
+    size_t M = 0, K = 0, N = 0;        // problem
+    size_t tm = 0, tk = 0, tn = 0;     // single_M, single_K, single_N
+    size_t X = 1, Z = 1;               // mult_X, mult_Z
+    api a;
+
+    size_t mt() const { return (M + tm - 1) / tm; }
+    size_t kt() const { return (K + tk - 1) / tk; }
+    size_t nt() const { return (N + tn - 1) / tn; }
+    size_t m_rounds() const { return (mt() + X - 1) / X; }
+    size_t n_rounds() const { return (nt() + Z - 1) / Z; }
+    size_t iterations() const { return m_rounds() * n_rounds() * kt(); }
+
+    perf_model::gemm_config kernel() const
+    {
+        perf_model::gemm_config c;
+        c.m = tm, c.k = tk, c.n = tn, c.api = a;
+        return c;
+    }
+
+    size_t window_bytes() const { return perf_model::gemm_memory(kernel()); }
+    size_t iteration_cycles() const { return perf_model::gemm(kernel()).interval(); }
+    size_t cycles() const { return iterations() * iteration_cycles(); }
+
+    // fraction of the MACs spent on padding
+    double padding() const
+    {
+        double run = double(m_rounds() * X * tm) * double(kt() * tk) * double(n_rounds() * Z * tn);
+        return 1.0 - double(M) * double(K) * double(N) / run;
+    }
+};
+
+inline bool valid_tile(size_t tm, size_t tk, size_t tn, const api &a)
+{
+    return tm && tk && tn && tm % (2 * a.m) == 0 && tn % (2 * a.n) == 0 && tk % a.k == 0;
+}
+
+// best plan for M x K x N, or throws when no tile fits
+inline plan choose(size_t M, size_t K, size_t N, const api &a = api(), const limits &lim = limits())
+{
+    if (!M || !K || !N)
+        throw std::invalid_argument("M, K and N must be positive");
+    if (std::none_of(std::begin(api_shapes), std::end(api_shapes),
+                     [&](const api &s) { return s.m == a.m && s.k == a.k && s.n == a.n; }))
+        throw std::invalid_argument(std::to_string(a.m) + "x" + std::to_string(a.k) + "x" +
+                                    std::to_string(a.n) + " is not an int32 mmul shape of the AI Engine API");
+    bool found = false;
+    plan best;
+    auto better = [&](const plan &p) {
+        if (!found)
+            return true;
+        if (p.cycles() != best.cycles())
+            return p.cycles() < best.cycles();
+        if (p.X * p.Z != best.X * best.Z)
+            return p.X * p.Z < best.X * best.Z;
+        return p.padding() < best.padding();
+    };
+
+    for (size_t tm = 2 * a.m; tm <= max_tile; tm += 2 * a.m)
+        for (size_t tn = 2 * a.n; tn <= max_tile; tn += 2 * a.n)
+            for (size_t tk = a.k; tk <= max_tile; tk += a.k) {
+                plan p;
+                p.M = M, p.K = K, p.N = N, p.tm = tm, p.tk = tk, p.tn = tn, p.a = a;
+                if (p.window_bytes() > lim.memory)
+                    continue;
+                // a tile much larger than the problem only adds padding
+                if ((tm > 2 * a.m && tm - 2 * a.m >= M) || (tn > 2 * a.n && tn - 2 * a.n >= N) ||
+                    (tk > a.k && tk - a.k >= K))
+                    continue;
+                for (size_t x = 1; x <= p.mt(); ++x)
+                    for (size_t z = 1; z <= p.nt(); ++z) {
+                        if (x * z > lim.kernels || x + z > lim.plio_in || x * z > lim.plio_out)
+                            break;
+                        p.X = x, p.Z = z;
+                        if (better(p)) {
+                            best = p;
+                            found = true;
+                        }
+                    }
+            }
+    if (!found)
+        throw std::runtime_error("no tile of the kernel fits in " + std::to_string(lim.memory) +
+                                 " bytes of tile memory");
+    return best;
+}
+
+/*
+ *  Plan header: the include.h the api_benchmark kernel and graph compile
+ *  with, plus the problem shape and ITERATIONS. scatter and gather read the
+ *  plan back from it, so the header is the single record of a plan.
+ */
+
+inline void write_header(const plan &p, const std::string &path)
+{
+    FILE *fp = std::fopen(path.c_str(), "w");
+    if (!fp)
+        throw std::runtime_error("cannot create " + path);
+    std::fprintf(fp,
+                 "#ifndef FUNCTION_INCLUDES_H\n#define FUNCTION_INCLUDES_H\n\n"
+                 "// generated by tools/gemm_plan.exe: %zu x %zu x %zu GEMM, %zu iterations of a %zu x %zu grid\n"
+                 "// of %zu x %zu x %zu kernels, %.1f%% of the MACs on padding, %zu cycles predicted\n\n"
+                 "// define shift right for output values after matrix mult\n#define SHIFT 0\n\n"
+                 "// multiple AIE parameters (XxYxZ on manuscript)\n"
+                 "#define mult_X %zu\n#define mult_Y 1\n#define mult_Z %zu\n\n"
+                 "// single kernel dimensions (MxKxN on manuscript)\n"
+                 "#define single_M %zu\n#define single_K %zu\n#define single_N %zu\n\n"
+                 "// AI Engine API dimensions\n#define M_API %zu\n#define K_API %zu\n#define N_API %zu\n\n"
+                 "// graph iterations and the GEMM they cover\n"
+                 "#define ITERATIONS %zu\n#define PLAN_M %zu\n#define PLAN_K %zu\n#define PLAN_N %zu\n\n#endif\n",
+                 p.M, p.K, p.N, p.iterations(), p.X, p.Z, p.tm, p.tk, p.tn, 100.0 * p.padding(), p.cycles(),
+                 p.X, p.Z, p.tm, p.tk, p.tn, p.a.m, p.a.k, p.a.n, p.iterations(), p.M, p.K, p.N);
+    std::fclose(fp);
+}
+
+inline plan read_header(const std::string &path)
+{
+    std::ifstream f(path);
+    if (!f)
+        throw std::runtime_error("cannot open " + path);
+    std::map<std::string, size_t> def;
+    std::string line;
+    while (std::getline(f, line)) {
+        std::istringstream s(line);
+        std::string d, name;
+        size_t v;
+        if (s >> d >> name >> v && d == "#define")
+            def[name] = v;
+    }
+    auto get = [&](const char *name) {
+        auto it = def.find(name);
+        if (it == def.end())
+            throw std::runtime_error(path + ": no " + name + ", not a plan written by gemm_plan");
+        return it->second;
+    };
+    if (get("mult_Y") != 1)
+        throw std::runtime_error(path + ": mult_Y must be 1, K is split over iterations");
+    if (get("SHIFT") != 0)
+        throw std::runtime_error(path + ": SHIFT must be 0 to add partial sums over K");
+    plan p;
+    p.M = get("PLAN_M"), p.K = get("PLAN_K"), p.N = get("PLAN_N");
+    p.tm = get("single_M"), p.tk = get("single_K"), p.tn = get("single_N");
+    p.X = get("mult_X"), p.Z = get("mult_Z");
+    p.a.m = get("M_API"), p.a.k = get("K_API"), p.a.n = get("N_API");
+    if (!valid_tile(p.tm, p.tk, p.tn, p.a))
+        throw std::runtime_error(path + ": single_M/K/N do not fit the kernel's M_API/K_API/N_API blocking");
+    return p;
+}
+
+/*
+ *  Scatter and gather, row-major int32 matrices. Iteration t = (mi*n_rounds
+ *  + ni)*Kt + ki puts tile (mi*X + x, ki) of A in stream x, tile (ki,
+ *  ni*Z + z) of B in stream z, and reads tile (mi*X + x, ni*Z + z) partial
+ *  ki from C stream x*Z + z. Elements past M, K or N are zero.
+ */
+
+template <typename T>
+std::vector<std::vector<T>> scatter_a(const plan &p, const std::vector<T> &A)
+{
+    std::vector<std::vector<T>> out(p.X);
+    for (size_t mi = 0; mi < p.m_rounds(); ++mi)
+        for (size_t ni = 0; ni < p.n_rounds(); ++ni)
+            for (size_t ki = 0; ki < p.kt(); ++ki)
+                for (size_t x = 0; x < p.X; ++x)
+                    for (size_t i = 0; i < p.tm / p.a.m; ++i)
+                        for (size_t k = 0; k < p.tk / p.a.k; ++k)
+                            for (size_t ma = 0; ma < p.a.m; ++ma)
+                                for (size_t ka = 0; ka < p.a.k; ++ka) {
+                                    size_t r = (mi * p.X + x) * p.tm + i * p.a.m + ma;
+                                    size_t c = ki * p.tk + k * p.a.k + ka;
+                                    out[x].push_back(r < p.M && c < p.K ? A[r * p.K + c] : T(0));
+                                }
+    return out;
+}
+
+template <typename T>
+std::vector<std::vector<T>> scatter_b(const plan &p, const std::vector<T> &B)
+{
+    std::vector<std::vector<T>> out(p.Z);
+    for (size_t mi = 0; mi < p.m_rounds(); ++mi)
+        for (size_t ni = 0; ni < p.n_rounds(); ++ni)
+            for (size_t ki = 0; ki < p.kt(); ++ki)
+                for (size_t z = 0; z < p.Z; ++z)
+                    for (size_t k = 0; k < p.tk / p.a.k; ++k)
+                        for (size_t j = 0; j < p.tn / p.a.n; ++j)
+                            for (size_t ka = 0; ka < p.a.k; ++ka)
+                                for (size_t na = 0; na < p.a.n; ++na) {
+                                    size_t r = ki * p.tk + k * p.a.k + ka;
+                                    size_t c = (ni * p.Z + z) * p.tn + j * p.a.n + na;
+                                    out[z].push_back(r < p.K && c < p.N ? B[r * p.N + c] : T(0));
+                                }
+    return out;
+}
+
+// visit(stream, position in the stream, row, col) for every C element the kernels write, padding included
+template <typename F>
+void walk_c(const plan &p, F visit)
+{
+    std::vector<size_t> pos(p.X * p.Z, 0);
+    for (size_t mi = 0; mi < p.m_rounds(); ++mi)
+        for (size_t ni = 0; ni < p.n_rounds(); ++ni)
+            for (size_t ki = 0; ki < p.kt(); ++ki)
+                for (size_t x = 0; x < p.X; ++x)
+                    for (size_t z = 0; z < p.Z; ++z)
+                        for (size_t i = 0; i < p.tm / p.a.m; ++i)
+                            for (size_t j = 0; j < p.tn / p.a.n; ++j)
+                                for (size_t ma = 0; ma < p.a.m; ++ma)
+                                    for (size_t na = 0; na < p.a.n; ++na) {
+                                        size_t s = x * p.Z + z;
+                                        visit(s, pos[s]++, (mi * p.X + x) * p.tm + i * p.a.m + ma,
+                                              (ni * p.Z + z) * p.tn + j * p.a.n + na);
+                                    }
+}
+
+// C from the X*Z output streams: partial tiles added over K, padding dropped
+template <typename T>
+std::vector<T> gather_c(const plan &p, const std::vector<std::vector<T>> &streams)
+{
+    const size_t per_stream = p.iterations() * p.tm * p.tn;
+    if (streams.size() != p.X * p.Z)
+        throw std::invalid_argument(std::to_string(streams.size()) + " C streams, the plan has " +
+                                    std::to_string(p.X * p.Z));
+    for (size_t s = 0; s < streams.size(); ++s)
+        if (streams[s].size() != per_stream)
+            throw std::invalid_argument("C stream " + std::to_string(s) + " has " +
+                                        std::to_string(streams[s].size()) + " values, expected " +
+                                        std::to_string(per_stream));
+    std::vector<uint32_t> acc(p.M * p.N, 0);
+    walk_c(p, [&](size_t s, size_t i, size_t r, size_t c) {
+        if (r < p.M && c < p.N)
+            acc[r * p.N + c] += static_cast<uint32_t>(streams[s][i]);
+    });
+    std::vector<T> out(acc.size());
+    for (size_t i = 0; i < acc.size(); ++i)
+        out[i] = static_cast<T>(static_cast<int32_t>(acc[i]));
+    return out;
+}
+
+// what the kernels write: the partial C tiles, for golden data
+template <typename T>
+std::vector<std::vector<T>> expected_c(const plan &p, const std::vector<T> &A, const std::vector<T> &B)
+{
+    std::vector<std::vector<T>> out(p.X * p.Z, std::vector<T>(p.iterations() * p.tm * p.tn));
+    std::vector<size_t> it(p.X * p.Z, 0);
+    walk_c(p, [&](size_t s, size_t i, size_t r, size_t c) {
+        // the iteration, hence the K slice, of this element
+        size_t ki = (i / (p.tm * p.tn)) % p.kt();
+        uint32_t v = 0;
+        if (r < p.M && c < p.N)
+            for (size_t k = ki * p.tk; k < std::min(p.K, (ki + 1) * p.tk); ++k)
+                v += static_cast<uint32_t>(A[r * p.K + k]) * static_cast<uint32_t>(B[k * p.N + c]);
+        out[s][i] = static_cast<T>(static_cast<int32_t>(v));
+    });
+    return out;
+}
+
+} // namespace gemm_plan
+
+#endif // GEMM_PLAN_H
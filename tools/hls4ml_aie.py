@@ -0,0 +1,716 @@
+"""
+Limited hls4ml backend: export the Dense layers of an hls4ml model onto the
+int32 GemV kernels of gemv_i32, as a self-contained AIE project.
+
+For every Dense layer (with its bias and a following ReLU or linear
+activation fused in) the export writes
+
+  data/<layer>_w.bin         the quantized weights as a packed weight blob
+  aie/kernels/<layer>_w.h    the kernel header generated from it by pack_weights.exe
+  aie/kernels/<layer>.h      K, N, SHIFT, RELU and the bias of the layer
+  aie/kernels/<layer>.cc     a gemv::dense8_packed (or dense4) instantiation
+
+plus aie/graph.cpp chaining the layers tile to tile through windows,
+aie/kernels.h, a Makefile with run_sim and host_sim, golden data
+(data/x.txt/.bin, data/y_exp.txt/.bin) and model.json describing the export.
+
+With --fuse, all layers run in one kernel on one tile instead
+(aie/kernels/mlp_fused.cc, gemv::mlp8 in gemv_fused.h): the weights of every
+layer stay resident there and only the last layer's output leaves the tile.
+For small layers that saves the window handoff between tiles, which costs more
+than the layer itself. The whole model must then fit in one tile.
+
+Quantization follows the hls4ml precisions instead of a calibration. An
+ap_fixed<W,I> value is stored as the integer v * 2^(W-I). The kernels hold
+x*w at 2^(Fx+Fw) in the acc80 accumulator, which starts from the bias moved
+to that scale. SHIFT = Fx+Fw-Fy is the to_vector() shift to the result type.
+The floor shift and the wrap are ap_fixed's default AP_TRN/AP_WRAP. A Dense
+layer with an activation after it casts twice in hls4ml, to the Dense result_t
+and then to the activation's. Floor shifts compose and commute with ReLU, so
+the kernel does both in one SHIFT to the activation's result_t, which must
+then not have more fractional bits than the Dense one. An output matches
+hls4ml bit for bit unless it overflows one of the result types: hls4ml then
+wraps at W bits and the kernel at 32. The export reports any such output on
+the golden inputs. Weights and bias are quantized the way their ap_fixed
+types do it (truncate, wrap).
+
+Limits: int32 data (every width <= 32 bits), one tile per layer (or one
+for all of them with --fuse), so the weights must fit in tile memory, and K,
+N are zero padded to multiples of 8 and 16. Conv layers are not supported
+yet.
+
+The model is either an hls4ml ModelGraph (hls4ml.converters.convert_from_*),
+read through get_layers()/get_weights()/get_attr() only, or a JSON spec of the
+same information, so models can be exported without hls4ml installed:
+
+  {"input_t": "ap_fixed<16,6>",
+   "layers": [{"name": "fc1", "class_name": "Dense", "weight": "fc1_w.npy", "bias": [0.5, ...],
+               "weight_t": "ap_fixed<8,2>", "bias_t": "ap_fixed<16,6>", "result_t": "ap_fixed<16,6>"},
+              {"name": "relu1", "class_name": "Activation", "activation": "relu",
+               "result_t": "ap_ufixed<16,6>"}]}
+
+with weight/bias arrays inline or as .npy paths relative to the spec, weight
+shaped (inputs, outputs) as in Keras and hls4ml. dump_spec(model, path)
+writes one from a ModelGraph.
+
+How to run:
+python tools/hls4ml_aie.py model.json --out mlp_aie [--inputs x.npy] [--batch 20] [--lmac lmac4]
+python tools/hls4ml_aie.py --demo 30,40,10 --out mlp_aie       # random 2-layer MLP
+python tools/hls4ml_aie.py --demo 16,16,16,16 --out mlp_aie --fuse
+make -C mlp_aie host_sim                                       # or run_sim
+
+    import hls4ml_aie
+    hls4ml_aie.convert(hls_model, "mlp_aie", inputs=x_test[:20])
+"""
+
+import argparse
+import json
+import os
+import re
+import subprocess
+import sys
+from dataclasses import dataclass, field
+
+import numpy as np
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+REPO = os.path.dirname(HERE)
+KERNELS = os.path.join(REPO, "gemv_i32", "aie", "kernels")   # gemv_unrolled.h
+sys.path.insert(0, HERE)
+import calibrate  # noqa: E402
+import footprint  # noqa: E402
+import placement  # noqa: E402
+import weight_blob  # noqa: E402
+
+ACC_BITS = 80
+VX, COLS = 8, 16                    # gemv_unrolled.h: K and N granularity
+HEAP_BYTES = footprint.HEAP         # --aie.heapsize of the generated Makefile
+LMAC = {"lmac8": "dense8_packed", "lmac4": "dense4_packed"}
+FUSED = "mlp_fused"                 # kernel and source name of the --fuse kernel
+
+
+@dataclass(frozen=True)
+class Fixed:
+    """ap_fixed<width, integer> (ap_ufixed when not signed); ap_int<W> is Fixed(W, W)."""
+    width: int
+    integer: int
+    signed: bool = True
+
+    @property
+    def frac(self):
+        return self.width - self.integer
+
+    def __str__(self):
+        return f"ap_{'' if self.signed else 'u'}fixed<{self.width},{self.integer}>"
+
+    def wrap(self, v):
+        v = np.asarray(v)
+        if self.signed:
+            return calibrate.wrap(v, self.width).astype(np.int64)
+        return (v & ((1 << self.width) - 1)).astype(np.int64)
+
+    def quantize(self, v):
+        """Float to the stored integer, as an ap_fixed assignment does it (AP_TRN, AP_WRAP)."""
+        return self.wrap(np.floor(np.asarray(v, dtype=np.float64) * 2.0 ** self.frac).astype(np.int64))
+
+    def range(self):
+        lo = -(1 << (self.width - 1)) if self.signed else 0
+        hi = (1 << (self.width - 1)) - 1 if self.signed else (1 << self.width) - 1
+        return lo * 2.0 ** -self.frac, hi * 2.0 ** -self.frac
+
+
+def fixed(p):
+    """Fixed from an hls4ml precision type or a string such as "ap_fixed<16,6>" or "ap_int<8>"."""
+    if isinstance(p, Fixed):
+        return p
+    if isinstance(p, str):
+        m = re.fullmatch(r"\s*ap_(u?)(fixed|int)<\s*(\d+)\s*(?:,\s*(-?\d+)\s*)?(?:,[^>]*)?>\s*", p)
+        if not m or (m.group(2) == "fixed" and m.group(4) is None):
+            raise ValueError(f"unsupported precision {p!r}, expected ap_[u]fixed<W,I> or ap_[u]int<W>")
+        width = int(m.group(3))
+        return Fixed(width, width if m.group(2) == "int" else int(m.group(4)), m.group(1) != "u")
+    p = getattr(p, "precision", p)     # NamedType or the precision itself
+    width = getattr(p, "width", None)
+    if width is None:
+        raise ValueError(f"unsupported precision {p!r}: the AIE backend needs fixed point or integer types")
+    return Fixed(int(width), int(getattr(p, "integer", width)), bool(getattr(p, "signed", True)))
+
+
+@dataclass
+class Dense:
+    """One Dense layer with the activation after it, still in floating point."""
+    name: str
+    w: np.ndarray                    # (inputs, outputs)
+    b: np.ndarray                    # (outputs,)
+    x_t: Fixed
+    w_t: Fixed
+    b_t: Fixed
+    y_t: Fixed                       # result type after the fused activation
+    relu: bool = False
+    fused: list = field(default_factory=list)
+    z_t: Fixed = None                # the Dense layer's own result type, before the activation
+
+    def __post_init__(self):
+        if self.z_t is None:
+            self.z_t = self.y_t
+
+
+def _ident(name):
+    s = re.sub(r"\W", "_", name)
+    return s if s and not s[0].isdigit() else "l_" + s
+
+
+def _layers(entries, input_t):
+    """Dense layers from (class_name, name, get) entries, get(key) returning weights or types."""
+    layers, x_t = [], input_t
+    for cls, name, get in entries:
+        if cls in ("Input", "InputLayer"):
+            x_t = fixed(get("result_t"))
+        elif cls in ("Dense", "QDense"):
+            if x_t is None:
+                raise ValueError(f"{name}: no input precision")
+            w = np.asarray(get("weight"), dtype=np.float64)
+            if w.ndim != 2:
+                raise ValueError(f"{name}: weight has shape {w.shape}, expected (inputs, outputs)")
+            b = get("bias")
+            b = np.zeros(w.shape[1]) if b is None else np.asarray(b, dtype=np.float64).reshape(-1)
+            if b.shape != (w.shape[1],):
+                raise ValueError(f"{name}: {b.size} biases for {w.shape[1]} outputs")
+            layers.append(Dense(_ident(name), w, b, x_t, fixed(get("weight_t")),
+                                fixed(get("bias_t") or get("weight_t")), fixed(get("result_t"))))
+            x_t = layers[-1].y_t
+        elif cls in ("Activation", "ReLU", "QActivation"):
+            act = "relu" if cls == "ReLU" else str(get("activation")).lower()
+            if act not in ("relu", "linear"):
+                raise ValueError(f"{name}: activation {act} is not supported by the AIE backend")
+            if not layers or layers[-1].y_t is not x_t:
+                raise ValueError(f"{name}: only activations right after a Dense layer are supported")
+            y_t = fixed(get("result_t"))
+            if layers[-1].fused and y_t != layers[-1].y_t:
+                raise ValueError(f"{name}: result type {y_t} differs from {layers[-1].fused[-1]}'s "
+                                 f"{layers[-1].y_t}, only the cast after the first activation is modelled")
+            layers[-1].relu |= act == "relu"
+            layers[-1].y_t = y_t         # z_t keeps the Dense result type, lower() and run() apply both
+            layers[-1].fused.append(name)
+            x_t = layers[-1].y_t
+        elif cls in ("Conv1D", "Conv2D", "QConv1D", "QConv2D"):
+            raise ValueError(f"{name}: Conv layers are not supported by the AIE backend yet")
+        else:
+            raise ValueError(f"{name}: layer type {cls} is not supported by the AIE backend")
+    if not layers:
+        raise ValueError("the model has no Dense layers")
+    return layers
+
+
+def from_hls4ml(model):
+    """Dense layers of an hls4ml ModelGraph."""
+    def entry(layer):
+        def get(key):
+            if key in ("weight", "bias"):
+                try:
+                    v = layer.get_weights(key)
+                except (KeyError, AttributeError):
+                    return None
+                return None if v is None else v.data
+            if key in ("weight_t", "bias_t"):
+                try:
+                    return layer.get_weights(key[:-2]).type
+                except (KeyError, AttributeError):
+                    return None
+            if key == "result_t":
+                return layer.get_output_variable().type
+            return layer.get_attr(key)
+        return layer.class_name, layer.name, get
+    return _layers([entry(layer) for layer in model.get_layers()], None)
+
+
+def from_spec(spec, base="."):
+    """Dense layers of a JSON spec (a dict or a path)."""
+    if isinstance(spec, str):
+        base = os.path.dirname(os.path.abspath(spec))
+        with open(spec) as f:
+            spec = json.load(f)
+
+    def entry(layer):
+        def get(key):
+            v = layer.get(key)
+            if key in ("weight", "bias") and isinstance(v, str):
+                return np.load(os.path.join(base, v))
+            return v
+        return layer["class_name"], layer.get("name", layer["class_name"]), get
+    return _layers([entry(layer) for layer in spec["layers"]], fixed(spec["input_t"]))
+
+
+def dump_spec(model, path):
+    """Write the JSON spec of an hls4ml ModelGraph, weights inline."""
+    layers = from_hls4ml(model)
+    spec = {"input_t": str(layers[0].x_t), "layers": []}
+    for d in layers:
+        spec["layers"].append({"name": d.name, "class_name": "Dense", "weight": d.w.tolist(), "bias": d.b.tolist(),
+                               "weight_t": str(d.w_t), "bias_t": str(d.b_t), "result_t": str(d.z_t)})
+        if d.fused:
+            spec["layers"].append({"name": d.fused[-1], "class_name": "Activation",
+                                   "activation": "relu" if d.relu else "linear", "result_t": str(d.y_t)})
+    with open(path, "w") as f:
+        json.dump(spec, f)
+
+
+def demo_spec(sizes, seed=0):
+    """Random float MLP with hls4ml's default ap_fixed<16,6>, ReLU between layers."""
+    rng = np.random.default_rng(seed)
+    t = "ap_fixed<16,6>"
+    layers = []
+    for i, (k, n) in enumerate(zip(sizes[:-1], sizes[1:])):
+        layers.append({"name": f"fc{i + 1}", "class_name": "Dense", "weight": rng.normal(0, 0.5, (k, n)).tolist(),
+                       "bias": rng.normal(0, 0.25, n).tolist(), "weight_t": t, "bias_t": t,
+                       "result_t": t})
+        if i + 2 < len(sizes):
+            layers.append({"name": f"relu{i + 1}", "class_name": "Activation", "activation": "relu", "result_t": t})
+    return {"input_t": t, "layers": layers}
+
+
+def _pad(v, m):
+    return -(-v // m) * m
+
+
+@dataclass
+class Lowered:
+    """A Dense layer as the kernel runs it: integers, padded, with SHIFT."""
+    dense: Dense
+    k: int                           # padded inputs
+    n: int                           # padded outputs
+    w: np.ndarray                    # (k, n) int32
+    b: np.ndarray                    # (n,) int32, at the accumulator scale
+    shift: int
+
+
+def lower(layers):
+    """Quantize and pad every layer, checking the AIE limits."""
+    out, k_prev = [], None
+    for d in layers:
+        for what, t in (("input", d.x_t), ("weight", d.w_t), ("bias", d.b_t), ("result", d.z_t), ("result", d.y_t)):
+            if t.width > 32:
+                raise ValueError(f"{d.name}: {what} type {t} is wider than 32 bits")
+        acc_frac = d.x_t.frac + d.w_t.frac
+        shift = acc_frac - d.y_t.frac
+        if acc_frac < d.z_t.frac:
+            raise ValueError(f"{d.name}: result type {d.z_t} has more fractional bits than x*w ({acc_frac})")
+        if d.y_t.frac > d.z_t.frac:
+            raise ValueError(f"{d.name}: {d.fused[-1]} result type {d.y_t} has more fractional bits than "
+                             f"the Dense result type {d.z_t}, whose cast already dropped them")
+        k0, n0 = d.w.shape
+        # a layer reads exactly the window the previous one writes
+        k = k_prev if k_prev is not None else _pad(k0, VX)
+        if k < k0:
+            raise ValueError(f"{d.name}: {k0} inputs, but the previous layer has {k} outputs")
+        n = _pad(n0, COLS)
+
+        w = np.zeros((k, n), dtype=np.int64)
+        w[:k0, :n0] = d.w_t.quantize(d.w)
+        b = np.zeros(n, dtype=np.int64)
+        bq = d.b_t.quantize(d.b)
+        b[:n0] = bq << (acc_frac - d.b_t.frac) if acc_frac >= d.b_t.frac else bq >> (d.b_t.frac - acc_frac)
+        if np.abs(b).max(initial=0) >= 1 << 31:
+            raise ValueError(f"{d.name}: bias does not fit int32 at the accumulator scale 2^{acc_frac}")
+
+        fp = footprint.gemv(k, n, "int32", bias=True, heap=HEAP_BYTES)
+        if not fp.fits():
+            raise ValueError(f"{d.name}: {k}x{n} needs {fp.total} bytes of tile memory, "
+                             f"more than {footprint.TILE_MEMORY}")
+        out.append(Lowered(d, k, n, w.astype(np.int32), b.astype(np.int32), shift))
+        k_prev = n
+    return out
+
+
+def run(lowered, x):
+    """Golden output of the kernels for integer inputs x (batch, k) and the hls4ml one."""
+    aie = hls = x
+    overflow = []
+    for ly in lowered:
+        acc = calibrate.wrap(calibrate.accumulate(aie, ly.w, ACC_BITS) + ly.b, ACC_BITS)
+        aie = calibrate.requantize(acc, ly.shift, np.int32).astype(np.int64)
+        # hls4ml: the cast to the Dense result_t, the activation, then the cast to its result_t
+        d = ly.dense
+        drop = d.z_t.frac - d.y_t.frac
+        acc = d.z_t.wrap((calibrate.accumulate(hls, ly.w, ACC_BITS) + ly.b) >> (ly.shift - drop))
+        if d.relu:
+            aie, acc = np.maximum(aie, 0), np.maximum(acc, 0)
+        hls = d.y_t.wrap(acc >> drop)
+        n0 = ly.dense.w.shape[1]
+        overflow.append(int(np.count_nonzero(aie[:, :n0] != hls[:, :n0])))
+    return aie.astype(np.int32), overflow
+
+
+def reference(layers, x):
+    """Floating point model on the float inputs."""
+    for d in layers:
+        x = x @ d.w + d.b
+        if d.relu:
+            x = np.maximum(x, 0)
+    return x
+
+
+def _write(path, text):
+    with open(path, "w") as f:
+        f.write(text)
+
+
+def _tail(values, per_line):
+    return "\n".join("    " + ", ".join(str(int(v)) for v in values[i:i + per_line]) +
+                     ("," if i + per_line < len(values) else "") for i in range(0, len(values), per_line))
+
+
+def _params_h(ly):
+    d, guard = ly.dense, ly.dense.name.upper() + "_H"
+    up = ly.dense.name.upper()
+    return f"""#ifndef {guard}
+#define {guard}
+
+// generated by tools/hls4ml_aie.py: Dense {d.name}, {d.w.shape[0]}x{d.w.shape[1]} padded to {ly.k}x{ly.n}
+// {d.x_t} x {d.w_t} + {d.b_t} -> {d.z_t}{', ReLU' if d.relu else ''}{f' -> {d.y_t}' if d.z_t != d.y_t else ''}
+#define {up}_K {ly.k}
+#define {up}_N {ly.n}
+#define {up}_SHIFT {ly.shift}
+#define {up}_RELU {'true' if d.relu else 'false'}
+
+// bias at the accumulator scale, 2^{d.x_t.frac + d.w_t.frac}
+alignas(32) const int32 {d.name}_b[{ly.n}] = {{
+{_tail(ly.b, COLS)}
+}};
+
+#endif // {guard}
+"""
+
+
+def _kernel_cc(ly, impl):
+    name, up = ly.dense.name, ly.dense.name.upper()
+    return f"""#include <adf.h>
+#include "aie_api/aie.hpp"
+#include "aie_api/aie_adf.hpp"
+#include "{name}_w.h"
+#include "{name}.h"
+#include "gemv_unrolled.h"
+
+// generated by tools/hls4ml_aie.py
+void dense_{name}(
+    input_window_int32 * __restrict in,
+    output_window_int32 * __restrict out)
+{{
+    gemv::{impl}<{up}_K, {up}_N, {up}_RELU>(in, out, {name}_w, {name}_b, {up}_SHIFT);
+}}
+"""
+
+
+def _fused_cc(lowered):
+    includes = "\n".join(f'#include "{ly.dense.name}_w.h"\n#include "{ly.dense.name}.h"' for ly in lowered)
+    layers = ",\n".join(f"               gemv::dense_layer<{up}_K, {up}_N, {up}_RELU>{{{name}_w, {name}_b, {up}_SHIFT}}"
+                        for name, up in ((ly.dense.name, ly.dense.name.upper()) for ly in lowered))
+    return f"""#include <adf.h>
+#include "aie_api/aie.hpp"
+#include "aie_api/aie_adf.hpp"
+{includes}
+#include "gemv_fused.h"
+
+// generated by tools/hls4ml_aie.py: {" -> ".join(ly.dense.name for ly in lowered)} in one kernel
+void {FUSED}(
+    input_window_int32 * __restrict in,
+    output_window_int32 * __restrict out)
+{{
+    gemv::mlp8(in, out,
+{layers});
+}}
+"""
+
+
+def _kernels_h(stages, fuse):
+    decls = "\n".join(f"""void {func}(
+    input_window_int32 * __restrict in,
+    output_window_int32 * __restrict out);
+""" for _, func, _, _, _ in stages)
+    what = "all Dense layers in one kernel" if fuse else "one Dense layer per kernel"
+    return f"""#include "adf/window/types.h"
+
+#ifndef FUNCTION_KERNELS_H
+#define FUNCTION_KERNELS_H
+
+// generated by tools/hls4ml_aie.py, {what}
+{decls}
+#endif
+"""
+
+
+def _stages(lowered, fuse):
+    """Graph kernels as (name, function, source, inputs, outputs)."""
+    if fuse:
+        return [("mlp", FUSED, FUSED, lowered[0].k, lowered[-1].n)]
+    return [(ly.dense.name, f"dense_{ly.dense.name}", ly.dense.name, ly.k, ly.n) for ly in lowered]
+
+
+def _graph_cpp(lowered, stages, batch):
+    names = [st[0] for st in stages]
+    chain = " -> ".join(f"{ly.dense.name} ({ly.k}x{ly.n})" for ly in lowered)
+    if len(stages) < len(lowered):
+        chain += ", fused in one kernel"
+    members = "\n".join(f"  kernel {n};" for n in names)
+    create = "\n".join(f"\t\t{n} = kernel::create({func});" for n, func, _, _, _ in stages)
+    ends = ["X.out[0]"] + [f"{n}.out[0]" for n in names]
+    starts = [f"{n}.in[0]" for n in names] + ["Y.in[0]"]
+    sizes = [stages[0][3]] + [st[4] for st in stages]
+    connects = "\n".join(f"\t  connect< window<{s}*sizeof(int32_t)> >  ({a}, {b});"
+                         for s, a, b in zip(sizes, ends, starts))
+    refs = ", ".join("&" + n for n in names)
+    sources = "\n".join(f"\t  source({n}) = \"kernels/{src}.cc\";\n\t  runtime<ratio>({n}) = 1.0;"
+                        for n, _, src, _, _ in stages)
+    tiles, shared = placement.pipeline(len(names))
+    neighbours = "\n".join([f"\t  location<kernel>({n}) = tile({c}, {r});" for n, (c, r) in zip(names, tiles)] +
+                           [f"\t  location<buffer>({a}.out[0]) = location<kernel>({b if t == tiles[i + 1] else a});"
+                            for i, (a, b, t) in enumerate(zip(names, names[1:], shared))])
+    return f"""
+#include <adf.h>
+#include "kernels.h"
+
+#ifdef PLACEMENT
+#include "placement.h"
+#endif
+
+using namespace adf;
+
+// generated by tools/hls4ml_aie.py: {chain}
+class mlpGraph : public adf::graph {{
+private:
+{members}
+
+public:
+
+  input_plio  X;
+  output_plio Y;
+
+  mlpGraph(){{
+
+#ifdef PLIO_BINARY
+		X = input_plio::create("X", plio_128_bits, "data/x.bin", 0.0, true);
+		Y = output_plio::create("Y", plio_128_bits, "data/y_sim.bin", 0.0, true);
+#else
+		X = input_plio::create(plio_128_bits, "data/x.txt");
+		Y = output_plio::create(plio_128_bits, "data/y_sim.txt");
+#endif
+{create}
+
+{connects}
+{sources}
+
+#ifdef PLACEMENT
+	  // tiles and banks planned by tools/placement.py
+	  kernel *layers[] = {{{refs}}};
+	  place_graph([&](int i) -> kernel & {{ return *layers[i]; }});
+#else
+	  // layers on neighbouring tiles (placement.pipeline()), each window between
+	  // them one ping-pong buffer in memory both reach: handed over under locks,
+	  // no DMA or copy
+{neighbours}
+#endif
+  }}
+}};
+
+mlpGraph mygraph;
+
+int main(void) {{
+  mygraph.init();
+  mygraph.run({batch});
+  mygraph.end();
+  return 0;
+}}
+"""
+
+
+MAKEFILE = """\
+# Generated by tools/hls4ml_aie.py: {chain}
+#
+# make run_sim     aiecompiler + aiesimulator, outputs checked against data/y_exp
+# make host_sim    the same graph under the tools/emu host emulation
+# PLIO_FMT=bin uses the binary PLIO files. PLACEMENT=1 applies aie/placement.h,
+# written by `python $(TOOLS)/placement.py .`. Outputs are compared by
+# $(TOOLS)/plio_compare.exe, COMPARE_FLAGS adds e.g. --tol 1.
+
+TOOLS ?= {tools}
+KERNELS ?= {kernels}
+PLATFORM_REPO_PATHS ?= /tools/Xilinx/Vitis/2024.1/base_platforms
+BASE_PLATFORM ?= ${{PLATFORM_REPO_PATHS}}/xilinx_vck190_base_202410_1/xilinx_vck190_base_202410_1.xpfm
+PLIO_FMT ?= text
+PLACEMENT ?=
+
+GRAPH := aie/graph.cpp
+GRAPH_O := libadf.a
+AIECC := v++ -c --mode aie
+AIESIM := aiesimulator
+AIE_FLAGS := --include "$(XILINX_VITIS)/aietools/include" --include "./aie" --include "./aie/kernels" \\
+	     --include "$(KERNELS)" --include "./" --aie.xlopt=0 \\
+	     --platform $(BASE_PLATFORM) --work_dir ./Work --aie.heapsize={heap} --target hw
+ifeq ($(PLIO_FMT),bin)
+	AIE_FLAGS += --aie.Xpreproc=-DPLIO_BINARY
+endif
+ifneq ($(PLACEMENT),)
+	AIE_FLAGS += --aie.Xpreproc=-DPLACEMENT
+endif
+
+HOST_SIM_FLAGS := -std=c++17 -O2 -I$(TOOLS)/emu/include -I./aie -I./aie/kernels -I$(KERNELS) \\
+		  $(if $(filter bin,$(PLIO_FMT)),-DPLIO_BINARY) $(if $(PLACEMENT),-DPLACEMENT)
+
+.PHONY: aie sim run_sim host_sim clean
+
+aie: $(GRAPH_O)
+
+$(GRAPH_O): $(GRAPH) $(wildcard aie/kernels/*)
+	$(AIECC) $(AIE_FLAGS) $(GRAPH)
+
+sim: $(GRAPH_O)
+	$(AIESIM) --profile --pkg-dir=./Work
+
+PLIO_EXT := $(if $(filter bin,$(PLIO_FMT)),bin,txt)
+COMPARE_FLAGS ?=
+
+$(TOOLS)/plio_compare.exe:
+	$(MAKE) -C $(TOOLS) plio_compare.exe
+
+run_sim: sim $(TOOLS)/plio_compare.exe
+	$(TOOLS)/plio_compare.exe int32 "aiesimulator_output/data/y_sim.$(PLIO_EXT)" "data/y_exp.$(PLIO_EXT)" $(COMPARE_FLAGS) \\
+		&& echo "\\n\\n Success: Outputs match\\n\\n" || echo "\\n\\nError: Output does not match\\n\\n"
+
+host_sim: $(TOOLS)/plio_compare.exe
+	g++ $(HOST_SIM_FLAGS) -o host_sim.exe $(GRAPH) $(wildcard aie/kernels/*.cc)
+	./host_sim.exe
+	$(TOOLS)/plio_compare.exe int32 "hostsim_output/data/y_sim.$(PLIO_EXT)" "data/y_exp.$(PLIO_EXT)" $(COMPARE_FLAGS) \\
+		&& echo "\\n\\n Success: Outputs match\\n\\n" || echo "\\n\\nError: Output does not match\\n\\n"
+
+clean:
+	rm -rf Work $(GRAPH_O) *.log *.db *.csv .Xil aiesimulator_output hostsim_output host_sim.exe \\
+	       ISS_RPC_SERVER_PORT plio_throughput_info.json pl_sample_counts
+"""
+
+
+def _save_plio(path, v):
+    """int32 rows as a text PLIO file (4 values per 128-bit line) and a binary one."""
+    v = np.ascontiguousarray(v, dtype=np.int32)
+    np.savetxt(path + ".txt", v.reshape(-1, 4), fmt="%d")
+    v.astype("<i4").tofile(path + ".bin")
+
+
+def export(layers, out_dir, inputs=None, batch=20, lmac="lmac8", packer=None, seed=0, source="model", fuse=False):
+    """Write the AIE project for Dense layers (from_hls4ml/from_spec) to out_dir, return the lowered layers."""
+    packer = packer or os.path.join(HERE, "pack_weights.exe")
+    if not os.path.exists(packer):
+        raise SystemExit(f"{packer} not found, run `make -C {HERE}`")
+    if lmac not in LMAC:
+        raise ValueError(f"unknown lmac mode {lmac}, expected one of {', '.join(LMAC)}")
+    if fuse and lmac != "lmac8":
+        raise ValueError("the fused kernel (gemv::mlp8) uses the lmac8 schedule only")
+    lowered = lower(layers)
+    first = layers[0]
+    if fuse:
+        fp = footprint.fused([(ly.k, ly.n) for ly in lowered], heap=HEAP_BYTES)
+        if not fp.fits():
+            raise ValueError(f"fused, the layers need {fp.total} bytes of tile memory, more than "
+                             f"{footprint.TILE_MEMORY}; export them without --fuse, one tile per layer")
+    stages = _stages(lowered, fuse)
+
+    if inputs is None:
+        lo, hi = first.x_t.range()
+        inputs = np.random.default_rng(seed).uniform(max(lo, -1.0), min(hi, 1.0), (batch, first.w.shape[0]))
+    inputs = np.asarray(inputs, dtype=np.float64).reshape(-1, first.w.shape[0])
+    x = np.zeros((inputs.shape[0], lowered[0].k), dtype=np.int64)
+    x[:, :first.w.shape[0]] = first.x_t.quantize(inputs)
+    y, overflow = run(lowered, x)
+
+    for d in ("aie/kernels", "data"):
+        os.makedirs(os.path.join(out_dir, d), exist_ok=True)
+    kdir = os.path.join(out_dir, "aie", "kernels")
+    for ly in lowered:
+        name = ly.dense.name
+        txt = os.path.join(out_dir, "data", f"{name}_w.txt")
+        blob = os.path.join(out_dir, "data", f"{name}_w.bin")
+        np.savetxt(txt, ly.w, fmt="%d")
+        subprocess.run([packer, "blob", "int32", str(ly.k), str(ly.n), txt, blob, "--packed"], check=True)
+        subprocess.run([packer, "header", blob, os.path.join(kdir, f"{name}_w.h"), "--packed", f"{name}_w"],
+                       check=True)
+        os.remove(txt)
+        _write(os.path.join(kdir, f"{name}.h"), _params_h(ly))
+    # host_sim compiles every .cc: drop those of the other mode from an earlier export
+    stale = [ly.dense.name for ly in lowered] if fuse else [FUSED]
+    for src in stale:
+        if os.path.exists(os.path.join(kdir, f"{src}.cc")):
+            os.remove(os.path.join(kdir, f"{src}.cc"))
+    if fuse:
+        _write(os.path.join(kdir, f"{FUSED}.cc"), _fused_cc(lowered))
+    else:
+        for ly in lowered:
+            _write(os.path.join(kdir, f"{ly.dense.name}.cc"), _kernel_cc(ly, LMAC[lmac]))
+    _write(os.path.join(out_dir, "aie", "kernels.h"), _kernels_h(stages, fuse))
+    _write(os.path.join(out_dir, "aie", "graph.cpp"), _graph_cpp(lowered, stages, x.shape[0]))
+    _write(os.path.join(out_dir, "Makefile"), MAKEFILE.format(
+        chain=" -> ".join(ly.dense.name for ly in lowered), heap=HEAP_BYTES,
+        tools=os.path.relpath(HERE, out_dir), kernels=os.path.relpath(KERNELS, out_dir)))
+    _save_plio(os.path.join(out_dir, "data", "x"), x)
+    _save_plio(os.path.join(out_dir, "data", "y_exp"), y)
+
+    last = layers[-1]
+    err = np.abs(y[:, :last.w.shape[1]] * 2.0 ** -last.y_t.frac - reference(layers, inputs)).max()
+    summary = {
+        "source": source, "batch": int(x.shape[0]), "lmac": lmac, "fuse": fuse,
+        "input": {"type": str(first.x_t), "size": int(first.w.shape[0]), "padded": lowered[0].k},
+        "output": {"type": str(last.y_t), "size": int(last.w.shape[1]), "padded": lowered[-1].n},
+        "max_abs_error_vs_float": float(err),
+        "layers": [{"name": ly.dense.name, "inputs": int(ly.dense.w.shape[0]), "outputs": int(ly.dense.w.shape[1]),
+                    "k": ly.k, "n": ly.n, "shift": ly.shift, "relu": ly.dense.relu, "fused": ly.dense.fused,
+                    "x_t": str(ly.dense.x_t), "w_t": str(ly.dense.w_t), "b_t": str(ly.dense.b_t),
+                    "z_t": str(ly.dense.z_t), "y_t": str(ly.dense.y_t), "overflow": o} for ly, o in zip(lowered, overflow)],
+    }
+    with open(os.path.join(out_dir, "model.json"), "w") as f:
+        json.dump(summary, f, indent=2)
+
+    for ly, o in zip(lowered, overflow):
+        print(f"{ly.dense.name}: {ly.dense.w.shape[0]}x{ly.dense.w.shape[1]} -> {ly.k}x{ly.n}, SHIFT {ly.shift}"
+              f"{', ReLU' if ly.dense.relu else ''}")
+        if o:
+            types = ly.dense.y_t if ly.dense.z_t == ly.dense.y_t else f"{ly.dense.z_t} or {ly.dense.y_t}"
+            print(f"  {o} outputs overflow {types}: hls4ml wraps them at their width, the AIE at 32")
+    if fuse:
+        print(f"all layers in one kernel, {fp.total} of {footprint.TILE_MEMORY} bytes of tile memory")
+    print(f"{x.shape[0]} golden inputs, max |error| vs float {err:.4g} (result {last.y_t})")
+    print(f"wrote {out_dir}, run `make -C {out_dir} host_sim` or run_sim")
+    return lowered
+
+
+def convert(model, out_dir, **kwargs):
+    """Export an hls4ml ModelGraph, see export() for the options."""
+    return export(from_hls4ml(model), out_dir, source=getattr(model, "name", "hls4ml model"), **kwargs)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Export the Dense layers of an hls4ml model to the AIE GemV kernels.")
+    parser.add_argument("spec", nargs="?", help="JSON model spec (see the module docstring or dump_spec).")
+    parser.add_argument("--demo", help="Export a random MLP instead, layer sizes such as 30,40,10.")
+    parser.add_argument("--out", required=True, help="Project directory to write.")
+    parser.add_argument("--inputs", help="Float golden inputs, .npy shaped (batch, inputs). Default: random.")
+    parser.add_argument("--batch", type=int, default=20, help="Random golden inputs to generate.")
+    parser.add_argument("--lmac", choices=sorted(LMAC), default="lmac8", help="GemV8 (lmac8) or GemV4 (lmac4) kernels.")
+    parser.add_argument("--fuse", action="store_true", help="Run all layers in one kernel on one tile.")
+    parser.add_argument("--seed", type=int, default=0)
+    parser.add_argument("--packer", default=os.path.join(HERE, "pack_weights.exe"))
+    args = parser.parse_args()
+
+    if bool(args.spec) == bool(args.demo):
+        parser.error("give a spec or --demo")
+    try:
+        if args.demo:
+            layers, source = from_spec(demo_spec([int(s) for s in args.demo.split(",")], args.seed)), "demo"
+        else:
+            layers, source = from_spec(args.spec), os.path.basename(args.spec)
+        export(layers, args.out, np.load(args.inputs) if args.inputs else None, args.batch, args.lmac,
+               args.packer, args.seed, source, args.fuse)
+    except ValueError as e:
+        raise SystemExit(f"hls4ml_aie: {e}")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,97 @@
+/*
+*	Print the buffer element read by every accumulator lane and column of a
+*	MAC intrinsic, using the same index functions as the host emulation in
+*	emu/aie_emu.h. C++ counterpart of general_scheme.py, 16bx16b_scheme.py
+*	(16b-x with square 0x3210) and 8x8_data_scheme.py (8b-x8, the 8-lane
+*	mac8, with square 0x3120).
+*
+*	How to run:
+*	lane_map.exe general <lanes> <cols> <start> <offsets> <step> [buffer_size]
+*	lane_map.exe 16b-x   <start> <offsets> <offsets_hi> <step> <square> [buffer_size]
+*	lane_map.exe 16b-z   <start> <offsets> <offsets_hi> <step> [buffer_size]
+*	lane_map.exe 8b-x    <start> <offsets> <step> <square> [buffer_size]
+*	lane_map.exe 8b-z    <start> <offsets> <step> <square> [buffer_size]
+*	lane_map.exe 8b-x8   <start> <offsets> <step> <square> [buffer_size]
+*	lane_map.exe 8b-z8   <start> <offsets> <step> <square> [buffer_size]
+*
+*	8b-x and 8b-z are the 16 lanes x 8 columns of the 8-bit mac16, 8b-x8
+*	and 8b-z8 the 8 lanes x 16 columns of mac8.
+*
+*	Numbers accept 0x prefixes, e.g. `lane_map.exe general 4 2 0 0x3210 16`.
+*	Indices are wrapped to buffer_size when it is given.
+*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <string>
+
+#include "emu/aie_emu.h"
+
+static int usage()
+{
+    std::fprintf(stderr,
+                 "usage: lane_map general <lanes> <cols> <start> <offsets> <step> [buffer_size]\n"
+                 "       lane_map 16b-x   <start> <offsets> <offsets_hi> <step> <square> [buffer_size]\n"
+                 "       lane_map 16b-z   <start> <offsets> <offsets_hi> <step> [buffer_size]\n"
+                 "       lane_map 8b-x    <start> <offsets> <step> <square> [buffer_size]\n"
+                 "       lane_map 8b-z    <start> <offsets> <step> <square> [buffer_size]\n"
+                 "       lane_map 8b-x8   <start> <offsets> <step> <square> [buffer_size]\n"
+                 "       lane_map 8b-z8   <start> <offsets> <step> <square> [buffer_size]\n");
+    return 2;
+}
+
+static long num(const char *s) { return std::strtol(s, nullptr, 0); }
+
+static void print(unsigned lanes, unsigned cols, unsigned buffer_size, const std::function<int(unsigned, unsigned)> &idx)
+{
+    for (unsigned l = 0; l < lanes; ++l) {
+        std::printf("lane %2u:", l);
+        for (unsigned c = 0; c < cols; ++c) {
+            int i = idx(l, c);
+            std::printf(" %3d", buffer_size ? int(aie_emu::wrap_index(i, buffer_size)) : i);
+        }
+        std::printf("\n");
+    }
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+        return usage();
+
+    const std::string scheme = argv[1];
+    auto opt = [&](int i) { return argc > i ? unsigned(num(argv[i])) : 0u; };
+
+    if (scheme == "general" && (argc == 7 || argc == 8)) {
+        const int start = num(argv[4]), step = num(argv[6]);
+        const unsigned offsets = num(argv[5]);
+        print(num(argv[2]), num(argv[3]), opt(7), [&](unsigned l, unsigned c) {
+            return aie_emu::index_general(start, offsets, step, l, c);
+        });
+    } else if (scheme == "16b-x" && (argc == 7 || argc == 8)) {
+        const int start = num(argv[2]), step = num(argv[5]);
+        const unsigned lo = num(argv[3]), hi = num(argv[4]), square = num(argv[6]);
+        print(16, 2, opt(7), [&](unsigned l, unsigned c) {
+            return aie_emu::index_16b_x(start, lo, hi, step, square, l, c);
+        });
+    } else if (scheme == "16b-z" && (argc == 6 || argc == 7)) {
+        const int start = num(argv[2]), step = num(argv[5]);
+        const unsigned lo = num(argv[3]), hi = num(argv[4]);
+        print(16, 2, opt(6), [&](unsigned l, unsigned c) {
+            return aie_emu::index_16b_z(start, lo, hi, step, l, c);
+        });
+    } else if ((scheme == "8b-x" || scheme == "8b-z" || scheme == "8b-x8" || scheme == "8b-z8") &&
+               (argc == 6 || argc == 7)) {
+        const int start = num(argv[2]), step = num(argv[4]);
+        const unsigned offsets = num(argv[3]), square = num(argv[5]);
+        const bool x = scheme[3] == 'x', mac8 = scheme.size() == 5;
+        print(mac8 ? 8 : 16, mac8 ? 16 : 8, opt(6), [&](unsigned l, unsigned c) {
+            return x ? aie_emu::index_8b_x(start, offsets, step, square, l, c)
+                     : aie_emu::index_8b_z(start, offsets, step, square, l, c);
+        });
+    } else {
+        return usage();
+    }
+    return 0;
+}
@@ -0,0 +1,155 @@
+/*
+*	Write GemV weights as a binary blob (weight_blob.h) and generate the
+*	kernel headers from it, so every weight header and the golden data come
+*	from the same file.
+*
+*	How to run:
+*	pack_weights.exe blob   <dtype> <rows> <cols> matrix.txt w.bin [--packed]
+*	pack_weights.exe header w.bin out.h --split <Q>
+*	pack_weights.exe header w.bin out.h --packed [name]
+*	pack_weights.exe info   w.bin
+*
+*	matrix.txt holds rows x cols integers row-major (np.savetxt of mat_t:
+*	rows = inputs, cols = outputs). blob stores them row-major, or in kernel
+*	consumption order with --packed (weight_pack.h).
+*
+*	header --split writes matrix.h as the kernels.cc GemV kernels read it,
+*	DTYPE/DX/DY/Q/MQS and `matrix[Q][rows/Q][cols]` with row k in
+*	matrix[k%Q][k/Q]. header --packed writes
+*	`alignas(32) const <dtype> <name>[rows*cols]` in consumption order, name
+*	defaulting to matrix_packed.
+*/
+
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <string>
+
+#include "plio.h"
+#include "weight_blob.h"
+#include "weight_pack.h"
+
+static int usage()
+{
+    std::fprintf(stderr,
+                 "usage: pack_weights blob   <dtype> <rows> <cols> matrix.txt w.bin [--packed]\n"
+                 "       pack_weights header w.bin out.h --split <Q>\n"
+                 "       pack_weights header w.bin out.h --packed [name]\n"
+                 "       pack_weights info   w.bin\n");
+    return 2;
+}
+
+static std::string guard_of(const std::string &name)
+{
+    std::string guard = name;
+    for (char &c : guard)
+        c = std::toupper(static_cast<unsigned char>(c));
+    return guard + "_H";
+}
+
+static FILE *create(const std::string &path)
+{
+    FILE *fp = std::fopen(path.c_str(), "w");
+    if (!fp)
+        throw std::runtime_error("cannot create " + path);
+    return fp;
+}
+
+static void write_split(const weight_blob::blob &b, const std::string &path, size_t q)
+{
+    const size_t rows = b.h.rows, cols = b.h.cols;
+    if (q == 0 || rows % q != 0)
+        throw std::invalid_argument("Q=" + std::to_string(q) + " does not divide " + std::to_string(rows) + " rows");
+    const std::vector<int64_t> mat = b.values(weight_blob::layout::row_major);
+
+    FILE *fp = create(path);
+    std::fprintf(fp, "#ifndef MATRIX_H\n#define MATRIX_H\n");
+    std::fprintf(fp, "#define DTYPE %s\n#define DX %zu\n#define DY %zu\n#define Q %zu\n#define MQS ",
+                 plio::dtype_name(b.type()), rows, cols, q);
+    for (size_t i = 0; i < q; ++i)
+        std::fprintf(fp, "%sm[%zu]", i ? "," : "", i);
+    std::fprintf(fp, "\n\n// generated by tools/pack_weights.exe from a weight blob\n");
+    std::fprintf(fp, "alignas(32) const DTYPE matrix[%zu][%zu][%zu] = {\n", q, rows / q, cols);
+    for (size_t s = 0; s < q; ++s) {
+        std::fprintf(fp, "    { // matrix block %zu\n", s);
+        for (size_t k = s; k < rows; k += q) {
+            std::fprintf(fp, "        {");
+            for (size_t n = 0; n < cols; ++n)
+                std::fprintf(fp, "%s%lld", n ? ", " : "", static_cast<long long>(mat[k * cols + n]));
+            std::fprintf(fp, "}%s\n", k + q < rows ? "," : "");
+        }
+        std::fprintf(fp, "    }%s\n", s + 1 < q ? "," : "");
+    }
+    std::fprintf(fp, "};\n\n#endif // MATRIX_H\n");
+    std::fclose(fp);
+}
+
+static void write_packed(const weight_blob::blob &b, const std::string &path, const std::string &name)
+{
+    const std::vector<int64_t> packed = b.values(weight_blob::layout::gemv_packed);
+    const std::string guard = guard_of(name);
+
+    FILE *fp = create(path);
+    std::fprintf(fp, "#ifndef %s\n#define %s\n\n", guard.c_str(), guard.c_str());
+    std::fprintf(fp, "// %ux%u weights in GemV consumption order, %zu-column blocks (tools/weight_pack.h)\n",
+                 b.h.rows, b.h.cols, weight_pack::gemv_block);
+    std::fprintf(fp, "alignas(32) const %s %s[%zu] = {\n", plio::dtype_name(b.type()), name.c_str(), packed.size());
+    for (size_t i = 0; i < packed.size(); ++i) {
+        if (i % weight_pack::gemv_block == 0)
+            std::fprintf(fp, "    ");
+        std::fprintf(fp, "%lld%s", static_cast<long long>(packed[i]), i + 1 < packed.size() ? "," : "");
+        std::fprintf(fp, (i + 1) % weight_pack::gemv_block == 0 ? "\n" : " ");
+    }
+    std::fprintf(fp, "};\n\n#endif // %s\n", guard.c_str());
+    std::fclose(fp);
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 3)
+        return usage();
+    const std::string cmd = argv[1];
+
+    try {
+        if (cmd == "blob" && (argc == 7 || argc == 8)) {
+            const bool packed = argc == 8 && std::string(argv[7]) == "--packed";
+            if (argc == 8 && !packed)
+                return usage();
+            const plio::dtype t = plio::parse_dtype(argv[2]);
+            const size_t rows = std::strtoul(argv[3], nullptr, 10);
+            const size_t cols = std::strtoul(argv[4], nullptr, 10);
+
+            std::vector<int64_t> mat = plio::read_text(argv[5], t);
+            if (packed)
+                mat = weight_pack::pack_gemv(mat, rows, cols);
+            else if (mat.size() != rows * cols)
+                throw std::invalid_argument(std::string(argv[5]) + " has " + std::to_string(mat.size()) +
+                                            " values, expected " + std::to_string(rows) + "x" + std::to_string(cols));
+            weight_blob::write(argv[6], t, packed ? weight_blob::layout::gemv_packed : weight_blob::layout::row_major,
+                               rows, cols, mat);
+        } else if (cmd == "header" && argc >= 5) {
+            const weight_blob::blob b = weight_blob::read(argv[2]);
+            const std::string mode = argv[4];
+            if (mode == "--split" && argc == 6)
+                write_split(b, argv[3], std::strtoul(argv[5], nullptr, 10));
+            else if (mode == "--packed" && (argc == 5 || argc == 6))
+                write_packed(b, argv[3], argc == 6 ? argv[5] : "matrix_packed");
+            else
+                return usage();
+        } else if (cmd == "info" && argc == 3) {
+            const weight_blob::blob b = weight_blob::read(argv[2]);
+            std::printf("%s: %s %ux%u, %s", argv[2], plio::dtype_name(b.type()), b.h.rows, b.h.cols,
+                        b.order() == weight_blob::layout::gemv_packed ? "packed" : "row-major");
+            if (b.h.block)
+                std::printf(" (%u-column blocks)", b.h.block);
+            std::printf(", %llu bytes at offset %u\n", static_cast<unsigned long long>(b.h.bytes), b.h.offset);
+        } else {
+            return usage();
+        }
+    } catch (const std::exception &e) {
+        std::fprintf(stderr, "pack_weights: %s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,373 @@
+/*
+*	Predict the cycles of a GemV or GEMM kernel configuration with
+*	perf_model.h instead of an aiecompiler + aiesimulator run.
+*
+*	How to run:
+*	perf_model.exe gemv <K> <N> [--kernel GemV8|GemV4] [--source unrolled_kernels.cc] [--nb n]
+*	                    [--x int32] [--w int32] [--y int32] [--weights const|rtp|stream] [--chunk kc]
+*	perf_model.exe gemm <single_M> <single_K> <single_N> [--api 2x2x2]
+*	perf_model.exe calibrate
+*	perf_model.exe sweep [--max-k n] [--max-n n] [--max-tile n] [--csv out.csv]
+*	perf_model.exe cycles < configurations.txt
+*
+*	gemv and gemm break one configuration down: loop iterations, II and the
+*	MAC/load/store slot cycles behind it, the fixed cost, the PLIO transfers,
+*	the steady state interval and latency of an invocation, what bounds it,
+*	and the tile memory. calibrate prints the model next to the documented
+*	kernel cycles its fixed costs are fitted to, which it matches by
+*	construction. gemm cycles do not depend on the mmul shape (perf_model.h).
+*	sweep scores every GemV (int32, int16,
+*	int8 and mixed, each kernel, source, weight mode and NB up to 4) and
+*	every gemm tile up to --max-tile (default 64) on each mmul shape,
+*	prints the best ones that fit a tile and how many configurations per
+*	second it scored, and with --csv writes every row. cycles reads one gemv or
+*	gemm configuration per line of stdin, in the arguments of those commands,
+*	and prints its kernel cycles and tile memory per line: the cycle model of
+*	tools/autotune.py and bench/bench.py.
+*
+*	machine options, for every command:
+*	  --aie-freq ghz --pl-freq ghz   AIE and PLIO clocks (default 1.25 and 0.3125)
+*	  --plio-bits n                  PLIO width (default 128)
+*	  --mm2s                         the 32-bit pl_kernels feed the PLIOs, as on hw
+*	  --lock n --call n              window lock and kernel call cycles (default 6 and 20)
+*/
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "gemm_plan.h"
+#include "perf_model.h"
+#include "plio.h"
+
+using namespace perf_model;
+
+static int usage()
+{
+    std::fprintf(stderr,
+                 "usage: perf_model gemv <K> <N> [--kernel GemV8|GemV4] [--source file.cc] [--nb n] [--x dtype] "
+                 "[--w dtype] [--y dtype] [--weights const|rtp|stream] [--chunk kc] [machine]\n"
+                 "       perf_model gemm <single_M> <single_K> <single_N> [--api MxKxN] [machine]\n"
+                 "       perf_model calibrate [machine]\n"
+                 "       perf_model sweep [--max-k n] [--max-n n] [--max-tile n] [--csv out.csv] [machine]\n"
+                 "       perf_model cycles < configurations (one gemv or gemm command line each)\n"
+                 "machine: [--aie-freq ghz] [--pl-freq ghz] [--plio-bits n] [--mm2s] [--lock n] [--call n]\n");
+    return 2;
+}
+
+struct options {
+    machine m;
+    gemv_config gemv;
+    gemm_config gemm;
+    size_t max_k = 256, max_n = 256, max_tile = 64;
+    std::string csv;
+};
+
+static unsigned bits(const std::string &dtype)
+{
+    return unsigned(plio::dtype_size(plio::parse_dtype(dtype)) * 8);
+}
+
+static source parse_source(const std::string &name)
+{
+    for (source s : {source::kernels, source::optimized, source::unrolled, source::packed})
+        if (name == source_name(s))
+            return s;
+    throw std::invalid_argument("unknown --source " + name);
+}
+
+static weights parse_weights(const std::string &name)
+{
+    for (weights w : {weights::resident, weights::rtp, weights::stream})
+        if (name == weights_name(w))
+            return w;
+    throw std::invalid_argument("--weights takes const, rtp or stream, not " + name);
+}
+
+// options from argv[first..], false on an unknown one
+static bool parse(int argc, char **argv, int first, options &o)
+{
+    for (int i = first; i < argc; ++i) {
+        const std::string opt = argv[i];
+        if (opt == "--mm2s") {
+            o.m.mm2s = true;
+            continue;
+        }
+        if (i + 1 >= argc)
+            return false;
+        const std::string v = argv[++i];
+        const size_t n = std::strtoul(v.c_str(), nullptr, 10);
+        if (opt == "--kernel") {
+            if (v != "GemV8" && v != "GemV4")
+                throw std::invalid_argument("--kernel takes GemV8 or GemV4, not " + v);
+            o.gemv.v = v == "GemV8" ? variant::gemv8 : variant::gemv4;
+        } else if (opt == "--source") {
+            o.gemv.src = parse_source(v);
+        } else if (opt == "--nb") {
+            o.gemv.nb = n;
+        } else if (opt == "--x") {
+            o.gemv.x_bits = bits(v);
+        } else if (opt == "--w") {
+            o.gemv.w_bits = bits(v);
+        } else if (opt == "--y") {
+            o.gemv.y_bits = bits(v);
+        } else if (opt == "--weights") {
+            o.gemv.wt = parse_weights(v);
+        } else if (opt == "--chunk") {
+            o.gemv.wt = weights::chunked;
+            o.gemv.chunk = n;
+        } else if (opt == "--api") {
+            if (std::sscanf(v.c_str(), "%zux%zux%zu", &o.gemm.api.m, &o.gemm.api.k, &o.gemm.api.n) != 3)
+                throw std::invalid_argument("--api takes MxKxN, e.g. 2x2x2, not " + v);
+        } else if (opt == "--max-k") {
+            o.max_k = n;
+        } else if (opt == "--max-n") {
+            o.max_n = n;
+        } else if (opt == "--max-tile") {
+            o.max_tile = n;
+        } else if (opt == "--csv") {
+            o.csv = v;
+        } else if (opt == "--aie-freq") {
+            o.m.aie_ghz = std::strtod(v.c_str(), nullptr);
+        } else if (opt == "--pl-freq") {
+            o.m.pl_ghz = std::strtod(v.c_str(), nullptr);
+        } else if (opt == "--plio-bits") {
+            o.m.plio_bits = unsigned(n);
+        } else if (opt == "--lock") {
+            o.m.lock_cycles = n;
+        } else if (opt == "--call") {
+            o.m.call_cycles = n;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+static std::string describe(const gemv_config &c)
+{
+    char s[160];
+    if (c.int32())
+        std::snprintf(s, sizeof(s), "%s %s %zux%zu NB %zu, %s weights", variant_name(c.v), source_name(c.src), c.k,
+                      c.n, c.nb, weights_name(c.wt));
+    else
+        std::snprintf(s, sizeof(s), "GemV a%uw%u->%u %zux%zu NB %zu, %s weights", c.x_bits, c.w_bits, c.y_bits,
+                      c.k, c.n, c.nb, weights_name(c.wt));
+    std::string d = s;
+    if (c.wt == weights::chunked)
+        d += " of " + std::to_string(c.chunk);
+    return d;
+}
+
+static std::string describe(const gemm_config &c)
+{
+    char s[96];
+    std::snprintf(s, sizeof(s), "gemm %zux%zux%zu on %zux%zux%zu mmul", c.m, c.k, c.n, c.api.m, c.api.k, c.api.n);
+    return s;
+}
+
+static void print(const std::string &name, const estimate &e, const machine &m)
+{
+    const kernel_cycles &k = e.kernel;
+    std::printf("%s\n", name.c_str());
+    std::printf("  kernel  %zu cycles: %zu iterations at II %.4g (MAC %.4g, load %.4g, store %.4g) + %zu fixed, %s "
+                "bound\n",
+                k.total(), k.trips, k.ii(), k.mac, k.load, k.store, k.fixed, k.bound());
+    std::printf("  graph   %zu cycles per invocation (kernel + %zu call and locks, input PLIO %zu, output PLIO %zu), "
+                "%s bound\n",
+                e.interval(), e.handoff, e.in, e.out, e.bound());
+    std::printf("          latency %zu cycles, %.2f MACs/cycle, %.3g invocations/s at %.3g GHz, %.3g B/cycle per "
+                "PLIO\n",
+                e.latency(), e.macs_per_cycle(), e.per_second(m), m.aie_ghz, stream_rate(m));
+    std::printf("  memory  %zu of %zu bytes%s\n", e.memory, tile_memory, e.fits() ? "" : ", does not fit");
+}
+
+static void calibrate(const machine &m)
+{
+    struct point {
+        gemv_config c;
+        size_t cycles;
+    };
+    std::vector<point> points;
+    for (source s : {source::kernels, source::optimized})
+        for (variant v : {variant::gemv8, variant::gemv4}) {
+            gemv_config c;
+            c.v = v, c.src = s;
+            points.push_back({c, s == source::kernels ? (v == variant::gemv8 ? documented::gemv8 : documented::gemv4)
+                                                      : (v == variant::gemv8 ? documented::gemv8_optimized
+                                                                             : documented::gemv4_optimized)});
+        }
+    gemv_config i16;
+    i16.x_bits = i16.w_bits = i16.y_bits = 16;
+    points.push_back({i16, documented::gemv_i16});
+
+    std::printf("%-52s %10s %6s %6s %6s %6s  %s\n", "kernel", "documented", "model", "loop", "II", "fixed",
+                "interval (plio, mm2s)");
+    machine hw = m;
+    hw.mm2s = true;
+    for (const point &p : points) {
+        const estimate e = gemv(p.c, m);
+        std::printf("%-52s %10zu %6zu %6zu %6.4g %6zu  %zu, %zu\n", describe(p.c).c_str(), p.cycles, e.kernel.total(),
+                    e.kernel.loop(), e.kernel.ii(), e.kernel.fixed, e.interval(), gemv(p.c, hw).interval());
+    }
+    const gemm_config g;
+    const estimate e = gemm(g, m);
+    std::printf("%-52s %10zu %6zu %6zu %6.4g %6zu  %zu, %zu\n", describe(g).c_str(), documented::gemm,
+                e.kernel.total(), e.kernel.loop(), e.kernel.ii(), e.kernel.fixed, e.interval(),
+                gemm(g, hw).interval());
+    std::printf("\none fixed cost per kernel is fitted to each documented figure, so they match by construction;\n"
+                "nothing here validates the model\n");
+}
+
+struct row {
+    std::string kind, name;
+    estimate e;
+};
+
+static void sweep(const options &o)
+{
+    std::vector<row> rows;
+    const auto t0 = std::chrono::steady_clock::now();
+    auto add = [&](const char *kind, const std::string &name, const estimate &e) { rows.push_back({kind, name, e}); };
+
+    // x, w, y widths of gemv_i32, gemv_i16, gemv_i8 and the gemv_mixed MIX builds
+    const unsigned types[][3] = {{32, 32, 32}, {16, 16, 16}, {8, 8, 8}, {8, 16, 8}, {16, 8, 16}, {16, 32, 16}};
+    for (const auto &t : types)
+        for (size_t k = 8; k <= o.max_k; k += 8)
+            for (size_t n = block; n <= o.max_n; n += block)
+                for (size_t nb = 1; nb <= 4; ++nb)
+                    for (weights wt : {weights::resident, weights::rtp, weights::stream})
+                        for (variant v : {variant::gemv8, variant::gemv4})
+                            for (source s : {source::unrolled, source::packed}) {
+                                gemv_config c;
+                                c.k = k, c.n = n, c.nb = nb, c.x_bits = t[0], c.w_bits = t[1], c.y_bits = t[2];
+                                c.wt = wt, c.v = v, c.src = s;
+                                if (!c.int32() && (k % 16 || v != variant::gemv8 || s != source::unrolled))
+                                    continue;
+                                add("gemv", describe(c), gemv(c, o.m));
+                            }
+    // split-K GemV8 over K up to max-k
+    for (size_t k = 8; k <= o.max_k; k += 8)
+        for (size_t n = block; n <= o.max_n; n += block)
+            for (size_t kc = 8; kc <= k; kc += 8)
+                if (k % kc == 0) {
+                    gemv_config c;
+                    c.k = k, c.n = n, c.wt = weights::chunked, c.chunk = kc;
+                    add("gemv", describe(c), gemv(c, o.m));
+                }
+    for (const gemm_plan::api &a : gemm_plan::api_shapes)
+        for (size_t tm = 2 * a.m; tm <= o.max_tile; tm += 2 * a.m)
+            for (size_t tn = 2 * a.n; tn <= o.max_tile; tn += 2 * a.n)
+                for (size_t tk = a.k; tk <= o.max_tile; tk += a.k) {
+                    gemm_config c;
+                    c.m = tm, c.k = tk, c.n = tn, c.api = a;
+                    add("gemm", describe(c), gemm(c, o.m));
+                }
+    const double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    size_t fit = 0;
+    for (const row &r : rows)
+        fit += r.e.fits();
+    std::printf("%zu configurations (%zu fit a tile) in %.1f ms, %.3g per second\n", rows.size(), fit, s * 1e3,
+                double(rows.size()) / s);
+    for (const char *kind : {"gemv", "gemm"}) {
+        const row *best = nullptr;
+        for (const row &r : rows)
+            if (r.kind == kind && r.e.fits() && (!best || r.e.macs_per_cycle() > best->e.macs_per_cycle()))
+                best = &r;
+        if (best)
+            std::printf("best %s: %s, %.2f MACs/cycle, %zu cycles per invocation, %s bound%s\n", kind,
+                        best->name.c_str(), best->e.macs_per_cycle(), best->e.interval(), best->e.bound(),
+                        best->kind == "gemm" ? " (mmul shape not ranked)" : "");
+    }
+
+    if (o.csv.empty())
+        return;
+    FILE *fp = std::fopen(o.csv.c_str(), "w");
+    if (!fp)
+        throw std::runtime_error("cannot create " + o.csv);
+    std::fprintf(fp, "kind,configuration,kernel_cycles,ii,fixed,interval,latency,bound,macs_per_cycle,memory,fits\n");
+    for (const row &r : rows)
+        std::fprintf(fp, "%s,\"%s\",%zu,%.4g,%zu,%zu,%zu,%s,%.4f,%zu,%d\n", r.kind.c_str(), r.name.c_str(),
+                     r.e.kernel.total(), r.e.kernel.ii(), r.e.kernel.fixed, r.e.interval(), r.e.latency(),
+                     r.e.bound(), r.e.macs_per_cycle(), r.e.memory, r.e.fits());
+    std::fclose(fp);
+}
+
+// "<kernel cycles> <memory>" for each "gemv K N [options]" or "gemm M K N [options]" line of stdin
+static void cycles()
+{
+    std::string line;
+    for (size_t number = 1; std::getline(std::cin, line); ++number) {
+        std::istringstream words(line);
+        std::vector<std::string> args{"perf_model"};
+        for (std::string w; words >> w;)
+            args.push_back(w);
+        std::vector<char *> argv;
+        for (std::string &a : args)
+            argv.push_back(&a[0]);
+        const int argc = int(argv.size());
+
+        options o;
+        estimate e;
+        if (argc >= 4 && args[1] == "gemv" && parse(argc, argv.data(), 4, o)) {
+            o.gemv.k = std::strtoul(argv[2], nullptr, 10);
+            o.gemv.n = std::strtoul(argv[3], nullptr, 10);
+            e = gemv(o.gemv, o.m);
+        } else if (argc >= 5 && args[1] == "gemm" && parse(argc, argv.data(), 5, o)) {
+            o.gemm.m = std::strtoul(argv[2], nullptr, 10);
+            o.gemm.k = std::strtoul(argv[3], nullptr, 10);
+            o.gemm.n = std::strtoul(argv[4], nullptr, 10);
+            e = gemm(o.gemm, o.m);
+        } else {
+            throw std::invalid_argument("line " + std::to_string(number) + ": not a gemv or gemm configuration");
+        }
+        std::printf("%zu %zu\n", e.kernel.total(), e.memory);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+        return usage();
+    const std::string cmd = argv[1];
+    options o;
+
+    try {
+        if (cmd == "gemv" && argc >= 4 && parse(argc, argv, 4, o)) {
+            o.gemv.k = std::strtoul(argv[2], nullptr, 10);
+            o.gemv.n = std::strtoul(argv[3], nullptr, 10);
+            print(describe(o.gemv), gemv(o.gemv, o.m), o.m);
+            return 0;
+        }
+        if (cmd == "gemm" && argc >= 5 && parse(argc, argv, 5, o)) {
+            o.gemm.m = std::strtoul(argv[2], nullptr, 10);
+            o.gemm.k = std::strtoul(argv[3], nullptr, 10);
+            o.gemm.n = std::strtoul(argv[4], nullptr, 10);
+            print(describe(o.gemm), gemm(o.gemm, o.m), o.m);
+            std::printf("  note    the mmul shape is not modelled, every shape of this tile gives these cycles\n");
+            return 0;
+        }
+        if (cmd == "calibrate" && parse(argc, argv, 2, o)) {
+            calibrate(o.m);
+            return 0;
+        }
+        if (cmd == "sweep" && parse(argc, argv, 2, o)) {
+            sweep(o);
+            return 0;
+        }
+        if (cmd == "cycles" && argc == 2) {
+            cycles();
+            return 0;
+        }
+        return usage();
+    } catch (const std::exception &e) {
+        std::fprintf(stderr, "perf_model: %s\n", e.what());
+        return 1;
+    }
+}
@@ -0,0 +1,383 @@
+/*
+ *  Cycle-approximate performance model of the GemV and GEMM kernels.
+ *
+ *  Every point of a sizing study otherwise costs an aiecompiler and an
+ *  aiesimulator run. This predicts the cycles of one kernel invocation, and
+ *  of the graph iteration around it, from the instruction mix of the
+ *  kernels' inner loops, fast enough to score thousands of configurations
+ *  per second before simulating the few that matter.
+ *
+ *  Kernel. The inner loops are software pipelined
+ *  (chess_prepare_for_pipelining, or flattened in gemm). An AIE1 tile issues
+ *  one vector MAC, two 256-bit loads and one 256-bit store per cycle, so an
+ *  iteration of a loop costs its busiest slot:
+ *
+ *      II = max(MAC ops, 256-bit loads / 2, 256-bit stores)
+ *
+ *  GemV8/GemV4 int32: one iteration per 8 inputs of a 16-column block. That
+ *  is 16 lmac8 or lmac4 of 8 int32 MACs against 8 weight rows of 64 bytes
+ *  and the 8 inputs, so II = 16, MAC bound, with the load ports half busy.
+ *
+ *  int16, int8 and mixed GemV: one mac16/mac8 per iteration at the AIE1 rate
+ *  of the operand widths, see macs_per_cycle(), except a16w8, which widens
+ *  its weights and runs at the 16b x 16b rate (gemv_mixed.h). Its weights are
+ *  read in the same iteration. With 8-bit weights and inputs, or a8w16, that
+ *  is more than the 64 bytes per cycle the load ports give, so those kernels
+ *  are load bound.
+ *
+ *  gemm: one 2x2 block of mmul tiles per K_API step (gemm_plan.h). Every
+ *  mmul shape of gemm_plan::api_shapes is MAC bound here, so a tile costs
+ *  M*K*N/8 plus the fixed cost of 2x2x2 whatever the shape. The per-shape
+ *  loads, shuffles and lane use are not modelled, so the model does not
+ *  rank the shapes. Only aiesimulator does.
+ *
+ *  Each call also has a fixed cost: accumulator setup, to_vector, the
+ *  output writes and the loop fill. GemV pays it per 16-column block and
+ *  input vector, gemm per call. It is fitted to the documented kernel
+ *  cycles, the source comments and tile.cycles() printouts for 16x16
+ *  (16x32x16 for gemm):
+ *
+ *      GemV8   kernels.cc 79, optimized_kernels.cc 71
+ *      GemV4   kernels.cc 87, optimized_kernels.cc 77
+ *      gemv_i16 GemV 42, gemm 2x2x2 1071
+ *
+ *  That is one free constant per figure, so the model reproduces these by
+ *  construction. They are the fit, not a check of it. No run the fit did not
+ *  see has been compared with the model, so it is not validated: use it to
+ *  prune a search, and confirm the winners with aiesimulator. The unrolled,
+ *  packed, rtp and split-K kernels are assumed to share the schedule of
+ *  optimized_kernels.cc. The int8 and mixed kernels are assumed to share the
+ *  schedule of gemv_i16. None of them is measured yet.
+ *
+ *  Graph. Windows are ping-pong buffered, so the DMA of the next input and
+ *  of the previous output overlap the kernel. In steady state one invocation
+ *  takes the longest of:
+ *
+ *      kernel + call + a lock acquire/release per window port
+ *      bytes / stream rate, for each PLIO
+ *
+ *  A PLIO moves min(4 bytes per AIE cycle (one stream port), plio bits / 8
+ *  per PL cycle). plio_128_bits at aiesimulator's PL clock, a quarter of
+ *  the AIE clock, gives the full 4 bytes. On hardware the pl_kernels
+ *  mm2s/s2mm feed the PLIOs with ap_axis<32>. That is 4 bytes per PL cycle,
+ *  or 1 byte per AIE cycle at that clock. The latency of one invocation adds
+ *  the transfers instead. The documented figures are all taken inside the
+ *  kernel, so the call and lock costs are estimates and can be set from the
+ *  command line.
+ */
+
+#ifndef PERF_MODEL_H
+#define PERF_MODEL_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+
+namespace perf_model {
+
+constexpr unsigned load_ports = 2;
+constexpr unsigned store_ports = 1;
+constexpr size_t port_bytes = 32;      // 256-bit load and store ports
+constexpr size_t block = 16;           // GemV outputs per column block
+constexpr size_t tile_memory = 32 * 1024;
+constexpr size_t align = 32;           // buffers are 256-bit aligned (tools/footprint.py)
+constexpr size_t heap = 2048;          // --aie.heapsize of the gemv_i32 and gemm_i32 Makefiles, footprint.HEAP
+constexpr size_t stack = 1024;         // aiecompiler default, footprint.STACK
+
+// documented kernel cycles the fixed costs are fitted to
+namespace documented {
+constexpr size_t gemv8 = 79, gemv4 = 87;                     // gemv_i32 kernels.cc, 16x16
+constexpr size_t gemv8_optimized = 71, gemv4_optimized = 77; // optimized_kernels.cc
+constexpr size_t gemv_i16 = 42;                              // gemv_i16 kernels.cc, 16x16
+constexpr size_t gemm = 1071;                                // gemm_i32, 16x32x16 on 2x2x2 mmul
+} // namespace documented
+
+// the AIE tile and the PL side of its PLIOs
+struct machine {
+    double aie_ghz = 1.25;
+    double pl_ghz = 0.3125;            // aiesimulator's PLIO clock, a quarter of the AIE clock
+    unsigned plio_bits = 128;          // plio_128_bits in the graphs
+    unsigned mm2s_bits = 32;           // ap_axis<32> of pl_kernels/mm2s.cpp and s2mm.cpp
+    bool mm2s = false;                 // the PL kernels feed the PLIOs (hw, hw_emu), not aiesimulator
+    size_t stream_bytes = 4;           // one AIE stream port per cycle
+    size_t lock_cycles = 6;            // acquire and release of one window buffer, per invocation
+    size_t call_cycles = 20;           // kernel call and return in the tile's main loop
+};
+
+// int MACs per cycle of the AIE1 vector unit: 128 8x8, 64 16x8, 32 16x16,
+// 16 32x16, 8 32x32. 8-bit operands against 32-bit ones use the 16-bit multipliers.
+constexpr unsigned macs_per_cycle(unsigned x_bits, unsigned w_bits)
+{
+    if (x_bits == 8 && w_bits == 32)
+        x_bits = 16;
+    if (w_bits == 8 && x_bits == 32)
+        w_bits = 16;
+    return 8 * (32 / x_bits) * (32 / w_bits);
+}
+
+constexpr size_t aligned(size_t bytes) { return (bytes + align - 1) / align * align; }
+
+// bytes one PLIO moves per AIE cycle
+inline double stream_rate(const machine &m)
+{
+    const double ratio = m.pl_ghz / m.aie_ghz;
+    double r = std::min(double(m.stream_bytes), m.plio_bits / 8.0 * ratio);
+    if (m.mm2s)
+        r = std::min(r, m.mm2s_bits / 8.0 * ratio);
+    return r;
+}
+
+inline size_t stream_cycles(const machine &m, size_t bytes)
+{
+    return size_t(std::ceil(double(bytes) / stream_rate(m)));
+}
+
+// one kernel call
+struct kernel_cycles {
+    size_t trips = 0;                  // pipelined loop iterations
+    double mac = 0, load = 0, store = 0; // issue slot cycles per iteration
+    size_t fixed = 0;                  // setup, epilogue and loop fill, fitted
+
+    double ii() const { return std::max({mac, load, store}); }
+    size_t loop() const { return size_t(double(trips) * ii() + 0.5); }
+    size_t total() const { return loop() + fixed; }
+    const char *bound() const
+    {
+        if (fixed > loop())
+            return "fixed cost";
+        return mac >= load && mac >= store ? "MAC" : load >= store ? "load" : "store";
+    }
+};
+
+// one graph invocation, steady state
+struct estimate {
+    kernel_cycles kernel;
+    size_t handoff = 0;                // kernel call and window locks
+    size_t in = 0, out = 0;            // cycles of the busiest input and output PLIO
+    size_t macs = 0;                   // useful MACs
+    size_t memory = 0;                 // tile data memory bytes
+
+    size_t compute() const { return kernel.total() + handoff; }
+    size_t interval() const { return std::max({compute(), in, out}); }
+    size_t latency() const { return in + compute() + out; }
+    bool fits() const { return memory <= tile_memory; }
+    const char *bound() const
+    {
+        if (interval() > compute())
+            return in >= out ? "input PLIO" : "output PLIO";
+        return kernel.bound();
+    }
+    double macs_per_cycle() const { return double(macs) / double(interval()); }
+    double per_second(const machine &m) const { return m.aie_ghz * 1e9 / double(interval()); }
+};
+
+/*
+ *  GemV
+ */
+
+enum class variant { gemv8, gemv4 };
+enum class source { kernels, optimized, unrolled, packed };
+// resident: matrix.h in the ELF (const); rtp: the async RTP, two copies;
+// stream: over their own PLIO every invocation; chunked: GemV8SplitK
+enum class weights { resident, rtp, stream, chunked };
+
+struct gemv_config {
+    size_t k = 16, n = 16, nb = 1;     // DX inputs, DY outputs, input vectors per invocation
+    unsigned x_bits = 32, w_bits = 32, y_bits = 32;
+    variant v = variant::gemv8;        // int32 only
+    source src = source::unrolled;     // int32 only
+    weights wt = weights::resident;
+    size_t chunk = 0;                  // inputs per invocation for weights::chunked
+
+    bool int32() const { return x_bits == 32 && w_bits == 32; }
+    size_t k_call() const { return wt == weights::chunked ? chunk : k; }
+};
+
+inline const char *variant_name(variant v) { return v == variant::gemv8 ? "GemV8" : "GemV4"; }
+
+inline const char *source_name(source s)
+{
+    switch (s) {
+    case source::kernels:   return "kernels.cc";
+    case source::optimized: return "optimized_kernels.cc";
+    case source::unrolled:  return "unrolled_kernels.cc";
+    case source::packed:    return "packed_kernels.cc";
+    }
+    return "?";
+}
+
+inline const char *weights_name(weights w)
+{
+    switch (w) {
+    case weights::resident: return "const";
+    case weights::rtp:      return "rtp";
+    case weights::stream:   return "stream";
+    case weights::chunked:  return "chunked";
+    }
+    return "?";
+}
+
+inline void check(const gemv_config &c)
+{
+    for (unsigned b : {c.x_bits, c.w_bits, c.y_bits})
+        if (b != 8 && b != 16 && b != 32)
+            throw std::invalid_argument("operand widths are 8, 16 or 32 bits, not " + std::to_string(b));
+    const size_t kstep = c.int32() ? 8 : 16;
+    if (!c.k || !c.n || !c.nb || c.k % kstep || c.n % block)
+        throw std::invalid_argument("K must be a multiple of " + std::to_string(kstep) +
+                                    " and N of 16 for these kernels");
+    if (c.int32() && (c.src == source::kernels || c.src == source::optimized) &&
+        (c.k != 16 || c.n != 16 || c.nb != 1))
+        throw std::invalid_argument(std::string(source_name(c.src)) + " is 16x16 with NB 1 only");
+    if (c.wt == weights::chunked &&
+        (!c.int32() || c.v != variant::gemv8 || !c.chunk || c.chunk % 8 || c.k % c.chunk))
+        throw std::invalid_argument("split-K is the int32 GemV8 with a chunk that is a multiple of 8 and divides K");
+}
+
+// the pipelined loop alone
+inline kernel_cycles gemv_loop(const gemv_config &c)
+{
+    kernel_cycles kc;
+    const size_t k = c.k_call();
+    if (c.int32()) {
+        // 16 lmac8/lmac4 per 8 inputs of a column block: 8 weight rows and the inputs
+        kc.trips = c.nb * (c.n / block) * (k / 8);
+        kc.mac = 16;
+        kc.load = double(8 * block * 4 + 8 * 4) / (load_ports * port_bytes);
+    } else {
+        // one mac16/mac8 per iteration with its weights; a16w8 widens them to int16
+        const unsigned rate = c.x_bits == 16 && c.w_bits == 8 ? macs_per_cycle(16, 16)
+                                                              : macs_per_cycle(c.x_bits, c.w_bits);
+        kc.trips = c.nb * ((k * c.n + rate - 1) / rate);
+        kc.mac = 1;
+        kc.load = double(rate) * c.w_bits / 8 / (load_ports * port_bytes);
+    }
+    // the output writes, spread over the iterations
+    kc.store = double(c.nb * c.n * c.y_bits / 8) / port_bytes / store_ports / double(kc.trips);
+    return kc;
+}
+
+// fixed cycles per column block and input vector, fitted at 16x16
+inline size_t gemv_fixed(const gemv_config &c)
+{
+    gemv_config ref;
+    size_t measured;
+    if (c.int32()) {
+        ref.v = c.v;
+        if (c.src == source::kernels)
+            measured = c.v == variant::gemv8 ? documented::gemv8 : documented::gemv4;
+        else
+            measured = c.v == variant::gemv8 ? documented::gemv8_optimized : documented::gemv4_optimized;
+    } else {
+        ref.x_bits = ref.w_bits = ref.y_bits = 16;
+        measured = documented::gemv_i16;
+    }
+    return measured - gemv_loop(ref).loop();
+}
+
+inline kernel_cycles gemv_kernel(const gemv_config &c)
+{
+    kernel_cycles kc = gemv_loop(c);
+    kc.fixed = c.nb * (c.n / block) * gemv_fixed(c);
+    return kc;
+}
+
+// tile data memory, as tools/footprint.py gemv and split_k
+inline size_t gemv_memory(const gemv_config &c)
+{
+    if (c.wt == weights::chunked)
+        return 2 * aligned(c.chunk * 4) + 2 * aligned(c.chunk * c.n * 4) + aligned(c.n / 8 * 80) + heap + stack;
+    const size_t w = c.k * c.n * c.w_bits / 8;
+    const size_t resident = c.wt == weights::resident ? w : c.wt == weights::rtp ? 2 * w : 0;
+    return aligned(resident) + 2 * aligned(c.nb * c.k * c.x_bits / 8) + 2 * aligned(c.nb * c.n * c.y_bits / 8) +
+           heap + stack;
+}
+
+inline estimate gemv(const gemv_config &c, const machine &m = machine())
+{
+    check(c);
+    estimate e;
+    e.kernel = gemv_kernel(c);
+    const size_t k = c.k_call();
+    e.in = stream_cycles(m, c.nb * k * c.x_bits / 8);
+    e.out = stream_cycles(m, c.nb * c.n * c.y_bits / 8);
+    if (c.wt == weights::stream)
+        e.in = std::max(e.in, stream_cycles(m, k * c.n * c.w_bits / 8));
+    if (c.wt == weights::chunked) {
+        // a weight window per chunk; y leaves on a stream once every K / chunk calls
+        e.in = std::max(e.in, stream_cycles(m, k * c.n * 4));
+        e.out = (e.out + c.k / k - 1) / (c.k / k);
+    }
+    // x and y windows, or x and weight windows for split-K
+    e.handoff = m.call_cycles + 2 * m.lock_cycles;
+    e.macs = c.nb * k * c.n;
+    e.memory = gemv_memory(c);
+    return e;
+}
+
+/*
+ *  GEMM: gemm_i32 on single_M x single_K x single_N tiles, M_API x K_API x N_API mmul
+ */
+
+struct mmul_shape {
+    size_t m = 2, k = 2, n = 2;
+};
+
+struct gemm_config {
+    size_t m = 16, k = 32, n = 16;     // single_M, single_K, single_N
+    mmul_shape api;
+};
+
+inline void check(const gemm_config &c)
+{
+    const mmul_shape &a = c.api;
+    if (!a.m || !a.k || !a.n || !c.m || !c.k || !c.n || c.m % (2 * a.m) || c.n % (2 * a.n) || c.k % a.k)
+        throw std::invalid_argument("single_M must be a multiple of 2*M_API, single_N of 2*N_API and "
+                                    "single_K of K_API");
+}
+
+inline kernel_cycles gemm_loop(const gemm_config &c)
+{
+    // one 2x2 block of mmul tiles per K_API step: 4 mmul at 8 int32 MACs per
+    // cycle, 2 A and 2 B tiles loaded; 4 C tiles stored per K_API row
+    const mmul_shape &a = c.api;
+    kernel_cycles kc;
+    kc.trips = (c.m / (2 * a.m)) * (c.n / (2 * a.n)) * (c.k / a.k);
+    kc.mac = 4.0 * a.m * a.k * a.n / macs_per_cycle(32, 32);
+    kc.load = (2.0 * a.m * a.k + 2.0 * a.k * a.n) * 4 / (load_ports * port_bytes);
+    kc.store = 4.0 * a.m * a.n * 4 / (store_ports * port_bytes) / double(c.k / a.k);
+    return kc;
+}
+
+inline kernel_cycles gemm_kernel(const gemm_config &c)
+{
+    kernel_cycles kc = gemm_loop(c);
+    kc.fixed = documented::gemm - gemm_loop(gemm_config()).loop();
+    return kc;
+}
+
+// ping-pong A, B and C windows, heap and stack, as tools/footprint.py gemm
+inline size_t gemm_memory(const gemm_config &c)
+{
+    return 2 * (aligned(c.m * c.k * 4) + aligned(c.k * c.n * 4) + aligned(c.m * c.n * 4)) + heap + stack;
+}
+
+inline estimate gemm(const gemm_config &c, const machine &m = machine())
+{
+    check(c);
+    estimate e;
+    e.kernel = gemm_kernel(c);
+    // A and B come on PLIOs of their own
+    e.in = std::max(stream_cycles(m, c.m * c.k * 4), stream_cycles(m, c.k * c.n * 4));
+    e.out = stream_cycles(m, c.m * c.n * 4);
+    e.handoff = m.call_cycles + 3 * m.lock_cycles;
+    e.macs = c.m * c.k * c.n;
+    e.memory = gemm_memory(c);
+    return e;
+}
+
+} // namespace perf_model
+
+#endif // PERF_MODEL_H
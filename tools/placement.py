@@ -0,0 +1,621 @@
+"""
+Tile placement and memory bank planner for ADF graphs.
+
+Reads a graph as the host emulation records it (tools/emu/adf_emu.h writes
+the kernels, ports, connections and existing constraints to $ADF_EMU_GRAPH
+from graph.init()), places every kernel on a tile and every buffer in a
+memory bank, and writes placement.h: location<kernel>, location<buffer>,
+location<parameter> and location<stack> constraints inside
+place_graph(k), which the graph constructor calls with k(i) returning its
+i-th kernel::create().
+
+Model (AIE1, VCK190): 50 x 8 tiles, 32 KB of data memory per tile in four
+8 KB banks. A kernel reaches the memory of its own tile, the tiles north and
+south, and the tile west (even rows) or east (odd rows). Cascade streams go
+east on even rows and west on odd rows.
+
+  placement  kernels are placed in dataflow order. A kernel goes next to the
+             kernels it shares windows with, so the window becomes one
+             buffer both tiles can reach and needs no DMA. Cascade
+             consumers go on the cascade neighbour. A window between tiles
+             that share no memory costs its Manhattan distance in stream
+             hops, and a PLIO costs the rows down to the shim.
+  banks      each window, and each array run-time parameter, is a ping and a
+             pong buffer. In steady state a kernel at pipeline depth s
+             touches the ping or the pong of its buffers in alternate
+             iterations, while the DMA or the neighbouring kernel touches the
+             other half. Two buffers in the same bank that are touched at the
+             same time collide. Every 256-bit access of the smaller one is
+             counted as a one cycle stall, a worst case. Buffers are assigned
+             greedily, then single moves are tried until no move lowers the
+             total. not_equal() constraints already in the graph are kept.
+
+The report compares the predicted stalls with the buffers packed first fit
+into each kernel's own tile, roughly what an unconstrained graph gets.
+
+pipeline(n) lays out an n-stage chain without a graph dump: up a column,
+across at the top, down the next, so every stage shares a memory module with
+the next one and each window between stages is a single lock-synchronized
+ping-pong buffer in that module, with no DMA. tools/hls4ml_aie.py writes its
+layer graphs this way. A location<buffer>(port) = location<kernel>(k)
+constraint in the graph keeps that buffer in k's tile here as well.
+
+How to run:
+python tools/placement.py gemm_i32/aie/api_benchmark            # runs make host_sim there, writes aie/placement.h
+python tools/placement.py --graph graph.json --out placement.h   # from an existing dump
+python tools/placement.py gemv_i32 --static 0=1024              # override kernel 0's static data
+
+Each kernel's tile also holds its static data, which is kept clear of the
+pinned buffers. That is the heap (--aie.heapsize in the directory's Makefile)
+plus the const arrays its source can see (footprint.static_data(): matrix.h,
+matrix_packed.h, ...). --static K=BYTES replaces the figure for kernel K. With
+--graph and no directory the sources are not at hand, so only --static is
+reserved.
+
+Build the graph with `make ... PLACEMENT=1` to apply it.
+"""
+
+import argparse
+import json
+import os
+import subprocess
+import sys
+import tempfile
+from collections import defaultdict
+from dataclasses import dataclass, field
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+import footprint  # noqa: E402
+
+COLS, ROWS = 50, 8
+MEM_BYTES, BANKS = 32768, 4
+BANK_BYTES = MEM_BYTES // BANKS
+ALIGN = 32
+ACCESS_BYTES = 32                    # one 256-bit load or store
+NOT_EQUAL = 10 ** 9                  # search cost of a not_equal() pair in one bank
+
+
+def modules(tile):
+    """Memory modules (tiles) a kernel on `tile` can access, its own first."""
+    c, r = tile
+    side = c - 1 if r % 2 == 0 else c + 1
+    cand = [(c, r), (side, r), (c, r - 1), (c, r + 1)]
+    return [(x, y) for x, y in cand if 0 <= x < COLS and 0 <= y < ROWS]
+
+
+def cascade_next(tile):
+    c, r = tile
+    step = 1 if r % 2 == 0 else -1
+    if 0 <= c + step < COLS:
+        return (c + step, r)
+    return (c, r + 1) if r + 1 < ROWS else None
+
+
+def hops(a, b):
+    return abs(a[0] - b[0]) + abs(a[1] - b[1])
+
+
+def pipeline(n, origin=(24, 0)):
+    """Tiles of an n-stage chain where neighbours share memory, and for each hop the
+    tile whose memory holds the buffer between them (the consumer's when the producer
+    reaches it, else the producer's, which the consumer then reaches)."""
+    tiles, (c, r), step = [], origin, 1
+    for _ in range(n):
+        if c >= COLS:
+            raise ValueError(f"{n} stages do not fit in the array from tile{origin}")
+        tiles.append((c, r))
+        if 0 <= r + step < ROWS:
+            r += step
+        else:
+            c, step = c + 1, -step
+    shared = []
+    for a, b in zip(tiles, tiles[1:]):
+        shared.append(b if b in modules(a) else a)
+        assert shared[-1] in modules(a) and shared[-1] in modules(b)
+    return tiles, shared
+
+
+@dataclass
+class Buffer:
+    """A double buffered window or run-time parameter."""
+    name: str
+    bytes: int
+    what: str                        # buffer or parameter
+    users: list                      # kernel indices that read or write it
+    ports: list                      # (kernel, "in"/"out", port) it is constrained through
+    dma: bool                        # the other side is a DMA (PLIO, or a tile out of reach)
+    pin: int = None                  # kept in this kernel's tile (location<buffer> = location<kernel>)
+
+    @property
+    def accesses(self):
+        return max(1, self.bytes // ACCESS_BYTES)
+
+
+@dataclass
+class Item:
+    """What gets a bank: half of a buffer, a stack, or reserved static data."""
+    name: str
+    bytes: int
+    kernel: int                      # owning kernel for stack/static, else -1
+    buffer: Buffer = None
+    half: int = 0                    # 0 ping, 1 pong
+    module: tuple = None
+    bank: int = 0
+    offset: int = 0
+    reach: list = field(default_factory=list)
+
+    @property
+    def banks(self):
+        return max(1, -(-self.bytes // BANK_BYTES))
+
+
+class Graph:
+    def __init__(self, dump):
+        self.nodes = {n["id"]: n for n in dump["nodes"]}
+        self.kernels = [n["id"] for n in dump["nodes"] if n["type"] == "kernel"]
+        self.index = {nid: i for i, nid in enumerate(self.kernels)}
+        self.edges = dump["edges"]
+        self.fixed = {}
+        for c in dump.get("constraints", []):
+            if c["what"] == "kernel" and c["node"] in self.index and c["sites"]:
+                s = c["sites"][0]
+                self.fixed[self.index[c["node"]]] = (s["col"], s["row"])
+        self.pinned = {}
+        for c in dump.get("constraints", []):
+            if c["what"] == "buffer" and c["sites"] and c["sites"][0]["kind"] == "kernel":
+                self.pinned[self._port(c)] = self.index.get(c["sites"][0]["x"])
+        self.not_equal = [(self._port(a), self._port(b)) for a, b in dump.get("not_equal", [])]
+
+    def _port(self, t):
+        return (self.index.get(t["node"], -1), "out" if t["out"] else "in", t["port"])
+
+    def kernel_of(self, nid):
+        return self.index.get(nid)
+
+    def name(self, k):
+        n = self.nodes[self.kernels[k]]
+        return n["name"] + (f" ({n['source']})" if n["source"] else "")
+
+    def depth(self):
+        """Pipeline depth of each kernel: longest kernel-to-kernel path into it."""
+        d = [0] * len(self.kernels)
+        for _ in self.kernels:
+            for e in self.edges:
+                a, b = self.kernel_of(e["src"]), self.kernel_of(e["dst"])
+                if a is not None and b is not None:
+                    d[b] = max(d[b], d[a] + 1)
+        return d
+
+    def order(self):
+        """Kernels in dataflow order, creation order breaking ties."""
+        d = self.depth()
+        return sorted(range(len(self.kernels)), key=lambda k: (d[k], k))
+
+
+class Planner:
+    def __init__(self, graph, origin=(24, 0), stack=1024, static=None):
+        self.g = graph
+        self.origin = origin
+        self.stack = stack
+        self.static = static or {}
+        self.tiles = {}
+
+    # -- tiles ---------------------------------------------------------------
+
+    def kernel_bytes(self, k):
+        total = self.stack + self.static.get(k, 0)
+        for e in self.g.edges:
+            for nid, side in ((e["dst"], "in"), (e["src"], "out")):
+                if self.g.kernel_of(nid) == k and e["conn"] in ("window", "parameter"):
+                    total += 2 * (e["bytes"] or self.port_bytes(k, side, e["dst_port" if side == "in" else "src_port"]))
+        return total
+
+    def port_bytes(self, k, side, p):
+        return self.g.nodes[self.g.kernels[k]][side][p]["bytes"]
+
+    def place_tiles(self):
+        used = defaultdict(int)           # bytes claimed per memory module
+        taken = set(self.g.fixed.values())
+        self.tiles = dict(self.g.fixed)
+        for k in self.tiles:
+            used[self.tiles[k]] += self.kernel_bytes(k)
+
+        for k in self.g.order():
+            if k in self.tiles:
+                continue
+            need = self.kernel_bytes(k)
+            cascade = [self.g.kernel_of(e["src"]) for e in self.g.edges
+                       if e["conn"] == "cascade" and self.g.kernel_of(e["dst"]) == k]
+            if cascade and cascade[0] in self.tiles:
+                t = cascade_next(self.tiles[cascade[0]])
+                if t is None or t in taken:
+                    raise SystemExit(f"placement: no free cascade neighbour for {self.g.name(k)}")
+                best = t
+            else:
+                best = min(self.candidates(taken), key=lambda t: self.tile_cost(k, t, used, need))
+            self.tiles[k] = best
+            taken.add(best)
+            used[best] += need
+        return self.tiles
+
+    def candidates(self, taken):
+        placed = set(self.tiles.values()) or {self.origin}
+        near = {(c, r) for pc, pr in placed for c in range(pc - 3, pc + 4) for r in range(pr - 3, pr + 4)
+                if 0 <= c < COLS and 0 <= r < ROWS}
+        free = [t for t in near if t not in taken]
+        return free or [(c, r) for c in range(COLS) for r in range(ROWS) if (c, r) not in taken]
+
+    def tile_cost(self, k, t, used, need):
+        cost = 0.0
+        for e in self.g.edges:
+            a, b = self.g.kernel_of(e["src"]), self.g.kernel_of(e["dst"])
+            if k not in (a, b):
+                continue
+            other = b if a == k else a
+            if other is None:                       # PLIO: stream down to the shim
+                cost += t[1] + 1
+            elif other in self.tiles:
+                shared = set(modules(t)) & set(modules(self.tiles[other]))
+                cost += 0 if shared and e["conn"] in ("window", "parameter") else hops(t, self.tiles[other]) * 2
+        free = sum(MEM_BYTES - used[m] for m in modules(t))
+        if free < need:
+            cost += 1000
+        if MEM_BYTES - used[t] < need:
+            cost += 10                              # spills into neighbours' memory
+        # compact toward the origin, low rows first
+        return (cost, hops(t, self.origin), t[1], t[0])
+
+    # -- buffers -------------------------------------------------------------
+
+    def buffers(self):
+        out = []
+        for e in self.g.edges:
+            if e["conn"] not in ("window", "parameter"):
+                continue
+            a, b = self.g.kernel_of(e["src"]), self.g.kernel_of(e["dst"])
+            nbytes = e["bytes"] or (self.port_bytes(b, "in", e["dst_port"]) if b is not None else 0)
+            what = "parameter" if e["conn"] == "parameter" else "buffer"
+            if a is not None and b is not None:
+                if set(modules(self.tiles[a])) & set(modules(self.tiles[b])):
+                    pin = self.g.pinned.get((a, "out", e["src_port"]), self.g.pinned.get((b, "in", e["dst_port"])))
+                    out.append(Buffer(f"k{b}.in[{e['dst_port']}]", nbytes, what, [a, b], [(b, "in", e["dst_port"])],
+                                      False, pin))
+                else:
+                    out.append(Buffer(f"k{a}.out[{e['src_port']}]", nbytes, what, [a], [(a, "out", e["src_port"])], True))
+                    out.append(Buffer(f"k{b}.in[{e['dst_port']}]", nbytes, what, [b], [(b, "in", e["dst_port"])], True))
+            elif b is not None:
+                out.append(Buffer(f"k{b}.in[{e['dst_port']}]", nbytes, what, [b], [(b, "in", e["dst_port"])],
+                                  e["conn"] == "window"))
+            elif a is not None:
+                out.append(Buffer(f"k{a}.out[{e['src_port']}]", nbytes, what, [a], [(a, "out", e["src_port"])], True))
+        return out
+
+    def items(self, bufs):
+        items = []
+        for buf in bufs:
+            reach = set(modules(self.tiles[buf.users[0]]))
+            for u in buf.users[1:]:
+                reach &= set(modules(self.tiles[u]))
+            reach = [m for m in modules(self.tiles[buf.users[-1]]) if m in reach]
+            if buf.pin is not None and self.tiles[buf.pin] in reach:
+                reach = [self.tiles[buf.pin]]
+            for half in (0, 1):
+                items.append(Item(f"{buf.name}.{'ping' if half == 0 else 'pong'}", buf.bytes, -1, buf, half,
+                                  reach=reach))
+        for k in range(len(self.g.kernels)):
+            own = [self.tiles[k]]
+            items.append(Item(f"k{k}.stack", self.stack, k, reach=own))
+            if self.static.get(k):
+                items.append(Item(f"k{k}.static", self.static[k], k, reach=own))
+        return items
+
+    def concurrency(self, items):
+        """C[i, j]: stall cycles per iteration if items i and j share a bank; not_equal() item pairs."""
+        depth = self.g.depth()
+        C = defaultdict(float)
+        for t in (0, 1):
+            access = []                              # (item, agent, accesses)
+            for i, it in enumerate(items):
+                buf = it.buffer
+                if buf is None:
+                    if it.name.endswith(".static"):
+                        access.append((i, ("k", it.kernel), max(1, it.bytes // ACCESS_BYTES)))
+                    continue
+                for u in buf.users:
+                    if (t - depth[u]) % 2 == it.half:
+                        access.append((i, ("k", u), buf.accesses))
+                if buf.dma and (t - depth[buf.users[0]] + 1) % 2 == it.half:
+                    access.append((i, ("dma", buf.name), buf.accesses))
+            for x in range(len(access)):
+                for y in range(x + 1, len(access)):
+                    i, _, wi = access[x]
+                    j, _, wj = access[y]
+                    if i != j:
+                        C[min(i, j), max(i, j)] += min(wi, wj) / 2.0     # averaged over the two phases
+
+        ports = defaultdict(list)
+        for i, it in enumerate(items):
+            if it.buffer:
+                for p in it.buffer.ports:
+                    ports[p].append(i)
+        apart = {(min(i, j), max(i, j)) for a, b in self.g.not_equal for i in ports[a] for j in ports[b]}
+        return C, apart
+
+    def cost(self, items, C, apart):
+        """Predicted stalls, per kernel, and the not_equal() pairs that share a bank."""
+        total = 0.0
+        per = defaultdict(float)
+        for (i, j), w in C.items():
+            if self.together(items[i], items[j]):
+                total += w
+                for it in (items[i], items[j]):
+                    users = it.buffer.users if it.buffer else [it.kernel]
+                    for k in users:
+                        per[k] += w / 2 / len(users)
+        broken = sum(1 for i, j in apart if self.together(items[i], items[j]))
+        return total, per, broken
+
+    def together(self, a, b):
+        return a.module == b.module and bool(set(self.bank_span(a)) & set(self.bank_span(b)))
+
+    @staticmethod
+    def bank_span(it):
+        return range(it.bank, it.bank + it.banks)
+
+    def fits(self, it, module, bank, load):
+        if bank + it.banks > BANKS:
+            return False
+        if it.banks > 1:
+            return all(load[module, b] == 0 for b in range(bank, bank + it.banks))
+        return load[module, bank] + _aligned(it.bytes) <= BANK_BYTES
+
+    def assign_banks(self, items, C, apart):
+        load = defaultdict(int)
+        nbr = defaultdict(list)
+        for (i, j), w in C.items():
+            nbr[i].append((j, w))
+            nbr[j].append((i, w))
+        for i, j in apart:
+            nbr[i].append((j, NOT_EQUAL))
+            nbr[j].append((i, NOT_EQUAL))
+        weight = [sum(w for _, w in nbr[i]) for i in range(len(items))]
+
+        def delta(i, module, bank):
+            it = items[i]
+            span = set(range(bank, bank + it.banks))
+            return sum(w for j, w in nbr[i] if items[j].module == module and
+                       span & set(self.bank_span(items[j])))
+
+        # the ping and the pong of a buffer stay in one tile
+        partner = {}
+        for i, it in enumerate(items):
+            for j in range(i + 1, len(items)):
+                if it.buffer is not None and items[j].buffer is it.buffer:
+                    partner[i], partner[j] = j, i
+
+        def reach(i):
+            j = partner.get(i)
+            return [items[j].module] if j is not None and items[j].module else items[i].reach
+
+        order = sorted(range(len(items)), key=lambda i: (-items[i].banks, -weight[i], i))
+        for i in order:
+            it = items[i]
+            # fewest stalls, then own memory first, then the emptiest bank
+            opts = [(delta(i, m, b), ri, load[m, b], b, m) for ri, m in enumerate(reach(i)) for b in range(BANKS)
+                    if self.fits(it, m, b, load)]
+            if not opts:
+                raise SystemExit(f"placement: {it.name} ({it.bytes} bytes) does not fit in the memory its kernel reaches")
+            _, _, _, it.bank, it.module = min(opts)
+            for b in self.bank_span(it):
+                load[it.module, b] += _aligned(it.bytes) if it.banks == 1 else BANK_BYTES
+
+        for _ in range(20):                          # single moves while they help
+            moved = False
+            for i in order:
+                it = items[i]
+                if it.banks > 1:
+                    continue
+                load[it.module, it.bank] -= _aligned(it.bytes)
+                here = delta(i, it.module, it.bank)
+                opts = [(delta(i, m, b), m, b) for m in reach(i) for b in range(BANKS) if self.fits(it, m, b, load)]
+                best = min(opts)
+                if best[0] < here:
+                    _, it.module, it.bank = best
+                    moved = True
+                load[it.module, it.bank] += _aligned(it.bytes)
+            if not moved:
+                break
+
+        used = defaultdict(int)
+        for it in sorted(items, key=lambda it: (it.module, it.bank, -it.bytes, it.name)):
+            it.offset = it.bank * BANK_BYTES + used[it.module, it.bank]
+            for b in self.bank_span(it):
+                used[it.module, b] += _aligned(it.bytes) if it.banks == 1 else BANK_BYTES
+        return items
+
+    def first_fit(self, items):
+        """Buffers packed in port order into each kernel's own memory, the unconstrained baseline."""
+        plain = []
+        fill = defaultdict(int)
+        for it in items:
+            p = Item(it.name, it.bytes, it.kernel, it.buffer, it.half)
+            p.module = it.reach[0] if it.buffer is None else self.tiles[it.buffer.users[-1]]
+            p.bank = min(BANKS - p.banks, fill[p.module] // BANK_BYTES)
+            fill[p.module] += _aligned(it.bytes)
+            plain.append(p)
+        return plain
+
+    def plan(self):
+        self.place_tiles()
+        bufs = self.buffers()
+        items = self.items(bufs)
+        C, apart = self.concurrency(items)
+        before, _, _ = self.cost(self.first_fit(items), C, apart)
+        self.assign_banks(items, C, apart)
+        after, per, broken = self.cost(items, C, apart)
+        return Plan(self, bufs, items, before, after, per, broken)
+
+
+def _aligned(n):
+    return -(-n // ALIGN) * ALIGN
+
+
+@dataclass
+class Plan:
+    planner: Planner
+    buffers: list
+    items: list
+    before: float
+    after: float
+    per: dict
+    broken: int                      # not_equal() pairs left in one bank
+
+    def routing(self):
+        g, tiles = self.planner.g, self.planner.tiles
+        total = 0
+        for e in g.edges:
+            a, b = g.kernel_of(e["src"]), g.kernel_of(e["dst"])
+            if (a is None and b is None) or e["conn"] == "cascade":
+                continue
+            if a is None or b is None:
+                total += tiles[b if a is None else a][1] + 1
+            elif not (set(modules(tiles[a])) & set(modules(tiles[b]))) or e["conn"] == "stream":
+                total += hops(tiles[a], tiles[b])
+        return total
+
+    def report(self):
+        g, tiles = self.planner.g, self.planner.tiles
+        lines = []
+        for k in range(len(g.kernels)):
+            lines.append(f"kernel {k} {g.name(k)}: tile{tiles[k]}, predicted stalls {self.per.get(k, 0):.0f} cycles/iteration")
+        for it in self.items:
+            lines.append(f"  {it.name:24s} {it.bytes:6d} B  tile{it.module} bank {it.bank} @0x{it.offset:04x}")
+        lines.append(f"bank conflict stalls: {self.after:.0f} cycles/iteration predicted, "
+                     f"{self.before:.0f} packed first fit")
+        lines.append(f"stream routing: {self.routing()} hops")
+        if self.broken:
+            lines.append(f"warning: {self.broken} not_equal() buffer pairs could not be put in different banks")
+        return "\n".join(lines)
+
+    def header(self, source):
+        g, tiles = self.planner.g, self.planner.tiles
+        by_port = {}
+        for it in self.items:
+            if it.buffer:
+                by_port.setdefault(it.buffer.ports[0], [None, None])[it.half] = it
+        body = []
+        for k in range(len(g.kernels)):
+            c, r = tiles[k]
+            stack = next(it for it in self.items if it.name == f"k{k}.stack")
+            body.append(f"    // {g.name(k)}")
+            body.append(f"    location<kernel>(k({k})) = tile({c}, {r});")
+            body.append(f"    location<stack>(k({k})) = bank({stack.module[0]}, {stack.module[1]}, {stack.bank});")
+            for (kk, side, p), (ping, pong) in sorted(by_port.items()):
+                if kk != k:
+                    continue
+                what = ping.buffer.what
+                body.append(f"    location<{what}>(k({k}).{side}[{p}]) = "
+                            f"{{ address({ping.module[0]}, {ping.module[1]}, 0x{ping.offset:04x}), "
+                            f"address({pong.module[0]}, {pong.module[1]}, 0x{pong.offset:04x}) }};")
+        n, nb = len(g.kernels), len(self.buffers)
+        return f"""#ifndef PLACEMENT_H
+#define PLACEMENT_H
+
+/*
+ *  Generated by tools/placement.py from {source}: {n} kernel{'s' if n != 1 else ''}, {nb} buffer{'s' if nb != 1 else ''}.
+ *  Predicted bank conflict stalls {self.after:.0f} cycles per iteration ({self.before:.0f} packed
+ *  first fit), stream routing {self.routing()} hops.
+ *
+ *  The graph constructor calls place_graph(k) after its connect<>()s, with
+ *  k(i) the i-th kernel::create() of the graph. Build with PLACEMENT=1.
+ */
+
+#include <adf.h>
+
+template <typename Kernels>
+void place_graph(Kernels k)
+{{
+    using namespace adf;
+
+{chr(10).join(body)}
+}}
+
+#endif // PLACEMENT_H
+"""
+
+
+def dump_graph(directory, make_args):
+    """Run make host_sim in `directory` with ADF_EMU_GRAPH set, return the graph."""
+    fd, path = tempfile.mkstemp(suffix=".json")
+    os.close(fd)
+    try:
+        env = dict(os.environ, ADF_EMU_GRAPH=path)
+        subprocess.run(["make", "-C", directory, "host_sim", "PLACEMENT=", *make_args], env=env, check=True,
+                       stdout=subprocess.DEVNULL)
+        with open(path) as f:
+            return json.load(f)
+    finally:
+        os.remove(path)
+
+
+def parse_static(values):
+    out = {}
+    for v in values:
+        k, _, b = v.partition("=")
+        out[int(k)] = int(b)
+    return out
+
+
+def kernel_static(graph, directory):
+    """Static data per kernel: the Makefile's heap plus the const arrays of its source."""
+    heap = footprint.makefile_heap(os.path.join(directory, "Makefile"))
+    out = {}
+    for k, nid in enumerate(graph.kernels):
+        # sources are relative to the graph (kernels/...) or to the directory (aie/kernels/...)
+        source = graph.nodes[nid]["source"]
+        paths = [os.path.join(directory, "aie", source), os.path.join(directory, source)] if source else []
+        path = next((p for p in paths if os.path.isfile(p)), None)
+        out[k] = heap + (footprint.static_data(path)[0] if path else 0)
+    return out
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Place the kernels and buffers of an ADF graph, write placement.h.")
+    parser.add_argument("directory", nargs="?", help="Kernel directory with a host_sim make target.")
+    parser.add_argument("--graph", help="Graph dump (ADF_EMU_GRAPH) instead of running make.")
+    parser.add_argument("--out", help="Header to write (default: <directory>/aie/placement.h).")
+    parser.add_argument("--origin", default="24,0", help="Tile to start from, col,row.")
+    parser.add_argument("--stack", type=int, default=1024, help="Stack bytes per kernel.")
+    parser.add_argument("--static", action="append", default=[], metavar="K=BYTES",
+                        help="Static data (heap, constant weights) of kernel K, instead of the one "
+                             "read from its source and Makefile.")
+    parser.add_argument("--make-arg", action="append", default=[], help="Extra make argument for host_sim.")
+    args = parser.parse_args()
+
+    if bool(args.directory) == bool(args.graph):
+        parser.error("give a directory or --graph")
+    if args.graph:
+        with open(args.graph) as f:
+            dump = json.load(f)
+        source, out = os.path.basename(args.graph), args.out or "placement.h"
+    else:
+        dump = dump_graph(args.directory, args.make_arg)
+        source = os.path.normpath(args.directory)
+        out = args.out or os.path.join(args.directory, "aie", "placement.h")
+
+    graph = Graph(dump)
+    if not graph.kernels:
+        raise SystemExit("placement: the graph has no kernels")
+    origin = tuple(int(v) for v in args.origin.split(","))
+    static = kernel_static(graph, args.directory) if args.directory else {}
+    static.update(parse_static(args.static))
+    plan = Planner(graph, origin, args.stack, static).plan()
+    print(plan.report())
+    with open(out, "w") as f:
+        f.write(plan.header(source))
+    print(f"wrote {out}")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,315 @@
+#include "plio.h"
+
+#include <cerrno>
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace plio {
+
+dtype parse_dtype(const std::string &name)
+{
+    if (name == "int8")   return dtype::int8;
+    if (name == "int16")  return dtype::int16;
+    if (name == "int32")  return dtype::int32;
+    if (name == "uint8")  return dtype::uint8;
+    if (name == "uint16") return dtype::uint16;
+    if (name == "uint32") return dtype::uint32;
+    throw std::runtime_error("unknown dtype '" + name + "'");
+}
+
+const char *dtype_name(dtype t)
+{
+    switch (t) {
+    case dtype::int8:   return "int8";
+    case dtype::int16:  return "int16";
+    case dtype::int32:  return "int32";
+    case dtype::uint8:  return "uint8";
+    case dtype::uint16: return "uint16";
+    case dtype::uint32: return "uint32";
+    }
+    return "?";
+}
+
+int64_t dtype_min(dtype t)
+{
+    switch (t) {
+    case dtype::int8:  return INT8_MIN;
+    case dtype::int16: return INT16_MIN;
+    case dtype::int32: return INT32_MIN;
+    default:           return 0;
+    }
+}
+
+int64_t dtype_max(dtype t)
+{
+    switch (t) {
+    case dtype::int8:   return INT8_MAX;
+    case dtype::int16:  return INT16_MAX;
+    case dtype::int32:  return INT32_MAX;
+    case dtype::uint8:  return UINT8_MAX;
+    case dtype::uint16: return UINT16_MAX;
+    case dtype::uint32: return UINT32_MAX;
+    }
+    return 0;
+}
+
+mapped_file::mapped_file(const std::string &path)
+{
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw std::runtime_error("cannot open " + path + ": " + std::strerror(errno));
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw std::runtime_error("cannot stat " + path);
+    }
+
+    size_ = static_cast<size_t>(st.st_size);
+    if (size_ > 0) {
+        void *p = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p == MAP_FAILED) {
+            ::close(fd);
+            throw std::runtime_error("cannot mmap " + path);
+        }
+        ::madvise(p, size_, MADV_SEQUENTIAL);
+        data_ = static_cast<const char *>(p);
+    }
+    ::close(fd);
+}
+
+mapped_file::~mapped_file()
+{
+    if (data_)
+        ::munmap(const_cast<char *>(data_), size_);
+}
+
+namespace {
+
+// Walk a text PLIO buffer, calling f(value, line) for every integer token.
+// Returns an error string instead of throwing so validate() can reuse it.
+template <typename F>
+std::string scan_text(const char *p, const char *end, dtype t, F &&f)
+{
+    const int64_t lo = dtype_min(t), hi = dtype_max(t);
+    size_t line = 1;
+
+    while (p < end) {
+        // skip aiesimulator "T <time> <unit>" and "TLAST" lines
+        if (*p == 'T') {
+            while (p < end && *p != '\n') ++p;
+            continue;
+        }
+        if (*p == '\n') { ++line; ++p; continue; }
+        if (*p == ' ' || *p == '\t' || *p == '\r') { ++p; continue; }
+
+        int64_t v;
+        const char *s = p;
+        if (*s == '+') ++s;
+        auto res = std::from_chars(s, end, v);
+        if (res.ec != std::errc())
+            return "line " + std::to_string(line) + ": bad token";
+        if (v < lo || v > hi)
+            return "line " + std::to_string(line) + ": value " + std::to_string(v) +
+                   " out of range for " + dtype_name(t);
+        f(v);
+        p = res.ptr;
+    }
+    return {};
+}
+
+int64_t load_element(const unsigned char *p, dtype t)
+{
+    switch (t) {
+    case dtype::int8:   return static_cast<int8_t>(p[0]);
+    case dtype::uint8:  return p[0];
+    case dtype::int16:  return static_cast<int16_t>(p[0] | p[1] << 8);
+    case dtype::uint16: return static_cast<uint16_t>(p[0] | p[1] << 8);
+    case dtype::int32:
+    case dtype::uint32: {
+        uint32_t u = uint32_t(p[0]) | uint32_t(p[1]) << 8 | uint32_t(p[2]) << 16 | uint32_t(p[3]) << 24;
+        return t == dtype::int32 ? int64_t(static_cast<int32_t>(u)) : int64_t(u);
+    }
+    }
+    return 0;
+}
+
+} // namespace
+
+std::vector<int64_t> read_text(const std::string &path, dtype t)
+{
+    mapped_file f(path);
+    std::vector<int64_t> values;
+    values.reserve(f.size() / 2);
+    std::string err = scan_text(f.data(), f.data() + f.size(), t, [&](int64_t v) { values.push_back(v); });
+    if (!err.empty())
+        throw std::runtime_error(path + ": " + err);
+    return values;
+}
+
+void write_text(const std::string &path, const std::vector<int64_t> &values, size_t per_line)
+{
+    FILE *fp = std::fopen(path.c_str(), "w");
+    if (!fp)
+        throw std::runtime_error("cannot create " + path);
+
+    std::vector<char> buf(1 << 20);
+    std::setvbuf(fp, buf.data(), _IOFBF, buf.size());
+
+    char num[24];
+    for (size_t i = 0; i < values.size(); ++i) {
+        auto res = std::to_chars(num, num + sizeof(num), values[i]);
+        std::fwrite(num, 1, res.ptr - num, fp);
+        std::fputc((i + 1) % per_line == 0 || i + 1 == values.size() ? '\n' : ' ', fp);
+    }
+    std::fclose(fp);
+}
+
+std::vector<int64_t> read_binary(const std::string &path, dtype t)
+{
+    mapped_file f(path);
+    const size_t es = dtype_size(t);
+    if (f.size() % es != 0)
+        throw std::runtime_error(path + ": size " + std::to_string(f.size()) +
+                                 " is not a whole number of " + dtype_name(t));
+
+    std::vector<int64_t> values(f.size() / es);
+    const unsigned char *p = reinterpret_cast<const unsigned char *>(f.data());
+    for (size_t i = 0; i < values.size(); ++i)
+        values[i] = load_element(p + i * es, t);
+    return values;
+}
+
+void write_binary(const std::string &path, const std::vector<int64_t> &values, dtype t)
+{
+    const size_t es = dtype_size(t);
+    const int64_t lo = dtype_min(t), hi = dtype_max(t);
+
+    std::vector<unsigned char> out(values.size() * es);
+    for (size_t i = 0; i < values.size(); ++i) {
+        if (values[i] < lo || values[i] > hi)
+            throw std::runtime_error(path + ": value " + std::to_string(values[i]) + " at index " +
+                                     std::to_string(i) + " out of range for " + dtype_name(t));
+        uint32_t u = static_cast<uint32_t>(values[i]);
+        for (size_t b = 0; b < es; ++b)
+            out[i * es + b] = static_cast<unsigned char>(u >> (8 * b));
+    }
+
+    FILE *fp = std::fopen(path.c_str(), "wb");
+    if (!fp)
+        throw std::runtime_error("cannot create " + path);
+    size_t n = std::fwrite(out.data(), 1, out.size(), fp);
+    std::fclose(fp);
+    if (n != out.size())
+        throw std::runtime_error("short write to " + path);
+}
+
+reader::reader(const std::string &path, dtype t)
+    : path_(path), f_(path), t_(t), binary_(is_binary_path(path)), p_(f_.data()), end_(f_.data() + f_.size())
+{
+    if (binary_ && f_.size() % dtype_size(t) != 0)
+        throw std::runtime_error(path + ": size " + std::to_string(f_.size()) +
+                                 " is not a whole number of " + dtype_name(t));
+}
+
+bool reader::next(int64_t &v)
+{
+    if (binary_) {
+        if (p_ == end_)
+            return false;
+        v = load_element(reinterpret_cast<const unsigned char *>(p_), t_);
+        p_ += dtype_size(t_);
+        return true;
+    }
+
+    while (p_ < end_) {
+        if (*p_ == 'T') {
+            const char *eol = static_cast<const char *>(std::memchr(p_, '\n', end_ - p_));
+            if (!eol)
+                eol = end_;
+            if (eol - p_ >= 5 && std::memcmp(p_, "TLAST", 5) == 0) {
+                ++tlast_;
+            } else {
+                // "T <time> <unit>", ps/ns/us
+                const char *q = p_ + 1;
+                while (q < eol && *q == ' ')
+                    ++q;
+                double time;
+                auto res = std::from_chars(q, eol, time);
+                if (res.ec == std::errc()) {
+                    for (q = res.ptr; q < eol && *q == ' ';)
+                        ++q;
+                    const char u = q < eol ? *q : 'n';
+                    time_ns_ = time * (u == 'p' ? 1e-3 : u == 'u' ? 1e3 : 1.0);
+                }
+            }
+            p_ = eol;
+            continue;
+        }
+        if (*p_ == '\n') { ++line_; ++p_; continue; }
+        if (*p_ == ' ' || *p_ == '\t' || *p_ == '\r') { ++p_; continue; }
+
+        const char *s = *p_ == '+' ? p_ + 1 : p_;
+        auto res = std::from_chars(s, end_, v);
+        if (res.ec != std::errc())
+            throw std::runtime_error(path_ + ": line " + std::to_string(line_) + ": bad token");
+        if (v < dtype_min(t_) || v > dtype_max(t_))
+            throw std::runtime_error(path_ + ": line " + std::to_string(line_) + ": value " + std::to_string(v) +
+                                     " out of range for " + dtype_name(t_));
+        value_line_ = line_;
+        p_ = res.ptr;
+        return true;
+    }
+    return false;
+}
+
+bool is_binary_path(const std::string &path)
+{
+    return path.size() >= 4 && path.compare(path.size() - 4, 4, ".bin") == 0;
+}
+
+std::vector<int64_t> read_any(const std::string &path, dtype t)
+{
+    return is_binary_path(path) ? read_binary(path, t) : read_text(path, t);
+}
+
+std::string validate(const std::string &path, dtype t, size_t plio_bits, size_t *count)
+{
+    const size_t bits = 8 * dtype_size(t);
+    if (plio_bits == 0 || plio_bits % bits != 0)
+        return "PLIO width " + std::to_string(plio_bits) + " is not a positive multiple of the " +
+               std::to_string(bits) + "-bit " + dtype_name(t);
+    const size_t per_word = values_per_word(t, plio_bits);
+    size_t n = 0;
+
+    try {
+        mapped_file f(path);
+        if (is_binary_path(path)) {
+            if (f.size() % dtype_size(t) != 0)
+                return "size " + std::to_string(f.size()) + " is not a whole number of " + dtype_name(t);
+            n = f.size() / dtype_size(t);
+        } else {
+            std::string err = scan_text(f.data(), f.data() + f.size(), t, [&](int64_t) { ++n; });
+            if (!err.empty())
+                return err;
+        }
+    } catch (const std::exception &e) {
+        return e.what();
+    }
+
+    if (count)
+        *count = n;
+    if (n % per_word != 0)
+        return std::to_string(n) + " values is not a whole number of " + std::to_string(plio_bits) +
+               "-bit PLIO words (" + std::to_string(per_word) + " " + dtype_name(t) + " each)";
+    return {};
+}
+
+} // namespace plio
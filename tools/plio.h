@@ -0,0 +1,116 @@
+/*
+ *  PLIO data file helpers shared by the host-side tools.
+ *
+ *  Two on-disk forms are supported:
+ *
+ *   text   - whitespace separated integers, as written by np.savetxt and the
+ *            golden generators (four int32 / eight int16 / sixteen int8 values
+ *            per line for plio_128_bits). Lines starting with 'T' (aiesimulator
+ *            timestamps and TLAST markers) are skipped.
+ *
+ *   binary - the raw little-endian element stream, no header. This is what
+ *            input_plio/output_plio read and write when created with the
+ *            binary flag (see PLIO_BINARY in the graphs).
+ *
+ *  Binary files are read through mmap so multi-GB batches are not copied
+ *  before they are converted or compared.
+ */
+
+#ifndef PLIO_H
+#define PLIO_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace plio {
+
+enum class dtype { int8, int16, int32, uint8, uint16, uint32 };
+
+dtype       parse_dtype(const std::string &name);
+const char *dtype_name(dtype t);
+int64_t     dtype_min(dtype t);
+int64_t     dtype_max(dtype t);
+
+// Inline, so header-only users (weight_blob.h in the graphs) need not link plio.cpp.
+inline size_t dtype_size(dtype t)
+{
+    switch (t) {
+    case dtype::int8:  case dtype::uint8:  return 1;
+    case dtype::int16: case dtype::uint16: return 2;
+    case dtype::int32: case dtype::uint32: return 4;
+    }
+    return 0;
+}
+
+// Number of values per 128-bit PLIO word, i.e. per line of a text file.
+inline size_t values_per_word(dtype t, size_t plio_bits = 128) { return plio_bits / (8 * dtype_size(t)); }
+
+// Read-only memory mapping of a whole file. Empty files map to {nullptr, 0}.
+class mapped_file {
+public:
+    explicit mapped_file(const std::string &path);
+    ~mapped_file();
+    mapped_file(const mapped_file &) = delete;
+    mapped_file &operator=(const mapped_file &) = delete;
+
+    const char *data() const { return data_; }
+    size_t size() const { return size_; }
+
+private:
+    const char *data_ = nullptr;
+    size_t size_ = 0;
+};
+
+// Parse a text PLIO file. Throws std::runtime_error (with the line number)
+// on a malformed token or a value that does not fit in t.
+std::vector<int64_t> read_text(const std::string &path, dtype t);
+
+// Write values in text form, per_line values on each line.
+void write_text(const std::string &path, const std::vector<int64_t> &values, size_t per_line);
+
+// Read a binary PLIO file. The size must be a multiple of the element size.
+std::vector<int64_t> read_binary(const std::string &path, dtype t);
+
+// Write values in binary form. Values are range checked against t.
+void write_binary(const std::string &path, const std::vector<int64_t> &values, dtype t);
+
+// Sequential reader over a text or binary PLIO file through mmap, one value
+// at a time, for streams too large to hold as a vector. In text files it also
+// follows the aiesimulator "T <time> <unit>" and TLAST lines between values.
+class reader {
+public:
+    reader(const std::string &path, dtype t);
+
+    // The next value, false at the end of the file. Throws std::runtime_error
+    // (with the line number) on a malformed token or an out of range value.
+    bool next(int64_t &v);
+
+    double time_ns() const { return time_ns_; }  // last timestamp before that value, -1 if none
+    size_t line() const { return value_line_; }  // its line in a text file, 0 for binary
+    size_t tlast() const { return tlast_; }      // TLAST markers passed so far
+
+private:
+    std::string path_;
+    mapped_file f_;
+    dtype t_;
+    bool binary_;
+    const char *p_, *end_;
+    size_t line_ = 1, value_line_ = 0, tlast_ = 0;
+    double time_ns_ = -1;
+};
+
+// Pick the reader from the extension: ".bin" is binary, anything else text.
+bool is_binary_path(const std::string &path);
+std::vector<int64_t> read_any(const std::string &path, dtype t);
+
+// Check that a file is a well formed PLIO stream for t: every token parses and
+// is in range (text), or the size is whole elements (binary), and the element
+// count is a multiple of one plio_bits word. Returns an empty string when the
+// file is valid, otherwise a description of the first problem.
+std::string validate(const std::string &path, dtype t, size_t plio_bits = 128, size_t *count = nullptr);
+
+} // namespace plio
+
+#endif // PLIO_H
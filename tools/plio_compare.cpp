@@ -0,0 +1,188 @@
+/*
+*	Compare a simulator PLIO output with the golden data, value by value.
+*
+*	How to run:
+*	plio_compare.exe <dtype> actual expected [--tol n] [--frame n] [--report n]
+*	                 [--freq ghz] [--timestamps out.csv]
+*
+*	Both files are text or .bin (by extension) and are streamed through mmap,
+*	so GB-sized outputs need no memory. In text files the aiesimulator T and
+*	TLAST lines are followed, not compared, and any whitespace or values per
+*	line is accepted.
+*
+*	--tol n        accept |actual - expected| <= n (default 0, exact)
+*	--frame n      values per graph iteration, to place mismatches and time
+*	               iterations; without it every timestamp line starts one
+*	--report n     mismatches to print (default 10)
+*	--freq ghz     AIE clock for the cycle counts (default 1.25)
+*	--timestamps   write iteration,time_ns,cycles,interval_cycles for every
+*	               iteration of the actual file
+*
+*	Exits with 0 when every value matches and the lengths agree, 1 otherwise.
+*/
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <stdexcept>
+#include <string>
+
+#include "plio.h"
+
+static int usage()
+{
+    std::fprintf(stderr, "usage: plio_compare <dtype> actual expected [--tol n] [--frame n] [--report n] "
+                         "[--freq ghz] [--timestamps out.csv]\n");
+    return 2;
+}
+
+struct options {
+    int64_t tol = 0;
+    size_t frame = 0, report = 10;
+    double freq = 1.25;
+    std::string timestamps;
+};
+
+// start times of the iterations of the actual stream, as min/mean/max intervals
+struct iteration_times {
+    const options &o;
+    FILE *csv = nullptr;
+    size_t count = 0;
+    double first = -1, last = -1;
+    double min = 0, max = 0, sum = 0;
+
+    explicit iteration_times(const options &opt) : o(opt)
+    {
+        if (o.timestamps.empty())
+            return;
+        csv = std::fopen(o.timestamps.c_str(), "w");
+        if (!csv)
+            throw std::runtime_error("cannot create " + o.timestamps);
+        std::fprintf(csv, "iteration,time_ns,cycles,interval_cycles\n");
+    }
+    ~iteration_times()
+    {
+        if (csv)
+            std::fclose(csv);
+    }
+
+    void start(double t)
+    {
+        if (t < 0)
+            return;
+        const double interval = last < 0 ? 0 : (t - last) * o.freq;
+        if (last >= 0) {
+            min = count == 1 ? interval : std::min(min, interval);
+            max = std::max(max, interval);
+            sum += interval;
+        } else {
+            first = t;
+        }
+        if (csv)
+            std::fprintf(csv, "%zu,%.3f,%.0f,%.0f\n", count, t, t * o.freq, interval);
+        last = t;
+        ++count;
+    }
+
+    void print() const
+    {
+        if (count == 0)
+            return;
+        std::printf("%zu iterations from %.1f ns to %.1f ns", count, first, last);
+        if (count > 1)
+            std::printf(", interval min %.0f / mean %.0f / max %.0f cycles at %.2f GHz", min, sum / (count - 1), max,
+                        o.freq);
+        std::printf("\n");
+    }
+};
+
+static bool compare(plio::dtype t, const std::string &actual, const std::string &expected, const options &o)
+{
+    plio::reader a(actual, t), e(expected, t);
+    iteration_times times(o);
+
+    size_t n = 0, bad = 0, worst_at = 0;
+    int64_t worst = 0;
+    bool same_length = true;
+    double prev_time = -1;
+    for (int64_t va, ve;; ++n) {
+        const bool has_a = a.next(va), has_e = e.next(ve);
+        if (has_a != has_e) {
+            size_t longer = n + 1;
+            for (int64_t v; (has_a ? a : e).next(v);)
+                ++longer;
+            std::printf("%s has %zu values, %s has %zu\n", actual.c_str(), has_a ? longer : n, expected.c_str(),
+                        has_e ? longer : n);
+            same_length = false;
+        }
+        if (!has_a || !has_e)
+            break;
+
+        // a new iteration every frame values, or at every new timestamp
+        if (o.frame ? n % o.frame == 0 : a.time_ns() != prev_time)
+            times.start(a.time_ns());
+        prev_time = a.time_ns();
+
+        const int64_t diff = va > ve ? va - ve : ve - va;
+        if (diff <= o.tol)
+            continue;
+        if (diff > worst)
+            worst = diff, worst_at = n;
+        if (bad++ < o.report) {
+            std::printf("[%zu]", n);
+            if (o.frame)
+                std::printf(" iteration %zu element %zu", n / o.frame, n % o.frame);
+            if (a.line())
+                std::printf(" line %zu", a.line());
+            if (a.time_ns() >= 0)
+                std::printf(" at %.1f ns", a.time_ns());
+            std::printf(": %lld, expected %lld\n", static_cast<long long>(va), static_cast<long long>(ve));
+        }
+    }
+
+    times.print();
+    const std::string tol = o.tol ? std::to_string(o.tol) : "";
+    if (bad)
+        std::printf("%zu of %zu values differ%s, largest difference %lld at [%zu]\n", bad, n,
+                    o.tol ? (" by more than " + tol).c_str() : "", static_cast<long long>(worst), worst_at);
+    else
+        std::printf("%s%zu %s values match%s\n", same_length ? "" : "the first ", n, plio::dtype_name(t),
+                    o.tol ? (" within " + tol).c_str() : "");
+    return bad == 0 && same_length;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 4)
+        return usage();
+
+    try {
+        const plio::dtype t = plio::parse_dtype(argv[1]);
+        options o;
+        for (int i = 4; i < argc; i += 2) {
+            const std::string opt = argv[i];
+            if (i + 1 >= argc)
+                return usage();
+            if (opt == "--tol") {
+                o.tol = std::strtoll(argv[i + 1], nullptr, 10);
+                if (o.tol < 0)
+                    throw std::runtime_error("--tol must be >= 0");
+            }
+            else if (opt == "--frame")
+                o.frame = std::strtoul(argv[i + 1], nullptr, 10);
+            else if (opt == "--report")
+                o.report = std::strtoul(argv[i + 1], nullptr, 10);
+            else if (opt == "--freq")
+                o.freq = std::strtod(argv[i + 1], nullptr);
+            else if (opt == "--timestamps")
+                o.timestamps = argv[i + 1];
+            else
+                return usage();
+        }
+        return compare(t, argv[2], argv[3], o) ? 0 : 1;
+    } catch (const std::exception &e) {
+        std::fprintf(stderr, "plio_compare: %s\n", e.what());
+        return 1;
+    }
+}
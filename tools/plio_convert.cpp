@@ -0,0 +1,63 @@
+/*
+*	Convert and validate PLIO data files.
+*
+*	How to run:
+*	plio_convert.exe txt2bin  <dtype> in.txt out.bin
+*	plio_convert.exe bin2txt  <dtype> in.bin out.txt [values_per_line]
+*	plio_convert.exe validate <dtype> file [plio_bits]
+*
+*	dtype is one of int8, int16, int32, uint8, uint16, uint32. Text input may
+*	be aiesimulator output; its T/TLAST lines are dropped on conversion.
+*	values_per_line defaults to one 128-bit PLIO word per line.
+*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <string>
+
+#include "plio.h"
+
+static int usage()
+{
+    std::fprintf(stderr,
+                 "usage: plio_convert txt2bin  <dtype> in.txt out.bin\n"
+                 "       plio_convert bin2txt  <dtype> in.bin out.txt [values_per_line]\n"
+                 "       plio_convert validate <dtype> file [plio_bits]\n");
+    return 2;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 4)
+        return usage();
+
+    const std::string cmd = argv[1];
+    try {
+        plio::dtype t = plio::parse_dtype(argv[2]);
+
+        if (cmd == "txt2bin" && argc == 5) {
+            plio::write_binary(argv[4], plio::read_text(argv[3], t), t);
+        } else if (cmd == "bin2txt" && (argc == 5 || argc == 6)) {
+            size_t per_line = argc == 6 ? std::strtoul(argv[5], nullptr, 10) : plio::values_per_word(t);
+            if (per_line == 0)
+                return usage();
+            plio::write_text(argv[4], plio::read_binary(argv[3], t), per_line);
+        } else if (cmd == "validate" && (argc == 4 || argc == 5)) {
+            size_t bits = argc == 5 ? std::strtoul(argv[4], nullptr, 10) : 128;
+            size_t n = 0;
+            std::string err = plio::validate(argv[3], t, bits, &n);
+            if (!err.empty()) {
+                std::fprintf(stderr, "%s: %s\n", argv[3], err.c_str());
+                return 1;
+            }
+            std::printf("%s: %zu %s values, OK\n", argv[3], n, plio::dtype_name(t));
+        } else {
+            return usage();
+        }
+    } catch (const std::exception &e) {
+        std::fprintf(stderr, "plio_convert: %s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,763 @@
+/*
+*	Where the cycles of an aiesimulator run go, per kernel tile, from the
+*	VCD of `aiesimulator --dump-vcd` and the `--profile` reports, without
+*	opening vitis_analyzer.
+*
+*	How to run:
+*	trace_report.exe tutorial.vcd [--profile aiesimulator_output] [--freq ghz] [--map rules.txt]
+*	                 [--json out.json|-] [--signals]
+*	trace_report.exe --profile aiesimulator_output
+*
+*	The VCD is streamed through mmap. Each signal is given to a tile by the
+*	<col>_<row> in its hierarchical name (tile_24_0, core_24_0, ...) and to a
+*	category by the first matching rule, case-insensitive:
+*
+*	  ignore     dma                                  DMA locks and streams are not the core's
+*	  state      state|status                         string core state: run, idle, stall causes
+*	  instr      instr|opcode|mnemonic                MAC while the value names a (v|l)mac/mul/msc
+*	  function   func                                 current function, per function time
+*	  lock       lock and stall|wait|acq              core waiting on a window lock
+*	  stream_out stream|ss and out|write|put and stall  output backpressure
+*	  stream_in  stream|ss and in|read|get and stall  input starvation
+*	  stream     stream and stall|backpressure
+*	  cascade    cascade and stall
+*	  memory     mem|bank and stall|conflict
+*	  stall      stall                                any other stall
+*	  mac        vmac|vmul|mac_active|mac_busy        vector MAC unit busy
+*	  enable     core and enable|active|run           core running
+*
+*	Scalar and vector signals count while nonzero. --map adds rules, lines
+*	"<category> <regex>", tried before these. --signals lists the signals
+*	of the trace with the tile and category they got, to write such rules.
+*
+*	Per tile it reports the span the core was enabled (first to last event
+*	when the trace has no enable or state signal), the active and stalled
+*	cycles, the stall cycles by cause (causes may overlap), the lock waits
+*	(count, total, longest), the stream stalls, and the vector MAC
+*	utilization of the active and of all cycles. Tiles are named after the
+*	function they spent the most time in, from the function signal or the
+*	profile.
+*
+*	--profile reads the profile_funct_<col>_<row> reports of aiesimulator
+*	--profile (XML) in a directory: per function, the calls and the cycles
+*	with and without the functions it calls. The fields are found by name
+*	(name/function, calls, cycles, total/descendants), not by position.
+*
+*	--json writes the same as JSON, to a file or to stdout with -.
+*/
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <exception>
+#include <fstream>
+#include <map>
+#include <regex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "plio.h"
+
+static int usage()
+{
+    std::fprintf(stderr, "usage: trace_report trace.vcd [--profile dir] [--freq ghz] [--map rules.txt] "
+                         "[--json out.json|-] [--signals]\n"
+                         "       trace_report --profile dir [--json out.json|-]\n");
+    return 2;
+}
+
+enum category { none, ignore, state, instr, function, lock, stream_out, stream_in, stream, cascade, memory, stall,
+                mac, enable, active, off, categories };
+
+static const char *category_names[categories] = {"none",  "ignore", "state",   "instr",  "function", "lock",
+                                                 "stream_out", "stream_in", "stream", "cascade", "memory",
+                                                 "stall", "mac",    "enable",  "active", "off"};
+
+static bool is_stall(int c) { return c >= lock && c <= stall; }
+
+static std::string lower(std::string s)
+{
+    for (char &c : s)
+        c = char(std::tolower(static_cast<unsigned char>(c)));
+    return s;
+}
+
+struct rule {
+    category cat;
+    std::regex re;
+};
+
+static std::vector<rule> default_rules()
+{
+    const std::pair<category, const char *> r[] = {
+        {ignore, "dma"},
+        {state, "state|status"},
+        {instr, "instr|opcode|mnemonic"},
+        {function, "func"},
+        {lock, "lock.*(stall|wait|acq)|(stall|wait|acq).*lock"},
+        {stream_out, "(stream|ss).*(out|write|put).*(stall|wait|backpressure)|"
+                     "(stall|wait|backpressure).*(stream|ss).*(out|write|put)"},
+        {stream_in, "(stream|ss).*(in|read|get).*(stall|wait|starv)|(stall|wait|starv).*(stream|ss).*(in|read|get)"},
+        {stream, "stream.*(stall|backpressure)|(stall|backpressure).*stream"},
+        {cascade, "cascade.*stall|stall.*cascade"},
+        {memory, "(mem|bank).*(stall|conflict)|(stall|conflict).*(mem|bank)"},
+        {stall, "stall"},
+        {mac, "vmac|vmul|mac_active|mac_busy"},
+        {enable, "core.*(enable|active|run)|(enable|active|run).*core"},
+    };
+    std::vector<rule> rules;
+    for (const auto &p : r)
+        rules.push_back({p.first, std::regex(p.second, std::regex::icase | std::regex::optimize)});
+    return rules;
+}
+
+static std::vector<rule> read_rules(const std::string &path)
+{
+    std::ifstream f(path);
+    if (!f)
+        throw std::runtime_error("cannot open " + path);
+    std::vector<rule> rules;
+    std::string line;
+    for (size_t n = 1; std::getline(f, line); ++n) {
+        std::istringstream s(line);
+        std::string cat, re;
+        if (!(s >> cat) || cat[0] == '#')
+            continue;
+        std::getline(s >> std::ws, re);
+        const auto it = std::find(category_names, category_names + categories, cat);
+        if (it == category_names + categories || re.empty())
+            throw std::runtime_error(path + ":" + std::to_string(n) + ": expected <category> <regex>");
+        rules.push_back({category(it - category_names), std::regex(re, std::regex::icase | std::regex::optimize)});
+    }
+    return rules;
+}
+
+// what a string value of a state signal means
+static category state_value(const std::string &v)
+{
+    const std::string s = lower(v);
+    if (s.find("lock") != std::string::npos)
+        return lock;
+    if (s.find("stream") != std::string::npos)
+        return s.find("out") != std::string::npos ? stream_out
+               : s.find("in") != std::string::npos ? stream_in : stream;
+    if (s.find("cascade") != std::string::npos)
+        return cascade;
+    if (s.find("mem") != std::string::npos || s.find("bank") != std::string::npos)
+        return memory;
+    if (s.find("stall") != std::string::npos)
+        return stall;
+    if (s.empty() || s.find("idle") != std::string::npos || s.find("disable") != std::string::npos ||
+        s.find("done") != std::string::npos || s.find("halt") != std::string::npos ||
+        s.find("sleep") != std::string::npos)
+        return off;
+    return active;
+}
+
+static bool is_mac_instr(const std::string &v)
+{
+    static const std::regex re("(^|[^a-z])(v|l)?(mac|mul|msc)", std::regex::icase | std::regex::optimize);
+    return std::regex_search(v, re);
+}
+
+/*
+ *  Accounting. Every signal is a channel whose current category (or none)
+ *  changes with its value. Tiles are advanced lazily to the time of each
+ *  change of one of their channels.
+ */
+
+struct channel {
+    std::string name;
+    int tile = -1;
+    category cat = none;            // from the rules
+    category now = none;            // what the current value counts as
+    std::string value;              // function name, for function channels
+    uint64_t since = 0, total = 0, episodes = 0, longest = 0;
+};
+
+struct tile {
+    int col = 0, row = 0;
+    bool has_enable = false, started = false;
+    int enabled = 0, stalled = 0, busy = 0;     // channels currently on
+    uint64_t last = 0;
+    uint64_t span = 0, active = 0, stall_time = 0, mac_time = 0;
+    uint64_t cause[categories] = {};
+    std::map<std::string, uint64_t> functions;  // time per function
+
+    void advance(uint64_t t)
+    {
+        if (started && t > last) {
+            const uint64_t d = t - last;
+            if (!has_enable || enabled > 0 || stalled > 0) {
+                span += d;
+                if (stalled > 0)
+                    stall_time += d;
+                else
+                    active += d;
+                if (busy > 0 && stalled == 0)
+                    mac_time += d;
+            }
+        }
+        started = true;
+        last = t;
+    }
+};
+
+struct trace {
+    double ps_per_unit = 1;         // $timescale
+    uint64_t end = 0;
+    std::vector<channel> channels;
+    std::vector<tile> tiles;
+    std::map<std::string, std::vector<size_t>> ids;   // VCD id code -> channels
+};
+
+static int find_tile(trace &tr, const std::string &name)
+{
+    static const std::regex re("(?:tile|core|cm|aie)[_\\[\\(]?(\\d+)[_,](\\d+)", std::regex::icase);
+    std::smatch m;
+    if (!std::regex_search(name, m, re))
+        return -1;
+    const int col = std::stoi(m[1]), row = std::stoi(m[2]);
+    for (size_t i = 0; i < tr.tiles.size(); ++i)
+        if (tr.tiles[i].col == col && tr.tiles[i].row == row)
+            return int(i);
+    tile t;
+    t.col = col, t.row = row;
+    tr.tiles.push_back(t);
+    return int(tr.tiles.size() - 1);
+}
+
+static void set(trace &tr, channel &c, category now, const std::string &value, uint64_t t)
+{
+    tile &tl = tr.tiles[c.tile];
+    tl.advance(t);
+    if (c.now != none && c.now != off) {
+        const uint64_t d = t - c.since;
+        c.total += d;
+        c.longest = std::max(c.longest, d);
+        if (is_stall(c.now))
+            tl.cause[c.now] += d;
+        if (c.cat == function && !c.value.empty())
+            tl.functions[c.value] += d;
+    }
+    auto count = [&](category k, int step) {
+        if (k == enable || k == active)
+            tl.enabled += step;
+        else if (is_stall(k))
+            tl.stalled += step;
+        else if (k == mac)
+            tl.busy += step;
+    };
+    count(c.now, -1);
+    count(now, +1);
+    if (now != none && now != off && now != c.now)
+        ++c.episodes;
+    c.now = now;
+    c.value = value;
+    c.since = t;
+}
+
+// a value change of channel c to the VCD value v (scalar, vector, real or string)
+static void change(trace &tr, channel &c, const std::string &v, char kind, uint64_t t)
+{
+    category now = none;
+    switch (c.cat) {
+    case state:
+        now = state_value(v);
+        break;
+    case instr:
+        now = is_mac_instr(v) ? mac : none;
+        break;
+    case function:
+        now = v.empty() ? none : function;
+        break;
+    default:
+        if (kind == 's')
+            now = v.empty() ? none : c.cat;
+        else if (kind == 'r')
+            now = std::strtod(v.c_str(), nullptr) != 0 ? c.cat : none;
+        else
+            now = v.find('1') != std::string::npos ? c.cat : none;
+    }
+    set(tr, c, now, c.cat == function ? v : std::string(), t);
+}
+
+/*
+ *  VCD parsing: whitespace separated tokens, the header up to
+ *  $enddefinitions, then #time and value changes.
+ */
+
+struct tokens {
+    const char *p, *end;
+    bool next(std::string &tok)
+    {
+        while (p < end && std::isspace(static_cast<unsigned char>(*p)))
+            ++p;
+        if (p == end)
+            return false;
+        const char *s = p;
+        while (p < end && !std::isspace(static_cast<unsigned char>(*p)))
+            ++p;
+        tok.assign(s, p);
+        return true;
+    }
+    // up to the next $end
+    std::vector<std::string> block()
+    {
+        std::vector<std::string> out;
+        std::string tok;
+        while (next(tok) && tok != "$end")
+            out.push_back(tok);
+        return out;
+    }
+};
+
+static double timescale_ps(const std::vector<std::string> &words)
+{
+    std::string all;
+    for (const std::string &w : words)
+        all += w;
+    const double n = std::strtod(all.c_str(), nullptr);
+    const std::string unit = lower(all.substr(all.find_first_not_of("0123456789.")));
+    static const std::map<std::string, double> units = {{"s", 1e12}, {"ms", 1e9}, {"us", 1e6},
+                                                        {"ns", 1e3}, {"ps", 1},   {"fs", 1e-3}};
+    const auto it = units.find(unit);
+    if (it == units.end())
+        throw std::runtime_error("unknown $timescale " + all);
+    return (n > 0 ? n : 1) * it->second;
+}
+
+static trace read_vcd(const std::string &path, const std::vector<rule> &rules)
+{
+    plio::mapped_file f(path);
+    tokens tk{f.data(), f.data() + f.size()};
+    trace tr;
+    std::vector<std::string> scope;
+    std::string tok;
+
+    while (tk.next(tok)) {
+        if (tok == "$timescale") {
+            tr.ps_per_unit = timescale_ps(tk.block());
+        } else if (tok == "$scope") {
+            const std::vector<std::string> b = tk.block();
+            scope.push_back(b.size() > 1 ? b[1] : "");
+        } else if (tok == "$upscope") {
+            tk.block();
+            if (!scope.empty())
+                scope.pop_back();
+        } else if (tok == "$var") {
+            // $var <type> <size> <id> <reference> [<index>] $end
+            const std::vector<std::string> b = tk.block();
+            if (b.size() < 4)
+                throw std::runtime_error(path + ": malformed $var");
+            std::string name;
+            for (const std::string &s : scope)
+                name += s + ".";
+            for (size_t i = 3; i < b.size(); ++i)
+                name += b[i];
+            channel c;
+            c.name = name;
+            c.tile = find_tile(tr, name);
+            for (const rule &r : rules)
+                if (std::regex_search(name, r.re)) {
+                    c.cat = r.cat;
+                    break;
+                }
+            if (c.tile < 0 || c.cat == none || c.cat == ignore)
+                c.cat = ignore;
+            else if (c.cat == enable || c.cat == state)
+                tr.tiles[c.tile].has_enable = true;
+            tr.ids[b[2]].push_back(tr.channels.size());
+            tr.channels.push_back(c);
+        } else if (tok == "$enddefinitions") {
+            tk.block();
+            break;
+        } else if (tok[0] == '$') {
+            tk.block();
+        }
+    }
+
+    uint64_t t = 0;
+    std::string id, value;
+    auto apply = [&](const std::string &code, const std::string &v, char kind) {
+        const auto it = tr.ids.find(code);
+        if (it == tr.ids.end())
+            return;
+        for (size_t i : it->second)
+            if (tr.channels[i].cat != ignore)
+                change(tr, tr.channels[i], v, kind, t);
+    };
+    while (tk.next(tok)) {
+        const char c0 = tok[0];
+        if (c0 == '#') {
+            t = std::strtoull(tok.c_str() + 1, nullptr, 10);
+            tr.end = std::max(tr.end, t);
+        } else if (c0 == '$') {
+            // $dumpvars/$dumpon/... blocks hold ordinary value changes; $comment does not
+            if (tok == "$comment")
+                tk.block();
+        } else if (c0 == 'b' || c0 == 'B' || c0 == 'r' || c0 == 'R' || c0 == 's' || c0 == 'S') {
+            if (!tk.next(id))
+                break;
+            apply(id, tok.substr(1), char(std::tolower(c0)));
+        } else {
+            // scalar: value and id in one token
+            apply(tok.substr(1), tok.substr(0, 1), '1');
+        }
+    }
+
+    // close what is still on at the end of the trace
+    for (channel &c : tr.channels)
+        if (c.cat != ignore && c.now != none)
+            set(tr, c, none, std::string(), tr.end);
+    for (tile &tl : tr.tiles)
+        if (tl.has_enable)
+            tl.advance(tr.end);
+    return tr;
+}
+
+/*
+ *  Profile reports: leaf elements are grouped by their parent element, and
+ *  every group with a name and a cycle count is one function.
+ */
+
+struct function_profile {
+    std::string name;
+    uint64_t calls = 0, self = 0, total = 0;
+};
+
+struct tile_profile {
+    std::string file;
+    int col = -1, row = -1;
+    std::vector<function_profile> functions;
+};
+
+static std::string xml_text(std::string s)
+{
+    const std::pair<const char *, const char *> ent[] = {{"&lt;", "<"}, {"&gt;", ">"}, {"&quot;", "\""},
+                                                         {"&apos;", "'"}, {"&amp;", "&"}};
+    for (const auto &e : ent)
+        for (size_t i; (i = s.find(e.first)) != std::string::npos;)
+            s.replace(i, std::strlen(e.first), e.second);
+    const size_t a = s.find_first_not_of(" \t\r\n"), b = s.find_last_not_of(" \t\r\n");
+    return a == std::string::npos ? "" : s.substr(a, b - a + 1);
+}
+
+static void add_function(tile_profile &tp, const std::map<std::string, std::string> &fields)
+{
+    function_profile fp;
+    std::vector<std::pair<std::string, uint64_t>> cycles;
+    for (const auto &kv : fields) {
+        const std::string k = lower(kv.first);
+        if (k.find("cycle") != std::string::npos)
+            cycles.push_back({k, std::strtoull(kv.second.c_str(), nullptr, 10)});
+        else if (k.find("call") != std::string::npos)
+            fp.calls = std::strtoull(kv.second.c_str(), nullptr, 10);
+        else if (fp.name.empty() && (k.find("name") != std::string::npos || k.find("function") != std::string::npos))
+            fp.name = kv.second;
+    }
+    if (fp.name.empty() || cycles.empty())
+        return;
+    for (const auto &c : cycles) {
+        const bool with_callees = c.first.find("total") != std::string::npos ||
+                                  c.first.find("desc") != std::string::npos ||
+                                  c.first.find("incl") != std::string::npos;
+        (with_callees ? fp.total : fp.self) = c.second;
+    }
+    if (!fp.self)
+        fp.self = fp.total;
+    if (!fp.total)
+        fp.total = fp.self;
+    tp.functions.push_back(fp);
+}
+
+static tile_profile read_profile(const std::string &path)
+{
+    tile_profile tp;
+    tp.file = path;
+    static const std::regex re("_(\\d+)_(\\d+)\\.[a-z]+$");
+    std::smatch m;
+    if (std::regex_search(path, m, re))
+        tp.col = std::stoi(m[1]), tp.row = std::stoi(m[2]);
+
+    plio::mapped_file f(path);
+    const std::string s(f.data(), f.size());
+    // stack of open elements, each with the leaf fields and attributes seen in it
+    std::vector<std::pair<std::map<std::string, std::string>, bool>> open;   // fields, has children
+    size_t i = 0;
+    while ((i = s.find('<', i)) != std::string::npos) {
+        const size_t close = s.find('>', i);
+        if (close == std::string::npos)
+            break;
+        const std::string tag = s.substr(i + 1, close - i - 1);
+        const size_t text_start = close + 1;
+        i = close + 1;
+        if (tag.empty() || tag[0] == '?' || tag[0] == '!')
+            continue;
+        if (tag[0] == '/') {
+            if (open.empty())
+                continue;
+            auto node = open.back();
+            open.pop_back();
+            if (node.second)
+                add_function(tp, node.first);
+            continue;
+        }
+        const bool self_closing = tag.back() == '/';
+        std::istringstream ts(tag.substr(0, tag.size() - self_closing));
+        std::string name;
+        ts >> name;
+        std::map<std::string, std::string> attrs;
+        static const std::regex attr("([A-Za-z_:][-A-Za-z0-9_:.]*)\\s*=\\s*\"([^\"]*)\"");
+        for (std::sregex_iterator a(tag.begin(), tag.end(), attr), e; a != e; ++a)
+            attrs[(*a)[1]] = xml_text((*a)[2]);
+        if (self_closing) {
+            add_function(tp, attrs);
+            continue;
+        }
+        // a leaf: <name>text</name>
+        const size_t next = s.find('<', text_start);
+        if (next != std::string::npos && s.compare(next, name.size() + 3, "</" + name + ">") == 0) {
+            if (!open.empty()) {
+                open.back().first[name] = xml_text(s.substr(text_start, next - text_start));
+                open.back().second = true;
+            }
+            i = next + name.size() + 3;
+            continue;
+        }
+        open.push_back({attrs, !attrs.empty()});
+    }
+    std::sort(tp.functions.begin(), tp.functions.end(),
+              [](const function_profile &a, const function_profile &b) { return a.total > b.total; });
+    return tp;
+}
+
+static std::vector<tile_profile> read_profiles(const std::string &dir)
+{
+    std::vector<std::string> files;
+    DIR *d = opendir(dir.c_str());
+    if (!d)
+        throw std::runtime_error("cannot open " + dir);
+    while (dirent *e = readdir(d)) {
+        const std::string n = e->d_name;
+        if (n.rfind("profile_funct", 0) == 0 && n.size() > 4 && n.compare(n.size() - 4, 4, ".xml") == 0)
+            files.push_back(dir + "/" + n);
+    }
+    closedir(d);
+    std::sort(files.begin(), files.end());
+    if (files.empty())
+        throw std::runtime_error("no profile_funct_*.xml in " + dir + ", run aiesimulator with --profile");
+    std::vector<tile_profile> out;
+    for (const std::string &f : files)
+        out.push_back(read_profile(f));
+    return out;
+}
+
+/*
+ *  Reports
+ */
+
+// the kernel a tile runs: the function with the most time that is not the runtime's
+static std::string kernel_name(const std::map<std::string, uint64_t> &functions)
+{
+    std::string best;
+    uint64_t most = 0;
+    for (const auto &f : functions)
+        if (f.first.rfind("_", 0) != 0 && f.first.rfind("main", 0) != 0 && f.second > most)
+            best = f.first, most = f.second;
+    return best;
+}
+
+static std::string json_string(const std::string &s)
+{
+    std::string out = "\"";
+    for (char c : s) {
+        if (c == '"' || c == '\\')
+            out += '\\';
+        if (static_cast<unsigned char>(c) < 0x20)
+            continue;
+        out += c;
+    }
+    return out + "\"";
+}
+
+struct report {
+    const trace *tr = nullptr;
+    std::vector<tile_profile> profiles;
+    double ps_per_cycle = 800;
+
+    double cycles(uint64_t t) const { return double(t) * tr->ps_per_unit / ps_per_cycle; }
+
+    std::string name(const tile &tl) const
+    {
+        std::string n = kernel_name(tl.functions);
+        for (const tile_profile &p : profiles)
+            if (n.empty() && p.col == tl.col && p.row == tl.row) {
+                std::map<std::string, uint64_t> f;
+                for (const function_profile &fp : p.functions)
+                    f[fp.name] = fp.total;
+                n = kernel_name(f);
+            }
+        return n.empty() ? "?" : n;
+    }
+
+    void text() const
+    {
+        if (tr) {
+            std::printf("%zu tiles, %.0f cycles traced (%.4g ps per cycle)\n", tr->tiles.size(), cycles(tr->end),
+                        ps_per_cycle);
+            std::printf("%-7s %-20s %10s %10s %10s %8s %8s %8s %8s %8s %7s %7s\n", "tile", "kernel", "span", "active",
+                        "stalled", "lock", "str in", "str out", "memory", "cascade", "MAC/act", "MAC/all");
+            for (const tile &tl : tr->tiles) {
+                if (!tl.started)
+                    continue;
+                const double act = cycles(tl.active), span = cycles(tl.span), mac_c = cycles(tl.mac_time);
+                std::printf("%3d_%-3d %-20.20s %10.0f %10.0f %10.0f %8.0f %8.0f %8.0f %8.0f %8.0f %6.1f%% %6.1f%%\n",
+                            tl.col, tl.row, name(tl).c_str(), span, act, cycles(tl.stall_time), cycles(tl.cause[lock]),
+                            cycles(tl.cause[stream_in] + tl.cause[stream]), cycles(tl.cause[stream_out]),
+                            cycles(tl.cause[memory]), cycles(tl.cause[cascade]), act ? 100 * mac_c / act : 0,
+                            span ? 100 * mac_c / span : 0);
+            }
+            for (const channel &c : tr->channels)
+                if ((c.cat == lock || c.cat == stream_in || c.cat == stream_out || c.cat == stream) && c.episodes)
+                    std::printf("  %d_%d %s: %llu waits, %.0f cycles, longest %.0f\n", tr->tiles[c.tile].col,
+                                tr->tiles[c.tile].row, c.name.c_str(), static_cast<unsigned long long>(c.episodes),
+                                cycles(c.total), cycles(c.longest));
+        }
+        for (const tile_profile &p : profiles) {
+            std::printf("\n%s\n  %-40s %8s %12s %12s\n", p.file.c_str(), "function", "calls", "cycles", "+callees");
+            for (const function_profile &f : p.functions)
+                std::printf("  %-40.40s %8llu %12llu %12llu\n", f.name.c_str(),
+                            static_cast<unsigned long long>(f.calls), static_cast<unsigned long long>(f.self),
+                            static_cast<unsigned long long>(f.total));
+        }
+    }
+
+    void json(FILE *fp) const
+    {
+        std::fprintf(fp, "{\n  \"tiles\": [");
+        const char *sep = "";
+        if (tr)
+            for (size_t i = 0; i < tr->tiles.size(); ++i) {
+                const tile &tl = tr->tiles[i];
+                if (!tl.started)
+                    continue;
+                const double act = cycles(tl.active), span = cycles(tl.span), mac_c = cycles(tl.mac_time);
+                std::fprintf(fp,
+                             "%s\n    {\"tile\": [%d, %d], \"kernel\": %s, \"span\": %.0f, \"active\": %.0f, "
+                             "\"stalled\": %.0f, \"stalls\": {\"lock\": %.0f, \"stream_in\": %.0f, \"stream_out\": "
+                             "%.0f, \"memory\": %.0f, \"cascade\": %.0f, \"other\": %.0f}, \"mac\": %.0f, "
+                             "\"mac_util_active\": %.4f, \"mac_util\": %.4f, \"waits\": [",
+                             sep, tl.col, tl.row, json_string(name(tl)).c_str(), span, act, cycles(tl.stall_time),
+                             cycles(tl.cause[lock]), cycles(tl.cause[stream_in] + tl.cause[stream]),
+                             cycles(tl.cause[stream_out]), cycles(tl.cause[memory]), cycles(tl.cause[cascade]),
+                             cycles(tl.cause[stall]), mac_c, act ? mac_c / act : 0, span ? mac_c / span : 0);
+                const char *wsep = "";
+                for (const channel &c : tr->channels)
+                    if (c.tile == int(i) && is_stall(c.cat) && c.episodes) {
+                        std::fprintf(fp, "%s{\"signal\": %s, \"cause\": \"%s\", \"count\": %llu, \"cycles\": %.0f, "
+                                         "\"longest\": %.0f}",
+                                     wsep, json_string(c.name).c_str(), category_names[c.cat],
+                                     static_cast<unsigned long long>(c.episodes), cycles(c.total), cycles(c.longest));
+                        wsep = ", ";
+                    }
+                std::fprintf(fp, "]}");
+                sep = ",";
+            }
+        std::fprintf(fp, "\n  ],\n  \"profiles\": [");
+        sep = "";
+        for (const tile_profile &p : profiles) {
+            std::fprintf(fp, "%s\n    {\"file\": %s, \"tile\": [%d, %d], \"functions\": [", sep,
+                         json_string(p.file).c_str(), p.col, p.row);
+            const char *fsep = "";
+            for (const function_profile &f : p.functions) {
+                std::fprintf(fp, "%s\n      {\"name\": %s, \"calls\": %llu, \"cycles\": %llu, \"total\": %llu}", fsep,
+                             json_string(f.name).c_str(), static_cast<unsigned long long>(f.calls),
+                             static_cast<unsigned long long>(f.self), static_cast<unsigned long long>(f.total));
+                fsep = ",";
+            }
+            std::fprintf(fp, "]}");
+            sep = ",";
+        }
+        std::fprintf(fp, "\n  ]\n}\n");
+    }
+};
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+        return usage();
+
+    try {
+        std::string vcd, profile_dir, map, json;
+        double freq = 1.25;
+        bool signals = false;
+        for (int i = 1; i < argc; ++i) {
+            const std::string opt = argv[i];
+            if (opt == "--signals") {
+                signals = true;
+            } else if (opt[0] != '-' || opt == "-") {
+                if (!vcd.empty())
+                    return usage();
+                vcd = opt;
+            } else if (i + 1 >= argc) {
+                return usage();
+            } else if (opt == "--profile") {
+                profile_dir = argv[++i];
+            } else if (opt == "--freq") {
+                freq = std::strtod(argv[++i], nullptr);
+            } else if (opt == "--map") {
+                map = argv[++i];
+            } else if (opt == "--json") {
+                json = argv[++i];
+            } else {
+                return usage();
+            }
+        }
+        if (vcd.empty() && profile_dir.empty())
+            return usage();
+
+        std::vector<rule> rules = map.empty() ? std::vector<rule>() : read_rules(map);
+        for (rule &r : default_rules())
+            rules.push_back(r);
+
+        trace tr;
+        report rep;
+        rep.ps_per_cycle = 1000.0 / freq;
+        if (!vcd.empty()) {
+            tr = read_vcd(vcd, rules);
+            rep.tr = &tr;
+        }
+        if (signals) {
+            for (const channel &c : tr.channels)
+                std::printf("%-8s %-10s %s\n",
+                            c.tile < 0 ? "-" : (std::to_string(tr.tiles[c.tile].col) + "_" +
+                                                std::to_string(tr.tiles[c.tile].row)).c_str(),
+                            category_names[c.cat], c.name.c_str());
+            return 0;
+        }
+        if (!profile_dir.empty())
+            rep.profiles = read_profiles(profile_dir);
+
+        if (json.empty()) {
+            rep.text();
+        } else if (json == "-") {
+            rep.json(stdout);
+        } else {
+            FILE *fp = std::fopen(json.c_str(), "w");
+            if (!fp)
+                throw std::runtime_error("cannot create " + json);
+            rep.json(fp);
+            std::fclose(fp);
+        }
+    } catch (const std::exception &e) {
+        std::fprintf(stderr, "trace_report: %s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,171 @@
+/*
+ *  Binary weight blobs: one file per weight matrix, shared by the header
+ *  generator (pack_weights.exe), the run-time weight path (graph.update() in
+ *  the WEIGHTS=rtp graphs) and the golden models (weight_blob.py).
+ *
+ *  Layout, little-endian:
+ *
+ *      0   char[4]  magic "AIEW"
+ *      4   u16      version (1)
+ *      6   u8       dtype, plio::dtype
+ *      7   u8       layout: 0 row-major, 1 GemV packed (weight_pack.h)
+ *      8   u32      rows (inputs, DX)
+ *      12  u32      cols (outputs, DY)
+ *      16  u32      column block of the packed layout, 0 for row-major
+ *      20  u32      offset of the data, a multiple of 64
+ *      24  u64      data size in bytes
+ *      32  u8[32]   reserved, zero
+ *
+ *  followed by the elements at `offset`, so a mapped or DMA'd blob can be
+ *  handed to a 256-bit load as is.
+ *
+ *  Header only, so graph.cpp can load blobs without linking anything.
+ */
+
+#ifndef WEIGHT_BLOB_H
+#define WEIGHT_BLOB_H
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "plio.h"
+#include "weight_pack.h"
+
+namespace weight_blob {
+
+constexpr char magic[4] = {'A', 'I', 'E', 'W'};
+constexpr uint16_t version = 1;
+constexpr uint32_t alignment = 64;
+
+enum class layout : uint8_t { row_major = 0, gemv_packed = 1 };
+
+struct header {
+    char magic[4];
+    uint16_t version;
+    uint8_t dtype;
+    uint8_t layout;
+    uint32_t rows;
+    uint32_t cols;
+    uint32_t block;
+    uint32_t offset;
+    uint64_t bytes;
+    uint8_t reserved[32];
+};
+static_assert(sizeof(header) == 64, "weight blob header must be 64 bytes");
+
+struct blob {
+    header h;
+    std::vector<unsigned char> data;
+
+    plio::dtype type() const { return static_cast<plio::dtype>(h.dtype); }
+    weight_blob::layout order() const { return static_cast<weight_blob::layout>(h.layout); }
+    size_t count() const { return h.rows * size_t(h.cols); }
+
+    // Elements as stored, sign or zero extended.
+    std::vector<int64_t> values() const
+    {
+        const size_t es = plio::dtype_size(type());
+        const bool is_signed = type() == plio::dtype::int8 || type() == plio::dtype::int16 || type() == plio::dtype::int32;
+        std::vector<int64_t> v(count());
+        for (size_t i = 0; i < v.size(); ++i) {
+            uint64_t u = 0;
+            std::memcpy(&u, data.data() + i * es, es);
+            const unsigned sh = 64 - 8 * unsigned(es);
+            v[i] = is_signed ? static_cast<int64_t>(u << sh) >> sh : static_cast<int64_t>(u);
+        }
+        return v;
+    }
+
+    // Elements in the given order, repacking when the blob is stored the other way.
+    std::vector<int64_t> values(weight_blob::layout want) const
+    {
+        std::vector<int64_t> v = values();
+        if (want == order())
+            return v;
+        if (want == layout::gemv_packed)
+            return weight_pack::pack_gemv(v, h.rows, h.cols);
+        return weight_pack::unpack_gemv(v, h.rows, h.cols, h.block);
+    }
+};
+
+// Write values (one per element, range checked by the caller) as a blob.
+inline void write(const std::string &path, plio::dtype t, layout order, size_t rows, size_t cols,
+                  const std::vector<int64_t> &values)
+{
+    if (values.size() != rows * cols)
+        throw std::invalid_argument("weight_blob: " + std::to_string(values.size()) + " values for a " +
+                                    std::to_string(rows) + "x" + std::to_string(cols) + " matrix");
+    const size_t es = plio::dtype_size(t);
+
+    header h{};
+    std::memcpy(h.magic, magic, sizeof(magic));
+    h.version = version;
+    h.dtype = static_cast<uint8_t>(t);
+    h.layout = static_cast<uint8_t>(order);
+    h.rows = uint32_t(rows);
+    h.cols = uint32_t(cols);
+    h.block = order == layout::gemv_packed ? uint32_t(weight_pack::gemv_block) : 0;
+    h.offset = alignment;
+    h.bytes = values.size() * es;
+
+    std::vector<unsigned char> out(h.offset + h.bytes, 0);
+    std::memcpy(out.data(), &h, sizeof(h));
+    for (size_t i = 0; i < values.size(); ++i) {
+        const uint64_t u = static_cast<uint64_t>(values[i]);
+        std::memcpy(out.data() + h.offset + i * es, &u, es);
+    }
+
+    std::ofstream f(path, std::ios::binary);
+    if (!f.write(reinterpret_cast<const char *>(out.data()), out.size()))
+        throw std::runtime_error("weight_blob: cannot write " + path);
+}
+
+inline blob read(const std::string &path)
+{
+    std::ifstream f(path, std::ios::binary);
+    if (!f)
+        throw std::runtime_error("weight_blob: cannot open " + path);
+    std::vector<unsigned char> file((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+
+    blob b;
+    if (file.size() < sizeof(header))
+        throw std::runtime_error("weight_blob: " + path + " is too short for a header");
+    std::memcpy(&b.h, file.data(), sizeof(header));
+    if (std::memcmp(b.h.magic, magic, sizeof(magic)) != 0)
+        throw std::runtime_error("weight_blob: " + path + " is not a weight blob");
+    if (b.h.version != version)
+        throw std::runtime_error("weight_blob: " + path + " has version " + std::to_string(b.h.version));
+    if (b.h.dtype > static_cast<uint8_t>(plio::dtype::uint32) || b.h.layout > static_cast<uint8_t>(layout::gemv_packed))
+        throw std::runtime_error("weight_blob: " + path + " has an unknown dtype or layout");
+    if (b.h.bytes != b.count() * plio::dtype_size(b.type()) || b.h.offset + b.h.bytes > file.size())
+        throw std::runtime_error("weight_blob: " + path + " is truncated or its size does not match its shape");
+
+    b.data.assign(file.begin() + b.h.offset, file.begin() + b.h.offset + b.h.bytes);
+    return b;
+}
+
+// Load a rows x cols matrix of T in the given order, checking shape and element size.
+template <typename T>
+std::vector<T> load(const std::string &path, size_t rows, size_t cols, layout order)
+{
+    static_assert(std::is_integral_v<T>, "weight blobs hold integers");
+    blob b = read(path);
+    if (b.h.rows != rows || b.h.cols != cols)
+        throw std::runtime_error("weight_blob: " + path + " is " + std::to_string(b.h.rows) + "x" +
+                                 std::to_string(b.h.cols) + ", expected " + std::to_string(rows) + "x" +
+                                 std::to_string(cols));
+    if (plio::dtype_size(b.type()) != sizeof(T))
+        throw std::runtime_error("weight_blob: " + path + " element size does not match");
+    std::vector<int64_t> v = b.values(order);
+    return std::vector<T>(v.begin(), v.end());
+}
+
+} // namespace weight_blob
+
+#endif // WEIGHT_BLOB_H
@@ -0,0 +1,49 @@
+"""
+Reader for the binary weight blobs written by pack_weights.exe (format in
+weight_blob.h), so the golden models compute with exactly the weights the
+kernels and the run-time weight path see.
+
+    import weight_blob
+    mat_t = weight_blob.load("data/w.bin")      # rows x cols, row-major
+"""
+
+import struct
+
+import numpy as np
+
+MAGIC = b"AIEW"
+VERSION = 1
+HEADER = struct.Struct("<4sHBBIIIIQ32x")
+
+# plio::dtype order
+DTYPES = [np.int8, np.int16, np.int32, np.uint8, np.uint16, np.uint32]
+ROW_MAJOR, GEMV_PACKED = 0, 1
+
+
+def header(path):
+    """The blob header as a dict, after checking it against the file."""
+    with open(path, "rb") as f:
+        head = f.read(HEADER.size)
+        size = f.seek(0, 2)
+    if len(head) < HEADER.size:
+        raise ValueError(f"{path}: too short for a weight blob header")
+    magic, version, dtype, layout, rows, cols, block, offset, nbytes = HEADER.unpack(head)
+    if magic != MAGIC or version != VERSION:
+        raise ValueError(f"{path}: not a version {VERSION} weight blob")
+    if dtype >= len(DTYPES) or layout not in (ROW_MAJOR, GEMV_PACKED):
+        raise ValueError(f"{path}: unknown dtype {dtype} or layout {layout}")
+    dt = np.dtype(DTYPES[dtype]).newbyteorder("<")
+    if nbytes != rows * cols * dt.itemsize or offset + nbytes > size:
+        raise ValueError(f"{path}: truncated or size does not match {rows}x{cols}")
+    return dict(dtype=dt, layout=layout, rows=rows, cols=cols, block=block, offset=offset)
+
+
+def load(path):
+    """The blob's matrix as a rows x cols row-major array of its dtype."""
+    h = header(path)
+    rows, cols, block = h["rows"], h["cols"], h["block"]
+    data = np.fromfile(path, dtype=h["dtype"], count=rows * cols, offset=h["offset"])
+    if h["layout"] == ROW_MAJOR:
+        return data.reshape(rows, cols)
+    # [column block][row][block] -> [row][column]
+    return data.reshape(cols // block, rows, block).transpose(1, 0, 2).reshape(rows, cols).copy()
@@ -0,0 +1,77 @@
+/*
+ *  Weight packing in the order the int32 GemV kernels consume it.
+ *
+ *  The gemv_i32 kernels produce outputs in blocks of 16 columns and, inside a
+ *  block, walk the input rows in order: lmac8 takes one 16-wide row slice per
+ *  MAC, lmac4 two adjacent slices as one 32-element buffer. Laying the matrix
+ *  out as
+ *
+ *      for each column block, for each row k: mat[k][block*16 .. block*16+15]
+ *
+ *  serves both: a kernel walks one pointer with consecutive 256-bit loads and
+ *  post-increments, with no row arithmetic and no concat in the loop.
+ *
+ *  Only gemv_i32 (matrix_packed.h, matrix_heads.h and the split-K chunks)
+ *  uses this layout. The int16, int8 and mixed generators write the
+ *  row-major matrix.h.
+ *
+ *  The matrix is given row-major, rows = inputs (DX), cols = outputs (DY),
+ *  i.e. mat_t in run.py.
+ */
+
+#ifndef WEIGHT_PACK_H
+#define WEIGHT_PACK_H
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace weight_pack {
+
+constexpr size_t gemv_block = 16;
+
+// Position of mat[k][n] in the packed stream.
+inline size_t gemv_index(size_t k, size_t n, size_t rows, size_t block = gemv_block)
+{
+    return (n / block) * rows * block + k * block + n % block;
+}
+
+inline void check_gemv_shape(size_t rows, size_t cols, size_t block = gemv_block)
+{
+    if (block == 0 || cols % block != 0)
+        throw std::invalid_argument("weight_pack: " + std::to_string(cols) + " columns is not a multiple of " +
+                                    std::to_string(block));
+    if (rows % 8 != 0)
+        throw std::invalid_argument("weight_pack: " + std::to_string(rows) + " rows is not a multiple of 8");
+}
+
+template <typename T>
+std::vector<T> pack_gemv(const std::vector<T> &mat, size_t rows, size_t cols, size_t block = gemv_block)
+{
+    check_gemv_shape(rows, cols, block);
+    if (mat.size() != rows * cols)
+        throw std::invalid_argument("weight_pack: matrix has " + std::to_string(mat.size()) + " values, expected " +
+                                    std::to_string(rows) + "x" + std::to_string(cols));
+
+    std::vector<T> out(mat.size());
+    for (size_t k = 0; k < rows; ++k)
+        for (size_t n = 0; n < cols; ++n)
+            out[gemv_index(k, n, rows, block)] = mat[k * cols + n];
+    return out;
+}
+
+template <typename T>
+std::vector<T> unpack_gemv(const std::vector<T> &packed, size_t rows, size_t cols, size_t block = gemv_block)
+{
+    check_gemv_shape(rows, cols, block);
+    std::vector<T> mat(packed.size());
+    for (size_t k = 0; k < rows; ++k)
+        for (size_t n = 0; n < cols; ++n)
+            mat[k * cols + n] = packed.at(gemv_index(k, n, rows, block));
+    return mat;
+}
+
+} // namespace weight_pack
+
+#endif // WEIGHT_PACK_H